@@ -6,6 +6,7 @@
 #include "..\Library\Camera.h"
 #include "..\Library\Utility.h"
 #include "..\Library\Model.h"
+#include "..\Library\ModelCache.h"
 #include "..\Library\Mesh.h"
 #include "..\Library\ModelMaterial.h"
 #include "..\Library\PointLight.h"
@@ -16,11 +17,12 @@
 #include "..\Library\AnimationPlayer.h"
 #include "..\Library\AnimationClip.h"
 #include "..\Library\ProxyModel.h"
+#include "..\Library\TextBuilder.h"
+#include "..\Library\RenderPipeline.h"
 #include <WICTextureLoader.h>
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include <sstream>
-#include <iomanip>
 #include "Shlwapi.h"
 
 namespace Rendering
@@ -35,9 +37,15 @@ namespace Rendering
 		mMaterial(nullptr), mEffect(nullptr), mWorldMatrix(MatrixHelper::Identity),
 		mVertexBuffers(), mIndexBuffers(), mIndexCounts(), mColorTextures(),
 		mKeyboard(nullptr), mAmbientColor(reinterpret_cast<const float*>(&ColorHelper::White)), mPointLight(nullptr),
-		mSpecularColor(1.0f, 1.0f, 1.0f, 1.0f), mSpecularPower(25.0f), mSkinnedModel(nullptr), mAnimationPlayer(nullptr),
+		mSpecularColor(1.0f, 1.0f, 1.0f, 1.0f), mSpecularPower(25.0f), mSkinnedModel(), mAnimationPlayer(nullptr),
+		mWorldMatrixSlot(0), mPointLightSlot(0), mBonePaletteSlot(0), mDrawStates(),
 		mRenderStateHelper(game), mProxyModel(nullptr), mSpriteBatch(nullptr), mSpriteFont(nullptr), mTextPosition(0.0f, 40.0f), mManualAdvanceMode(true)
 	{
+		// The diffuse textures are named by the model, so only the models and effect can be declared; the proxy model is
+		// declared here because the proxy is created during Initialize
+		DeclareModel("..\\source\\Library\\Content\\Models\\RunningSoldier.dae", true);
+		DeclareModel("..\\source\\Library\\Content\\Models\\PointLightProxy.obj", true);
+		DeclareEffect(L"Content\\Effects\\SkinnedModel.cso");
 	}
 
 	AnimationDemo::~AnimationDemo()
@@ -59,7 +67,6 @@ namespace Rendering
 
 		DeleteObject(mSpriteFont);
 		DeleteObject(mSpriteBatch);
-		DeleteObject(mSkinnedModel);
 		DeleteObject(mAnimationPlayer);
 		DeleteObject(mProxyModel);
 		DeleteObject(mPointLight);
@@ -72,7 +79,7 @@ namespace Rendering
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
 		// Load the model
-		mSkinnedModel = new Model(*mGame, "..\\source\\Library\\Content\\Models\\RunningSoldier.dae", true);
+		mSkinnedModel = mGame->Models().Load("..\\source\\Library\\Content\\Models\\RunningSoldier.dae", true);
 
 		// Initialize the material
 		mEffect = new Effect(*mGame);
@@ -135,6 +142,20 @@ namespace Rendering
 
 		mSpriteBatch = new SpriteBatch(mGame->Direct3DDeviceContext());
 		mSpriteFont = new SpriteFont(mGame->Direct3DDevice(), L"..\\source\\Library\\Content\\Arial_14_Regular.spritefont");
+
+		RenderPipeline& pipeline = mGame->Pipeline();
+		mWorldMatrixSlot = pipeline.AllocateTransforms();
+		mPointLightSlot = pipeline.AllocateLights();
+		mBonePaletteSlot = pipeline.AllocateBonePalette(mSkinnedModel->Bones().size());
+
+		// Update drives the player, the light and the proxy itself, so it writes them as well as reading the input and camera
+		DeclareRead(mKeyboard);
+		DeclareRead(mCamera);
+		DeclareRead(mSkinnedModel.get());
+		DeclareWrite(this);
+		DeclareWrite(mAnimationPlayer);
+		DeclareWrite(mPointLight);
+		DeclareWrite(mProxyModel);
 	}
 
 	void AnimationDemo::Update(const GameTime& gameTime)
@@ -152,8 +173,36 @@ namespace Rendering
 		mProxyModel->Update(gameTime);
 	}
 
+	void AnimationDemo::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		snapshot.SetTransform(mWorldMatrixSlot, mWorldMatrix);
+		snapshot.SetBonePalette(mBonePaletteSlot, mAnimationPlayer->BoneTransforms());
+
+		RenderSnapshot::LightState pointLight;
+		XMStoreFloat4(&pointLight.Color, mPointLight->ColorVector());
+		pointLight.Position = mPointLight->Position();
+		pointLight.Radius = mPointLight->Radius();
+		snapshot.SetLight(mPointLightSlot, pointLight);
+
+		DrawState& drawState = mDrawStates[snapshot.Index()];
+		drawState.AmbientColor = mAmbientColor;
+		drawState.SpecularColor = mSpecularColor;
+		drawState.SpecularPower = mSpecularPower;
+		drawState.PointLightIntensity = mPointLight->Color().a;
+		drawState.AnimationTime = mAnimationPlayer->CurrentTime();
+		drawState.Keyframe = mAnimationPlayer->CurrentKeyframe();
+		drawState.ManualAdvanceMode = mManualAdvanceMode;
+		drawState.InterpolationEnabled = mAnimationPlayer->InterpolationEnabled();
+
+		mProxyModel->CaptureRenderState(snapshot);
+	}
+
 	void AnimationDemo::Draw(const GameTime& gameTime)
 	{
+		const RenderSnapshot& snapshot = mGame->Pipeline().Current();
+		const RenderSnapshot::LightState& pointLight = snapshot.Light(mPointLightSlot);
+		const DrawState& drawState = mDrawStates[snapshot.Index()];
+
 		ID3D11DeviceContext* direct3DDeviceContext = mGame->Direct3DDeviceContext();
 		direct3DDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
@@ -161,10 +210,13 @@ namespace Rendering
 		ID3D11InputLayout* inputLayout = mMaterial->InputLayouts().at(pass);
 		direct3DDeviceContext->IASetInputLayout(inputLayout);
 
-		XMMATRIX worldMatrix = XMLoadFloat4x4(&mWorldMatrix);
-		XMMATRIX wvp = worldMatrix * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
-		XMVECTOR ambientColor = XMLoadColor(&mAmbientColor);
-		XMVECTOR specularColor = XMLoadColor(&mSpecularColor);
+		XMMATRIX worldMatrix = snapshot.TransformMatrix(mWorldMatrixSlot);
+		XMMATRIX wvp = worldMatrix * XMLoadFloat4x4(&snapshot.View().ViewProjectionMatrix);
+		XMVECTOR ambientColor = XMLoadColor(&drawState.AmbientColor);
+		XMVECTOR specularColor = XMLoadColor(&drawState.SpecularColor);
+		XMVECTOR cameraPosition = XMLoadFloat3(&snapshot.View().Position);
+		const XMFLOAT4X4* bonePalette = snapshot.BonePalette(mBonePaletteSlot);
+		UINT boneCount = mSkinnedModel->Bones().size();
 
 		UINT stride = mMaterial->VertexSize();
 		UINT offset = 0;
@@ -182,14 +234,14 @@ namespace Rendering
 			mMaterial->WorldViewProjection() << wvp;
 			mMaterial->World() << worldMatrix;
 			mMaterial->SpecularColor() << specularColor;
-			mMaterial->SpecularPower() << mSpecularPower;
+			mMaterial->SpecularPower() << drawState.SpecularPower;
 			mMaterial->AmbientColor() << ambientColor;
-			mMaterial->LightColor() << mPointLight->ColorVector();
-			mMaterial->LightPosition() << mPointLight->PositionVector();
-			mMaterial->LightRadius() << mPointLight->Radius();
+			mMaterial->LightColor() << XMLoadFloat4(&pointLight.Color);
+			mMaterial->LightPosition() << XMLoadFloat3(&pointLight.Position);
+			mMaterial->LightRadius() << pointLight.Radius;
 			mMaterial->ColorTexture() << colorTexture;
-			mMaterial->CameraPosition() << mCamera->PositionVector();
-			mMaterial->BoneTransforms() << mAnimationPlayer->BoneTransforms();
+			mMaterial->CameraPosition() << cameraPosition;
+			mMaterial->BoneTransforms().SetMatrixArray(bonePalette, boneCount);
 
 			pass->Apply(0, direct3DDeviceContext);
 
@@ -201,29 +253,35 @@ namespace Rendering
 		mRenderStateHelper.SaveAll();
 		mSpriteBatch->Begin();
 
-		std::wostringstream helpLabel;
-		helpLabel << std::setprecision(5) << L"Ambient Intensity (+PgUp/-PgDn): " << mAmbientColor.a << "\n";
-		helpLabel << L"Point Light Intensity (+Home/-End): " << mPointLight->Color().a << "\n";
-		helpLabel << L"Specular Power (+Insert/-Delete): " << mSpecularPower << "\n";
+		TextBuilder helpLabel(mGame->FrameArena());
+		helpLabel.SetPrecision(5);
+		helpLabel << L"Ambient Intensity (+PgUp/-PgDn): " << drawState.AmbientColor.a << "\n";
+		helpLabel << L"Point Light Intensity (+Home/-End): " << drawState.PointLightIntensity << "\n";
+		helpLabel << L"Specular Power (+Insert/-Delete): " << drawState.SpecularPower << "\n";
 		helpLabel << L"Move Point Light (8/2, 4/6, 3/9)\n";
-		helpLabel << "Frame Advance Mode (Enter): " << (mManualAdvanceMode ? "Manual" : "Auto") << "\nAnimation Time: " << mAnimationPlayer->CurrentTime()
-			<< "\nFrame Interpolation (I): " << (mAnimationPlayer->InterpolationEnabled() ? "On" : "Off") << "\nGo to Bind Pose (B)";
+		helpLabel << "Frame Advance Mode (Enter): " << (drawState.ManualAdvanceMode ? "Manual" : "Auto") << "\nAnimation Time: " << drawState.AnimationTime
+			<< "\nFrame Interpolation (I): " << (drawState.InterpolationEnabled ? "On" : "Off") << "\nGo to Bind Pose (B)";
 
-		if (mManualAdvanceMode)
+		if (drawState.ManualAdvanceMode)
 		{
-			helpLabel << "\nCurrent Keyframe (Space): " << mAnimationPlayer->CurrentKeyframe();
+			helpLabel << "\nCurrent Keyframe (Space): " << drawState.Keyframe;
 		}
 		else
 		{
 			helpLabel << "\nPause / Resume(P)";
 		}
 
-		mSpriteFont->DrawString(mSpriteBatch, helpLabel.str().c_str(), mTextPosition);
+		mSpriteFont->DrawString(mSpriteBatch, helpLabel.Text(), mTextPosition);
 
 		mSpriteBatch->End();
 		mRenderStateHelper.RestoreAll();
 	}
 
+	bool AnimationDemo::DrawsFromSnapshot() const
+	{
+		return true;
+	}
+
 	void AnimationDemo::UpdateOptions()
 	{
 		if (mKeyboard != nullptr)
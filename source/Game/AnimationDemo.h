@@ -34,13 +34,32 @@ namespace Rendering
 
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void Draw(const GameTime& gameTime) override;
+		virtual bool DrawsFromSnapshot() const override;
 
 	private:
 		AnimationDemo();
 		AnimationDemo(const AnimationDemo& rhs);
 		AnimationDemo& operator=(const AnimationDemo& rhs);
 
+		// The material settings and help text values the snapshot has no slots for
+		struct DrawState
+		{
+			XMCOLOR AmbientColor;
+			XMCOLOR SpecularColor;
+			float SpecularPower;
+			UCHAR PointLightIntensity;
+			float AnimationTime;
+			UINT Keyframe;
+			bool ManualAdvanceMode;
+			bool InterpolationEnabled;
+
+			DrawState()
+				: AmbientColor(), SpecularColor(), SpecularPower(0.0f), PointLightIntensity(0), AnimationTime(0.0f), Keyframe(0),
+				  ManualAdvanceMode(false), InterpolationEnabled(false) { }
+		};
+
 		void UpdateOptions();
 		void UpdateAmbientLight(const GameTime& gameTime);
 		void UpdatePointLight(const GameTime& gameTime);
@@ -64,9 +83,14 @@ namespace Rendering
 		std::vector<UINT> mIndexCounts;
 		std::vector<ID3D11ShaderResourceView*> mColorTextures;
 
-		Model* mSkinnedModel;
+		std::shared_ptr<Model> mSkinnedModel;
 		AnimationPlayer* mAnimationPlayer;
 
+		UINT mWorldMatrixSlot;
+		UINT mPointLightSlot;
+		UINT mBonePaletteSlot;
+		DrawState mDrawStates[2];		// Indexed by RenderSnapshot::Index
+
 		RenderStateHelper mRenderStateHelper;
 		ProxyModel* mProxyModel;
 		SpriteBatch* mSpriteBatch;
@@ -0,0 +1,31 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(Benchmark)
+
+	Benchmark::Benchmark(Game& game)
+		: GameComponent(game), mFailures()
+	{
+	}
+
+	Benchmark::~Benchmark()
+	{
+	}
+
+	const std::vector<std::wstring>& Benchmark::Failures() const
+	{
+		return mFailures;
+	}
+
+	bool Benchmark::Check(bool condition, const std::wstring& description)
+	{
+		if (condition == false)
+		{
+			mFailures.push_back(description);
+		}
+
+		return condition;
+	}
+}
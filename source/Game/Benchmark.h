@@ -0,0 +1,36 @@
+#pragma once
+
+#include "..\Library\GameComponent.h"
+#include <sstream>
+
+using namespace Library;
+
+namespace Rendering
+{
+	// A component BenchmarkGame runs without a window or a device. Each Update measures one sample of every case it covers;
+	// WriteResults reports the averages once the run is over. Benchmarks that also verify their subject record each failed
+	// expectation with Check, and BenchmarkGame reports a run with any failure as failed.
+	class Benchmark : public GameComponent
+	{
+		RTTI_DECLARATIONS(Benchmark, GameComponent)
+
+	public:
+		Benchmark(Game& game);
+		virtual ~Benchmark();
+
+		virtual void WriteResults(std::wostringstream& results) const = 0;
+
+		const std::vector<std::wstring>& Failures() const;
+
+	protected:
+		// Records description as a failure when condition is false, and returns condition
+		bool Check(bool condition, const std::wstring& description);
+
+	private:
+		Benchmark();
+		Benchmark(const Benchmark& rhs);
+		Benchmark& operator=(const Benchmark& rhs);
+
+		std::vector<std::wstring> mFailures;
+	};
+}
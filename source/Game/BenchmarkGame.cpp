@@ -0,0 +1,95 @@
+#include "stdafx.h"
+#include "BenchmarkGame.h"
+#include "Benchmark.h"
+#include "ComponentScheduleTest.h"
+#include "MorphTargetBenchmark.h"
+#include "DispatchBenchmark.h"
+#include "FrustumCullerBenchmark.h"
+#include "LightManagerBenchmark.h"
+#include "MeshBvhBenchmark.h"
+#include "ModelLoadBenchmark.h"
+#include "EntityBenchmark.h"
+#include "DynamicAabbTreeBenchmark.h"
+#include "FrameTimingTest.h"
+#include "OcclusionCullerTest.h"
+#include "RenderPipelineTest.h"
+#include "ShadowCascadeTest.h"
+#include "TransformHierarchyBenchmark.h"
+
+namespace Rendering
+{
+	const UINT BenchmarkGame::DefaultFrameCount = 100;
+
+	BenchmarkGame::BenchmarkGame(HINSTANCE instance, const std::wstring& windowClass, const std::wstring& windowTitle, int showCommand)
+		: Game(instance, windowClass, windowTitle, showCommand),
+		mClockSource(), mBenchmarks(), mResults(), mFailureCount(0)
+	{
+		SetClockSource(mClockSource);
+	}
+
+	BenchmarkGame::~BenchmarkGame()
+	{
+	}
+
+	const std::wstring& BenchmarkGame::Results() const
+	{
+		return mResults;
+	}
+
+	UINT BenchmarkGame::FailureCount() const
+	{
+		return mFailureCount;
+	}
+
+	void BenchmarkGame::Initialize()
+	{
+		mBenchmarks.push_back(new MorphTargetBenchmark(*this));
+		mBenchmarks.push_back(new DispatchBenchmark(*this));
+		mBenchmarks.push_back(new FrustumCullerBenchmark(*this));
+		mBenchmarks.push_back(new MeshBvhBenchmark(*this));
+		mBenchmarks.push_back(new EntityBenchmark(*this));
+		mBenchmarks.push_back(new DynamicAabbTreeBenchmark(*this));
+		mBenchmarks.push_back(new OcclusionCullerTest(*this));
+		mBenchmarks.push_back(new ShadowCascadeTest(*this));
+		mBenchmarks.push_back(new LightManagerBenchmark(*this));
+		mBenchmarks.push_back(new TransformHierarchyBenchmark(*this));
+		mBenchmarks.push_back(new FrameTimingTest(*this));
+		mBenchmarks.push_back(new RenderPipelineTest(*this));
+		mBenchmarks.push_back(new ComponentScheduleTest(*this));
+		mBenchmarks.push_back(new ModelLoadBenchmark(*this));
+
+		for (Benchmark* benchmark : mBenchmarks)
+		{
+			AddComponent(benchmark);
+		}
+
+		Game::Initialize();
+	}
+
+	void BenchmarkGame::Shutdown()
+	{
+		std::wostringstream results;
+		for (Benchmark* benchmark : mBenchmarks)
+		{
+			benchmark->WriteResults(results);
+
+			for (const std::wstring& failure : benchmark->Failures())
+			{
+				results << L"  FAILED: " << failure << std::endl;
+			}
+
+			mFailureCount += benchmark->Failures().size();
+		}
+
+		mResults = results.str();
+
+		for (Benchmark* benchmark : mBenchmarks)
+		{
+			delete benchmark;
+		}
+
+		mBenchmarks.clear();
+
+		Game::Shutdown();
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "..\Library\Common.h"
+#include "..\Library\Game.h"
+#include "..\Library\ClockSource.h"
+#include <sstream>
+
+using namespace Library;
+
+namespace Rendering
+{
+	class Benchmark;
+
+	// Runs the engine's CPU benchmarks through RunHeadless, on a virtual clock so every frame sees the same elapsed time.
+	// Started by passing -benchmark on the command line; the results are written next to the executable.
+	class BenchmarkGame : public Game
+	{
+	public:
+		BenchmarkGame(HINSTANCE instance, const std::wstring& windowClass, const std::wstring& windowTitle, int showCommand);
+		~BenchmarkGame();
+
+		// Filled in as the run shuts down, before the benchmarks are released
+		const std::wstring& Results() const;
+		UINT FailureCount() const;
+
+		virtual void Initialize() override;
+
+		static const UINT DefaultFrameCount;
+
+	protected:
+		virtual void Shutdown() override;
+
+	private:
+		BenchmarkGame();
+		BenchmarkGame(const BenchmarkGame& rhs);
+		BenchmarkGame& operator=(const BenchmarkGame& rhs);
+
+		VirtualClockSource mClockSource;
+		std::vector<Benchmark*> mBenchmarks;
+		std::wstring mResults;
+		UINT mFailureCount;
+	};
+}
@@ -16,11 +16,10 @@
 #include "..\Library\VectorHelper.h"
 #include "..\Library\FullScreenRenderTarget.h"
 #include "..\Library\Bloom.h"
-#include <sstream>
-#include <iomanip>
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include "..\Library\PointLight.h"
+#include "..\Library\TextBuilder.h"
 
 #include "PointLightDemo.h"
 
@@ -54,32 +53,32 @@ namespace Rendering
 		}
 
 		mKeyboard = new Keyboard(*this, mDirectInput);
-		mComponents.push_back(mKeyboard);
+		AddComponent(mKeyboard);
 		mServices.AddService(Keyboard::TypeIdClass(), mKeyboard);
 
 		mMouse = new Mouse(*this, mDirectInput);
-		mComponents.push_back(mMouse);
+		AddComponent(mMouse);
 		mServices.AddService(Mouse::TypeIdClass(), mMouse);
 
 		mCamera = new FirstPersonCamera(*this);
-		mComponents.push_back(mCamera);
+		AddComponent(mCamera);
 		mServices.AddService(Camera::TypeIdClass(), mCamera);
 
 		mFpsComponent = new FpsComponent(*this);
 		mFpsComponent->Initialize();
 
 		mSkybox = new Skybox(*this, *mCamera, L"..\\source\\Library\\Content\\Textures\\Maskonaive2_1024.dds", 500.0f);
-		mComponents.push_back(mSkybox);
+		AddComponent(mSkybox);
 
 		mGrid = new Grid(*this, *mCamera);
-		mComponents.push_back(mGrid);
+		AddComponent(mGrid);
 
 		RasterizerStates::Initialize(mDirect3DDevice);
 		SamplerStates::BorderColor = ColorHelper::Black;
 		SamplerStates::Initialize(mDirect3DDevice);
 
 		mPointLightDemo = new PointLightDemo(*this, *mCamera);
-		mComponents.push_back(mPointLightDemo);
+		AddComponent(mPointLightDemo);
 
 		mRenderStateHelper = new RenderStateHelper(*this);
 
@@ -180,20 +179,21 @@ namespace Rendering
 
 		mSpriteBatch->Begin();
 
-		std::wostringstream helpLabel;
+		TextBuilder helpLabel(FrameArena());
 		helpLabel << L"Ambient Intensity (+PgUp/-PgDn): " << mPointLightDemo->GetAmbientColor().a << "\n"
 			<< L"Point Light Intensity (+Home/-End): " << mPointLightDemo->GetPointLight().Color().a << "\n"
 			<< L"Specular Power (+Insert/-Delete): " << mPointLightDemo->GetSpecularPower() << "\n"
 			<< L"Move Point Light (8/2, 4/6, 3/9)\n";
 
 		const BloomSettings& bloomSettings = mBloom->GetBloomSettings();
-		helpLabel << std::setprecision(2) << "\nBloom Enabled (Space Bar): " << (mBloomEnabled ? L"True" : L"False") << "\n"
+		helpLabel.SetPrecision(2);
+		helpLabel << "\nBloom Enabled (Space Bar): " << (mBloomEnabled ? L"True" : L"False") << "\n"
 			<< L"Draw Mode (Enter): " << mBloom->DrawModeString().c_str() << "\n"
 			<< L"Bloom Threshold (+U/-I): " << bloomSettings.BloomThreshold << "\n"
 			<< L"Blur Amount (+J/-K): " << bloomSettings.BlurAmount << "\n"
 			<< L"Bloom Intensity (+N/-M): " << bloomSettings.BloomIntensity << "\n"
 			<< L"Bloom Saturation (+G/-H): " << bloomSettings.BloomSaturation << "\n";
-		mSpriteFont->DrawString(mSpriteBatch, helpLabel.str().c_str(), mTextPosition);
+		mSpriteFont->DrawString(mSpriteBatch, helpLabel.Text(), mTextPosition);
 
 		mSpriteBatch->End();
 
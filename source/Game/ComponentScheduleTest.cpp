@@ -0,0 +1,434 @@
+#include "stdafx.h"
+#include "ComponentScheduleTest.h"
+#include "..\Library\DrawableGameComponent.h"
+#include "..\Library\ClockSource.h"
+#include "..\Library\GameTime.h"
+#include <cmath>
+
+namespace Rendering
+{
+	// Records the game time of every update it is given, spinning for a set cost in each
+	class ScheduleProbe : public DrawableGameComponent
+	{
+		RTTI_DECLARATIONS(ScheduleProbe, DrawableGameComponent)
+
+	public:
+		ScheduleProbe(Game& game, double costMilliseconds = 0.0)
+			: DrawableGameComponent(game), mCostMilliseconds(costMilliseconds), mTotalTimes(), mElapsedTimes()
+		{
+			// A resource of its own lets the probes share a stage, as scheduled demo components do
+			DeclareWrite(this);
+		}
+
+		virtual void Update(const GameTime& gameTime) override
+		{
+			mTotalTimes.push_back(gameTime.TotalGameTime());
+			mElapsedTimes.push_back(gameTime.ElapsedGameTime());
+
+			double startTime = RealClockSource::Milliseconds();
+			while (RealClockSource::Milliseconds() - startTime < mCostMilliseconds)
+			{
+			}
+		}
+
+		const std::vector<double>& TotalTimes() const
+		{
+			return mTotalTimes;
+		}
+
+		const std::vector<double>& ElapsedTimes() const
+		{
+			return mElapsedTimes;
+		}
+
+	private:
+		double mCostMilliseconds;
+		std::vector<double> mTotalTimes;
+		std::vector<double> mElapsedTimes;
+	};
+
+	RTTI_DEFINITIONS(ScheduleProbe)
+	RTTI_DEFINITIONS(ComponentScheduleTest)
+
+	const double ComponentScheduleTest::FrameSeconds = 1.0 / 60.0;
+	const double ComponentScheduleTest::Tolerance = 1e-9;
+	const UINT ComponentScheduleTest::SampleComponentCount = 256;
+
+	ComponentScheduleTest::ComponentScheduleTest(Game& game)
+		: Benchmark(game), mJobSystem(1), mGraph(mJobSystem), mComponents(), mFrame(0), mCheckedUpdateCount(0), mScheduleMilliseconds(0.0), mSampleCount(0)
+	{
+		// Serial, so the probes' costs are measured without other updates running alongside
+		mJobSystem.SetSerial(true);
+	}
+
+	ComponentScheduleTest::~ComponentScheduleTest()
+	{
+		for (GameComponent* component : mComponents)
+		{
+			delete component;
+		}
+	}
+
+	void ComponentScheduleTest::Initialize()
+	{
+		CheckEveryFrame();
+
+		// Whole frames, a fraction between two, and far longer than a frame
+		const double intervals[] = { 0.05, 0.07, 0.1, 1.0 };
+		for (UINT i = 0; i < ARRAYSIZE(intervals); i++)
+		{
+			CheckInterval(intervals[i]);
+		}
+
+		CheckBudget();
+		CheckHidden(HiddenUpdateFull);
+		CheckHidden(HiddenUpdateReduced);
+		CheckHidden(HiddenUpdateSuspended);
+		CheckDisabled();
+		CheckThrottledBudget();
+
+		// A mix of schedules for the timed samples
+		for (UINT i = 0; i < SampleComponentCount; i++)
+		{
+			ScheduleProbe* probe = new ScheduleProbe(*mGame);
+			switch (i % 4)
+			{
+			case 1:
+				probe->SetUpdateInterval(0.1);
+				break;
+
+			case 2:
+				probe->SetUpdateBudget(0.5);
+				break;
+
+			case 3:
+				probe->SetHiddenUpdate(HiddenUpdateReduced);
+				probe->SetVisible(false);
+				break;
+			}
+
+			mComponents.push_back(probe);
+		}
+
+		mFrame = 0;
+	}
+
+	void ComponentScheduleTest::Update(const GameTime& gameTime)
+	{
+		double startTime = RealClockSource::Milliseconds();
+		RunFrames(mGraph, mComponents, 1);
+		mScheduleMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		mSampleCount++;
+	}
+
+	void ComponentScheduleTest::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+
+		results << L"Component schedule (" << SampleComponentCount << L" components)" << std::endl;
+		results << L"  Checked " << mCheckedUpdateCount << L" scheduled updates" << std::endl;
+		results << L"  " << mScheduleMilliseconds / sampleCount << L" ms per frame to schedule and update" << std::endl;
+	}
+
+	void ComponentScheduleTest::RunFrames(ComponentGraph& graph, const std::vector<GameComponent*>& components, UINT frameCount)
+	{
+		for (UINT i = 0; i < frameCount; i++)
+		{
+			mFrame++;
+
+			GameTime gameTime;
+			gameTime.SetTotalGameTime(mFrame * FrameSeconds);
+			gameTime.SetElapsedGameTime(FrameSeconds);
+			graph.Update(components, gameTime);
+		}
+	}
+
+	bool ComponentScheduleTest::CheckElapsedTimes(const ScheduleProbe& probe, const std::wstring& description)
+	{
+		// Each update is passed the time since the last, so together they account for all of it
+		const std::vector<double>& totalTimes = probe.TotalTimes();
+		const std::vector<double>& elapsedTimes = probe.ElapsedTimes();
+
+		double lastTotalTime = 0.0;
+		UINT failureCount = 0;
+		for (UINT i = 0; i < totalTimes.size(); i++)
+		{
+			if (std::fabs(elapsedTimes[i] - (totalTimes[i] - lastTotalTime)) > Tolerance)
+			{
+				failureCount++;
+			}
+
+			lastTotalTime = totalTimes[i];
+		}
+
+		mCheckedUpdateCount += totalTimes.size();
+
+		std::wostringstream counts;
+		counts << L": " << failureCount << L" of " << totalTimes.size() << L" updates were not passed the time since the last";
+		return Check(failureCount == 0, description + counts.str());
+	}
+
+	void ComponentScheduleTest::CheckEveryFrame()
+	{
+		const UINT frameCount = 30;
+
+		// Hidden settings change nothing for a visible component
+		ScheduleProbe probe(*mGame);
+		ScheduleProbe reducedProbe(*mGame);
+		reducedProbe.SetHiddenUpdate(HiddenUpdateReduced);
+
+		std::vector<GameComponent*> components;
+		components.push_back(&probe);
+		components.push_back(&reducedProbe);
+
+		ComponentGraph graph(mJobSystem);
+		mFrame = 0;
+		RunFrames(graph, components, frameCount);
+
+		Check(probe.TotalTimes().size() == frameCount && reducedProbe.TotalTimes().size() == frameCount, L"Components with no schedule did not update every frame");
+		CheckElapsedTimes(probe, L"Unscheduled");
+		CheckElapsedTimes(reducedProbe, L"Visible with reduced hidden updates");
+	}
+
+	void ComponentScheduleTest::CheckInterval(double interval)
+	{
+		ScheduleProbe probe(*mGame);
+		probe.SetUpdateInterval(interval);
+
+		std::vector<GameComponent*> components(1, &probe);
+		ComponentGraph graph(mJobSystem);
+		mFrame = 0;
+		RunFrames(graph, components, 240);
+
+		std::wostringstream description;
+		description << L"Interval of " << interval << L" s";
+
+		// The first update is never held back; after it, each lands on the frame nearest the interval
+		const std::vector<double>& totalTimes = probe.TotalTimes();
+		UINT offIntervalCount = 0;
+		for (UINT i = 1; i < totalTimes.size(); i++)
+		{
+			if (std::fabs(totalTimes[i] - totalTimes[i - 1] - interval) > FrameSeconds * 0.5 + Tolerance)
+			{
+				offIntervalCount++;
+			}
+		}
+
+		UINT intervalFrameCount = static_cast<UINT>(std::floor(interval / FrameSeconds + 0.5));
+		UINT expectedCount = 1 + (mFrame - 1) / intervalFrameCount;
+		Check(totalTimes.empty() == false && std::fabs(totalTimes.front() - FrameSeconds) <= Tolerance, description.str() + L": the first update was held back");
+		Check(offIntervalCount == 0 && totalTimes.size() == expectedCount, description.str() + L": updates were not spaced by the interval");
+		CheckElapsedTimes(probe, description.str());
+	}
+
+	void ComponentScheduleTest::CheckBudget()
+	{
+		const UINT frameCount = 120;
+		const UINT settleFrameCount = 10;
+
+		// Two and a half times over budget skips to every third frame; well under budget skips nothing
+		ScheduleProbe overProbe(*mGame, 0.25);
+		overProbe.SetUpdateBudget(0.1);
+		ScheduleProbe underProbe(*mGame, 0.25);
+		underProbe.SetUpdateBudget(1.0);
+
+		std::vector<GameComponent*> components;
+		components.push_back(&overProbe);
+		components.push_back(&underProbe);
+
+		ComponentGraph graph(mJobSystem);
+		mFrame = 0;
+		RunFrames(graph, components, frameCount);
+
+		// Counted once the first measurements have settled into the average, allowing for the timer's noise
+		UINT settledCount = 0;
+		for (double totalTime : overProbe.TotalTimes())
+		{
+			if (totalTime > settleFrameCount * FrameSeconds + Tolerance)
+			{
+				settledCount++;
+			}
+		}
+
+		std::wostringstream description;
+		description << L"Over budget: " << settledCount << L" updates in " << frameCount - settleFrameCount << L" frames";
+		Check(settledCount >= (frameCount - settleFrameCount) / 4 && settledCount <= (frameCount - settleFrameCount) / 2, description.str());
+		Check(underProbe.TotalTimes().size() == frameCount, L"Under budget: updates were skipped");
+
+		const std::vector<ComponentGraph::ComponentCost>& costs = graph.ComponentCosts();
+		Check(costs[0].UpdateCount + costs[0].SkippedCount == frameCount && costs[0].UpdateCount == overProbe.TotalTimes().size(),
+			L"Over budget: the graph's update and skip counts do not add up to the frames run");
+		CheckElapsedTimes(overProbe, L"Over budget");
+		CheckElapsedTimes(underProbe, L"Under budget");
+	}
+
+	void ComponentScheduleTest::CheckHidden(HiddenUpdate hiddenUpdate)
+	{
+		const UINT visibleFrameCount = 10;
+		const UINT hiddenFrameCount = 60;
+		const double hiddenInterval = 0.25;
+
+		ScheduleProbe probe(*mGame);
+		probe.SetHiddenUpdate(hiddenUpdate, hiddenInterval);
+
+		std::vector<GameComponent*> components(1, &probe);
+		ComponentGraph graph(mJobSystem);
+		mFrame = 0;
+		RunFrames(graph, components, visibleFrameCount);
+		probe.SetVisible(false);
+		RunFrames(graph, components, hiddenFrameCount);
+		probe.SetVisible(true);
+		RunFrames(graph, components, visibleFrameCount);
+
+		const wchar_t* names[] = { L"Full", L"Reduced", L"Suspended" };
+		std::wstring description = std::wstring(L"Hidden, ") + names[hiddenUpdate];
+
+		// Split the updates at the frames the probe was hidden for
+		const std::vector<double>& totalTimes = probe.TotalTimes();
+		const std::vector<double>& elapsedTimes = probe.ElapsedTimes();
+		double hiddenStart = visibleFrameCount * FrameSeconds + Tolerance;
+		double hiddenEnd = (visibleFrameCount + hiddenFrameCount) * FrameSeconds + Tolerance;
+
+		std::vector<double> hiddenTimes;
+		UINT visibleCount = 0;
+		UINT firstVisibleAgain = totalTimes.size();
+		for (UINT i = 0; i < totalTimes.size(); i++)
+		{
+			if (totalTimes[i] > hiddenStart && totalTimes[i] < hiddenEnd)
+			{
+				hiddenTimes.push_back(totalTimes[i]);
+			}
+			else
+			{
+				visibleCount++;
+				if (totalTimes[i] > hiddenEnd && firstVisibleAgain == totalTimes.size())
+				{
+					firstVisibleAgain = i;
+				}
+			}
+		}
+
+		Check(visibleCount == visibleFrameCount * 2, description + L": a visible frame was skipped");
+
+		switch (hiddenUpdate)
+		{
+		case HiddenUpdateFull:
+			Check(hiddenTimes.size() == hiddenFrameCount, description + L": a hidden frame was skipped");
+			CheckElapsedTimes(probe, description);
+			break;
+
+		case HiddenUpdateReduced:
+		{
+			UINT offIntervalCount = 0;
+			double lastTime = visibleFrameCount * FrameSeconds;
+			for (double time : hiddenTimes)
+			{
+				if (std::fabs(time - lastTime - hiddenInterval) > FrameSeconds * 0.5 + Tolerance)
+				{
+					offIntervalCount++;
+				}
+
+				lastTime = time;
+			}
+
+			Check(hiddenTimes.size() == static_cast<UINT>(hiddenFrameCount * FrameSeconds / hiddenInterval) && offIntervalCount == 0,
+				description + L": hidden updates were not spaced by the hidden interval");
+			CheckElapsedTimes(probe, description);
+			break;
+		}
+
+		case HiddenUpdateSuspended:
+			Check(hiddenTimes.empty(), description + L": the component updated while hidden");
+			Check(firstVisibleAgain < totalTimes.size() && std::fabs(elapsedTimes[firstVisibleAgain] - FrameSeconds) <= Tolerance,
+				description + L": the first update once visible again was passed the time spent hidden");
+			mCheckedUpdateCount += totalTimes.size();
+			break;
+		}
+	}
+
+	void ComponentScheduleTest::CheckDisabled()
+	{
+		const UINT enabledFrameCount = 10;
+		const UINT disabledFrameCount = 30;
+
+		ScheduleProbe probe(*mGame);
+		probe.SetUpdateInterval(0.05);
+
+		std::vector<GameComponent*> components(1, &probe);
+		ComponentGraph graph(mJobSystem);
+		mFrame = 0;
+		RunFrames(graph, components, enabledFrameCount);
+		UINT enabledCount = probe.TotalTimes().size();
+
+		probe.SetEnabled(false);
+		RunFrames(graph, components, disabledFrameCount);
+		Check(probe.TotalTimes().size() == enabledCount, L"Disabled: the component updated");
+
+		// Time gathered while disabled is dropped, so the interval starts over from the frame it is enabled again
+		probe.SetEnabled(true);
+		RunFrames(graph, components, enabledFrameCount);
+
+		const std::vector<double>& totalTimes = probe.TotalTimes();
+		Check(totalTimes.size() > enabledCount && std::fabs(probe.ElapsedTimes()[enabledCount] - 3 * FrameSeconds) <= Tolerance &&
+			std::fabs(totalTimes[enabledCount] - (enabledFrameCount + disabledFrameCount + 3) * FrameSeconds) <= Tolerance,
+			L"Disabled: the first update once enabled again was not one interval after it");
+		mCheckedUpdateCount += totalTimes.size();
+	}
+
+	void ComponentScheduleTest::CheckThrottledBudget()
+	{
+		const UINT probeCount = 4;
+		const UINT frameCount = 41;
+
+		// Each probe is due every frame, and any one of them overruns the budget alone
+		std::vector<ScheduleProbe*> probes;
+		std::vector<GameComponent*> components;
+		for (UINT i = 0; i < probeCount; i++)
+		{
+			probes.push_back(new ScheduleProbe(*mGame, 1.0));
+			probes.back()->SetUpdateInterval(FrameSeconds);
+			components.push_back(probes.back());
+		}
+
+		ComponentGraph graph(mJobSystem);
+		graph.SetThrottledBudget(0.75);
+		mFrame = 0;
+		RunFrames(graph, components, frameCount);
+
+		Check(graph.GetStatistics().UpdatedCount == 1 && graph.GetStatistics().DeferredCount == probeCount - 1,
+			L"Throttled budget: more updates ran in a frame than the budget fits");
+
+		// Round-robin gives every probe its turn once in as many frames as there are probes
+		for (UINT i = 0; i < probeCount; i++)
+		{
+			const std::vector<double>& totalTimes = probes[i]->TotalTimes();
+			UINT longGapCount = 0;
+			for (UINT j = 1; j < totalTimes.size(); j++)
+			{
+				if (totalTimes[j] - totalTimes[j - 1] > probeCount * FrameSeconds + Tolerance)
+				{
+					longGapCount++;
+				}
+			}
+
+			std::wostringstream description;
+			description << L"Throttled budget, probe " << i;
+			Check(totalTimes.size() >= 1 + (frameCount - 1) / probeCount && longGapCount == 0, description.str() + L": starved of updates");
+			Check(totalTimes.empty() == false && std::fabs(totalTimes.front() - FrameSeconds) <= Tolerance, description.str() + L": the first update was deferred");
+			CheckElapsedTimes(*probes[i], description.str());
+		}
+
+		// A component joining a frame whose budget is already spent still has its first update
+		ScheduleProbe lateProbe(*mGame);
+		lateProbe.SetUpdateInterval(FrameSeconds);
+		components.push_back(&lateProbe);
+		RunFrames(graph, components, 1);
+		Check(lateProbe.TotalTimes().size() == 1, L"Throttled budget: the first update of a component added later was deferred");
+
+		for (ScheduleProbe* probe : probes)
+		{
+			delete probe;
+		}
+	}
+}
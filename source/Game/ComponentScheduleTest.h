@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\JobSystem.h"
+#include "..\Library\ComponentGraph.h"
+
+namespace Rendering
+{
+	class ScheduleProbe;
+
+	// Runs probe components through a serial ComponentGraph on frames of known length and checks the rules that decide
+	// when each updates: an update interval is met on the frame nearest it; a budget skips frames in proportion to the
+	// measured cost; hidden components update fully, at the hidden interval or not at all; and the throttled budget defers
+	// due updates round-robin without starving any. Every update must receive exactly the game time gathered since the
+	// last, and one held back while disabled or suspended only that frame's. Each Update times scheduling a larger graph.
+	class ComponentScheduleTest : public Benchmark
+	{
+		RTTI_DECLARATIONS(ComponentScheduleTest, Benchmark)
+
+	public:
+		ComponentScheduleTest(Game& game);
+		~ComponentScheduleTest();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		ComponentScheduleTest();
+		ComponentScheduleTest(const ComponentScheduleTest& rhs);
+		ComponentScheduleTest& operator=(const ComponentScheduleTest& rhs);
+
+		static const double FrameSeconds;
+		static const double Tolerance;			// In seconds
+		static const UINT SampleComponentCount;
+
+		void RunFrames(ComponentGraph& graph, const std::vector<GameComponent*>& components, UINT frameCount);
+		bool CheckElapsedTimes(const ScheduleProbe& probe, const std::wstring& description);
+
+		void CheckEveryFrame();
+		void CheckInterval(double interval);
+		void CheckBudget();
+		void CheckHidden(HiddenUpdate hiddenUpdate);
+		void CheckDisabled();
+		void CheckThrottledBudget();
+
+		JobSystem mJobSystem;
+		ComponentGraph mGraph;
+		std::vector<GameComponent*> mComponents;
+		UINT mFrame;
+		UINT mCheckedUpdateCount;
+		double mScheduleMilliseconds;			// Summed over the samples
+		UINT mSampleCount;
+	};
+}
@@ -33,6 +33,7 @@ namespace Rendering
 
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void Draw(const GameTime& gameTime) override;
 
 	private:
@@ -57,6 +58,9 @@ namespace Rendering
 		DirectionalLight* mDirectionalLight;
 		Keyboard* mKeyboard;
 		XMFLOAT4X4 mWorldMatrix;
+		XMFLOAT4X4 mWorldViewProjectionMatrix;
+		bool mIsWorldDirty;
+		UINT mCameraVersion;
 
 		ProxyModel* mProxyModel;
 
@@ -0,0 +1,135 @@
+#include "stdafx.h"
+#include "DispatchBenchmark.h"
+#include "..\Library\DrawableGameComponent.h"
+#include "..\Library\ClockSource.h"
+
+namespace Rendering
+{
+	// Stand-ins one level below the engine's component types, as the game's own components are
+	class UpdateProbe : public GameComponent
+	{
+		RTTI_DECLARATIONS(UpdateProbe, GameComponent)
+
+	public:
+		UpdateProbe(Game& game)
+			: GameComponent(game) { }
+	};
+
+	class DrawProbe : public DrawableGameComponent
+	{
+		RTTI_DECLARATIONS(DrawProbe, DrawableGameComponent)
+
+	public:
+		DrawProbe(Game& game)
+			: DrawableGameComponent(game) { }
+	};
+
+	RTTI_DEFINITIONS(UpdateProbe)
+	RTTI_DEFINITIONS(DrawProbe)
+	RTTI_DEFINITIONS(DispatchBenchmark)
+
+	const UINT DispatchBenchmark::ComponentCount = 10000;
+	const std::wstring DispatchBenchmark::MethodDisplayNames[] = { L"Is(type name)", L"As", L"Partitioned list" };
+
+	DispatchBenchmark::DispatchBenchmark(Game& game)
+		: Benchmark(game), mComponents(), mDrawableComponents(), mSampleCount(0), mVisibleCount(0)
+	{
+		ZeroMemory(mMilliseconds, sizeof(mMilliseconds));
+	}
+
+	DispatchBenchmark::~DispatchBenchmark()
+	{
+		for (GameComponent* component : mComponents)
+		{
+			delete component;
+		}
+	}
+
+	void DispatchBenchmark::Initialize()
+	{
+		mComponents.reserve(ComponentCount);
+		for (UINT i = 0; i < ComponentCount; i++)
+		{
+			if ((i & 1) == 0)
+			{
+				DrawProbe* drawProbe = new DrawProbe(*mGame);
+				mComponents.push_back(drawProbe);
+				mDrawableComponents.push_back(drawProbe);
+			}
+			else
+			{
+				mComponents.push_back(new UpdateProbe(*mGame));
+			}
+		}
+	}
+
+	void DispatchBenchmark::Update(const GameTime& gameTime)
+	{
+		for (UINT method = 0; method < MethodEnd; method++)
+		{
+			double startTime = RealClockSource::Milliseconds();
+			mVisibleCount += CountVisible(static_cast<Method>(method));
+			mMilliseconds[method] += RealClockSource::Milliseconds() - startTime;
+		}
+
+		mSampleCount++;
+	}
+
+	void DispatchBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		results << L"Drawable dispatch (" << ComponentCount << L" components, " << mDrawableComponents.size() << L" drawable)" << std::endl;
+
+		for (UINT method = 0; method < MethodEnd; method++)
+		{
+			double averageMilliseconds = (mSampleCount > 0 ? mMilliseconds[method] / mSampleCount : 0.0);
+			results << L"  " << MethodDisplayNames[method] << L": " << averageMilliseconds << L" ms per frame" << std::endl;
+		}
+	}
+
+	UINT DispatchBenchmark::CountVisible(Method method) const
+	{
+		UINT visibleCount = 0;
+
+		switch (method)
+		{
+		case MethodTypeName:
+		{
+			const std::string typeName = DrawableGameComponent::TypeName();
+			for (GameComponent* component : mComponents)
+			{
+				if (component->Is(typeName) && static_cast<DrawableGameComponent*>(component)->Visible())
+				{
+					visibleCount++;
+				}
+			}
+			break;
+		}
+
+		case MethodMask:
+			for (GameComponent* component : mComponents)
+			{
+				DrawableGameComponent* drawableGameComponent = component->As<DrawableGameComponent>();
+				if (drawableGameComponent != nullptr && drawableGameComponent->Visible())
+				{
+					visibleCount++;
+				}
+			}
+			break;
+
+		case MethodPartition:
+			for (DrawableGameComponent* drawableGameComponent : mDrawableComponents)
+			{
+				if (drawableGameComponent->Visible())
+				{
+					visibleCount++;
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		return visibleCount;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Benchmark.h"
+
+namespace Library
+{
+	class DrawableGameComponent;
+}
+
+namespace Rendering
+{
+	// Times three ways of finding the drawable components among 10,000, half of them drawable: asking each component by
+	// type name, which walks its class chain as every type check once did; asking each with As, a single mask test; and
+	// reading a list partitioned once up front, which is what Game::Draw does now.
+	class DispatchBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(DispatchBenchmark, Benchmark)
+
+	public:
+		DispatchBenchmark(Game& game);
+		~DispatchBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		enum Method
+		{
+			MethodTypeName = 0,
+			MethodMask,
+			MethodPartition,
+			MethodEnd
+		};
+
+		DispatchBenchmark();
+		DispatchBenchmark(const DispatchBenchmark& rhs);
+		DispatchBenchmark& operator=(const DispatchBenchmark& rhs);
+
+		UINT CountVisible(Method method) const;
+
+		static const UINT ComponentCount;
+		static const std::wstring MethodDisplayNames[];
+
+		std::vector<GameComponent*> mComponents;
+		std::vector<DrawableGameComponent*> mDrawableComponents;
+		double mMilliseconds[MethodEnd];		// Summed over the samples
+		UINT mSampleCount;
+		UINT mVisibleCount;						// Kept so the loops cannot be optimized away
+	};
+}
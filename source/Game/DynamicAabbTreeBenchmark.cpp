@@ -0,0 +1,227 @@
+#include "stdafx.h"
+#include "DynamicAabbTreeBenchmark.h"
+#include "..\Library\GameTime.h"
+#include "..\Library\ClockSource.h"
+#include <algorithm>
+#include <random>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(DynamicAabbTreeBenchmark)
+
+	const UINT DynamicAabbTreeBenchmark::ObjectCount = 100000;
+	const float DynamicAabbTreeBenchmark::FieldExtent = 500.0f;
+	const float DynamicAabbTreeBenchmark::ObjectExtent = 0.5f;
+	const float DynamicAabbTreeBenchmark::MaxSpeed = 10.0f;
+	const UINT DynamicAabbTreeBenchmark::BoxQueryCount = 16;
+	const float DynamicAabbTreeBenchmark::QueryExtent = 25.0f;
+	const UINT DynamicAabbTreeBenchmark::RayQueryCount = 8;
+	const float DynamicAabbTreeBenchmark::RayLength = 300.0f;
+
+	DynamicAabbTreeBenchmark::DynamicAabbTreeBenchmark(Game& game)
+		: Benchmark(game), mTree(), mProxies(), mBoxes(), mVelocities(), mQueryBoxes(), mRays(),
+		  mFrustum(XMMatrixLookToRH(XMVectorZero(), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) * XMMatrixPerspectiveFovRH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 200.0f)),
+		  mTreeResults(), mBruteForceResults(), mMoveMilliseconds(0.0), mTreeMilliseconds(0.0), mBruteForceMilliseconds(0.0),
+		  mReinsertionCount(0), mNodesVisitedCount(0), mCheckedQueryCount(0), mMismatchCount(0), mSampleCount(0)
+	{
+	}
+
+	DynamicAabbTreeBenchmark::~DynamicAabbTreeBenchmark()
+	{
+	}
+
+	void DynamicAabbTreeBenchmark::Initialize()
+	{
+		// Seeded, so every run moves the same objects and asks the same questions
+		std::default_random_engine generator(4321);
+		std::uniform_real_distribution<float> position(-FieldExtent, FieldExtent);
+		std::uniform_real_distribution<float> speed(-MaxSpeed, MaxSpeed);
+
+		mProxies.reserve(ObjectCount);
+		mBoxes.reserve(ObjectCount);
+		mVelocities.reserve(ObjectCount);
+		for (UINT i = 0; i < ObjectCount; i++)
+		{
+			XMFLOAT3 center(position(generator), position(generator), position(generator));
+			AxisAlignedBox box(XMFLOAT3(center.x - ObjectExtent, center.y - ObjectExtent, center.z - ObjectExtent), XMFLOAT3(center.x + ObjectExtent, center.y + ObjectExtent, center.z + ObjectExtent));
+
+			mProxies.push_back(mTree.CreateProxy(box));
+			mBoxes.push_back(box);
+			mVelocities.push_back(XMFLOAT3(speed(generator), speed(generator), speed(generator)));
+		}
+
+		std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+		for (UINT i = 0; i < BoxQueryCount; i++)
+		{
+			XMFLOAT3 center(position(generator), position(generator), position(generator));
+			mQueryBoxes.push_back(AxisAlignedBox(XMFLOAT3(center.x - QueryExtent, center.y - QueryExtent, center.z - QueryExtent), XMFLOAT3(center.x + QueryExtent, center.y + QueryExtent, center.z + QueryExtent)));
+		}
+
+		for (UINT i = 0; i < RayQueryCount; i++)
+		{
+			XMVECTOR rayDirection = XMVector3Normalize(XMVectorSet(direction(generator), direction(generator), direction(generator), 0.0f));
+			mRays.push_back(Ray(XMVectorSet(position(generator), position(generator), position(generator), 1.0f), rayDirection));
+		}
+
+		mTreeResults.resize(QueryCount());
+	}
+
+	void DynamicAabbTreeBenchmark::Update(const GameTime& gameTime)
+	{
+		float seconds = static_cast<float>(gameTime.ElapsedGameTime());
+		UINT reinsertionCount = mTree.GetStatistics().Reinsertions;
+
+		// Objects bounce off the walls of the cube
+		double startTime = RealClockSource::Milliseconds();
+		for (UINT i = 0; i < ObjectCount; i++)
+		{
+			XMFLOAT3& velocity = mVelocities[i];
+			AxisAlignedBox& box = mBoxes[i];
+			float* minimum = &box.Minimum.x;
+			float* maximum = &box.Maximum.x;
+			float* speeds = &velocity.x;
+
+			for (UINT axis = 0; axis < 3; axis++)
+			{
+				float center = (minimum[axis] + maximum[axis]) * 0.5f + speeds[axis] * seconds;
+				if (center < -FieldExtent || center > FieldExtent)
+				{
+					speeds[axis] = -speeds[axis];
+				}
+
+				minimum[axis] += speeds[axis] * seconds;
+				maximum[axis] += speeds[axis] * seconds;
+			}
+
+			mTree.MoveProxy(mProxies[i], box, XMFLOAT3(velocity.x * seconds, velocity.y * seconds, velocity.z * seconds));
+		}
+
+		mMoveMilliseconds += RealClockSource::Milliseconds() - startTime;
+		mReinsertionCount += mTree.GetStatistics().Reinsertions - reinsertionCount;
+
+		startTime = RealClockSource::Milliseconds();
+		for (UINT query = 0; query < QueryCount(); query++)
+		{
+			RunTreeQuery(query, mTreeResults[query]);
+			mNodesVisitedCount += mTree.GetStatistics().NodesVisited;
+		}
+
+		mTreeMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		UINT mismatchCount = 0;
+		for (UINT query = 0; query < QueryCount(); query++)
+		{
+			// Only the scan is timed, not the comparison
+			startTime = RealClockSource::Milliseconds();
+			mBruteForceResults.clear();
+			for (UINT i = 0; i < ObjectCount; i++)
+			{
+				if (IsHit(query, mBoxes[i]))
+				{
+					mBruteForceResults.push_back(mProxies[i]);
+				}
+			}
+
+			mBruteForceMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+			if (MatchesBruteForce(query, mBruteForceResults) == false)
+			{
+				mismatchCount++;
+			}
+		}
+
+		mTree.Validate();
+
+		std::wostringstream description;
+		description << L"Frame " << mSampleCount << L": " << mismatchCount << L" of " << QueryCount() << L" queries differ from brute force";
+		Check(mismatchCount == 0, description.str());
+
+		mMismatchCount += mismatchCount;
+		mSampleCount++;
+	}
+
+	void DynamicAabbTreeBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+		double queryCount = (mCheckedQueryCount > 0 ? static_cast<double>(mCheckedQueryCount) : 1.0);
+
+		results << L"Dynamic AABB tree (" << ObjectCount << L" moving objects, height " << mTree.Height() << L", "
+			<< mReinsertionCount / sampleCount << L" reinsertions per frame)" << std::endl;
+		results << L"  Move: " << mMoveMilliseconds / sampleCount << L" ms per frame" << std::endl;
+		results << L"  " << QueryCount() << L" queries through the tree: " << mTreeMilliseconds / sampleCount << L" ms per frame, "
+			<< mNodesVisitedCount / queryCount << L" nodes visited per query" << std::endl;
+		results << L"  " << QueryCount() << L" queries by brute force: " << mBruteForceMilliseconds / sampleCount << L" ms per frame" << std::endl;
+		results << L"  Checked " << mCheckedQueryCount << L" queries against brute force, " << mMismatchCount << L" differ" << std::endl;
+	}
+
+	UINT DynamicAabbTreeBenchmark::QueryCount() const
+	{
+		// Box queries, then rays, then the frustum
+		return BoxQueryCount + RayQueryCount + 1;
+	}
+
+	void DynamicAabbTreeBenchmark::RunTreeQuery(UINT query, std::vector<UINT>& proxies) const
+	{
+		if (query < BoxQueryCount)
+		{
+			mTree.Query(mQueryBoxes[query], proxies);
+		}
+		else if (query < BoxQueryCount + RayQueryCount)
+		{
+			mTree.Query(mRays[query - BoxQueryCount], RayLength, proxies);
+		}
+		else
+		{
+			mTree.Query(mFrustum, proxies);
+		}
+	}
+
+	bool DynamicAabbTreeBenchmark::IsHit(UINT query, const AxisAlignedBox& box) const
+	{
+		if (query < BoxQueryCount)
+		{
+			return box.Overlaps(mQueryBoxes[query]);
+		}
+		else if (query < BoxQueryCount + RayQueryCount)
+		{
+			float distance;
+			return box.Intersects(mRays[query - BoxQueryCount], RayLength, distance);
+		}
+		else
+		{
+			return mFrustum.Intersects(box.Minimum, box.Maximum);
+		}
+	}
+
+	bool DynamicAabbTreeBenchmark::MatchesBruteForce(UINT query, const std::vector<UINT>& hitProxies)
+	{
+		std::vector<UINT>& treeResults = mTreeResults[query];
+		std::sort(treeResults.begin(), treeResults.end());
+		mCheckedQueryCount++;
+
+		// Every object that is hit must be found
+		for (UINT proxy : hitProxies)
+		{
+			if (std::binary_search(treeResults.begin(), treeResults.end(), proxy) == false)
+			{
+				return false;
+			}
+		}
+
+		// And the tree must return exactly the objects whose enlarged boxes are hit
+		UINT fatHitCount = 0;
+		for (UINT i = 0; i < ObjectCount; i++)
+		{
+			if (IsHit(query, mTree.FatBox(mProxies[i])))
+			{
+				fatHitCount++;
+				if (std::binary_search(treeResults.begin(), treeResults.end(), mProxies[i]) == false)
+				{
+					return false;
+				}
+			}
+		}
+
+		return (fatHitCount == treeResults.size());
+	}
+}
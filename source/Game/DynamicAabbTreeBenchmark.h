@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\DynamicAabbTree.h"
+#include "..\Library\Frustum.h"
+#include "..\Library\Ray.h"
+
+namespace Rendering
+{
+	// Moves 100,000 boxes through a cube each frame and keeps a DynamicAabbTree in step with them, then runs box, ray and
+	// frustum queries through the tree and through a brute-force scan of every object. Each query's result must equal the
+	// scan over the tree's enlarged boxes and include every object whose own box is hit. Reports the time to move the
+	// objects, and the time per frame of the queries through the tree and by brute force.
+	class DynamicAabbTreeBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(DynamicAabbTreeBenchmark, Benchmark)
+
+	public:
+		DynamicAabbTreeBenchmark(Game& game);
+		~DynamicAabbTreeBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		DynamicAabbTreeBenchmark();
+		DynamicAabbTreeBenchmark(const DynamicAabbTreeBenchmark& rhs);
+		DynamicAabbTreeBenchmark& operator=(const DynamicAabbTreeBenchmark& rhs);
+
+		static const UINT ObjectCount;
+		static const float FieldExtent;			// Half the cube's side
+		static const float ObjectExtent;
+		static const float MaxSpeed;
+		static const UINT BoxQueryCount;
+		static const float QueryExtent;
+		static const UINT RayQueryCount;
+		static const float RayLength;
+
+		UINT QueryCount() const;
+		void RunTreeQuery(UINT query, std::vector<UINT>& proxies) const;
+		bool IsHit(UINT query, const AxisAlignedBox& box) const;
+		bool MatchesBruteForce(UINT query, const std::vector<UINT>& hitProxies);
+
+		DynamicAabbTree mTree;
+		std::vector<UINT> mProxies;				// Indexed by object
+		std::vector<AxisAlignedBox> mBoxes;
+		std::vector<XMFLOAT3> mVelocities;
+		std::vector<AxisAlignedBox> mQueryBoxes;
+		std::vector<Ray> mRays;
+		Frustum mFrustum;
+		std::vector<std::vector<UINT>> mTreeResults;
+		std::vector<UINT> mBruteForceResults;
+		double mMoveMilliseconds;				// Summed over the samples
+		double mTreeMilliseconds;
+		double mBruteForceMilliseconds;
+		UINT mReinsertionCount;
+		UINT mNodesVisitedCount;
+		UINT mCheckedQueryCount;
+		UINT mMismatchCount;
+		UINT mSampleCount;
+	};
+}
@@ -0,0 +1,74 @@
+#include "stdafx.h"
+#include "EntityBenchmark.h"
+#include "..\Library\GameTime.h"
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(EntityBenchmark)
+
+	const UINT EntityBenchmark::EntityCount = 100000;
+	const float EntityBenchmark::EntitySpacing = 2.0f;
+
+	EntityBenchmark::EntityBenchmark(Game& game)
+		: Benchmark(game), mWorld(),
+		  mFrustum(XMMatrixLookToRH(XMVectorZero(), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) * XMMatrixPerspectiveFovRH(XM_PIDIV4, 4.0f / 3.0f, 0.1f, 1000.0f)),
+		  mTotals(), mSampleCount(0)
+	{
+	}
+
+	EntityBenchmark::~EntityBenchmark()
+	{
+	}
+
+	void EntityBenchmark::Initialize()
+	{
+		UINT componentMask = EntityWorld::ComponentBit(EntityComponentTransform) | EntityWorld::ComponentBit(EntityComponentBounds) | EntityWorld::ComponentBit(EntityComponentAnimation);
+		AxisAlignedBox bounds(XMFLOAT3(-0.5f, -0.5f, -0.5f), XMFLOAT3(0.5f, 0.5f, 0.5f));
+
+		// A square field centered on the camera, which looks down one axis and so sees a wedge of it
+		UINT rowLength = static_cast<UINT>(ceil(sqrt(static_cast<float>(EntityCount))));
+		float halfExtent = rowLength * EntitySpacing * 0.5f;
+
+		for (UINT i = 0; i < EntityCount; i++)
+		{
+			EntityWorld::Entity entity = mWorld.Create(componentMask);
+
+			EntityWorld::Transform transform;
+			transform.Position = XMFLOAT3((i % rowLength) * EntitySpacing - halfExtent, 0.0f, (i / rowLength) * EntitySpacing - halfExtent);
+			mWorld.SetTransform(entity, transform);
+			mWorld.SetLocalBounds(entity, bounds);
+
+			EntityWorld::AnimationState animationState;
+			animationState.Duration = 1.0f;
+			animationState.Time = (i % 60) / 60.0f;
+			animationState.IsLooping = true;
+			mWorld.SetAnimationState(entity, animationState);
+		}
+	}
+
+	void EntityBenchmark::Update(const GameTime& gameTime)
+	{
+		mWorld.UpdateAnimations(static_cast<float>(gameTime.ElapsedGameTime()));
+		mWorld.UpdateTransforms();
+		mWorld.Cull(mFrustum);
+
+		const EntityWorld::Statistics& statistics = mWorld.GetStatistics();
+		mTotals.AnimationMilliseconds += statistics.AnimationMilliseconds;
+		mTotals.TransformMilliseconds += statistics.TransformMilliseconds;
+		mTotals.CullMilliseconds += statistics.CullMilliseconds;
+		mSampleCount++;
+	}
+
+	void EntityBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		const EntityWorld::Statistics& statistics = mWorld.GetStatistics();
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+
+		results << L"Entity systems (" << statistics.EntityCount << L" entities in " << statistics.ChunkCount << L" chunks, "
+			<< statistics.VisibleCount << L" visible)" << std::endl;
+		results << L"  Animation: " << mTotals.AnimationMilliseconds / sampleCount << L" ms per frame" << std::endl;
+		results << L"  Transforms: " << mTotals.TransformMilliseconds / sampleCount << L" ms per frame" << std::endl;
+		results << L"  Culling: " << mTotals.CullMilliseconds / sampleCount << L" ms per frame" << std::endl;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\EntityWorld.h"
+#include "..\Library\Frustum.h"
+
+namespace Rendering
+{
+	// Runs the animation, transform and culling systems of an EntityWorld holding 100,000 entities, spread over a square
+	// field that a fixed camera sees part of, and reports the average time of each system per frame.
+	class EntityBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(EntityBenchmark, Benchmark)
+
+	public:
+		EntityBenchmark(Game& game);
+		~EntityBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		EntityBenchmark();
+		EntityBenchmark(const EntityBenchmark& rhs);
+		EntityBenchmark& operator=(const EntityBenchmark& rhs);
+
+		static const UINT EntityCount;
+		static const float EntitySpacing;
+
+		EntityWorld mWorld;
+		Frustum mFrustum;
+		EntityWorld::Statistics mTotals;		// Timings summed over the samples
+		UINT mSampleCount;
+	};
+}
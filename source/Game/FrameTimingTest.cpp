@@ -0,0 +1,217 @@
+#include "stdafx.h"
+#include "FrameTimingTest.h"
+#include "..\Library\FixedTimeStep.h"
+#include "..\Library\FramePacer.h"
+#include "..\Library\ClockSource.h"
+#include "..\Library\GameClock.h"
+#include "..\Library\GameTime.h"
+#include "..\Library\GameException.h"
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(FrameTimingTest)
+
+	const UINT FrameTimingTest::FrameCount = 600;
+	const double FrameTimingTest::Tolerance = 1e-9;
+
+	FrameTimingTest::FrameTimingTest(Game& game)
+		: Benchmark(game), mSteppedFrameCount(0), mPacedFrameCount(0)
+	{
+	}
+
+	FrameTimingTest::~FrameTimingTest()
+	{
+	}
+
+	void FrameTimingTest::Initialize()
+	{
+		// Displays slower than, equal to, faster than and unrelated to the 60 Hz step
+		const UINT frameRates[] = { 30, 50, 60, 144, 240 };
+		for (UINT i = 0; i < ARRAYSIZE(frameRates); i++)
+		{
+			CheckFixedTimeStep(frameRates[i]);
+		}
+
+		CheckClampedStall();
+
+		FixedTimeStep fixedTimeStep;
+		Check(IsRejected(fixedTimeStep, 0.0, fixedTimeStep.MaxStepsPerFrame()), L"A fixed time step of zero seconds was accepted");
+		Check(IsRejected(fixedTimeStep, fixedTimeStep.StepSeconds(), 0), L"A limit of zero fixed steps per frame was accepted");
+
+		CheckSteadyPacing();
+		CheckLatePacing(0.5, true);
+		CheckLatePacing(2.0, false);
+		CheckDisabledPacing();
+	}
+
+	void FrameTimingTest::WriteResults(std::wostringstream& results) const
+	{
+		results << L"Frame timing" << std::endl;
+		results << L"  Checked " << mSteppedFrameCount << L" frames of fixed stepping and " << mPacedFrameCount << L" paced frames on virtual clocks" << std::endl;
+	}
+
+	void FrameTimingTest::CheckFixedTimeStep(UINT frameRate)
+	{
+		VirtualClockSource clock(1.0 / frameRate);
+		GameClock gameClock(clock);
+		FixedTimeStep fixedTimeStep;
+		GameTime frameTime;
+		GameTime simulationTime;
+
+		double stepSeconds = fixedTimeStep.StepSeconds();
+		double stepsPerFrame = (1.0 / frameRate) / stepSeconds;
+		bool isEven = (std::floor(stepsPerFrame) == stepsPerFrame);
+		UINT failureCount = 0;
+
+		for (UINT i = 0; i < FrameCount; i++)
+		{
+			clock.Advance();
+			gameClock.UpdateGameTime(frameTime);
+
+			UINT stepCount = fixedTimeStep.Advance(frameTime.ElapsedGameTime());
+			for (UINT j = 0; j < stepCount; j++)
+			{
+				fixedTimeStep.Step(simulationTime);
+			}
+
+			// Every step simulated plus the fraction of one still owed accounts for all the time that has passed
+			double alpha = fixedTimeStep.Alpha();
+			bool isCorrect = (alpha >= 0.0 && alpha < 1.0 + Tolerance && IsNear(fixedTimeStep.SimulatedSeconds() + alpha * stepSeconds, frameTime.TotalGameTime()));
+			isCorrect = isCorrect && (isEven == false || stepCount == static_cast<UINT>(stepsPerFrame));
+			isCorrect = isCorrect && (stepCount == 0 || (IsNear(simulationTime.TotalGameTime(), fixedTimeStep.SimulatedSeconds()) && simulationTime.ElapsedGameTime() == stepSeconds));
+			if (isCorrect == false)
+			{
+				failureCount++;
+			}
+
+			mSteppedFrameCount++;
+		}
+
+		const FixedTimeStep::Statistics& statistics = fixedTimeStep.GetStatistics();
+
+		std::wostringstream description;
+		description << L"Fixed stepping at " << frameRate << L" frames per second: " << failureCount << L" frames lost or gained time";
+		Check(failureCount == 0 && statistics.ClampedFrameCount == 0, description.str());
+	}
+
+	void FrameTimingTest::CheckClampedStall()
+	{
+		FixedTimeStep fixedTimeStep;
+		double stepSeconds = fixedTimeStep.StepSeconds();
+		UINT maxStepsPerFrame = fixedTimeStep.MaxStepsPerFrame();
+
+		UINT stepCount = fixedTimeStep.Advance(1.0);
+		const FixedTimeStep::Statistics& statistics = fixedTimeStep.GetStatistics();
+		Check(stepCount == maxStepsPerFrame && statistics.ClampedFrameCount == 1 && IsNear(statistics.DroppedSeconds, 1.0 - maxStepsPerFrame * stepSeconds),
+			L"A one-second stall was not clamped to the step limit");
+		Check(fixedTimeStep.Alpha() < Tolerance, L"A clamped stall left part of a step owed");
+
+		// The next ordinary frame carries on as if the stall had not happened
+		Check(fixedTimeStep.Advance(stepSeconds) == 1, L"The frame after a clamped stall did not run one step");
+		mSteppedFrameCount += 2;
+	}
+
+	void FrameTimingTest::CheckSteadyPacing()
+	{
+		// Each frame's work takes well under a period
+		VirtualClockSource clock(0.005);
+		FramePacer pacer(60, clock);
+		double period = 1.0 / pacer.TargetFrameRate();
+
+		UINT failureCount = 0;
+		double lastEnd = 0.0;
+		for (UINT i = 0; i < FrameCount; i++)
+		{
+			clock.Advance();
+			pacer.Wait();
+
+			double end = clock.Seconds();
+			if (i > 0 && IsNear(end - lastEnd, period) == false)
+			{
+				failureCount++;
+			}
+
+			lastEnd = end;
+			mPacedFrameCount++;
+		}
+
+		const FramePacer::Statistics& statistics = pacer.GetStatistics();
+
+		std::wostringstream description;
+		description << L"Paced frames of 5 ms work: " << failureCount << L" ended other than one period after the last";
+		Check(failureCount == 0 && statistics.MissedFrameCount == 0, description.str());
+		// The first frame's deadline is a whole period after its work ends, every later one a period after the last
+		double waitedSeconds = FrameCount * (period - clock.FrameSeconds()) + clock.FrameSeconds();
+		Check(IsNear(statistics.SpunSeconds, FrameCount * pacer.SpinSeconds()) && IsNear(statistics.SleptSeconds + statistics.SpunSeconds, waitedSeconds),
+			L"Paced frames did not sleep until the spin time before each deadline");
+	}
+
+	void FrameTimingTest::CheckLatePacing(double lateness, bool keepsSchedule)
+	{
+		VirtualClockSource clock(0.005);
+		FramePacer pacer(60, clock);
+		double period = 1.0 / pacer.TargetFrameRate();
+
+		clock.Advance();
+		pacer.Wait();
+		double onTimeEnd = clock.Seconds();
+
+		// One frame whose work overruns its deadline by the given number of periods
+		clock.SetFrameSeconds(period * (1.0 + lateness));
+		clock.Advance();
+		pacer.Wait();
+		double lateEnd = clock.Seconds();
+
+		clock.SetFrameSeconds(0.005);
+		clock.Advance();
+		pacer.Wait();
+		double nextEnd = clock.Seconds();
+		mPacedFrameCount += 3;
+
+		std::wostringstream description;
+		description << L"A frame " << lateness << L" periods late";
+		Check(pacer.GetStatistics().MissedFrameCount == 1 && lateEnd == onTimeEnd + period * (1.0 + lateness), description.str() + L" was not counted as missed, or waited");
+		if (keepsSchedule)
+		{
+			Check(IsNear(nextEnd, onTimeEnd + 2.0 * period), description.str() + L" moved the schedule");
+		}
+		else
+		{
+			Check(IsNear(nextEnd, lateEnd + period), description.str() + L" did not restart the schedule");
+		}
+	}
+
+	void FrameTimingTest::CheckDisabledPacing()
+	{
+		VirtualClockSource clock(0.005);
+		FramePacer pacer(0, clock);
+
+		clock.Advance();
+		double end = clock.Seconds();
+		pacer.Wait();
+		mPacedFrameCount++;
+
+		Check(clock.Seconds() == end && pacer.GetStatistics().FrameCount == 0, L"Pacing at a target of zero frames per second waited");
+	}
+
+	bool FrameTimingTest::IsRejected(FixedTimeStep& fixedTimeStep, double stepSeconds, UINT maxStepsPerFrame)
+	{
+		try
+		{
+			fixedTimeStep.SetStepSeconds(stepSeconds);
+			fixedTimeStep.SetMaxStepsPerFrame(maxStepsPerFrame);
+		}
+		catch (const GameException&)
+		{
+			return true;
+		}
+
+		return false;
+	}
+
+	bool FrameTimingTest::IsNear(double value, double expected)
+	{
+		return (std::fabs(value - expected) <= Tolerance * (std::max)(1.0, std::fabs(expected)));
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Benchmark.h"
+
+namespace Library
+{
+	class FixedTimeStep;
+	class VirtualClockSource;
+}
+
+namespace Rendering
+{
+	// Checks FixedTimeStep and FramePacer against frames timed by their own VirtualClockSource, so every frame takes exactly
+	// the time the test gives it. Fixed stepping must run a whole number of steps per frame at several display rates, keep
+	// the simulated time plus the interpolation alpha equal to the time elapsed, and clamp a stall to the step limit. Frame
+	// pacing must end every frame exactly one period after the last, keep its schedule after a frame late by less than a
+	// period, and restart it after a later one.
+	class FrameTimingTest : public Benchmark
+	{
+		RTTI_DECLARATIONS(FrameTimingTest, Benchmark)
+
+	public:
+		FrameTimingTest(Game& game);
+		~FrameTimingTest();
+
+		virtual void Initialize() override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		FrameTimingTest();
+		FrameTimingTest(const FrameTimingTest& rhs);
+		FrameTimingTest& operator=(const FrameTimingTest& rhs);
+
+		static const UINT FrameCount;			// Per scenario
+		static const double Tolerance;			// In seconds
+
+		void CheckFixedTimeStep(UINT frameRate);
+		void CheckClampedStall();
+		void CheckSteadyPacing();
+		void CheckLatePacing(double lateness, bool keepsSchedule);
+		void CheckDisabledPacing();
+		static bool IsRejected(FixedTimeStep& fixedTimeStep, double stepSeconds, UINT maxStepsPerFrame);
+		static bool IsNear(double value, double expected);
+
+		UINT mSteppedFrameCount;
+		UINT mPacedFrameCount;
+	};
+}
@@ -0,0 +1,137 @@
+#include "stdafx.h"
+#include "FrustumCullerBenchmark.h"
+#include "..\Library\ClockSource.h"
+#include <random>
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(FrustumCullerBenchmark)
+
+	const UINT FrustumCullerBenchmark::ObjectCount = 1000000;
+	const float FrustumCullerBenchmark::FieldExtent = 500.0f;
+	const float FrustumCullerBenchmark::MinimumObjectExtent = 0.25f;
+	const float FrustumCullerBenchmark::MaximumObjectExtent = 2.0f;
+	const double FrustumCullerBenchmark::PlaneTolerance = 1e-2;
+
+	FrustumCullerBenchmark::FrustumCullerBenchmark(Game& game)
+		: Benchmark(game), mFrustum(ViewProjectionMatrix(0.0f)), mCuller(mFrustum), mBoxes(), mVisibilityMask(), mVisibleIndices(),
+		  mMaskMilliseconds(0.0), mIndexListMilliseconds(0.0), mVisibleCount(0), mCheckedCount(0), mUndecidedCount(0), mMismatchCount(0), mSampleCount(0)
+	{
+	}
+
+	FrustumCullerBenchmark::~FrustumCullerBenchmark()
+	{
+	}
+
+	void FrustumCullerBenchmark::Initialize()
+	{
+		// Seeded, so every run culls the same boxes
+		std::default_random_engine generator(1618);
+		std::uniform_real_distribution<float> position(-FieldExtent, FieldExtent);
+		std::uniform_real_distribution<float> extent(MinimumObjectExtent, MaximumObjectExtent);
+
+		mBoxes.Reserve(ObjectCount);
+		for (UINT i = 0; i < ObjectCount; i++)
+		{
+			XMFLOAT3 center(position(generator), position(generator), position(generator));
+			XMFLOAT3 halfExtent(extent(generator), extent(generator), extent(generator));
+			mBoxes.Add(XMFLOAT3(center.x - halfExtent.x, center.y - halfExtent.y, center.z - halfExtent.z), XMFLOAT3(center.x + halfExtent.x, center.y + halfExtent.y, center.z + halfExtent.z));
+		}
+	}
+
+	void FrustumCullerBenchmark::Update(const GameTime& gameTime)
+	{
+		mFrustum.SetMatrix(ViewProjectionMatrix(mSampleCount * 0.05f));
+		mCuller.SetFrustum(mFrustum);
+
+		double startTime = RealClockSource::Milliseconds();
+		mCuller.Cull(mBoxes, mVisibilityMask);
+		mMaskMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		startTime = RealClockSource::Milliseconds();
+		mVisibleCount += mCuller.CollectVisible(mBoxes, mVisibleIndices);
+		mIndexListMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		CheckAgainstReference();
+		mSampleCount++;
+	}
+
+	void FrustumCullerBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+		double maskMilliseconds = mMaskMilliseconds / sampleCount;
+		double indexListMilliseconds = mIndexListMilliseconds / sampleCount;
+
+		results << L"Frustum culling (" << ObjectCount << L" boxes, " << mVisibleCount / sampleCount << L" visible per frame)" << std::endl;
+		results << L"  Bitmask: " << maskMilliseconds << L" ms per frame, " << (maskMilliseconds > 0.0 ? ObjectCount / (maskMilliseconds * 1000.0) : 0.0) << L" objects per microsecond" << std::endl;
+		results << L"  Index list: " << indexListMilliseconds << L" ms per frame, " << (indexListMilliseconds > 0.0 ? ObjectCount / (indexListMilliseconds * 1000.0) : 0.0) << L" objects per microsecond" << std::endl;
+		results << L"  Checked " << mCheckedCount << L" boxes against the reference, " << mMismatchCount << L" differ, " << mUndecidedCount << L" too close to a plane to call" << std::endl;
+	}
+
+	XMMATRIX FrustumCullerBenchmark::ViewProjectionMatrix(float yaw)
+	{
+		XMVECTOR direction = XMVectorSet(std::sin(yaw), 0.0f, -std::cos(yaw), 0.0f);
+
+		return XMMatrixLookToRH(XMVectorZero(), direction, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) * XMMatrixPerspectiveFovRH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+	}
+
+	void FrustumCullerBenchmark::CheckAgainstReference()
+	{
+		const XMFLOAT4* planes[] = { &mFrustum.Near(), &mFrustum.Far(), &mFrustum.Left(), &mFrustum.Right(), &mFrustum.Top(), &mFrustum.Bottom() };
+
+		UINT mismatchCount = 0;
+		UINT listedCount = 0;
+		for (UINT i = 0; i < ObjectCount; i++)
+		{
+			bool isVisible = FrustumCuller::IsVisible(mVisibilityMask, i);
+			bool isListed = (listedCount < mVisibleIndices.size() && mVisibleIndices[listedCount] == i);
+			if (isListed)
+			{
+				listedCount++;
+			}
+
+			if (isListed != isVisible)
+			{
+				mismatchCount++;
+				continue;
+			}
+
+			// Planes face outward; the box is outside a plane when even its corner furthest inside lies in front of it
+			bool isOutside = false;
+			bool isUndecided = false;
+			for (UINT j = 0; j < ARRAYSIZE(planes); j++)
+			{
+				const XMFLOAT4& plane = *planes[j];
+				double distance = static_cast<double>(plane.w) +
+					static_cast<double>(plane.x) * (plane.x > 0.0f ? mBoxes.MinimumX[i] : mBoxes.MaximumX[i]) +
+					static_cast<double>(plane.y) * (plane.y > 0.0f ? mBoxes.MinimumY[i] : mBoxes.MaximumY[i]) +
+					static_cast<double>(plane.z) * (plane.z > 0.0f ? mBoxes.MinimumZ[i] : mBoxes.MaximumZ[i]);
+
+				if (distance > PlaneTolerance)
+				{
+					isOutside = true;
+				}
+				else if (distance > -PlaneTolerance)
+				{
+					isUndecided = true;
+				}
+			}
+
+			if (isOutside == false && isUndecided)
+			{
+				mUndecidedCount++;
+				continue;
+			}
+
+			mCheckedCount++;
+			if (isVisible == isOutside)
+			{
+				mismatchCount++;
+			}
+		}
+
+		mMismatchCount += mismatchCount;
+		Check(mismatchCount == 0 && listedCount == mVisibleIndices.size(), L"Culled boxes differ from the reference or between the bitmask and the index list");
+	}
+}
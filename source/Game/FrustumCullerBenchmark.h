@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\Frustum.h"
+#include "..\Library\FrustumCuller.h"
+
+namespace Rendering
+{
+	// Culls 1,000,000 boxes scattered through a cube against the frustum of a camera turning in place at its center, once
+	// into a visibility bitmask and once into a list of visible indices. Both results must agree with each other and with
+	// a plane-by-plane test of every box in double precision; boxes too close to a plane for float arithmetic to call are
+	// left out of the comparison. Reports the time of each kind of cull and the objects culled per microsecond.
+	class FrustumCullerBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(FrustumCullerBenchmark, Benchmark)
+
+	public:
+		FrustumCullerBenchmark(Game& game);
+		~FrustumCullerBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		FrustumCullerBenchmark();
+		FrustumCullerBenchmark(const FrustumCullerBenchmark& rhs);
+		FrustumCullerBenchmark& operator=(const FrustumCullerBenchmark& rhs);
+
+		static const UINT ObjectCount;
+		static const float FieldExtent;			// Half the cube's side
+		static const float MinimumObjectExtent;
+		static const float MaximumObjectExtent;
+		static const double PlaneTolerance;		// Boxes whose distance to a plane is within this are not compared
+
+		static XMMATRIX ViewProjectionMatrix(float yaw);
+		void CheckAgainstReference();
+
+		Frustum mFrustum;
+		FrustumCuller mCuller;
+		FrustumCuller::BoxArray mBoxes;
+		std::vector<UINT> mVisibilityMask;
+		std::vector<UINT> mVisibleIndices;
+		double mMaskMilliseconds;				// Summed over the samples
+		double mIndexListMilliseconds;
+		UINT mVisibleCount;						// Summed over the samples
+		UINT mCheckedCount;
+		UINT mUndecidedCount;
+		UINT mMismatchCount;
+		UINT mSampleCount;
+	};
+}
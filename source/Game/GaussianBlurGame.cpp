@@ -15,11 +15,10 @@
 #include "..\Library\MatrixHelper.h"
 #include "..\Library\FullScreenRenderTarget.h"
 #include "..\Library\GaussianBlur.h"
-#include <sstream>
-#include <iomanip>
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include "..\Library\PointLight.h"
+#include "..\Library\TextBuilder.h"
 
 #include "PointLightDemo.h"
 
@@ -53,32 +52,32 @@ namespace Rendering
 		}
 
 		mKeyboard = new Keyboard(*this, mDirectInput);
-		mComponents.push_back(mKeyboard);
+		AddComponent(mKeyboard);
 		mServices.AddService(Keyboard::TypeIdClass(), mKeyboard);
 
 		mMouse = new Mouse(*this, mDirectInput);
-		mComponents.push_back(mMouse);
+		AddComponent(mMouse);
 		mServices.AddService(Mouse::TypeIdClass(), mMouse);
 
 		mCamera = new FirstPersonCamera(*this);
-		mComponents.push_back(mCamera);
+		AddComponent(mCamera);
 		mServices.AddService(Camera::TypeIdClass(), mCamera);
 
 		mFpsComponent = new FpsComponent(*this);
 		mFpsComponent->Initialize();
 
 		mSkybox = new Skybox(*this, *mCamera, L"..\\source\\Library\\Content\\Textures\\BaconTextureCube.dds", 500.0f);
-		mComponents.push_back(mSkybox);
+		AddComponent(mSkybox);
 
 		mGrid = new Grid(*this, *mCamera);
-		mComponents.push_back(mGrid);
+		AddComponent(mGrid);
 
 		RasterizerStates::Initialize(mDirect3DDevice);
 		SamplerStates::BorderColor = ColorHelper::Black;
 		SamplerStates::Initialize(mDirect3DDevice);
 
 		mPointLightDemo = new PointLightDemo(*this, *mCamera);
-		mComponents.push_back(mPointLightDemo);
+		AddComponent(mPointLightDemo);
 
 		mRenderStateHelper = new RenderStateHelper(*this);
 
@@ -153,13 +152,14 @@ namespace Rendering
 
 		mSpriteBatch->Begin();
 
-		std::wostringstream helpLabel;
+		TextBuilder helpLabel(FrameArena());
 		helpLabel << L"Ambient Intensity (+PgUp/-PgDn): " << mPointLightDemo->GetAmbientColor().a << "\n";
 		helpLabel << L"Point Light Intensity (+Home/-End): " << mPointLightDemo->GetPointLight().Color().a << "\n";
 		helpLabel << L"Specular Power (+Insert/-Delete): " << mPointLightDemo->GetSpecularPower() << "\n";
 		helpLabel << L"Move Point Light (8/2, 4/6, 3/9)\n";
-		helpLabel << std::setprecision(2) << L"Blur Amount (+J/-K): " << mGaussianBlur->BlurAmount();
-		mSpriteFont->DrawString(mSpriteBatch, helpLabel.str().c_str(), mTextPosition);
+		helpLabel.SetPrecision(2);
+		helpLabel << L"Blur Amount (+J/-K): " << mGaussianBlur->BlurAmount();
+		mSpriteFont->DrawString(mSpriteBatch, helpLabel.Text(), mTextPosition);
 
 		mSpriteBatch->End();
 
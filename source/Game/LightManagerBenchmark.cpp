@@ -0,0 +1,194 @@
+#include "stdafx.h"
+#include "LightManagerBenchmark.h"
+#include "..\Library\ClockSource.h"
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(LightManagerBenchmark)
+
+	const UINT LightManagerBenchmark::PointLightCount = 8000;
+	const UINT LightManagerBenchmark::SpotLightCount = 2000;
+	const UINT LightManagerBenchmark::ScreenWidth = 1920;
+	const UINT LightManagerBenchmark::ScreenHeight = 1080;
+	const float LightManagerBenchmark::FarPlaneDistance = 250.0f;
+	const float LightManagerBenchmark::LightFieldDepth = 220.0f;
+	const UINT LightManagerBenchmark::CheckedPointCount = 2000;
+	const float LightManagerBenchmark::Margin = 1e-3f;
+
+	LightManagerBenchmark::LightManagerBenchmark(Game& game)
+		: Benchmark(game), mCamera(game, XM_PIDIV4, static_cast<float>(ScreenWidth) / ScreenHeight, 0.5f, FarPlaneDistance), mLightManager(),
+		  mBuildMilliseconds(0.0), mIndexCount(0.0), mOccupiedClusterCount(0.0), mMaxLightsPerCluster(0),
+		  mCheckedPointCount(0), mCheckedLightCount(0), mMissingLightCount(0), mSampleCount(0)
+	{
+	}
+
+	LightManagerBenchmark::~LightManagerBenchmark()
+	{
+	}
+
+	void LightManagerBenchmark::Initialize()
+	{
+		mCamera.Initialize();
+
+		// Seeded, so every run places the same lights
+		std::default_random_engine generator(2024);
+		std::uniform_real_distribution<float> x(-150.0f, 150.0f);
+		std::uniform_real_distribution<float> y(-20.0f, 40.0f);
+		std::uniform_real_distribution<float> z(-LightFieldDepth, -5.0f);
+		std::uniform_real_distribution<float> radius(2.0f, 10.0f);
+		std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> halfAngle(XM_PI / 12.0f, XM_PIDIV4);
+
+		for (UINT i = 0; i < PointLightCount; i++)
+		{
+			mLightManager.AddPointLight(XMFLOAT3(x(generator), y(generator), z(generator)), radius(generator));
+		}
+
+		for (UINT i = 0; i < SpotLightCount; i++)
+		{
+			XMFLOAT3 position(x(generator), y(generator), z(generator));
+			float lightRadius = radius(generator) * 2.0f;
+
+			XMFLOAT3 lightDirection;
+			XMStoreFloat3(&lightDirection, XMVector3Normalize(XMVectorSet(direction(generator), direction(generator), direction(generator), 0.0f)));
+			mLightManager.AddSpotLight(position, lightRadius, lightDirection, std::cos(halfAngle(generator)));
+		}
+
+		const float yaws[] = { 0.0f, 0.3f };
+		for (UINT i = 0; i < ARRAYSIZE(yaws); i++)
+		{
+			SetPose(yaws[i]);
+			mLightManager.Build(mCamera, ScreenWidth, ScreenHeight);
+			CheckClusters(yaws[i]);
+		}
+	}
+
+	void LightManagerBenchmark::Update(const GameTime& gameTime)
+	{
+		SetPose(0.3f * std::sin(mSampleCount * 0.05f));
+
+		double startTime = RealClockSource::Milliseconds();
+		mLightManager.Build(mCamera, ScreenWidth, ScreenHeight);
+		mBuildMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		const LightManager::Statistics& statistics = mLightManager.GetStatistics();
+		mIndexCount += statistics.IndexCount;
+		mOccupiedClusterCount += statistics.OccupiedClusterCount;
+		mMaxLightsPerCluster = (std::max)(mMaxLightsPerCluster, statistics.MaxLightsPerCluster);
+		mSampleCount++;
+	}
+
+	void LightManagerBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+
+		results << L"Clustered lights (" << PointLightCount << L" point and " << SpotLightCount << L" spot lights, " << mLightManager.ColumnCount() << L"x"
+			<< mLightManager.RowCount() << L"x" << mLightManager.SliceCount() << L" clusters at " << ScreenWidth << L"x" << ScreenHeight << L")" << std::endl;
+		results << L"  Build: " << mBuildMilliseconds / sampleCount << L" ms per frame" << std::endl;
+		results << L"  " << mOccupiedClusterCount / sampleCount << L" occupied clusters, " << mIndexCount / sampleCount << L" light indices per frame, at most "
+			<< mMaxLightsPerCluster << L" lights in a cluster" << std::endl;
+		results << L"  Checked " << mCheckedLightCount << L" lights reaching " << mCheckedPointCount << L" points, " << mMissingLightCount << L" missing from their clusters" << std::endl;
+	}
+
+	void LightManagerBenchmark::SetPose(float yaw)
+	{
+		mCamera.Reset();
+		mCamera.SetPosition(0.0f, 5.0f, 0.0f);
+		mCamera.ApplyRotation(XMMatrixRotationY(yaw));
+		mCamera.UpdateViewMatrix();
+	}
+
+	void LightManagerBenchmark::CheckClusters(float yaw)
+	{
+		std::default_random_engine generator(99);
+		std::uniform_int_distribution<UINT> screenX(0, ScreenWidth - 1);
+		std::uniform_int_distribution<UINT> screenY(0, ScreenHeight - 1);
+		std::uniform_real_distribution<float> depth(mCamera.NearPlaneDistance(), LightFieldDepth);
+
+		XMMATRIX inverseView = XMMatrixInverse(nullptr, mCamera.ViewMatrix());
+		float tangentY = std::tan(mCamera.FieldOfView() * 0.5f);
+		float tangentX = tangentY * mCamera.AspectRatio();
+
+		const LightManager::PointLightArray& pointLights = mLightManager.PointLights();
+		const LightManager::SpotLightArray& spotLights = mLightManager.SpotLights();
+
+		UINT missingCount = 0;
+		for (UINT i = 0; i < CheckedPointCount; i++)
+		{
+			// The center of a pixel, at a depth along the view direction
+			UINT pixelX = screenX(generator);
+			UINT pixelY = screenY(generator);
+			float viewDepth = depth(generator);
+			float ndcX = 2.0f * (pixelX + 0.5f) / ScreenWidth - 1.0f;
+			float ndcY = 1.0f - 2.0f * (pixelY + 0.5f) / ScreenHeight;
+
+			XMFLOAT3 point;
+			XMStoreFloat3(&point, XMVector3TransformCoord(XMVectorSet(ndcX * tangentX * viewDepth, ndcY * tangentY * viewDepth, -viewDepth, 1.0f), inverseView));
+			UINT clusterIndex = mLightManager.ClusterIndex(pixelX, pixelY, viewDepth);
+			mCheckedPointCount++;
+
+			for (UINT j = 0; j < pointLights.Count(); j++)
+			{
+				float dx = point.x - pointLights.PositionX[j];
+				float dy = point.y - pointLights.PositionY[j];
+				float dz = point.z - pointLights.PositionZ[j];
+				float reach = pointLights.Radius[j] * (1.0f - Margin);
+				if (dx * dx + dy * dy + dz * dz < reach * reach)
+				{
+					mCheckedLightCount++;
+					if (IsListed(clusterIndex, j) == false)
+					{
+						missingCount++;
+					}
+				}
+			}
+
+			for (UINT j = 0; j < spotLights.Count(); j++)
+			{
+				float dx = point.x - spotLights.PositionX[j];
+				float dy = point.y - spotLights.PositionY[j];
+				float dz = point.z - spotLights.PositionZ[j];
+				float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+				if (distance >= spotLights.Radius[j] * (1.0f - Margin) || distance == 0.0f)
+				{
+					continue;
+				}
+
+				float cosine = (dx * spotLights.DirectionX[j] + dy * spotLights.DirectionY[j] + dz * spotLights.DirectionZ[j]) / distance;
+				if (cosine > spotLights.OuterAngle[j] + Margin)
+				{
+					mCheckedLightCount++;
+					if (IsListed(clusterIndex, pointLights.Count() + j) == false)
+					{
+						missingCount++;
+					}
+				}
+			}
+		}
+
+		mMissingLightCount += missingCount;
+
+		std::wostringstream description;
+		description << L"Camera yaw " << yaw << L": " << missingCount << L" lights missing from the clusters of points they reach";
+		Check(missingCount == 0, description.str());
+	}
+
+	bool LightManagerBenchmark::IsListed(UINT clusterIndex, UINT lightIndex) const
+	{
+		// Lists hold point light indices, then spot light indices counted from zero again
+		const LightManager::Cluster& cluster = mLightManager.Clusters()[clusterIndex];
+		const std::vector<UINT>& indices = mLightManager.LightIndices();
+		UINT pointLightCount = mLightManager.PointLights().Count();
+
+		if (lightIndex < pointLightCount)
+		{
+			return std::find(indices.begin() + cluster.Offset, indices.begin() + cluster.Offset + cluster.PointLightCount, lightIndex) != indices.begin() + cluster.Offset + cluster.PointLightCount;
+		}
+
+		UINT spotLightsOffset = cluster.Offset + cluster.PointLightCount;
+		return std::find(indices.begin() + spotLightsOffset, indices.begin() + spotLightsOffset + cluster.SpotLightCount, lightIndex - pointLightCount) != indices.begin() + spotLightsOffset + cluster.SpotLightCount;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\Camera.h"
+#include "..\Library\LightManager.h"
+
+namespace Rendering
+{
+	// Bins 10,000 point and spot lights, scattered through the space in front of a camera, into LightManager's cluster grid
+	// at 1920x1080 each frame while the camera sweeps from side to side, and reports the time per build and how full the
+	// clusters are. Initialize checks, for two camera poses, that every light reaching a sample of points in the view
+	// frustum is listed in those points' clusters. The points are placed by unprojecting pixels and depths through the
+	// camera's view, independently of the grid's own geometry.
+	class LightManagerBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(LightManagerBenchmark, Benchmark)
+
+	public:
+		LightManagerBenchmark(Game& game);
+		~LightManagerBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		LightManagerBenchmark();
+		LightManagerBenchmark(const LightManagerBenchmark& rhs);
+		LightManagerBenchmark& operator=(const LightManagerBenchmark& rhs);
+
+		static const UINT PointLightCount;
+		static const UINT SpotLightCount;
+		static const UINT ScreenWidth;
+		static const UINT ScreenHeight;
+		static const float FarPlaneDistance;
+		static const float LightFieldDepth;		// Lights lie between the camera and this distance in front of it
+		static const UINT CheckedPointCount;	// Per camera pose
+		static const float Margin;				// Lights reaching a point by less than this fraction of their radius are not required
+
+		void SetPose(float yaw);
+		void CheckClusters(float yaw);
+		bool IsListed(UINT clusterIndex, UINT lightIndex) const;
+
+		Camera mCamera;
+		LightManager mLightManager;
+		double mBuildMilliseconds;				// Summed over the samples
+		double mIndexCount;
+		double mOccupiedClusterCount;
+		UINT mMaxLightsPerCluster;
+		UINT mCheckedPointCount;
+		UINT mCheckedLightCount;
+		UINT mMissingLightCount;
+		UINT mSampleCount;
+	};
+}
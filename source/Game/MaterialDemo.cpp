@@ -6,6 +6,7 @@
 #include "..\Library\Camera.h"
 #include "..\Library\Utility.h"
 #include "..\Library\Model.h"
+#include "..\Library\ModelCache.h"
 #include "..\Library\Mesh.h"
 #include "..\Library\BasicMaterial.h"
 #include "..\Library\TextureMaterial.h"
@@ -17,9 +18,11 @@ namespace Rendering
 
 		MaterialDemo::MaterialDemo(Game& game, Camera& camera)
 		: DrawableGameComponent(game, camera),
-		mBasicMaterial(nullptr), mBasicEffect(nullptr), mWorldMatrix(MatrixHelper::Identity),
+		mBasicMaterial(nullptr), mBasicEffect(nullptr), mWorldMatrix(MatrixHelper::Identity), mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mCameraVersion(0),
 		mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0)
 	{
+		DeclareModel("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
+		DeclareEffect(L"Content\\Effects\\BasicEffect.cso");
 	}
 
 	MaterialDemo::~MaterialDemo()
@@ -35,7 +38,7 @@ namespace Rendering
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
 		// Load the model
-		std::unique_ptr<Model> model(new Model(*mGame, "..\\source\\Library\\Content\\Models\\Sphere.obj", true));
+		std::shared_ptr<Model> model = mGame->Models().Load("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
 
 		// Initialize the material
 		mBasicEffect = new Effect(*mGame);
@@ -71,8 +74,14 @@ namespace Rendering
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
 		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-		XMMATRIX worldMatrix = XMLoadFloat4x4(&mWorldMatrix);
-		XMMATRIX wvp = worldMatrix * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+		if (mIsWorldDirty || mCameraVersion != mCamera->ViewProjectionVersion())
+		{
+			mIsWorldDirty = false;
+			mCameraVersion = mCamera->ViewProjectionVersion();
+			XMStoreFloat4x4(&mWorldViewProjectionMatrix, XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix());
+		}
+
+		XMMATRIX wvp = XMLoadFloat4x4(&mWorldViewProjectionMatrix);
 		mBasicMaterial->WorldViewProjection() << wvp;
 		pass->Apply(0, direct3DDeviceContext);
 
@@ -0,0 +1,250 @@
+#include "stdafx.h"
+#include "MeshBvhBenchmark.h"
+#include "..\Library\Game.h"
+#include "..\Library\Model.h"
+#include "..\Library\Mesh.h"
+#include "..\Library\ModelCache.h"
+#include "..\Library\ClockSource.h"
+#include "..\Library\Utility.h"
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(MeshBvhBenchmark)
+
+	const std::string MeshBvhBenchmark::ModelFilenames[] =
+	{
+		"..\\source\\Library\\Content\\Models\\Sphere.obj",
+		"..\\source\\Library\\Content\\Models\\teapot.obj",
+		"..\\source\\Library\\Content\\Models\\RunningSoldier.dae"
+	};
+
+	const UINT MeshBvhBenchmark::RayGridWidth = 320;
+	const UINT MeshBvhBenchmark::RayGridHeight = 180;
+	const UINT MeshBvhBenchmark::CheckedRayStride = 7;
+	const double MeshBvhBenchmark::EdgeTolerance = 1e-4;
+	const double MeshBvhBenchmark::DistanceTolerance = 1e-3;
+
+	MeshBvhBenchmark::MeshBvhBenchmark(Game& game)
+		: Benchmark(game), mCamera(game, XM_PIDIV4, 16.0f / 9.0f, 0.01f, 10000.0f), mArena(), mModels(), mRays(), mHits(),
+		  mCheckedRayCount(0), mUndecidedRayCount(0), mMismatchCount(0), mSampleCount(0)
+	{
+	}
+
+	MeshBvhBenchmark::~MeshBvhBenchmark()
+	{
+	}
+
+	void MeshBvhBenchmark::Initialize()
+	{
+		mCamera.Initialize();
+
+		for (UINT i = 0; i < ARRAYSIZE(ModelFilenames); i++)
+		{
+			TracedModel model(ModelFilenames[i]);
+			model.LoadedModel = mGame->Models().Load(model.Filename, true);
+
+			double startTime = RealClockSource::Milliseconds();
+			for (Mesh* mesh : model.LoadedModel->Meshes())
+			{
+				// Ray queries need a triangle list
+				MeshBvh* bvh = nullptr;
+				if (mesh->FaceCount() > 0 && mesh->Indices().size() == mesh->FaceCount() * 3)
+				{
+					bvh = mArena.Create<MeshBvh>(mesh->Vertices(), mesh->Indices(), mArena);
+					model.Bounds.Merge(bvh->Bounds());
+					model.TriangleCount += bvh->GetStatistics().TriangleCount;
+				}
+
+				model.Bvhs.push_back(bvh);
+			}
+
+			model.BuildMilliseconds = RealClockSource::Milliseconds() - startTime;
+			mModels.push_back(model);
+		}
+
+		const float yaws[] = { 0.0f, 2.3f };
+		for (const TracedModel& model : mModels)
+		{
+			Check(model.Bounds.IsEmpty() == false, Utility::ToWideString(model.Filename) + L" has no triangles to trace");
+			if (model.Bounds.IsEmpty())
+			{
+				continue;
+			}
+
+			for (UINT i = 0; i < ARRAYSIZE(yaws); i++)
+			{
+				AimCamera(model, yaws[i]);
+				CreateRays();
+				CheckHits(model, yaws[i]);
+			}
+		}
+	}
+
+	void MeshBvhBenchmark::Update(const GameTime& gameTime)
+	{
+		for (TracedModel& model : mModels)
+		{
+			if (model.Bounds.IsEmpty())
+			{
+				continue;
+			}
+
+			AimCamera(model, mSampleCount * 0.1f);
+			CreateRays();
+
+			for (MeshBvh* bvh : model.Bvhs)
+			{
+				if (bvh != nullptr)
+				{
+					double startTime = RealClockSource::Milliseconds();
+					model.HitCount += bvh->Trace(mRays, mCamera.FarPlaneDistance(), mHits);
+					model.TraceMilliseconds += RealClockSource::Milliseconds() - startTime;
+					model.RayCount += mRays.size();
+				}
+			}
+		}
+
+		mSampleCount++;
+	}
+
+	void MeshBvhBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		results << L"Mesh BVH ray tracing (" << RayGridWidth << L"x" << RayGridHeight << L" picking rays per mesh per frame)" << std::endl;
+		for (const TracedModel& model : mModels)
+		{
+			double megaraysPerSecond = (model.TraceMilliseconds > 0.0 ? model.RayCount / (model.TraceMilliseconds * 1000.0) : 0.0);
+
+			results << L"  " << Utility::ToWideString(model.Filename) << L": " << model.TriangleCount << L" triangles, built in " << model.BuildMilliseconds << L" ms, "
+				<< megaraysPerSecond << L" Mrays/s, " << (model.RayCount > 0 ? 100.0 * model.HitCount / model.RayCount : 0.0) << L"% hit" << std::endl;
+		}
+
+		results << L"  Checked " << mCheckedRayCount << L" rays against every triangle, " << mMismatchCount << L" differ, " << mUndecidedRayCount << L" too close to an edge to call" << std::endl;
+	}
+
+	void MeshBvhBenchmark::AimCamera(const TracedModel& model, float yaw)
+	{
+		// Circles the model at a distance that keeps all of it in view, looking at its center
+		XMFLOAT3 center = model.Bounds.Center();
+		XMFLOAT3 extents = model.Bounds.Extents();
+		float distance = 2.5f * std::sqrt(extents.x * extents.x + extents.y * extents.y + extents.z * extents.z);
+
+		mCamera.Reset();
+		mCamera.SetPosition(center.x + std::sin(yaw) * distance, center.y, center.z + std::cos(yaw) * distance);
+		mCamera.ApplyRotation(XMMatrixRotationY(yaw));
+		mCamera.UpdateViewMatrix();
+	}
+
+	void MeshBvhBenchmark::CreateRays()
+	{
+		mRays.clear();
+		for (UINT y = 0; y < RayGridHeight; y++)
+		{
+			for (UINT x = 0; x < RayGridWidth; x++)
+			{
+				int screenX = static_cast<int>((2 * x + 1) * mGame->ScreenWidth() / (2 * RayGridWidth));
+				int screenY = static_cast<int>((2 * y + 1) * mGame->ScreenHeight() / (2 * RayGridHeight));
+				mRays.push_back(mCamera.PickingRay(screenX, screenY));
+			}
+		}
+	}
+
+	void MeshBvhBenchmark::CheckHits(const TracedModel& model, float yaw)
+	{
+		float maxDistance = mCamera.FarPlaneDistance();
+
+		for (UINT i = 0; i < model.Bvhs.size(); i++)
+		{
+			MeshBvh* bvh = model.Bvhs[i];
+			if (bvh == nullptr)
+			{
+				continue;
+			}
+
+			bvh->Trace(mRays, maxDistance, mHits);
+
+			const Mesh& mesh = *model.LoadedModel->Meshes()[i];
+			const std::vector<XMFLOAT3>& vertices = mesh.Vertices();
+			const std::vector<UINT>& indices = mesh.Indices();
+
+			UINT mismatchCount = 0;
+			for (UINT j = 0; j < mRays.size(); j += CheckedRayStride)
+			{
+				const Ray& ray = mRays[j];
+				const MeshBvh::Hit& hit = mHits[j];
+
+				MeshBvh::Hit singleHit;
+				bool isSingleHit = bvh->Intersect(ray, maxDistance, singleHit);
+				if (isSingleHit != (hit.Triangle != MeshBvh::InvalidTriangle) || (isSingleHit && (singleHit.Triangle != hit.Triangle || singleHit.Distance != hit.Distance)))
+				{
+					mismatchCount++;
+					continue;
+				}
+
+				// Moller-Trumbore in double over every triangle. The nearest hit well inside a triangle bounds the answer from
+				// above, and the nearest hit that might be inside one, allowing for rounding at the edges, bounds it from below.
+				const XMFLOAT3& origin = ray.Position();
+				const XMFLOAT3& direction = ray.Direction();
+				double certainDistance = maxDistance;
+				double possibleDistance = maxDistance;
+				for (UINT k = 0; k < indices.size(); k += 3)
+				{
+					const XMFLOAT3& vertex0 = vertices[indices[k]];
+					const XMFLOAT3& vertex1 = vertices[indices[k + 1]];
+					const XMFLOAT3& vertex2 = vertices[indices[k + 2]];
+
+					double edge1[] = { static_cast<double>(vertex1.x) - vertex0.x, static_cast<double>(vertex1.y) - vertex0.y, static_cast<double>(vertex1.z) - vertex0.z };
+					double edge2[] = { static_cast<double>(vertex2.x) - vertex0.x, static_cast<double>(vertex2.y) - vertex0.y, static_cast<double>(vertex2.z) - vertex0.z };
+					double p[] = { direction.y * edge2[2] - direction.z * edge2[1], direction.z * edge2[0] - direction.x * edge2[2], direction.x * edge2[1] - direction.y * edge2[0] };
+					double determinant = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+					if (std::fabs(determinant) < 1e-12)
+					{
+						continue;
+					}
+
+					double t[] = { static_cast<double>(origin.x) - vertex0.x, static_cast<double>(origin.y) - vertex0.y, static_cast<double>(origin.z) - vertex0.z };
+					double q[] = { t[1] * edge1[2] - t[2] * edge1[1], t[2] * edge1[0] - t[0] * edge1[2], t[0] * edge1[1] - t[1] * edge1[0] };
+					double u = (t[0] * p[0] + t[1] * p[1] + t[2] * p[2]) / determinant;
+					double v = (direction.x * q[0] + direction.y * q[1] + direction.z * q[2]) / determinant;
+					double distance = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) / determinant;
+					if (distance <= 0.0)
+					{
+						continue;
+					}
+
+					double margin = (std::min)((std::min)(u, v), 1.0 - u - v);
+					if (margin > EdgeTolerance)
+					{
+						certainDistance = (std::min)(certainDistance, distance);
+					}
+
+					if (margin > -EdgeTolerance)
+					{
+						possibleDistance = (std::min)(possibleDistance, distance);
+					}
+				}
+
+				if (possibleDistance < certainDistance)
+				{
+					mUndecidedRayCount++;
+				}
+
+				double tolerance = DistanceTolerance * (std::max)(1.0, certainDistance);
+				bool isHit = (hit.Triangle != MeshBvh::InvalidTriangle);
+				bool matches = (isHit ? (hit.Distance >= possibleDistance - tolerance && hit.Distance <= certainDistance + tolerance) : certainDistance >= maxDistance);
+				if (matches == false)
+				{
+					mismatchCount++;
+				}
+
+				mCheckedRayCount++;
+			}
+
+			mMismatchCount += mismatchCount;
+
+			std::wostringstream description;
+			description << Utility::ToWideString(model.Filename) << L", mesh " << i << L", camera yaw " << yaw << L": traced hits differ from the reference";
+			Check(mismatchCount == 0, description.str());
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\Camera.h"
+#include "..\Library\MemoryArena.h"
+#include "..\Library\MeshBvh.h"
+#include "..\Library\Ray.h"
+
+namespace Library
+{
+	class Model;
+}
+
+namespace Rendering
+{
+	// Builds a MeshBvh for every mesh of the models the demos load, then traces a grid of picking rays from a camera
+	// circling each model. The rays come from Camera::PickingRay, as a mouse pick would. Initialize checks, for a sample
+	// of rays from two poses, that single-ray Intersect agrees with the batched Trace, and that the nearest hit agrees
+	// with a double-precision test of every triangle; rays passing too close to a triangle edge to call are allowed
+	// either answer. Reports the build time and the traced rays per second for each model.
+	class MeshBvhBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(MeshBvhBenchmark, Benchmark)
+
+	public:
+		MeshBvhBenchmark(Game& game);
+		~MeshBvhBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		MeshBvhBenchmark();
+		MeshBvhBenchmark(const MeshBvhBenchmark& rhs);
+		MeshBvhBenchmark& operator=(const MeshBvhBenchmark& rhs);
+
+		struct TracedModel
+		{
+			std::string Filename;
+			std::shared_ptr<Model> LoadedModel;
+			std::vector<MeshBvh*> Bvhs;		// Allocated from the benchmark's arena; null for meshes that are not triangle lists
+			AxisAlignedBox Bounds;
+			UINT TriangleCount;
+			double BuildMilliseconds;
+			double TraceMilliseconds;		// Summed over the samples
+			UINT RayCount;
+			UINT HitCount;
+
+			TracedModel(const std::string& filename)
+				: Filename(filename), LoadedModel(), Bvhs(), Bounds(), TriangleCount(0), BuildMilliseconds(0.0), TraceMilliseconds(0.0), RayCount(0), HitCount(0) { }
+		};
+
+		static const std::string ModelFilenames[];
+		static const UINT RayGridWidth;
+		static const UINT RayGridHeight;
+		static const UINT CheckedRayStride;		// Every this many rays of the grid is checked against the reference
+		static const double EdgeTolerance;		// In barycentric weight
+		static const double DistanceTolerance;	// Relative to the distance
+
+		void AimCamera(const TracedModel& model, float yaw);
+		void CreateRays();
+		void CheckHits(const TracedModel& model, float yaw);
+
+		Camera mCamera;
+		MemoryArena mArena;
+		std::vector<TracedModel> mModels;
+		std::vector<Ray> mRays;
+		std::vector<MeshBvh::Hit> mHits;
+		UINT mCheckedRayCount;
+		UINT mUndecidedRayCount;
+		UINT mMismatchCount;
+		UINT mSampleCount;
+	};
+}
@@ -7,6 +7,7 @@
 #include "..\..\DirectXTest\source\Library\Camera.h"
 #include "..\..\DirectXTest\source\Library\Utility.h"
 #include "..\..\DirectXTest\source\Library\Model.h"
+#include "..\..\DirectXTest\source\Library\ModelCache.h"
 #include "..\..\DirectXTest\source\Library\Mesh.h"
 #include "D3DCompiler.h"
 
@@ -17,8 +18,10 @@ namespace Rendering
 		ModelDemo::ModelDemo(Game& game, Camera& camera)
 		: DrawableGameComponent(game, camera),
 		mEffect(nullptr), mTechnique(nullptr), mPass(nullptr), mWvpVariable(nullptr),
-		mInputLayout(nullptr), mWorldMatrix(MatrixHelper::Identity), mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0)
+		mInputLayout(nullptr), mWorldMatrix(MatrixHelper::Identity), mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mCameraVersion(0), mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0)
 	{
+		// The effect is compiled from source, so only the model can be declared
+		DeclareModel("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
 	}
 
 	ModelDemo::~ModelDemo()
@@ -106,7 +109,7 @@ namespace Rendering
 		}
 
 		// Load the model
-		std::unique_ptr<Model> model(new Model(*mGame, "..\\source\\Library\\Content\\Models\\Sphere.obj", true));
+		std::shared_ptr<Model> model = mGame->Models().Load("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
 
 		// Create the vertex and index buffers
 		Mesh* mesh = model->Meshes().at(0);
@@ -126,8 +129,14 @@ namespace Rendering
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
 		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-		XMMATRIX worldMatrix = XMLoadFloat4x4(&mWorldMatrix);
-		XMMATRIX wvp = worldMatrix * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+		if (mIsWorldDirty || mCameraVersion != mCamera->ViewProjectionVersion())
+		{
+			mIsWorldDirty = false;
+			mCameraVersion = mCamera->ViewProjectionVersion();
+			XMStoreFloat4x4(&mWorldViewProjectionMatrix, XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix());
+		}
+
+		XMMATRIX wvp = XMLoadFloat4x4(&mWorldViewProjectionMatrix);
 		mWvpVariable->SetMatrix(reinterpret_cast<const float*>(&wvp));
 
 		mPass->Apply(0, direct3DDeviceContext);
@@ -52,5 +52,8 @@ namespace Rendering
 		UINT mIndexCount;
 
 		XMFLOAT4X4 mWorldMatrix;
+		XMFLOAT4X4 mWorldViewProjectionMatrix;
+		bool mIsWorldDirty;
+		UINT mCameraVersion;
 	};
 }
@@ -0,0 +1,277 @@
+#include "stdafx.h"
+#include "ModelLoadBenchmark.h"
+#include "..\Library\Mesh.h"
+#include "..\Library\Skeleton.h"
+#include "..\Library\Bone.h"
+#include "..\Library\AnimationLibrary.h"
+#include "..\Library\MemoryArena.h"
+#include "..\Library\MemoryTracker.h"
+#include "..\Library\ClockSource.h"
+#include "scene.h"
+#include <algorithm>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(ModelLoadBenchmark)
+
+	const UINT ModelLoadBenchmark::Sides[] = { 128, 256, 512 };
+	const UINT ModelLoadBenchmark::BoneCount = 64;
+	const UINT ModelLoadBenchmark::TargetCount = 4;
+	const UINT ModelLoadBenchmark::DeltasPerTarget = 4096;
+	const UINT ModelLoadBenchmark::ClipCount = 2;
+	const UINT ModelLoadBenchmark::KeyframeCount = 30;
+
+	ModelLoadBenchmark::ModelLoadBenchmark(Game& game)
+		: Benchmark(game), mCases()
+	{
+	}
+
+	ModelLoadBenchmark::~ModelLoadBenchmark()
+	{
+		for (Case& benchmarkCase : mCases)
+		{
+			DeleteObject(benchmarkCase.Scene);
+		}
+	}
+
+	void ModelLoadBenchmark::Initialize()
+	{
+		for (UINT i = 0; i < ARRAYSIZE(Sides); i++)
+		{
+			mCases.push_back(Case(CreateScene(Sides[i]), Sides[i] * Sides[i]));
+		}
+
+		if (MemoryTracker::IsEnabled())
+		{
+			CheckHeapAllocations();
+			CheckUnload();
+		}
+	}
+
+	void ModelLoadBenchmark::Update(const GameTime& gameTime)
+	{
+		for (Case& benchmarkCase : mCases)
+		{
+			double startTime = RealClockSource::Milliseconds();
+			Model* model = new Model(*mGame, *benchmarkCase.Scene, "ModelLoadBenchmark");
+			double loadedTime = RealClockSource::Milliseconds();
+			benchmarkCase.LoadStatistics = model->GetLoadStatistics();
+
+			DeleteObject(model);
+			double unloadedTime = RealClockSource::Milliseconds();
+
+			benchmarkCase.LoadMilliseconds += loadedTime - startTime;
+			benchmarkCase.UnloadMilliseconds += unloadedTime - loadedTime;
+			benchmarkCase.SampleCount++;
+		}
+	}
+
+	void ModelLoadBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		results << L"Model load and unload (" << BoneCount << L" bones, " << TargetCount << L" morph targets, " << ClipCount << L" clips of "
+			<< KeyframeCount << L" keyframes)" << std::endl;
+
+		for (const Case& benchmarkCase : mCases)
+		{
+			double sampleCount = (benchmarkCase.SampleCount > 0 ? static_cast<double>(benchmarkCase.SampleCount) : 1.0);
+
+			results << L"  " << benchmarkCase.VertexCount << L" vertices: " << benchmarkCase.LoadMilliseconds / sampleCount << L" ms to load, "
+				<< benchmarkCase.UnloadMilliseconds / sampleCount << L" ms to unload, " << benchmarkCase.LoadStatistics.HeapAllocationCount
+				<< L" heap allocations, " << benchmarkCase.LoadStatistics.ArenaAllocationCount << L" arena allocations totalling "
+				<< benchmarkCase.LoadStatistics.ArenaBytesAllocated << L" bytes" << std::endl;
+		}
+	}
+
+	aiScene* ModelLoadBenchmark::CreateScene(UINT side)
+	{
+		UINT vertexCount = side * side;
+		assert(vertexCount >= DeltasPerTarget);
+
+		// A flat grid skinned to a chain of bones, one bone per vertex in turn, with sparse morph targets of the same size
+		// on every mesh
+		aiScene* scene = new aiScene();
+		scene->mNumMaterials = 1;
+		scene->mMaterials = new aiMaterial*[1];
+		scene->mMaterials[0] = new aiMaterial();
+
+		aiMesh* mesh = new aiMesh();
+		scene->mNumMeshes = 1;
+		scene->mMeshes = new aiMesh*[1];
+		scene->mMeshes[0] = mesh;
+
+		mesh->mName.Set("Grid");
+		mesh->mNumVertices = vertexCount;
+		mesh->mVertices = new aiVector3D[vertexCount];
+		mesh->mNormals = new aiVector3D[vertexCount];
+		mesh->mTextureCoords[0] = new aiVector3D[vertexCount];
+		mesh->mNumUVComponents[0] = 2;
+		for (UINT i = 0; i < vertexCount; i++)
+		{
+			UINT x = i % side;
+			UINT z = i / side;
+			mesh->mVertices[i] = aiVector3D(static_cast<float>(x), 0.0f, static_cast<float>(z));
+			mesh->mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+			mesh->mTextureCoords[0][i] = aiVector3D(static_cast<float>(x) / side, static_cast<float>(z) / side, 0.0f);
+		}
+
+		mesh->mNumFaces = (side - 1) * (side - 1) * 2;
+		mesh->mFaces = new aiFace[mesh->mNumFaces];
+		UINT faceIndex = 0;
+		for (UINT z = 0; z + 1 < side; z++)
+		{
+			for (UINT x = 0; x + 1 < side; x++)
+			{
+				UINT corner = z * side + x;
+				UINT triangles[2][3] = { { corner, corner + 1, corner + side }, { corner + 1, corner + side + 1, corner + side } };
+
+				for (UINT i = 0; i < 2; i++)
+				{
+					aiFace& face = mesh->mFaces[faceIndex++];
+					face.mNumIndices = 3;
+					face.mIndices = new unsigned int[3];
+					std::copy(triangles[i], triangles[i] + 3, face.mIndices);
+				}
+			}
+		}
+
+		aiMatrix4x4 identity;
+		scene->mRootNode = new aiNode();
+		scene->mRootNode->mName.Set("Root");
+
+		mesh->mNumBones = BoneCount;
+		mesh->mBones = new aiBone*[BoneCount];
+		aiNode* parentNode = scene->mRootNode;
+		for (UINT boneIndex = 0; boneIndex < BoneCount; boneIndex++)
+		{
+			aiBone* bone = new aiBone();
+			bone->mName.Set(BoneName(boneIndex));
+			bone->mOffsetMatrix = identity;
+			bone->mNumWeights = (vertexCount - boneIndex + BoneCount - 1) / BoneCount;
+			bone->mWeights = new aiVertexWeight[bone->mNumWeights];
+			for (UINT i = 0; i < bone->mNumWeights; i++)
+			{
+				bone->mWeights[i] = aiVertexWeight(i * BoneCount + boneIndex, 1.0f);
+			}
+
+			mesh->mBones[boneIndex] = bone;
+
+			aiNode* node = new aiNode();
+			node->mName.Set(BoneName(boneIndex));
+			node->mParent = parentNode;
+			parentNode->mNumChildren = 1;
+			parentNode->mChildren = new aiNode*[1];
+			parentNode->mChildren[0] = node;
+			parentNode = node;
+		}
+
+		UINT stride = vertexCount / DeltasPerTarget;
+		mesh->mNumAnimMeshes = TargetCount;
+		mesh->mAnimMeshes = new aiAnimMesh*[TargetCount];
+		for (UINT target = 0; target < TargetCount; target++)
+		{
+			aiAnimMesh* animMesh = new aiAnimMesh();
+			animMesh->mNumVertices = vertexCount;
+			animMesh->mVertices = new aiVector3D[vertexCount];
+			animMesh->mNormals = new aiVector3D[vertexCount];
+			std::copy(mesh->mVertices, mesh->mVertices + vertexCount, animMesh->mVertices);
+			std::copy(mesh->mNormals, mesh->mNormals + vertexCount, animMesh->mNormals);
+
+			for (UINT i = 0; i < DeltasPerTarget; i++)
+			{
+				animMesh->mVertices[(i * stride + target) % vertexCount].y += 0.1f * (target + 1);
+			}
+
+			mesh->mAnimMeshes[target] = animMesh;
+		}
+
+		scene->mNumAnimations = ClipCount;
+		scene->mAnimations = new aiAnimation*[ClipCount];
+		for (UINT clipIndex = 0; clipIndex < ClipCount; clipIndex++)
+		{
+			aiAnimation* animation = new aiAnimation();
+			animation->mName.Set(clipIndex == 0 ? "Walk" : "Run");
+			animation->mDuration = KeyframeCount - 1;
+			animation->mTicksPerSecond = 30.0;
+			animation->mNumChannels = BoneCount;
+			animation->mChannels = new aiNodeAnim*[BoneCount];
+
+			for (UINT boneIndex = 0; boneIndex < BoneCount; boneIndex++)
+			{
+				aiNodeAnim* channel = new aiNodeAnim();
+				channel->mNodeName.Set(BoneName(boneIndex));
+				channel->mNumPositionKeys = KeyframeCount;
+				channel->mNumRotationKeys = KeyframeCount;
+				channel->mNumScalingKeys = KeyframeCount;
+				channel->mPositionKeys = new aiVectorKey[KeyframeCount];
+				channel->mRotationKeys = new aiQuatKey[KeyframeCount];
+				channel->mScalingKeys = new aiVectorKey[KeyframeCount];
+
+				for (UINT i = 0; i < KeyframeCount; i++)
+				{
+					channel->mPositionKeys[i] = aiVectorKey(i, aiVector3D(0.0f, 1.0f + 0.01f * i * (clipIndex + 1), 0.0f));
+					channel->mRotationKeys[i] = aiQuatKey(i, aiQuaternion());
+					channel->mScalingKeys[i] = aiVectorKey(i, aiVector3D(1.0f, 1.0f, 1.0f));
+				}
+
+				animation->mChannels[boneIndex] = channel;
+			}
+
+			scene->mAnimations[clipIndex] = animation;
+		}
+
+		return scene;
+	}
+
+	std::string ModelLoadBenchmark::BoneName(UINT boneIndex)
+	{
+		std::ostringstream name;
+		name << "Bone" << boneIndex;
+
+		return name.str();
+	}
+
+	void ModelLoadBenchmark::CheckHeapAllocations()
+	{
+		// Every container is reserved to its final size and the arenas take the small objects, so a bigger mesh costs
+		// bigger allocations rather than more of them
+		for (Case& benchmarkCase : mCases)
+		{
+			Model* model = new Model(*mGame, *benchmarkCase.Scene, "ModelLoadBenchmark");
+			benchmarkCase.LoadStatistics = model->GetLoadStatistics();
+			DeleteObject(model);
+		}
+
+		const Case& smallest = mCases.front();
+		const Case& largest = mCases.back();
+		std::wostringstream description;
+		description << L"Building a model of " << largest.VertexCount << L" vertices made " << largest.LoadStatistics.HeapAllocationCount
+			<< L" heap allocations, against " << smallest.LoadStatistics.HeapAllocationCount << L" for " << smallest.VertexCount << L" vertices";
+		Check(largest.LoadStatistics.HeapAllocationCount == smallest.LoadStatistics.HeapAllocationCount, description.str());
+	}
+
+	void ModelLoadBenchmark::CheckUnload()
+	{
+		MemoryTracker::Statistics startModelStatistics = MemoryTracker::GetStatistics(MemorySubsystemModels);
+		MemoryTracker::Statistics startAnimationStatistics = MemoryTracker::GetStatistics(MemorySubsystemAnimation);
+
+		Model* model = new Model(*mGame, *mCases.front().Scene, "ModelLoadBenchmark");
+		size_t modelArenaBytes = model->GetArena().GetStatistics().BytesReserved;
+		std::shared_ptr<Skeleton> skeleton = model->GetSkeleton();
+		std::shared_ptr<AnimationLibrary> animationLibrary = model->GetAnimationLibrary();
+		DeleteObject(model);
+
+		// What is still held is the skeleton's; the model's arena went with the model
+		size_t heldBytes = MemoryTracker::GetStatistics(MemorySubsystemModels).BytesInUse - startModelStatistics.BytesInUse;
+		Check(heldBytes < modelArenaBytes, L"A shared skeleton kept the arena of the model that loaded it alive");
+
+		bool isSkeletonIntact = (skeleton->BoneCount() == BoneCount && skeleton->Bones().back()->Name() == BoneName(BoneCount - 1) && skeleton->HasHierarchy());
+		bool isLibraryIntact = (animationLibrary->Clips().size() == ClipCount && animationLibrary->FindClip("Run") != nullptr);
+		Check(isSkeletonIntact && isLibraryIntact, L"A shared skeleton or clip library did not survive the model that loaded it");
+
+		animationLibrary = nullptr;
+		skeleton = nullptr;
+
+		Check(MemoryTracker::GetStatistics(MemorySubsystemModels).BytesInUse == startModelStatistics.BytesInUse, L"Unloading a model left model memory allocated");
+		Check(MemoryTracker::GetStatistics(MemorySubsystemAnimation).BytesInUse == startAnimationStatistics.BytesInUse, L"Unloading a model left animation memory allocated");
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\Model.h"
+
+struct aiScene;
+
+namespace Rendering
+{
+	// Builds models from generated skinned, morphed and animated scenes of very different sizes and times loading and
+	// unloading each one. Initialize checks that the heap allocations a build makes do not grow with the mesh, that a
+	// model hands all of its memory back when it is deleted, and that a skeleton and clip library it shared survive it
+	// without keeping its arena alive. The memory checks need the memory tracker and are skipped when it is compiled out.
+	class ModelLoadBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(ModelLoadBenchmark, Benchmark)
+
+	public:
+		ModelLoadBenchmark(Game& game);
+		~ModelLoadBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		struct Case
+		{
+			aiScene* Scene;
+			UINT VertexCount;
+			Model::LoadStatistics LoadStatistics;	// From the last load
+			double LoadMilliseconds;				// Summed over the samples
+			double UnloadMilliseconds;
+			UINT SampleCount;
+
+			Case(aiScene* scene, UINT vertexCount)
+				: Scene(scene), VertexCount(vertexCount), LoadStatistics(), LoadMilliseconds(0.0), UnloadMilliseconds(0.0), SampleCount(0) { }
+		};
+
+		ModelLoadBenchmark();
+		ModelLoadBenchmark(const ModelLoadBenchmark& rhs);
+		ModelLoadBenchmark& operator=(const ModelLoadBenchmark& rhs);
+
+		static const UINT Sides[];				// The mesh is a square grid of Side * Side vertices
+		static const UINT BoneCount;
+		static const UINT TargetCount;
+		static const UINT DeltasPerTarget;
+		static const UINT ClipCount;
+		static const UINT KeyframeCount;
+
+		static aiScene* CreateScene(UINT side);
+		static std::string BoneName(UINT boneIndex);
+
+		void CheckHeapAllocations();
+		void CheckUnload();
+
+		std::vector<Case> mCases;
+	};
+}
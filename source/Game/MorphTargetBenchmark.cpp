@@ -0,0 +1,135 @@
+#include "stdafx.h"
+#include "MorphTargetBenchmark.h"
+#include "..\Library\Model.h"
+#include "..\Library\Mesh.h"
+#include "..\Library\MorphTargetBlender.h"
+#include "..\Library\ClockSource.h"
+#include "scene.h"
+#include <algorithm>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(MorphTargetBenchmark)
+
+	const UINT MorphTargetBenchmark::VertexCounts[] = { 10000, 50000, 250000 };
+	const UINT MorphTargetBenchmark::ActiveTargetCounts[] = { 1, 2, 4, 8 };
+	const UINT MorphTargetBenchmark::TargetCount = 8;
+	const UINT MorphTargetBenchmark::DeltasPerTarget = 4096;
+
+	MorphTargetBenchmark::MorphTargetBenchmark(Game& game)
+		: Benchmark(game), mModels(), mCases(), mSampleIndex(0)
+	{
+	}
+
+	MorphTargetBenchmark::~MorphTargetBenchmark()
+	{
+		for (Case& benchmarkCase : mCases)
+		{
+			DeleteObject(benchmarkCase.Blender);
+		}
+
+		for (Model* model : mModels)
+		{
+			DeleteObject(model);
+		}
+	}
+
+	void MorphTargetBenchmark::Initialize()
+	{
+		for (UINT i = 0; i < ARRAYSIZE(VertexCounts); i++)
+		{
+			Model* model = CreateModel(VertexCounts[i]);
+			mModels.push_back(model);
+
+			for (UINT j = 0; j < ARRAYSIZE(ActiveTargetCounts); j++)
+			{
+				mCases.push_back(Case(new MorphTargetBlender(*model->Meshes().at(0)), ActiveTargetCounts[j]));
+			}
+		}
+	}
+
+	void MorphTargetBenchmark::Update(const GameTime& gameTime)
+	{
+		// Alternating the weight makes every sample a full blend rather than a clean no-op
+		float weight = ((mSampleIndex & 1) == 0 ? 0.5f : 0.75f);
+		mSampleIndex++;
+
+		for (Case& benchmarkCase : mCases)
+		{
+			for (UINT i = 0; i < benchmarkCase.ActiveTargetCount; i++)
+			{
+				benchmarkCase.Blender->SetWeight(i, weight);
+			}
+
+			double startTime = RealClockSource::Milliseconds();
+			benchmarkCase.Blender->Apply();
+			benchmarkCase.Milliseconds += RealClockSource::Milliseconds() - startTime;
+			benchmarkCase.SampleCount++;
+		}
+	}
+
+	void MorphTargetBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		results << L"Morph target blending (" << TargetCount << L" targets of " << DeltasPerTarget << L" deltas)" << std::endl;
+
+		for (const Case& benchmarkCase : mCases)
+		{
+			const MorphTargetBlender::Statistics& statistics = benchmarkCase.Blender->GetStatistics();
+			double averageMilliseconds = (benchmarkCase.SampleCount > 0 ? benchmarkCase.Milliseconds / benchmarkCase.SampleCount : 0.0);
+
+			results << L"  " << statistics.VertexCount << L" vertices, " << statistics.ActiveTargetCount << L" active: "
+				<< averageMilliseconds << L" ms per blend, " << statistics.AppliedDeltaCount << L" deltas applied, "
+				<< statistics.RestoredVertexCount << L" vertices restored" << std::endl;
+		}
+	}
+
+	Model* MorphTargetBenchmark::CreateModel(UINT vertexCount) const
+	{
+		assert(vertexCount >= DeltasPerTarget);
+
+		// A flat sheet of points; target t moves every (vertexCount / DeltasPerTarget)th vertex from vertex t on, so the
+		// targets overlap a little but each moves the same number of vertices on every mesh
+		aiScene scene;
+		scene.mNumMaterials = 1;
+		scene.mMaterials = new aiMaterial*[1];
+		scene.mMaterials[0] = new aiMaterial();
+
+		aiMesh* mesh = new aiMesh();
+		scene.mNumMeshes = 1;
+		scene.mMeshes = new aiMesh*[1];
+		scene.mMeshes[0] = mesh;
+
+		mesh->mNumVertices = vertexCount;
+		mesh->mVertices = new aiVector3D[vertexCount];
+		mesh->mNormals = new aiVector3D[vertexCount];
+		for (UINT i = 0; i < vertexCount; i++)
+		{
+			mesh->mVertices[i] = aiVector3D(static_cast<float>(i % 1024), 0.0f, static_cast<float>(i / 1024));
+			mesh->mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+		}
+
+		UINT stride = vertexCount / DeltasPerTarget;
+		mesh->mNumAnimMeshes = TargetCount;
+		mesh->mAnimMeshes = new aiAnimMesh*[TargetCount];
+		for (UINT target = 0; target < TargetCount; target++)
+		{
+			aiAnimMesh* animMesh = new aiAnimMesh();
+			animMesh->mNumVertices = vertexCount;
+			animMesh->mVertices = new aiVector3D[vertexCount];
+			animMesh->mNormals = new aiVector3D[vertexCount];
+			std::copy(mesh->mVertices, mesh->mVertices + vertexCount, animMesh->mVertices);
+			std::copy(mesh->mNormals, mesh->mNormals + vertexCount, animMesh->mNormals);
+
+			for (UINT i = 0; i < DeltasPerTarget; i++)
+			{
+				UINT vertexIndex = (i * stride + target) % vertexCount;
+				animMesh->mVertices[vertexIndex].y += 0.1f * (target + 1);
+				animMesh->mNormals[vertexIndex].x += 0.1f;
+			}
+
+			mesh->mAnimMeshes[target] = animMesh;
+		}
+
+		return new Model(*mGame, scene, "MorphTargetBenchmark");
+	}
+}
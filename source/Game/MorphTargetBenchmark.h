@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Benchmark.h"
+
+namespace Library
+{
+	class Model;
+	class MorphTargetBlender;
+}
+
+namespace Rendering
+{
+	// Times MorphTargetBlender::Apply on generated meshes of very different sizes that carry the same sparse targets, with
+	// more and more of those targets active. The time per blend should follow the number of active targets and stay flat
+	// as the mesh grows.
+	class MorphTargetBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(MorphTargetBenchmark, Benchmark)
+
+	public:
+		MorphTargetBenchmark(Game& game);
+		~MorphTargetBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		struct Case
+		{
+			MorphTargetBlender* Blender;	// One per case, so every blend restores the same targets it applies
+			UINT ActiveTargetCount;
+			double Milliseconds;			// Summed over the samples
+			UINT SampleCount;
+
+			Case(MorphTargetBlender* blender, UINT activeTargetCount)
+				: Blender(blender), ActiveTargetCount(activeTargetCount), Milliseconds(0.0), SampleCount(0) { }
+		};
+
+		MorphTargetBenchmark();
+		MorphTargetBenchmark(const MorphTargetBenchmark& rhs);
+		MorphTargetBenchmark& operator=(const MorphTargetBenchmark& rhs);
+
+		Model* CreateModel(UINT vertexCount) const;
+
+		static const UINT VertexCounts[];
+		static const UINT ActiveTargetCounts[];
+		static const UINT TargetCount;
+		static const UINT DeltasPerTarget;
+
+		std::vector<Model*> mModels;
+		std::vector<Case> mCases;
+		UINT mSampleIndex;
+	};
+}
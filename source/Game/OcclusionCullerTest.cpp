@@ -0,0 +1,278 @@
+#include "stdafx.h"
+#include "OcclusionCullerTest.h"
+#include "..\Library\AxisAlignedBox.h"
+#include <random>
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(OcclusionCullerTest)
+
+	const UINT OcclusionCullerTest::BufferWidth = 128;
+	const UINT OcclusionCullerTest::BufferHeight = 64;
+	const UINT OcclusionCullerTest::RandomTriangleCount = 300;
+	const UINT OcclusionCullerTest::RandomBoxCount = 2000;
+	const double OcclusionCullerTest::EdgeTolerance = 0.01;
+	const double OcclusionCullerTest::DepthTolerance = 1e-4;
+
+	OcclusionCullerTest::OcclusionCullerTest(Game& game)
+		: Benchmark(game), mCuller(BufferWidth, BufferHeight), mKnownTriangles(), mRandomTriangles(), mRandomBoxes(), mVisibilityMask(),
+		  mCheckedPixelCount(0), mCheckedBoxCount(0), mOccludedCount(0), mRasterizeMilliseconds(0.0), mCullMilliseconds(0.0), mSampleCount(0)
+	{
+	}
+
+	OcclusionCullerTest::~OcclusionCullerTest()
+	{
+	}
+
+	void OcclusionCullerTest::Initialize()
+	{
+		// A square at half depth split into two triangles, a sloped triangle overlapping its lower right corner, and a
+		// triangle hanging off the top left of the screen
+		XMFLOAT3 knownTriangles[] =
+		{
+			XMFLOAT3(-0.5f, -0.5f, 0.5f), XMFLOAT3(0.5f, -0.5f, 0.5f), XMFLOAT3(0.5f, 0.5f, 0.5f),
+			XMFLOAT3(-0.5f, -0.5f, 0.5f), XMFLOAT3(0.5f, 0.5f, 0.5f), XMFLOAT3(-0.5f, 0.5f, 0.5f),
+			XMFLOAT3(0.2f, -0.9f, 0.1f), XMFLOAT3(0.9f, -0.9f, 0.9f), XMFLOAT3(0.9f, 0.2f, 0.3f),
+			XMFLOAT3(-1.5f, 0.6f, 0.4f), XMFLOAT3(0.2f, 1.4f, 0.4f), XMFLOAT3(-0.8f, 0.95f, 0.6f)
+		};
+
+		mKnownTriangles.assign(knownTriangles, knownTriangles + ARRAYSIZE(knownTriangles));
+
+		Render(mKnownTriangles);
+		ReferenceDepths reference = RasterizeReference(mKnownTriangles);
+		CheckDepthBuffer(reference, L"Known triangles");
+
+		Check(mCuller.IsOccluded(AxisAlignedBox(XMFLOAT3(-0.3f, -0.3f, 0.7f), XMFLOAT3(0.3f, 0.3f, 0.8f))), L"A box behind the square is not occluded");
+		Check(mCuller.IsOccluded(AxisAlignedBox(XMFLOAT3(-0.3f, -0.3f, 0.2f), XMFLOAT3(0.3f, 0.3f, 0.3f))) == false, L"A box in front of the square is occluded");
+		Check(mCuller.IsOccluded(AxisAlignedBox(XMFLOAT3(0.3f, -0.2f, 0.7f), XMFLOAT3(0.8f, 0.2f, 0.8f))) == false, L"A box reaching past the square's edge is occluded");
+		Check(mCuller.IsOccluded(AxisAlignedBox(XMFLOAT3(-0.3f, -0.3f, -0.1f), XMFLOAT3(0.3f, 0.3f, 0.8f))) == false, L"A box crossing the near plane is occluded");
+		Check(mCuller.IsOccluded(AxisAlignedBox(XMFLOAT3(1.2f, -0.2f, 0.7f), XMFLOAT3(1.4f, 0.2f, 0.8f))) == false, L"A box off screen is occluded");
+
+		// Seeded, so every run checks the same scene
+		std::default_random_engine generator(12345);
+		std::uniform_real_distribution<float> position(-1.2f, 1.2f);
+		std::uniform_real_distribution<float> offset(-0.25f, 0.25f);
+		std::uniform_real_distribution<float> depth(0.1f, 0.9f);
+
+		while (mRandomTriangles.size() < RandomTriangleCount * 3)
+		{
+			float centerX = position(generator);
+			float centerY = position(generator);
+			XMFLOAT3 vertices[3];
+			for (UINT i = 0; i < 3; i++)
+			{
+				vertices[i] = XMFLOAT3(centerX + offset(generator), centerY + offset(generator), depth(generator));
+			}
+
+			// Slivers are left out; the culler drops triangles of almost no area, which the reference would still draw
+			float pixelArea = ((vertices[1].x - vertices[0].x) * (vertices[2].y - vertices[0].y) - (vertices[1].y - vertices[0].y) * (vertices[2].x - vertices[0].x))
+				* BufferWidth * BufferHeight * 0.25f;
+			if (std::fabs(pixelArea) >= 2.0f)
+			{
+				mRandomTriangles.insert(mRandomTriangles.end(), vertices, vertices + 3);
+			}
+		}
+
+		std::uniform_real_distribution<float> boxCenter(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> boxExtent(0.01f, 0.15f);
+		std::uniform_real_distribution<float> boxNear(0.05f, 0.9f);
+		std::uniform_real_distribution<float> boxDepth(0.02f, 0.1f);
+
+		mRandomBoxes.Reserve(RandomBoxCount);
+		for (UINT i = 0; i < RandomBoxCount; i++)
+		{
+			float centerX = boxCenter(generator);
+			float centerY = boxCenter(generator);
+			float extentX = boxExtent(generator);
+			float extentY = boxExtent(generator);
+			float nearDepth = boxNear(generator);
+			mRandomBoxes.Add(XMFLOAT3(centerX - extentX, centerY - extentY, nearDepth), XMFLOAT3(centerX + extentX, centerY + extentY, nearDepth + boxDepth(generator)));
+		}
+
+		Render(mRandomTriangles);
+		reference = RasterizeReference(mRandomTriangles);
+		CheckDepthBuffer(reference, L"Random triangles");
+
+		mVisibilityMask.clear();
+		mCuller.Cull(mRandomBoxes, mVisibilityMask);
+		CheckOccludedBoxes(reference, mRandomBoxes, mVisibilityMask);
+	}
+
+	void OcclusionCullerTest::Update(const GameTime& gameTime)
+	{
+		mCuller.ResetStatistics();
+
+		Render(mRandomTriangles);
+		mVisibilityMask.clear();
+		mOccludedCount = mCuller.Cull(mRandomBoxes, mVisibilityMask);
+
+		const OcclusionCuller::Statistics& statistics = mCuller.GetStatistics();
+		mRasterizeMilliseconds += statistics.RasterizeMilliseconds;
+		mCullMilliseconds += statistics.TestMilliseconds;
+		mSampleCount++;
+	}
+
+	void OcclusionCullerTest::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+
+		results << L"Occlusion culler (" << mCuller.Width() << L"x" << mCuller.Height() << L" buffer, " << RandomTriangleCount << L" triangles, "
+			<< RandomBoxCount << L" boxes, " << mOccludedCount << L" occluded)" << std::endl;
+		results << L"  Checked " << mCheckedPixelCount << L" pixels and " << mCheckedBoxCount << L" occluded boxes against the reference" << std::endl;
+		results << L"  Rasterize: " << mRasterizeMilliseconds / sampleCount << L" ms per frame" << std::endl;
+		results << L"  Cull: " << mCullMilliseconds / sampleCount << L" ms per frame" << std::endl;
+	}
+
+	void OcclusionCullerTest::Render(const std::vector<XMFLOAT3>& vertices)
+	{
+		std::vector<UINT> indices(vertices.size());
+		for (UINT i = 0; i < indices.size(); i++)
+		{
+			indices[i] = i;
+		}
+
+		mCuller.BeginFrame(XMMatrixIdentity());
+		mCuller.AddOccluder(&vertices[0], vertices.size(), &indices[0], indices.size(), XMMatrixIdentity());
+		mCuller.Rasterize();
+		mCuller.Validate();
+	}
+
+	OcclusionCullerTest::ReferenceDepths OcclusionCullerTest::RasterizeReference(const std::vector<XMFLOAT3>& vertices) const
+	{
+		UINT width = mCuller.Width();
+		UINT height = mCuller.Height();
+
+		ReferenceDepths reference;
+		reference.Certain.assign(width * height, 1.0);
+		reference.Possible.assign(width * height, 1.0);
+
+		for (UINT triangle = 0; triangle < vertices.size() / 3; triangle++)
+		{
+			const XMFLOAT3* corners = &vertices[triangle * 3];
+			double area = (static_cast<double>(corners[1].x) - corners[0].x) * (static_cast<double>(corners[2].y) - corners[0].y)
+				- (static_cast<double>(corners[1].y) - corners[0].y) * (static_cast<double>(corners[2].x) - corners[0].x);
+
+			for (UINT y = 0; y < height; y++)
+			{
+				double centerY = 1.0 - (y + 0.5) / height * 2.0;
+				for (UINT x = 0; x < width; x++)
+				{
+					double centerX = (x + 0.5) / width * 2.0 - 1.0;
+
+					// Weight i belongs to corner i and is measured against the opposite edge, in pixels to judge closeness
+					double weights[3];
+					bool isOutside = false;
+					bool isUndecided = false;
+					for (UINT i = 0; i < 3; i++)
+					{
+						const XMFLOAT3& from = corners[(i + 1) % 3];
+						const XMFLOAT3& to = corners[(i + 2) % 3];
+						double edgeX = (static_cast<double>(to.x) - from.x) * width * 0.5;
+						double edgeY = (static_cast<double>(to.y) - from.y) * height * 0.5;
+						double cross = (static_cast<double>(to.x) - from.x) * (centerY - from.y) - (static_cast<double>(to.y) - from.y) * (centerX - from.x);
+
+						weights[i] = cross / area;
+
+						double pixelDistance = weights[i] * std::fabs(area) * width * height * 0.25 / std::sqrt(edgeX * edgeX + edgeY * edgeY);
+						if (pixelDistance < -EdgeTolerance)
+						{
+							isOutside = true;
+						}
+						else if (pixelDistance <= EdgeTolerance)
+						{
+							isUndecided = true;
+						}
+					}
+
+					if (isOutside)
+					{
+						continue;
+					}
+
+					double depth = weights[0] * corners[0].z + weights[1] * corners[1].z + weights[2] * corners[2].z;
+					double& possible = reference.Possible[y * width + x];
+					possible = (std::min)(possible, depth);
+
+					if (isUndecided == false)
+					{
+						double& certain = reference.Certain[y * width + x];
+						certain = (std::min)(certain, depth);
+					}
+				}
+			}
+		}
+
+		return reference;
+	}
+
+	void OcclusionCullerTest::CheckDepthBuffer(const ReferenceDepths& reference, const std::wstring& scene)
+	{
+		const std::vector<float>& depths = mCuller.DepthBuffer();
+		UINT mismatchCount = 0;
+
+		for (UINT i = 0; i < depths.size(); i++)
+		{
+			if (reference.Certain[i] != reference.Possible[i])
+			{
+				continue;
+			}
+
+			mCheckedPixelCount++;
+			if (std::fabs(depths[i] - reference.Certain[i]) > DepthTolerance)
+			{
+				mismatchCount++;
+			}
+		}
+
+		std::wostringstream description;
+		description << scene << L": " << mismatchCount << L" pixels differ from the reference depth";
+		Check(mismatchCount == 0, description.str());
+	}
+
+	void OcclusionCullerTest::CheckOccludedBoxes(const ReferenceDepths& reference, const FrustumCuller::BoxArray& boxes, const std::vector<UINT>& visibilityMask)
+	{
+		UINT width = mCuller.Width();
+		UINT height = mCuller.Height();
+		UINT wrongCount = 0;
+
+		for (UINT i = 0; i < boxes.Count(); i++)
+		{
+			if ((visibilityMask[i / 32] & (1U << (i % 32))) != 0)
+			{
+				continue;
+			}
+
+			// An occluded box may show through at no pixel center it covers, even counting undecided edge pixels
+			mCheckedBoxCount++;
+			bool isVisible = false;
+			for (UINT y = 0; y < height && isVisible == false; y++)
+			{
+				double centerY = 1.0 - (y + 0.5) / height * 2.0;
+				if (centerY < boxes.MinimumY[i] || centerY > boxes.MaximumY[i])
+				{
+					continue;
+				}
+
+				for (UINT x = 0; x < width; x++)
+				{
+					double centerX = (x + 0.5) / width * 2.0 - 1.0;
+					if (centerX >= boxes.MinimumX[i] && centerX <= boxes.MaximumX[i] && reference.Possible[y * width + x] >= boxes.MinimumZ[i])
+					{
+						isVisible = true;
+						break;
+					}
+				}
+			}
+
+			if (isVisible)
+			{
+				wrongCount++;
+			}
+		}
+
+		std::wostringstream description;
+		description << wrongCount << L" boxes reported occluded are visible in the reference";
+		Check(wrongCount == 0, description.str());
+	}
+}
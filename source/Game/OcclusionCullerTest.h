@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\OcclusionCuller.h"
+#include "..\Library\FrustumCuller.h"
+
+namespace Rendering
+{
+	// Checks OcclusionCuller against a reference written independently of it: pixel coverage and depth come from
+	// barycentric weights of the normalized device coordinates, in double precision, rather than from the culler's edge
+	// functions. With an identity view-projection the test's coordinates are already normalized device coordinates.
+	// Initialize compares the depth buffer for a handful of known triangles and a seeded random set, then checks known
+	// boxes and every box the culler reports occluded against that reference. Each Update then times rasterizing and
+	// culling the random scene.
+	class OcclusionCullerTest : public Benchmark
+	{
+		RTTI_DECLARATIONS(OcclusionCullerTest, Benchmark)
+
+	public:
+		OcclusionCullerTest(Game& game);
+		~OcclusionCullerTest();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		OcclusionCullerTest();
+		OcclusionCullerTest(const OcclusionCullerTest& rhs);
+		OcclusionCullerTest& operator=(const OcclusionCullerTest& rhs);
+
+		// Per pixel, the nearest depth of triangles certainly covering its center and of triangles that might, where the
+		// center lies too close to an edge to call. The two differ only for pixels the test cannot decide.
+		struct ReferenceDepths
+		{
+			std::vector<double> Certain;
+			std::vector<double> Possible;
+		};
+
+		static const UINT BufferWidth;
+		static const UINT BufferHeight;
+		static const UINT RandomTriangleCount;
+		static const UINT RandomBoxCount;
+		static const double EdgeTolerance;		// Centers closer than this many pixels to a triangle edge are left undecided
+		static const double DepthTolerance;
+
+		void Render(const std::vector<XMFLOAT3>& vertices);
+		ReferenceDepths RasterizeReference(const std::vector<XMFLOAT3>& vertices) const;
+		void CheckDepthBuffer(const ReferenceDepths& reference, const std::wstring& scene);
+		void CheckOccludedBoxes(const ReferenceDepths& reference, const FrustumCuller::BoxArray& boxes, const std::vector<UINT>& visibilityMask);
+
+		OcclusionCuller mCuller;
+		std::vector<XMFLOAT3> mKnownTriangles;
+		std::vector<XMFLOAT3> mRandomTriangles;
+		FrustumCuller::BoxArray mRandomBoxes;
+		std::vector<UINT> mVisibilityMask;
+		UINT mCheckedPixelCount;
+		UINT mCheckedBoxCount;
+		UINT mOccludedCount;
+		double mRasterizeMilliseconds;			// Summed over the samples
+		double mCullMilliseconds;
+		UINT mSampleCount;
+	};
+}
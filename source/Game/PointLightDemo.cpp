@@ -8,16 +8,17 @@
 #include "..\Library\ColorHelper.h"
 #include "..\Library\Camera.h"
 #include "..\Library\Model.h"
+#include "..\Library\ModelCache.h"
+#include "..\Library\AssetLoader.h"
 #include "..\Library\Mesh.h"
 #include "..\Library\Utility.h"
 #include "..\Library\PointLight.h"
 #include "..\Library\Keyboard.h"
-#include <DDSTextureLoader.h>
 #include "..\Library\ProxyModel.h"
 #include "..\Library\RenderStateHelper.h"
+#include "..\Library\TextBuilder.h"
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
-#include <sstream>
 
 namespace Rendering
 {
@@ -32,9 +33,14 @@ namespace Rendering
 		: DrawableGameComponent(game, camera), mEffect(nullptr), mMaterial(nullptr), mTextureShaderResourceView(nullptr),
 		mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0),
 		mKeyboard(nullptr), mAmbientColor(1, 1, 1, 0), mPointLight(nullptr),
-		mSpecularColor(1.0f, 1.0f, 1.0f, 1.0f), mSpecularPower(25.0f), mWorldMatrix(MatrixHelper::Identity), mProxyModel(nullptr),
+		mSpecularColor(1.0f, 1.0f, 1.0f, 1.0f), mSpecularPower(25.0f), mWorldMatrix(MatrixHelper::Identity), mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mCameraVersion(0), mProxyModel(nullptr),
 		mRenderStateHelper(nullptr), mSpriteBatch(nullptr), mSpriteFont(nullptr), mTextPosition(0.0f, 40.0f)
 	{
+		// The proxy model is declared here because the proxy is created during Initialize
+		DeclareModel("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
+		DeclareModel("..\\source\\Library\\Content\\Models\\PointLightProxy.obj", true);
+		DeclareEffect(L"Content\\Effects\\PointLight.cso");
+		DeclareTexture(L"..\\source\\Library\\Content\\Textures\\Earthatday.dds");
 	}
 
 	PointLightDemo::~PointLightDemo()
@@ -55,7 +61,7 @@ namespace Rendering
 	{
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-		std::unique_ptr<Model> model(new Model(*mGame, "..\\source\\Library\\Content\\Models\\Sphere.obj", true));
+		std::shared_ptr<Model> model = mGame->Models().Load("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
 
 		// Initialize the material
 		mEffect = new Effect(*mGame);
@@ -70,11 +76,7 @@ namespace Rendering
 		mIndexCount = mesh->Indices().size();
 
 		std::wstring textureName = L"..\\source\\Library\\Content\\Textures\\Earthatday.dds";
-		HRESULT hr = DirectX::CreateDDSTextureFromFile(mGame->Direct3DDevice(), textureName.c_str(), nullptr, &mTextureShaderResourceView);
-		if (FAILED(hr))
-		{
-			throw GameException("CreateDDSTextureFromFile() failed.", hr);
-		}
+		mTextureShaderResourceView = mGame->Assets().AcquireTexture(textureName);
 
 		mPointLight = new PointLight(*mGame);
 		mPointLight->SetRadius(500.0f);
@@ -101,6 +103,11 @@ namespace Rendering
 		mProxyModel->Update(gameTime);
 	}
 
+	void PointLightDemo::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		mProxyModel->CaptureRenderState(snapshot);
+	}
+
 	void PointLightDemo::Draw(const GameTime& gameTime)
 	{
 		ID3D11DeviceContext* direct3DDeviceContext = mGame->Direct3DDeviceContext();
@@ -115,8 +122,15 @@ namespace Rendering
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
 		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
+		if (mIsWorldDirty || mCameraVersion != mCamera->ViewProjectionVersion())
+		{
+			mIsWorldDirty = false;
+			mCameraVersion = mCamera->ViewProjectionVersion();
+			XMStoreFloat4x4(&mWorldViewProjectionMatrix, XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix());
+		}
+
 		XMMATRIX worldMatrix = XMLoadFloat4x4(&mWorldMatrix);
-		XMMATRIX wvp = worldMatrix * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+		XMMATRIX wvp = XMLoadFloat4x4(&mWorldViewProjectionMatrix);
 		XMVECTOR ambientColor = XMLoadColor(&mAmbientColor);
 		XMVECTOR specularColor = XMLoadColor(&mSpecularColor);
 
@@ -140,13 +154,13 @@ namespace Rendering
 		mRenderStateHelper->SaveAll();
 		mSpriteBatch->Begin();
 
-		std::wostringstream helpLabel;
+		TextBuilder helpLabel(mGame->FrameArena());
 		helpLabel << L"Ambient Intensity (+PgUp/-PgDn): " << mAmbientColor.a << "\n";
 		helpLabel << L"Point Light Intensity (+Home/-End): " << mPointLight->Color().a << "\n";
 		helpLabel << L"Specular Power (+Insert/-Delete): " << mSpecularPower << "\n";
 		helpLabel << L"Move Point Light (8/2, 4/6, 3/9)\n";
 
-		mSpriteFont->DrawString(mSpriteBatch, helpLabel.str().c_str(), mTextPosition);
+		mSpriteFont->DrawString(mSpriteBatch, helpLabel.Text(), mTextPosition);
 
 		mSpriteBatch->End();
 		mRenderStateHelper->RestoreAll();
@@ -33,6 +33,7 @@ namespace Rendering
 
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void Draw(const GameTime& gameTime) override;
 
 		const XMCOLOR& GetAmbientColor() const;
@@ -64,6 +65,9 @@ namespace Rendering
 		XMCOLOR mSpecularColor;
 		float mSpecularPower;
 		XMFLOAT4X4 mWorldMatrix;
+		XMFLOAT4X4 mWorldViewProjectionMatrix;
+		bool mIsWorldDirty;
+		UINT mCameraVersion;
 
 		ProxyModel* mProxyModel;
 
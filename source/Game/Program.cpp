@@ -6,6 +6,9 @@
 #include "BloomGame.h"
 #include "DistortionMappingGame.h"
 #include "DistortionMappingPostGame.h"
+#include "BenchmarkGame.h"
+#include "..\Library\Utility.h"
+#include <fstream>
 
 
 #if defined(DEBUG) || defined(_DEBUG)
@@ -17,12 +20,46 @@
 using namespace Library;
 using namespace Rendering;
 
+// Runs headless and writes the results to Benchmarks.txt beside the executable. Returns nonzero if the run threw or any
+// benchmark's checks failed.
+int RunBenchmarks(HINSTANCE instance, int showCommand)
+{
+	std::unique_ptr<BenchmarkGame> game(new BenchmarkGame(instance, L"BenchmarkClass", L"Benchmarks", showCommand));
+
+	try
+	{
+		double seconds = game->RunHeadless(BenchmarkGame::DefaultFrameCount);
+
+		std::wofstream file((Utility::ExecutableDirectory() + L"\\Benchmarks.txt").c_str());
+		file << game->Results() << BenchmarkGame::DefaultFrameCount << L" frames in " << seconds << L" s" << std::endl;
+		OutputDebugString(game->Results().c_str());
+
+		if (game->FailureCount() > 0)
+		{
+			file << game->FailureCount() << L" checks failed" << std::endl;
+			return 1;
+		}
+	}
+	catch (GameException ex)
+	{
+		MessageBox(nullptr, ex.whatw().c_str(), L"Benchmarks", MB_OK);
+		return 1;
+	}
+
+	return 0;
+}
+
 int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR commandLine, int showCommand)
 {
 #if defined(DEBUG) | defined(_DEBUG)
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 #endif
 
+	if (strstr(commandLine, "-benchmark") != nullptr)
+	{
+		return RunBenchmarks(instance, showCommand);
+	}
+
 	std::unique_ptr<RenderingGame>game(new RenderingGame(instance, L"RenderingClass", L"Real-Time 3D Rendering", showCommand));
 	//std::unique_ptr<GaussianBlurGame>game(new GaussianBlurGame(instance, L"RenderingClass", L"Real-Time 3D Rendering", showCommand));
 	//std::unique_ptr<DistortionMappingGame>game(new DistortionMappingGame(instance, L"RenderingClass", L"Real-Time 3D Rendering", showCommand));
@@ -0,0 +1,306 @@
+#include "stdafx.h"
+#include "RenderPipelineTest.h"
+#include "..\Library\ClockSource.h"
+#include "..\Library\GameTime.h"
+#include <thread>
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(RenderPipelineTest)
+
+	const UINT RenderPipelineTest::TransformCount = 64;
+	const UINT RenderPipelineTest::LightCount = 16;
+	const UINT RenderPipelineTest::BoneCount = 48;
+	const UINT RenderPipelineTest::CapturePassCount = 3;
+	const UINT RenderPipelineTest::InitialFrameCount = 2000;
+	const UINT RenderPipelineTest::SampleFrameCount = 200;
+	const float RenderPipelineTest::InterpolationTolerance = 1e-4f;
+
+	RenderPipelineTest::RenderPipelineTest(Game& game)
+		: Benchmark(game), mPipeline([this](const RenderSnapshot& snapshot) { Render(snapshot); }),
+		  mFirstTransform(0), mFirstLight(0), mFirstBone(0), mBoneTransforms(BoneCount),
+		  mNextRenderedFrame(0), mRenderedFrameCount(0), mTornFrameCount(0), mOutOfOrderFrameCount(0),
+		  mReportedTornFrameCount(0), mReportedOutOfOrderFrameCount(0),
+		  mSubmittedFrameCount(0), mFrameMilliseconds(0.0), mSampleCount(0)
+	{
+	}
+
+	RenderPipelineTest::~RenderPipelineTest()
+	{
+	}
+
+	void RenderPipelineTest::Initialize()
+	{
+		mFirstTransform = mPipeline.AllocateTransforms(TransformCount);
+		mFirstLight = mPipeline.AllocateLights(LightCount);
+		mFirstBone = mPipeline.AllocateBonePalette(BoneCount);
+
+		mPipeline.SetPipelined(true);
+		RunFrames(InitialFrameCount);
+		CheckRenderedFrames(L"Pipelined");
+
+		// Switching modes hands the render stage back to the calling thread, and back again, without losing a frame
+		mPipeline.SetPipelined(false);
+		RunFrames(InitialFrameCount / 10);
+		CheckRenderedFrames(L"Serial");
+
+		mPipeline.SetPipelined(true);
+		RunFrames(InitialFrameCount / 10);
+		CheckRenderedFrames(L"Pipelined again");
+
+		CheckInterpolation();
+	}
+
+	void RenderPipelineTest::Update(const GameTime& gameTime)
+	{
+		double startTime = RealClockSource::Milliseconds();
+		RunFrames(SampleFrameCount);
+		mPipeline.Flush();
+		mFrameMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		CheckRenderedFrames(L"Sampled");
+		mSampleCount++;
+	}
+
+	void RenderPipelineTest::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+
+		results << L"Render pipeline (" << TransformCount << L" transforms, " << LightCount << L" lights, " << BoneCount << L" bones)" << std::endl;
+		results << L"  Raced " << mSubmittedFrameCount << L" frames: " << mTornFrameCount << L" torn, " << mOutOfOrderFrameCount << L" out of order" << std::endl;
+		results << L"  " << mFrameMilliseconds / (sampleCount * SampleFrameCount) << L" ms per frame pipelined" << std::endl;
+	}
+
+	float RenderPipelineTest::SlotValue(UINT frameNumber, UINT slot)
+	{
+		// Exact in a float for far more frames than the test runs
+		return static_cast<float>((frameNumber % 65536) * 256 + slot);
+	}
+
+	void RenderPipelineTest::RunFrames(UINT frameCount)
+	{
+		GameTime gameTime;
+
+		for (UINT i = 0; i < frameCount; i++)
+		{
+			gameTime.SetTotalGameTime(mSubmittedFrameCount);
+
+			RenderSnapshot& snapshot = mPipeline.BeginCapture(gameTime);
+			Capture(snapshot, snapshot.FrameNumber());
+			mPipeline.Submit();
+
+			mSubmittedFrameCount++;
+		}
+	}
+
+	void RenderPipelineTest::Capture(RenderSnapshot& snapshot, UINT frameNumber)
+	{
+		// Rewriting every slot keeps capture writing for as long as possible while the render stage reads
+		for (UINT pass = 0; pass < CapturePassCount; pass++)
+		{
+			RenderSnapshot::ViewState view;
+			view.ViewMatrix._41 = SlotValue(frameNumber, 0);
+			view.Position.x = SlotValue(frameNumber, 0);
+			snapshot.SetView(view);
+
+			for (UINT i = 0; i < TransformCount; i++)
+			{
+				float value = SlotValue(frameNumber, i);
+				snapshot.SetTransform(mFirstTransform + i, XMFLOAT4X4(value, value, value, value, value, value, value, value, value, value, value, value, value, value, value, value));
+			}
+
+			for (UINT i = 0; i < LightCount; i++)
+			{
+				RenderSnapshot::LightState light;
+				light.Position = XMFLOAT3(SlotValue(frameNumber, i), 0.0f, 0.0f);
+				light.Radius = SlotValue(frameNumber, i);
+				snapshot.SetLight(mFirstLight + i, light);
+			}
+
+			for (UINT i = 0; i < BoneCount; i++)
+			{
+				float value = SlotValue(frameNumber, i);
+				mBoneTransforms[i] = XMFLOAT4X4(value, 0.0f, 0.0f, 0.0f, 0.0f, value, 0.0f, 0.0f, 0.0f, 0.0f, value, 0.0f, 0.0f, 0.0f, 0.0f, value);
+			}
+
+			snapshot.SetBonePalette(mFirstBone, mBoneTransforms);
+		}
+	}
+
+	void RenderPipelineTest::Render(const RenderSnapshot& snapshot)
+	{
+		// Read the frame number once; a snapshot captured over while this reads it changes underneath that number
+		UINT frameNumber = snapshot.FrameNumber();
+		if (frameNumber != mNextRenderedFrame)
+		{
+			mOutOfOrderFrameCount++;
+		}
+
+		bool isIntact = IsIntact(snapshot, frameNumber);
+		std::this_thread::yield();
+		isIntact = (IsIntact(snapshot, frameNumber) && isIntact);
+
+		if (isIntact == false)
+		{
+			mTornFrameCount++;
+		}
+
+		mNextRenderedFrame = frameNumber + 1;
+		mRenderedFrameCount++;
+	}
+
+	bool RenderPipelineTest::IsIntact(const RenderSnapshot& snapshot, UINT frameNumber) const
+	{
+		// A snapshot not yet captured into has no slots at all
+		if (snapshot.TransformCount() < mFirstTransform + TransformCount || snapshot.LightCount() < mFirstLight + LightCount || snapshot.BoneTransformCount() < mFirstBone + BoneCount)
+		{
+			return false;
+		}
+
+		if (snapshot.Time().TotalGameTime() != frameNumber || snapshot.View().ViewMatrix._41 != SlotValue(frameNumber, 0) || snapshot.View().Position.x != SlotValue(frameNumber, 0))
+		{
+			return false;
+		}
+
+		for (UINT i = 0; i < TransformCount; i++)
+		{
+			const float* values = reinterpret_cast<const float*>(&snapshot.Transform(mFirstTransform + i));
+			for (UINT j = 0; j < 16; j++)
+			{
+				if (values[j] != SlotValue(frameNumber, i))
+				{
+					return false;
+				}
+			}
+		}
+
+		for (UINT i = 0; i < LightCount; i++)
+		{
+			const RenderSnapshot::LightState& light = snapshot.Light(mFirstLight + i);
+			if (light.Position.x != SlotValue(frameNumber, i) || light.Radius != SlotValue(frameNumber, i))
+			{
+				return false;
+			}
+		}
+
+		const XMFLOAT4X4* palette = snapshot.BonePalette(mFirstBone);
+		for (UINT i = 0; i < BoneCount; i++)
+		{
+			if (palette[i]._11 != SlotValue(frameNumber, i) || palette[i]._44 != SlotValue(frameNumber, i))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void RenderPipelineTest::CheckRenderedFrames(const std::wstring& description)
+	{
+		// The render stage's counters are only read once it is idle
+		mPipeline.Flush();
+
+		// Only frames rendered since the last check count, so a race is reported once
+		UINT tornFrameCount = mTornFrameCount - mReportedTornFrameCount;
+		UINT outOfOrderFrameCount = mOutOfOrderFrameCount - mReportedOutOfOrderFrameCount;
+		mReportedTornFrameCount = mTornFrameCount;
+		mReportedOutOfOrderFrameCount = mOutOfOrderFrameCount;
+
+		std::wostringstream counts;
+		counts << L": " << tornFrameCount << L" torn and " << outOfOrderFrameCount << L" out of order";
+		Check(tornFrameCount == 0 && outOfOrderFrameCount == 0, description + counts.str());
+		Check(mRenderedFrameCount == mSubmittedFrameCount, description + L": frames were submitted but not rendered");
+	}
+
+	void RenderPipelineTest::CheckInterpolation()
+	{
+		// Serial, so each snapshot is drawn on this thread before Submit returns
+		XMFLOAT4X4 drawnTransform;
+		XMFLOAT4X4 drawnProjection;
+		XMFLOAT4X4 drawnBone;
+		RenderSnapshot::LightState drawnLight;
+		RenderSnapshot::ViewState drawnView;
+		RenderPipeline pipeline([&](const RenderSnapshot& snapshot)
+		{
+			drawnTransform = snapshot.Transform(0);
+			drawnProjection = snapshot.Transform(1);
+			drawnBone = *snapshot.BonePalette(0);
+			drawnLight = snapshot.Light(0);
+			drawnView = snapshot.View();
+		});
+
+		pipeline.AllocateTransforms(2);
+		pipeline.AllocateBonePalette(1);
+		pipeline.AllocateLights();
+
+		// A quarter turn and four units apart, so a quarter of the way is an eighth of a turn and one unit
+		XMMATRIX previousTransform = XMMatrixIdentity();
+		XMMATRIX transform = XMMatrixRotationY(XM_PIDIV2) * XMMatrixTranslation(4.0f, 0.0f, 0.0f);
+		XMMATRIX expectedTransform = XMMatrixRotationY(XM_PIDIV2 * 0.25f) * XMMatrixTranslation(1.0f, 0.0f, 0.0f);
+
+		// A world-view-projection, as Grid and ProxyModel capture, blends before its projection
+		XMMATRIX projection = XMMatrixPerspectiveFovRH(XM_PIDIV4, 16.0f / 9.0f, 0.5f, 100.0f);
+		XMMATRIX previousProjected = XMMatrixTranslation(0.0f, 0.0f, -10.0f) * projection;
+		XMMATRIX projected = XMMatrixTranslation(4.0f, 0.0f, -10.0f) * projection;
+		XMMATRIX expectedProjected = XMMatrixTranslation(1.0f, 0.0f, -10.0f) * projection;
+
+		GameTime gameTime;
+		const float alphas[] = { 0.25f, 1.0f };
+		for (UINT i = 0; i < ARRAYSIZE(alphas); i++)
+		{
+			RenderSnapshot::ViewState view;
+			RenderSnapshot::LightState light;
+			std::vector<XMFLOAT4X4> bones(1);
+
+			RenderSnapshot& previous = pipeline.BeginCapture(gameTime);
+			previous.SetTransform(0, previousTransform);
+			previous.SetTransform(1, previousProjected);
+			XMStoreFloat4x4(&bones[0], previousTransform);
+			previous.SetBonePalette(0, bones);
+			previous.SetLight(0, light);
+			previous.SetView(view);
+			pipeline.KeepAsPreviousStep();
+
+			gameTime.SetInterpolationAlpha(alphas[i]);
+			RenderSnapshot& snapshot = pipeline.BeginCapture(gameTime);
+			snapshot.SetTransform(0, transform);
+			snapshot.SetTransform(1, projected);
+			XMStoreFloat4x4(&bones[0], transform);
+			snapshot.SetBonePalette(0, bones);
+			light.Position = XMFLOAT3(4.0f, 0.0f, 0.0f);
+			light.Radius = 4.0f;
+			snapshot.SetLight(0, light);
+			view.Position = XMFLOAT3(4.0f, 0.0f, 0.0f);
+			XMStoreFloat4x4(&view.ViewMatrix, transform);
+			snapshot.SetView(view);
+			pipeline.Submit();
+
+			XMFLOAT4X4 expected;
+			XMStoreFloat4x4(&expected, (alphas[i] < 1.0f ? expectedTransform : transform));
+			XMFLOAT4X4 expectedProjection;
+			XMStoreFloat4x4(&expectedProjection, (alphas[i] < 1.0f ? expectedProjected : projected));
+			float expectedOffset = 4.0f * alphas[i];
+
+			std::wostringstream description;
+			description << L"Interpolation at alpha " << alphas[i];
+
+			const XMFLOAT4X4* drawnMatrices[] = { &drawnTransform, &drawnBone, &drawnView.ViewMatrix, &drawnProjection };
+			const XMFLOAT4X4* expectedMatrices[] = { &expected, &expected, &expected, &expectedProjection };
+			for (UINT j = 0; j < ARRAYSIZE(drawnMatrices); j++)
+			{
+				bool isExpected = true;
+				for (UINT k = 0; k < 16; k++)
+				{
+					isExpected = (isExpected && std::fabs(reinterpret_cast<const float*>(drawnMatrices[j])[k] - reinterpret_cast<const float*>(expectedMatrices[j])[k]) <= InterpolationTolerance);
+				}
+
+				Check(isExpected, description.str() + L": a transform, bone, view or projected transform was not blended by the alpha");
+			}
+
+			Check(std::fabs(drawnLight.Position.x - expectedOffset) <= InterpolationTolerance && std::fabs(drawnLight.Radius - expectedOffset) <= InterpolationTolerance,
+				description.str() + L": a light was not blended by the alpha");
+			Check(std::fabs(drawnView.Position.x - expectedOffset) <= InterpolationTolerance, description.str() + L": the view position was not blended by the alpha");
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\RenderPipeline.h"
+
+namespace Rendering
+{
+	// Races the simulation thread against a pipelined RenderPipeline's render thread. Every frame the simulation writes
+	// values derived from the frame number into every slot of the snapshot it captures, several times over, and submits
+	// it straight away. The render stage reads each snapshot it is given twice, with a yield between, and counts frames
+	// that arrive out of order or whose slots hold another frame's values or change while it reads. Such a frame is what
+	// capture writing a snapshot the render stage is reading looks like. The render stage's counters are its own, so the
+	// test reads them only after Flush. Initialize also checks, on a serial pipeline of its own, that a snapshot submitted
+	// after KeepAsPreviousStep is drawn blended by its interpolation alpha. Each Update races another batch of frames and
+	// times the submits.
+	class RenderPipelineTest : public Benchmark
+	{
+		RTTI_DECLARATIONS(RenderPipelineTest, Benchmark)
+
+	public:
+		RenderPipelineTest(Game& game);
+		~RenderPipelineTest();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		RenderPipelineTest();
+		RenderPipelineTest(const RenderPipelineTest& rhs);
+		RenderPipelineTest& operator=(const RenderPipelineTest& rhs);
+
+		static const UINT TransformCount;
+		static const UINT LightCount;
+		static const UINT BoneCount;
+		static const UINT CapturePassCount;		// Times each frame's capture rewrites every slot
+		static const UINT InitialFrameCount;
+		static const UINT SampleFrameCount;
+		static const float InterpolationTolerance;
+
+		static float SlotValue(UINT frameNumber, UINT slot);
+
+		void RunFrames(UINT frameCount);
+		void Capture(RenderSnapshot& snapshot, UINT frameNumber);
+		void Render(const RenderSnapshot& snapshot);
+		bool IsIntact(const RenderSnapshot& snapshot, UINT frameNumber) const;
+		void CheckRenderedFrames(const std::wstring& description);
+		void CheckInterpolation();
+
+		RenderPipeline mPipeline;
+		UINT mFirstTransform;
+		UINT mFirstLight;
+		UINT mFirstBone;
+		std::vector<XMFLOAT4X4> mBoneTransforms;
+
+		// Written only by the render stage
+		UINT mNextRenderedFrame;
+		UINT mRenderedFrameCount;
+		UINT mTornFrameCount;
+		UINT mOutOfOrderFrameCount;
+
+		UINT mReportedTornFrameCount;
+		UINT mReportedOutOfOrderFrameCount;
+		UINT mSubmittedFrameCount;
+		double mFrameMilliseconds;				// Summed over the samples
+		UINT mSampleCount;
+	};
+}
@@ -4,6 +4,7 @@
 #include "..\Library\Keyboard.h"
 #include "..\Library\Mouse.h"
 #include "..\Library\FpsComponent.h"
+#include "..\Library\UpdateCostOverlay.h"
 #include "..\Library\ColorHelper.h"
 #include "..\Library\FirstPersonCamera.h"
 #include "..\Library\RenderStateHelper.h"
@@ -11,21 +12,27 @@
 #include "..\Library\SamplerStates.h"
 #include "..\Library\Skybox.h"
 #include "..\Library\Grid.h"
+#include "..\Library\ModelCache.h"
+#include "..\Library\Utility.h"
 
 #include "AnimationDemo.h"
 
 namespace Rendering
 {
 	const XMVECTORF32 RenderingGame::BackgroundColor = ColorHelper::CornflowerBlue;
+	const double RenderingGame::AnimationDemoUpdateBudget = 2.0;
 
 	RenderingGame::RenderingGame(HINSTANCE instance, const std::wstring& windowClass, const std::wstring& windowTitle, int showCommand)
 		: Game(instance, windowClass, windowTitle, showCommand),
-		mFpsComponent(nullptr), mGrid(nullptr),
+		mFpsComponent(nullptr), mUpdateCostOverlay(nullptr), mGrid(nullptr),
 		mDirectInput(nullptr), mKeyboard(nullptr), mMouse(nullptr), mRenderStateHelper(nullptr), mSkybox(nullptr),
 		mAnimationDemo(nullptr)
 	{
 		mDepthStencilBufferEnabled = true;
 		mMultiSamplingEnabled = true;
+		mIsFixedTimeStep = true;
+		mIsPipelined = true;
+		mFramePacer.SetTargetFrameRate(mFrameRate);
 	}
 
 	RenderingGame::~RenderingGame()
@@ -40,32 +47,42 @@ namespace Rendering
 		}
 
 		mKeyboard = new Keyboard(*this, mDirectInput);
-		mComponents.push_back(mKeyboard);
+		AddComponent(mKeyboard);
 		mServices.AddService(Keyboard::TypeIdClass(), mKeyboard);
 
 		mMouse = new Mouse(*this, mDirectInput);
-		mComponents.push_back(mMouse);
+		AddComponent(mMouse);
 		mServices.AddService(Mouse::TypeIdClass(), mMouse);
 
 		mCamera = new FirstPersonCamera(*this);
-		mComponents.push_back(mCamera);
+		AddComponent(mCamera);
 		mServices.AddService(Camera::TypeIdClass(), mCamera);
 
 		mFpsComponent = new FpsComponent(*this);
 		mFpsComponent->Initialize();
 
+		// Shown from the start in debug builds; F3 toggles it
+		mUpdateCostOverlay = new UpdateCostOverlay(*this);
+		mUpdateCostOverlay->Initialize();
+#if !defined( DEBUG ) && !defined( _DEBUG )
+		mUpdateCostOverlay->SetVisible(false);
+#endif
+
 		/*mSkybox = new Skybox(*this, *mCamera, L"Content\\Textures\\Maskonaive2_1024.dds", 500.0f);
-		mComponents.push_back(mSkybox);*/
+		AddComponent(mSkybox);*/
 
 		mGrid = new Grid(*this, *mCamera);
-		mComponents.push_back(mGrid);
+		AddComponent(mGrid);
 
 		RasterizerStates::Initialize(mDirect3DDevice);
 		SamplerStates::BorderColor = ColorHelper::Black;
 		SamplerStates::Initialize(mDirect3DDevice);
 
+		// Skinning is the costliest update; it is throttled over budget and slowed while F4 hides the model
 		mAnimationDemo = new AnimationDemo(*this, *mCamera);
-		mComponents.push_back(mAnimationDemo);
+		mAnimationDemo->SetUpdateBudget(AnimationDemoUpdateBudget);
+		mAnimationDemo->SetHiddenUpdate(HiddenUpdateReduced);
+		AddComponent(mAnimationDemo);
 
 		mRenderStateHelper = new RenderStateHelper(*this);
 
@@ -83,6 +100,7 @@ namespace Rendering
 		DeleteObject(mSkybox)
 		DeleteObject(mGrid);
 		DeleteObject(mFpsComponent);
+		DeleteObject(mUpdateCostOverlay);
 		DeleteObject(mCamera);
 
 		ReleaseObject(mDirectInput);
@@ -94,16 +112,29 @@ namespace Rendering
 
 	void RenderingGame::Update(const GameTime &gameTime)
 	{
-		mFpsComponent->Update(gameTime);
-
 		if (mKeyboard->WasKeyPressedThisFrame(DIK_ESCAPE))
 		{
 			Exit();
 		}
 
+		if (mKeyboard->WasKeyPressedThisFrame(DIK_F3))
+		{
+			mUpdateCostOverlay->SetVisible(mUpdateCostOverlay->Visible() == false);
+		}
+
+		if (mKeyboard->WasKeyPressedThisFrame(DIK_F4))
+		{
+			mAnimationDemo->SetVisible(mAnimationDemo->Visible() == false);
+		}
+
 		Game::Update(gameTime);
 	}
 
+	void RenderingGame::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		mUpdateCostOverlay->CaptureRenderState(snapshot);
+	}
+
 	void RenderingGame::Draw(const GameTime &gameTime)
 	{
 		mDirect3DDeviceContext->ClearRenderTargetView(mRenderTargetView, reinterpret_cast<const float*>(&BackgroundColor));
@@ -111,8 +142,12 @@ namespace Rendering
 
 		Game::Draw(gameTime);
 
+		// Counted here rather than in Update, which can run several times a frame under the fixed time step
+		mFpsComponent->Update(gameTime);
+
 		mRenderStateHelper->SaveAll();
 		mFpsComponent->Draw(gameTime);
+		mUpdateCostOverlay->Draw(gameTime);
 		mRenderStateHelper->RestoreAll();
 
 		HRESULT hr = mSwapChain->Present(0, 0);
@@ -11,6 +11,7 @@ namespace Library
 	class Mouse;
 	class FirstPersonCamera;
 	class FpsComponent;
+	class UpdateCostOverlay;
 	class RenderStateHelper;
 	class Skybox;
 	class Grid;
@@ -28,6 +29,7 @@ namespace Rendering
 
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void Draw(const GameTime& gameTime) override;
 
 	protected:
@@ -35,12 +37,14 @@ namespace Rendering
 
 	private:
 		static const XMVECTORF32 BackgroundColor;
+		static const double AnimationDemoUpdateBudget;
 
 		LPDIRECTINPUT8 mDirectInput;
 		Keyboard* mKeyboard;
 		Mouse* mMouse;
 		FirstPersonCamera * mCamera;
 		FpsComponent* mFpsComponent;
+		UpdateCostOverlay* mUpdateCostOverlay;
 		RenderStateHelper* mRenderStateHelper;
 		Skybox* mSkybox;
 		Grid* mGrid;
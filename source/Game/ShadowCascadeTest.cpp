@@ -0,0 +1,176 @@
+#include "stdafx.h"
+#include "ShadowCascadeTest.h"
+#include "..\Library\ClockSource.h"
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(ShadowCascadeTest)
+
+	const float ShadowCascadeTest::NearPlaneDistance = 0.5f;
+	const float ShadowCascadeTest::FarPlaneDistance = 150.0f;
+	const float ShadowCascadeTest::ShadowDistance = 60.0f;
+	const float ShadowCascadeTest::Tolerance = 1e-3f;
+
+	ShadowCascadeTest::ShadowCascadeTest(Game& game)
+		: Benchmark(game), mCamera(game, XM_PIDIV4, 16.0f / 9.0f, NearPlaneDistance, FarPlaneDistance),
+		  mTightBuilder(ShadowCascadeBuilder::DefaultCascadeCount, ShadowCascadeBuilder::DefaultResolution, ShadowCascadeBuilder::DefaultSplitBlend, CascadeFitTight),
+		  mStableBuilder(ShadowCascadeBuilder::DefaultCascadeCount, ShadowCascadeBuilder::DefaultResolution, ShadowCascadeBuilder::DefaultSplitBlend, CascadeFitStable),
+		  mLightDirection(-0.3f, -1.0f, -0.2f), mCheckedCornerCount(0), mOutsideCornerCount(0), mTightMilliseconds(0.0), mStableMilliseconds(0.0), mSampleCount(0)
+	{
+	}
+
+	ShadowCascadeTest::~ShadowCascadeTest()
+	{
+	}
+
+	void ShadowCascadeTest::Initialize()
+	{
+		mCamera.Initialize();
+
+		// Straight down exercises the builder's fallback up vector
+		const XMFLOAT3 lightDirections[] = { XMFLOAT3(-0.3f, -1.0f, -0.2f), XMFLOAT3(0.0f, -1.0f, 0.0f), XMFLOAT3(1.0f, -0.2f, 0.4f) };
+		const XMFLOAT3 positions[] = { XMFLOAT3(0.0f, 2.0f, 0.0f), XMFLOAT3(35.0f, 10.0f, -80.0f), XMFLOAT3(-120.0f, 50.0f, 300.0f) };
+		const float yaws[] = { 0.0f, 0.7f, 2.1f, -2.8f };
+		const float pitches[] = { 0.0f, -0.5f, 0.9f };
+		const float shadowDistances[] = { 0.0f, ShadowDistance };
+
+		for (UINT distance = 0; distance < ARRAYSIZE(shadowDistances); distance++)
+		{
+			mTightBuilder.SetShadowDistance(shadowDistances[distance]);
+			mStableBuilder.SetShadowDistance(shadowDistances[distance]);
+
+			for (UINT light = 0; light < ARRAYSIZE(lightDirections); light++)
+			{
+				for (UINT position = 0; position < ARRAYSIZE(positions); position++)
+				{
+					std::vector<float> stableTexelSizes;
+
+					for (UINT yaw = 0; yaw < ARRAYSIZE(yaws); yaw++)
+					{
+						for (UINT pitch = 0; pitch < ARRAYSIZE(pitches); pitch++)
+						{
+							SetPose(positions[position], yaws[yaw], pitches[pitch]);
+
+							std::wostringstream pose;
+							pose << L"shadow distance " << shadowDistances[distance] << L", light " << light << L", position " << position
+								<< L", yaw " << yaws[yaw] << L", pitch " << pitches[pitch];
+
+							mTightBuilder.Build(mCamera, lightDirections[light]);
+							mTightBuilder.Validate();
+							CheckCascades(mTightBuilder, L"Tight fit, " + pose.str());
+
+							mStableBuilder.Build(mCamera, lightDirections[light]);
+							mStableBuilder.Validate();
+							CheckCascades(mStableBuilder, L"Stable fit, " + pose.str());
+
+							const std::vector<ShadowCascadeBuilder::Cascade>& cascades = mStableBuilder.Cascades();
+							for (UINT i = 0; i < cascades.size(); i++)
+							{
+								if (stableTexelSizes.size() == i)
+								{
+									stableTexelSizes.push_back(cascades[i].TexelSize);
+								}
+								else
+								{
+									Check(std::fabs(cascades[i].TexelSize - stableTexelSizes[i]) <= stableTexelSizes[i] * Tolerance,
+										L"Stable fit, " + pose.str() + L": texel size changed as the camera turned");
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		mTightBuilder.SetShadowDistance(0.0f);
+		mStableBuilder.SetShadowDistance(0.0f);
+	}
+
+	void ShadowCascadeTest::Update(const GameTime& gameTime)
+	{
+		// A camera turning in place, as it would while the player looks around
+		SetPose(XMFLOAT3(35.0f, 10.0f, -80.0f), mSampleCount * 0.05f, -0.3f);
+
+		double startTime = RealClockSource::Milliseconds();
+		mTightBuilder.Build(mCamera, mLightDirection);
+		mTightMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		startTime = RealClockSource::Milliseconds();
+		mStableBuilder.Build(mCamera, mLightDirection);
+		mStableMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		mSampleCount++;
+	}
+
+	void ShadowCascadeTest::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+
+		results << L"Shadow cascades (" << mTightBuilder.CascadeCount() << L" cascades at " << mTightBuilder.Resolution() << L" texels)" << std::endl;
+		results << L"  Checked " << mCheckedCornerCount << L" split corners against their cascades, " << mOutsideCornerCount << L" outside" << std::endl;
+		results << L"  Tight fit: " << mTightMilliseconds / sampleCount << L" ms per build" << std::endl;
+		results << L"  Stable fit: " << mStableMilliseconds / sampleCount << L" ms per build" << std::endl;
+	}
+
+	void ShadowCascadeTest::SetPose(const XMFLOAT3& position, float yaw, float pitch)
+	{
+		mCamera.Reset();
+		mCamera.SetPosition(position);
+		mCamera.ApplyRotation(XMMatrixRotationX(pitch) * XMMatrixRotationY(yaw));
+		mCamera.UpdateViewMatrix();
+	}
+
+	void ShadowCascadeTest::CheckCascades(const ShadowCascadeBuilder& builder, const std::wstring& description)
+	{
+		float nearDistance = mCamera.NearPlaneDistance();
+		float farDistance = mCamera.FarPlaneDistance();
+		float shadowedDistance = (builder.ShadowDistance() > nearDistance ? (std::min)(farDistance, builder.ShadowDistance()) : farDistance);
+
+		// The four edges of the view frustum, from the near plane to the far plane
+		XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, mCamera.ViewProjectionMatrix());
+		XMVECTOR nearCorners[4];
+		XMVECTOR farCorners[4];
+		for (UINT i = 0; i < 4; i++)
+		{
+			float x = ((i & 1) ? 1.0f : -1.0f);
+			float y = ((i & 2) ? 1.0f : -1.0f);
+			nearCorners[i] = XMVector3TransformCoord(XMVectorSet(x, y, 0.0f, 1.0f), inverseViewProjection);
+			farCorners[i] = XMVector3TransformCoord(XMVectorSet(x, y, 1.0f, 1.0f), inverseViewProjection);
+		}
+
+		const std::vector<ShadowCascadeBuilder::Cascade>& cascades = builder.Cascades();
+		Check(cascades.front().NearDistance == nearDistance, description + L": the first split does not start at the near plane");
+		Check(cascades.back().FarDistance == shadowedDistance, description + L": the last split does not end at the shadowed distance");
+
+		UINT outsideCount = 0;
+		for (UINT i = 0; i < cascades.size(); i++)
+		{
+			const ShadowCascadeBuilder::Cascade& cascade = cascades[i];
+			Check(cascade.NearDistance < cascade.FarDistance, description + L": a split is empty");
+			Check(i == 0 || cascades[i - 1].FarDistance == cascade.NearDistance, description + L": the splits leave a gap");
+
+			// Depth along the view direction is linear along each edge
+			XMMATRIX viewProjection = XMLoadFloat4x4(&cascade.ViewProjectionMatrix);
+			float distances[] = { cascade.NearDistance, cascade.FarDistance };
+			for (UINT j = 0; j < ARRAYSIZE(distances); j++)
+			{
+				float fraction = (distances[j] - nearDistance) / (farDistance - nearDistance);
+				for (UINT k = 0; k < 4; k++)
+				{
+					XMFLOAT3 corner;
+					XMStoreFloat3(&corner, XMVector3TransformCoord(XMVectorLerp(nearCorners[k], farCorners[k], fraction), viewProjection));
+
+					mCheckedCornerCount++;
+					if (std::fabs(corner.x) > 1.0f + Tolerance || std::fabs(corner.y) > 1.0f + Tolerance || corner.z < -Tolerance || corner.z > 1.0f + Tolerance)
+					{
+						outsideCount++;
+					}
+				}
+			}
+		}
+
+		mOutsideCornerCount += outsideCount;
+		Check(outsideCount == 0, description + L": split corners lie outside their cascade");
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\Camera.h"
+#include "..\Library\ShadowCascadeBuilder.h"
+
+namespace Rendering
+{
+	// Checks ShadowCascadeBuilder for a set of camera poses and light directions, with both fits and with and without a
+	// shadow distance. The splits must tile the shadowed range, and every corner of every split must land inside its
+	// cascade's orthographic volume. The corners are found independently of the builder, by unprojecting the corners of
+	// clip space through the inverse of the camera's view-projection and interpolating along the frustum edges. Stable
+	// cascades must also keep their texel size as the camera turns. Each Update then times one build of each fit.
+	class ShadowCascadeTest : public Benchmark
+	{
+		RTTI_DECLARATIONS(ShadowCascadeTest, Benchmark)
+
+	public:
+		ShadowCascadeTest(Game& game);
+		~ShadowCascadeTest();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		ShadowCascadeTest();
+		ShadowCascadeTest(const ShadowCascadeTest& rhs);
+		ShadowCascadeTest& operator=(const ShadowCascadeTest& rhs);
+
+		static const float NearPlaneDistance;
+		static const float FarPlaneDistance;
+		static const float ShadowDistance;
+		static const float Tolerance;			// In the cascade's normalized device coordinates
+
+		void SetPose(const XMFLOAT3& position, float yaw, float pitch);
+		void CheckCascades(const ShadowCascadeBuilder& builder, const std::wstring& description);
+
+		Camera mCamera;
+		ShadowCascadeBuilder mTightBuilder;
+		ShadowCascadeBuilder mStableBuilder;
+		XMFLOAT3 mLightDirection;
+		UINT mCheckedCornerCount;
+		UINT mOutsideCornerCount;
+		double mTightMilliseconds;				// Summed over the samples
+		double mStableMilliseconds;
+		UINT mSampleCount;
+	};
+}
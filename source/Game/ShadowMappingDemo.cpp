@@ -7,22 +7,21 @@
 #include "..\Library\ColorHelper.h"
 #include "..\Library\Camera.h"
 #include "..\Library\Model.h"
+#include "..\Library\ModelCache.h"
+#include "..\Library\AssetLoader.h"
 #include "..\Library\Mesh.h"
 #include "..\Library\Utility.h"
 #include "..\Library\PointLight.h"
 #include "..\Library\Keyboard.h"
-#include <WICTextureLoader.h>
-#include <DDSTextureLoader.h>
 #include "..\Library\ProxyModel.h"
 #include "..\Library\Projector.h"
 #include "..\Library\RenderableFrustum.h"
 #include "..\Library\ShadowMappingMaterial.h"
 #include "..\Library\DepthMapMaterial.h"
-#include "..\Library\DepthMap.h"
+#include "..\Library\ShadowMapCache.h"
+#include "..\Library\TextBuilder.h"
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
-#include <sstream>
-#include <iomanip>
 
 namespace Rendering
 {
@@ -45,10 +44,16 @@ namespace Rendering
 		mShadowMappingEffect(nullptr), mShadowMappingMaterial(nullptr),
 		mProjectedTextureScalingMatrix(MatrixHelper::Zero), mRenderStateHelper(game),
 		mModelPositionVertexBuffer(nullptr), mModelPositionUVNormalVertexBuffer(nullptr), mModelIndexBuffer(nullptr), mModelIndexCount(0),
-		mModelWorldMatrix(MatrixHelper::Identity), mDepthMapEffect(nullptr), mDepthMapMaterial(nullptr), mDepthMap(nullptr), mDrawDepthMap(true),
+		mModelWorldMatrix(MatrixHelper::Identity), mDepthMapEffect(nullptr), mDepthMapMaterial(nullptr), mShadowMapCache(nullptr), mDrawDepthMap(true),
 		mSpriteBatch(nullptr), mSpriteFont(nullptr), mTextPosition(0.0f, 40.0f), mActiveTechnique(ShadowMappingTechniqueSimple),
 		mDepthBiasState(nullptr), mDepthBias(0), mSlopeScaledDepthBias(2.0f)
 	{
+		// The proxy model is declared here because the proxy is created during Initialize
+		DeclareModel("..\\source\\Library\\Content\\Models\\teapot.obj", true);
+		DeclareModel("..\\source\\Library\\Content\\Models\\PointLightProxy.obj", true);
+		DeclareEffect(L"Content\\Effects\\ShadowMapping.cso");
+		DeclareEffect(L"Content\\Effects\\DepthMap.cso");
+		DeclareTexture(L"..\\source\\Library\\Content\\Textures\\Checkerboard.png");
 	}
 
 	ShadowMappingDemo::~ShadowMappingDemo()
@@ -56,7 +61,7 @@ namespace Rendering
 		ReleaseObject(mDepthBiasState);
 		DeleteObject(mSpriteFont);
 		DeleteObject(mSpriteBatch);
-		DeleteObject(mDepthMap);
+		DeleteObject(mShadowMapCache);
 		DeleteObject(mDepthMapMaterial);
 		DeleteObject(mDepthMapEffect);
 		ReleaseObject(mModelIndexBuffer);
@@ -118,11 +123,7 @@ namespace Rendering
 		mShadowMappingMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), positionUVNormalVertices, mPlaneVertexCount, &mPlanePositionUVNormalVertexBuffer);
 
 		std::wstring textureName = L"..\\source\\Library\\Content\\Textures\\Checkerboard.png";
-		HRESULT hr = DirectX::CreateWICTextureFromFile(mGame->Direct3DDevice(), mGame->Direct3DDeviceContext(), textureName.c_str(), nullptr, &mCheckerboardTexture);
-		if (FAILED(hr))
-		{
-			throw GameException("CreateWICTextureFromFile() failed.", hr);
-		}
+		mCheckerboardTexture = mGame->Assets().AcquireTexture(textureName);
 
 		mPointLight = new PointLight(*mGame);
 		mPointLight->SetRadius(50.0f);
@@ -148,7 +149,7 @@ namespace Rendering
 		InitializeProjectedTextureScalingMatrix();
 
 		// Vertex and index buffers for a second model to render
-		std::unique_ptr<Model> model(new Model(*mGame, "..\\source\\Library\\Content\\Models\\teapot.obj", true));
+		std::shared_ptr<Model> model = mGame->Models().Load("..\\source\\Library\\Content\\Models\\teapot.obj", true);
 
 		Mesh* mesh = model->Meshes().at(0);
 		mDepthMapMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mModelPositionVertexBuffer);
@@ -158,7 +159,7 @@ namespace Rendering
 
 		XMStoreFloat4x4(&mModelWorldMatrix, XMMatrixScaling(0.1f, 0.1f, 0.1f) * XMMatrixTranslation(0.0f, 5.0f, 2.5f));
 
-		mDepthMap = new DepthMap(*mGame, DepthMapWidth, DepthMapHeight);
+		mShadowMapCache = new ShadowMapCache(*mGame, DepthMapWidth, DepthMapHeight);
 		mSpriteBatch = new SpriteBatch(mGame->Direct3DDeviceContext());
 		mSpriteFont = new SpriteFont(mGame->Direct3DDevice(), L"..\\source\\Library\\Content\\Arial_14_Regular.spritefont");
 
@@ -183,38 +184,52 @@ namespace Rendering
 		mRenderableProjectorFrustum->Update(gameTime);
 	}
 
+	void ShadowMappingDemo::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		mProxyModel->CaptureRenderState(snapshot);
+		mRenderableProjectorFrustum->CaptureRenderState(snapshot);
+	}
+
 	void ShadowMappingDemo::Draw(const GameTime& gameTime)
 	{
 		static float blendFactor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-		// Depth map pass (render the teapot model only)
-		mRenderStateHelper.SaveRasterizerState();
-		mDepthMap->Begin();
-
+		// Depth map pass (render the teapot model only), skipped while the light and the teapot are unchanged
 		ID3D11DeviceContext* direct3DDeviceContext = mGame->Direct3DDeviceContext();
 		direct3DDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-		direct3DDeviceContext->ClearDepthStencilView(mDepthMap->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-		Pass* pass = mDepthMapMaterial->CurrentTechnique()->Passes().at(0);
-		ID3D11InputLayout* inputLayout = mDepthMapMaterial->InputLayouts().at(pass);
-		direct3DDeviceContext->IASetInputLayout(inputLayout);
-
-		direct3DDeviceContext->RSSetState(mDepthBiasState);
+		XMMATRIX modelWorldMatrix = XMLoadFloat4x4(&mModelWorldMatrix);
+		mShadowMapCache->BeginFrame(mProjector->ViewMatrix() * mProjector->ProjectionMatrix());
+		mShadowMapCache->AddCaster(modelWorldMatrix);
 
-		UINT stride = mDepthMapMaterial->VertexSize();
+		Pass* pass;
+		ID3D11InputLayout* inputLayout;
+		UINT stride;
 		UINT offset = 0;
-		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mModelPositionVertexBuffer, &stride, &offset);
-		direct3DDeviceContext->IASetIndexBuffer(mModelIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-		XMMATRIX modelWorldMatrix = XMLoadFloat4x4(&mModelWorldMatrix);
-		mDepthMapMaterial->WorldLightViewProjection() << modelWorldMatrix * mProjector->ViewMatrix() * mProjector->ProjectionMatrix();
+		if (mShadowMapCache->BeginStaticPass())
+		{
+			mRenderStateHelper.SaveRasterizerState();
 
-		pass->Apply(0, direct3DDeviceContext);
+			pass = mDepthMapMaterial->CurrentTechnique()->Passes().at(0);
+			inputLayout = mDepthMapMaterial->InputLayouts().at(pass);
+			direct3DDeviceContext->IASetInputLayout(inputLayout);
 
-		direct3DDeviceContext->DrawIndexed(mModelIndexCount, 0, 0);
+			direct3DDeviceContext->RSSetState(mDepthBiasState);
+
+			stride = mDepthMapMaterial->VertexSize();
+			direct3DDeviceContext->IASetVertexBuffers(0, 1, &mModelPositionVertexBuffer, &stride, &offset);
+			direct3DDeviceContext->IASetIndexBuffer(mModelIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+
+			mDepthMapMaterial->WorldLightViewProjection() << modelWorldMatrix * mProjector->ViewMatrix() * mProjector->ProjectionMatrix();
+
+			pass->Apply(0, direct3DDeviceContext);
 
-		mDepthMap->End();
-		mRenderStateHelper.RestoreRasterizerState();
+			direct3DDeviceContext->DrawIndexed(mModelIndexCount, 0, 0);
+
+			mShadowMapCache->EndStaticPass();
+			mRenderStateHelper.RestoreRasterizerState();
+		}
 
 		// Projective texture mapping pass
 		pass = mShadowMappingMaterial->CurrentTechnique()->Passes().at(0);
@@ -244,7 +259,7 @@ namespace Rendering
 		mShadowMappingMaterial->ColorTexture() << mCheckerboardTexture;
 		mShadowMappingMaterial->CameraPosition() << mCamera->PositionVector();
 		mShadowMappingMaterial->ProjectiveTextureMatrix() << projectiveTextureMatrix;
-		mShadowMappingMaterial->ShadowMap() << mDepthMap->OutputTexture();
+		mShadowMappingMaterial->ShadowMap() << mShadowMapCache->OutputTexture();
 		mShadowMappingMaterial->ShadowMapSize() << shadowMapSize;
 
 		pass->Apply(0, direct3DDeviceContext);
@@ -270,7 +285,7 @@ namespace Rendering
 		mShadowMappingMaterial->ColorTexture() << mCheckerboardTexture;
 		mShadowMappingMaterial->CameraPosition() << mCamera->PositionVector();
 		mShadowMappingMaterial->ProjectiveTextureMatrix() << projectiveTextureMatrix;
-		mShadowMappingMaterial->ShadowMap() << mDepthMap->OutputTexture();
+		mShadowMappingMaterial->ShadowMap() << mShadowMapCache->OutputTexture();
 		mShadowMappingMaterial->ShadowMapSize() << shadowMapSize;
 
 		pass->Apply(0, direct3DDeviceContext);
@@ -286,17 +301,19 @@ namespace Rendering
 
 		if (mDrawDepthMap)
 		{
-			mSpriteBatch->Draw(mDepthMap->OutputTexture(), DepthMapDestinationRectangle);
+			mSpriteBatch->Draw(mShadowMapCache->OutputTexture(), DepthMapDestinationRectangle);
 		}
 
-		std::wostringstream helpLabel;
+		TextBuilder helpLabel(mGame->FrameArena());
 		helpLabel << L"Ambient Intensity (+PgUp/-PgDn): " << mAmbientColor.a << "\n";
 		helpLabel << L"Point Light Intensity (+Home/-End): " << mPointLight->Color().a << "\n";
 		helpLabel << L"Specular Power (+Insert/-Delete): " << mSpecularPower << "\n";
 		helpLabel << L"Move Projector/Light (8/2, 4/6, 3/9)\n";
 		helpLabel << L"Rotate Projector (Arrow Keys)\n";
 		helpLabel << L"Show Shadow Map (Enter): " << (mDrawDepthMap ? "Yes" : "No") << "\n";
-		helpLabel << std::setprecision(5) << L"Active Technique (Space): " << ShadowMappingDisplayNames[mActiveTechnique].c_str() << "\n";
+		helpLabel << L"Shadow Passes Skipped: " << mShadowMapCache->GetStatistics().StaticPassesSkipped << "\n";
+		helpLabel.SetPrecision(5);
+		helpLabel << L"Active Technique (Space): " << ShadowMappingDisplayNames[mActiveTechnique].c_str() << "\n";
 
 		if (mActiveTechnique == ShadowMappingTechniquePCF)
 		{
@@ -304,7 +321,7 @@ namespace Rendering
 				<< L"Slope-Scaled Depth Bias (+O/-P): " << mSlopeScaledDepthBias;
 		}
 
-		mSpriteFont->DrawString(mSpriteBatch, helpLabel.str().c_str(), mTextPosition);
+		mSpriteFont->DrawString(mSpriteBatch, helpLabel.Text(), mTextPosition);
 
 		mSpriteBatch->End();
 		mRenderStateHelper.RestoreAll();
@@ -322,6 +339,7 @@ namespace Rendering
 
 			mShadowMappingMaterial->SetCurrentTechnique(*mShadowMappingMaterial->GetEffect()->TechniquesByName().at(ShadowMappingTechniqueNames[mActiveTechnique]));
 			mDepthMapMaterial->SetCurrentTechnique(*mDepthMapMaterial->GetEffect()->TechniquesByName().at(DepthMappingTechniqueNames[mActiveTechnique]));
+			mShadowMapCache->Invalidate();
 		}
 	}
 
@@ -374,6 +392,12 @@ namespace Rendering
 		{
 			throw GameException("ID3D11Device::CreateRasterizerState() failed.", hr);
 		}
+
+		// The bias is baked into the cached depth
+		if (mShadowMapCache != nullptr)
+		{
+			mShadowMapCache->Invalidate();
+		}
 	}
 
 	void ShadowMappingDemo::UpdateAmbientLight(const GameTime& gameTime)
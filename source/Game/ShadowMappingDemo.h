@@ -16,7 +16,7 @@ namespace Library
 	class RenderableFrustum;
 	class ShadowMappingMaterial;
 	class DepthMapMaterial;
-	class DepthMap;
+	class ShadowMapCache;
 }
 
 namespace DirectX
@@ -49,6 +49,7 @@ namespace Rendering
 
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void Draw(const GameTime& gameTime) override;
 
 	private:
@@ -101,7 +102,7 @@ namespace Rendering
 
 		Effect* mDepthMapEffect;
 		DepthMapMaterial* mDepthMapMaterial;
-		DepthMap* mDepthMap;
+		ShadowMapCache* mShadowMapCache;
 		bool mDrawDepthMap;
 		SpriteBatch* mSpriteBatch;
 		SpriteFont* mSpriteFont;
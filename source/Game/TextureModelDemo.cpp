@@ -8,8 +8,9 @@
 #include "..\Library\Utility.h"
 #include "D3DCompiler.h"
 #include "..\Library\Model.h"
+#include "..\Library\ModelCache.h"
+#include "..\Library\AssetLoader.h"
 #include "..\Library\Mesh.h"
-#include <WICTextureLoader.h>
 
 namespace Rendering
 {
@@ -18,8 +19,11 @@ namespace Rendering
 		TextureModelDemo::TextureModelDemo(Game& game, Camera& camera)
 		: DrawableGameComponent(game, camera),
 		mEffect(nullptr), mTechnique(nullptr), mPass(nullptr), mWvpVariable(nullptr), mTextureShaderResourceView(nullptr), mColorTextureVariable(nullptr),
-		mInputLayout(nullptr), mWorldMatrix(MatrixHelper::Identity), mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0)
+		mInputLayout(nullptr), mWorldMatrix(MatrixHelper::Identity), mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mCameraVersion(0), mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0)
 	{
+		// The effect is compiled from source, so only the model and texture can be declared
+		DeclareModel("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
+		DeclareTexture(L"..\\source\\Library\\Content\\Textures\\EarthComposite.jpg");
 	}
 
 	TextureModelDemo::~TextureModelDemo()
@@ -121,7 +125,7 @@ namespace Rendering
 		}
 
 		// Load the model
-		std::unique_ptr<Model> model(new Model(*mGame, "..\\source\\Library\\Content\\Models\\Sphere.obj", true));
+		std::shared_ptr<Model> model = mGame->Models().Load("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
 
 		// Create the vertex and index buffers
 		Mesh* mesh = model->Meshes().at(0);
@@ -131,10 +135,7 @@ namespace Rendering
 
 		// Load the texture
 		std::wstring textureName = L"..\\source\\Library\\Content\\Textures\\EarthComposite.jpg";
-		if (FAILED(hr = DirectX::CreateWICTextureFromFile(mGame->Direct3DDevice(), mGame->Direct3DDeviceContext(), textureName.c_str(), nullptr, &mTextureShaderResourceView)))
-		{
-			throw GameException("CreateWICTextureFromFile() failed.", hr);
-		}
+		mTextureShaderResourceView = mGame->Assets().AcquireTexture(textureName);
 	}
 
 	void TextureModelDemo::Draw(const GameTime& gameTime)
@@ -148,8 +149,14 @@ namespace Rendering
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
 		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-		XMMATRIX worldMatrix = XMLoadFloat4x4(&mWorldMatrix);
-		XMMATRIX wvp = worldMatrix * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+		if (mIsWorldDirty || mCameraVersion != mCamera->ViewProjectionVersion())
+		{
+			mIsWorldDirty = false;
+			mCameraVersion = mCamera->ViewProjectionVersion();
+			XMStoreFloat4x4(&mWorldViewProjectionMatrix, XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix());
+		}
+
+		XMMATRIX wvp = XMLoadFloat4x4(&mWorldViewProjectionMatrix);
 		mWvpVariable->SetMatrix(reinterpret_cast<const float*>(&wvp));
 		mColorTextureVariable->SetResource(mTextureShaderResourceView);
 
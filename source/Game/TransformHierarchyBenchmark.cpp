@@ -0,0 +1,155 @@
+#include "stdafx.h"
+#include "TransformHierarchyBenchmark.h"
+#include "..\Library\Parallel.h"
+#include "..\Library\ClockSource.h"
+#include <cmath>
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(TransformHierarchyBenchmark)
+
+	const UINT TransformHierarchyBenchmark::CharacterCount = 768;
+	const UINT TransformHierarchyBenchmark::ChildCount = 4;
+	const UINT TransformHierarchyBenchmark::LevelCount = 4;
+
+	TransformHierarchyBenchmark::TransformHierarchyBenchmark(Game& game)
+		: Benchmark(game), mSerialHierarchy(), mParallelHierarchy(), mRoots(), mNodes(), mWorkerCounts(),
+		  mSerialMilliseconds(0.0), mParallelMilliseconds(), mParallelLevelCount(0), mMismatchCount(0), mSampleCount(0)
+	{
+	}
+
+	TransformHierarchyBenchmark::~TransformHierarchyBenchmark()
+	{
+	}
+
+	void TransformHierarchyBenchmark::Initialize()
+	{
+		// Characters are built depth first, as a model's nodes load, so the parallel pass has to sort them by depth first
+		std::default_random_engine generator(2718);
+		for (UINT i = 0; i < CharacterCount; i++)
+		{
+			TransformHierarchy::Handle root = mSerialHierarchy.Create();
+			mRoots.push_back(root);
+			mNodes.push_back(root);
+			AddChildren(root, 1, generator);
+		}
+
+		mSerialHierarchy.Update();
+		mParallelHierarchy = mSerialHierarchy;
+
+		UINT maxWorkerCount = Parallel::MaxWorkerCount();
+		Parallel::SetMaxWorkerCount(0);
+		UINT workerCount = Parallel::WorkerCount();
+		Parallel::SetMaxWorkerCount(maxWorkerCount);
+
+		for (UINT count = 1; count < workerCount; count *= 2)
+		{
+			mWorkerCounts.push_back(count);
+		}
+
+		mWorkerCounts.push_back(workerCount);
+		mParallelMilliseconds.resize(mWorkerCounts.size(), 0.0);
+	}
+
+	void TransformHierarchyBenchmark::Update(const GameTime& gameTime)
+	{
+		MoveCharacters(mSerialHierarchy);
+
+		double startTime = RealClockSource::Milliseconds();
+		mSerialHierarchy.Update();
+		mSerialMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		UINT maxWorkerCount = Parallel::MaxWorkerCount();
+		for (UINT i = 0; i < mWorkerCounts.size(); i++)
+		{
+			// Moving the roots again for every pass keeps the whole crowd stale, so each pass does the full work
+			MoveCharacters(mParallelHierarchy);
+			Parallel::SetMaxWorkerCount(mWorkerCounts[i]);
+
+			startTime = RealClockSource::Milliseconds();
+			mParallelHierarchy.UpdateParallel();
+			mParallelMilliseconds[i] += RealClockSource::Milliseconds() - startTime;
+
+			Parallel::SetMaxWorkerCount(maxWorkerCount);
+
+			mParallelLevelCount = mParallelHierarchy.GetStatistics().ParallelLevelCount;
+			bool matches = MatchesSerial();
+			if (matches == false)
+			{
+				mMismatchCount++;
+			}
+
+			std::wostringstream description;
+			description << L"UpdateParallel with " << mWorkerCounts[i] << L" workers differs from Update";
+			Check(matches, description.str());
+		}
+
+		mSampleCount++;
+	}
+
+	void TransformHierarchyBenchmark::WriteResults(std::wostringstream& results) const
+	{
+		double sampleCount = (mSampleCount > 0 ? static_cast<double>(mSampleCount) : 1.0);
+		double serialMilliseconds = mSerialMilliseconds / sampleCount;
+
+		results << L"Transform hierarchy (" << mNodes.size() << L" nodes in " << CharacterCount << L" characters, "
+			<< mParallelLevelCount << L" of " << LevelCount << L" levels split across workers)" << std::endl;
+		results << L"  Serial: " << serialMilliseconds << L" ms per update" << std::endl;
+		for (UINT i = 0; i < mWorkerCounts.size(); i++)
+		{
+			double parallelMilliseconds = mParallelMilliseconds[i] / sampleCount;
+			results << L"  " << mWorkerCounts[i] << L" workers: " << parallelMilliseconds << L" ms per update, "
+				<< (parallelMilliseconds > 0.0 ? serialMilliseconds / parallelMilliseconds : 0.0) << L"x serial" << std::endl;
+		}
+
+		results << L"  Compared " << mSampleCount * mWorkerCounts.size() << L" parallel updates with the serial one, " << mMismatchCount << L" differ" << std::endl;
+	}
+
+	void TransformHierarchyBenchmark::AddChildren(TransformHierarchy::Handle parent, UINT level, std::default_random_engine& generator)
+	{
+		if (level == LevelCount)
+		{
+			return;
+		}
+
+		std::uniform_real_distribution<float> angle(-XM_PIDIV2, XM_PIDIV2);
+		std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+		for (UINT i = 0; i < ChildCount; i++)
+		{
+			XMFLOAT4X4 localTransform;
+			XMStoreFloat4x4(&localTransform, XMMatrixRotationRollPitchYaw(angle(generator), angle(generator), angle(generator)) *
+				XMMatrixTranslation(offset(generator), offset(generator), offset(generator)));
+
+			TransformHierarchy::Handle child = mSerialHierarchy.Create(parent, localTransform);
+			mNodes.push_back(child);
+			AddChildren(child, level + 1, generator);
+		}
+	}
+
+	void TransformHierarchyBenchmark::MoveCharacters(TransformHierarchy& hierarchy)
+	{
+		// Characters stand on a square grid and turn in place
+		UINT rowLength = static_cast<UINT>(std::sqrt(static_cast<float>(CharacterCount)));
+		for (UINT i = 0; i < mRoots.size(); i++)
+		{
+			XMMATRIX transform = XMMatrixRotationY(mSampleCount * 0.01f + i) * XMMatrixTranslation(static_cast<float>(i % rowLength) * 2.0f, 0.0f, static_cast<float>(i / rowLength) * 2.0f);
+			hierarchy.SetLocalTransform(mRoots[i], transform);
+			hierarchy.MarkDirty(mRoots[i]);
+		}
+	}
+
+	bool TransformHierarchyBenchmark::MatchesSerial() const
+	{
+		// Compared by handle, since the parallel pass reorders the dense arrays
+		for (TransformHierarchy::Handle node : mNodes)
+		{
+			if (memcmp(&mSerialHierarchy.WorldTransform(node), &mParallelHierarchy.WorldTransform(node), sizeof(XMFLOAT4X4)) != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "..\Library\TransformHierarchy.h"
+#include <random>
+
+namespace Rendering
+{
+	// Builds a crowd of characters, each a tree of transforms four levels deep, and moves every character's root each
+	// frame. The serial Update and UpdateParallel then recompute the whole crowd, the parallel pass once for each worker
+	// count from one up to every core, doubling in between. Each parallel result must match the serial one bit for bit.
+	// Reports the time per update and the speedup over the serial pass for each worker count.
+	class TransformHierarchyBenchmark : public Benchmark
+	{
+		RTTI_DECLARATIONS(TransformHierarchyBenchmark, Benchmark)
+
+	public:
+		TransformHierarchyBenchmark(Game& game);
+		~TransformHierarchyBenchmark();
+
+		virtual void Initialize() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void WriteResults(std::wostringstream& results) const override;
+
+	private:
+		TransformHierarchyBenchmark();
+		TransformHierarchyBenchmark(const TransformHierarchyBenchmark& rhs);
+		TransformHierarchyBenchmark& operator=(const TransformHierarchyBenchmark& rhs);
+
+		static const UINT CharacterCount;
+		static const UINT ChildCount;			// Per node above the leaves
+		static const UINT LevelCount;
+
+		void AddChildren(TransformHierarchy::Handle parent, UINT level, std::default_random_engine& generator);
+		void MoveCharacters(TransformHierarchy& hierarchy);
+		bool MatchesSerial() const;
+
+		TransformHierarchy mSerialHierarchy;
+		TransformHierarchy mParallelHierarchy;	// A copy of the serial hierarchy; handles are valid in both
+		std::vector<TransformHierarchy::Handle> mRoots;
+		std::vector<TransformHierarchy::Handle> mNodes;
+		std::vector<UINT> mWorkerCounts;
+		double mSerialMilliseconds;				// Summed over the samples
+		std::vector<double> mParallelMilliseconds;	// Indexed alike with mWorkerCounts
+		UINT mParallelLevelCount;
+		UINT mMismatchCount;
+		UINT mSampleCount;
+	};
+}
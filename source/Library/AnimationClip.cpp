@@ -1,14 +1,19 @@
 #include "AnimationClip.h"
 #include "BoneAnimation.h"
 #include "Bone.h"
+#include "Skeleton.h"
+#include "Keyframe.h"
 #include "MatrixHelper.h"
+#include "StreamHelper.h"
+#include "MemoryArena.h"
+#include "GameException.h"
 #include "scene.h"
 
 namespace Library
 {
-	AnimationClip::AnimationClip(Model& model, aiAnimation& animation)
-		: mName(animation.mName.C_Str()), mDuration(static_cast<float>(animation.mDuration)), mTicksPerSecond(static_cast<float>(animation.mTicksPerSecond)),
-		mBoneAnimations(), mBoneAnimationsByBone(), mKeyframeCount(0)
+	AnimationClip::AnimationClip(const Skeleton& skeleton, aiAnimation& animation, MemoryArena& arena)
+		: mOwnedArena(), mName(animation.mName.C_Str()), mDuration(static_cast<float>(animation.mDuration)), mTicksPerSecond(static_cast<float>(animation.mTicksPerSecond)),
+		mBoneAnimations(), mBoneAnimationsByBoneIndex(skeleton.BoneCount(), nullptr), mKeyframeCount(0)
 	{
 		assert(animation.mNumChannels > 0);
 
@@ -19,28 +24,37 @@ namespace Library
 
 		for (UINT i = 0; i < animation.mNumChannels; i++)
 		{
-			BoneAnimation* boneAnimation = new BoneAnimation(model, *(animation.mChannels[i]));
-			mBoneAnimations.push_back(boneAnimation);
-
-			assert(mBoneAnimationsByBone.find(&(boneAnimation->GetBone())) == mBoneAnimationsByBone.end());
-			mBoneAnimationsByBone[&(boneAnimation->GetBone())] = boneAnimation;
+			BoneAnimation* boneAnimation = new (arena.Allocate<BoneAnimation>()) BoneAnimation(skeleton, *(animation.mChannels[i]), arena);
+			AddBoneAnimation(boneAnimation);
 		}
+	}
 
-		for (BoneAnimation* boneAnimation : mBoneAnimations)
+	AnimationClip::AnimationClip(const Skeleton& skeleton, std::istream& stream, size_t arenaSize)
+		: mOwnedArena(new MemoryArena(arenaSize)), mName(), mDuration(0.0f), mTicksPerSecond(1.0f), mBoneAnimations(), mBoneAnimationsByBoneIndex(skeleton.BoneCount(), nullptr), mKeyframeCount(0)
+	{
+		StreamHelper::ReadString(stream, mName);
+		StreamHelper::Read(stream, mDuration);
+		StreamHelper::Read(stream, mTicksPerSecond);
+
+		UINT boneAnimationCount;
+		StreamHelper::Read(stream, boneAnimationCount);
+		mBoneAnimations.reserve(boneAnimationCount);
+
+		for (UINT i = 0; i < boneAnimationCount; i++)
 		{
-			if (boneAnimation->Keyframes().size() > mKeyframeCount)
+			BoneAnimation* boneAnimation = new (mOwnedArena->Allocate<BoneAnimation>()) BoneAnimation(skeleton, stream, *mOwnedArena);
+			if (mBoneAnimationsByBoneIndex[boneAnimation->BoneIndex()] != nullptr)
 			{
-				mKeyframeCount = boneAnimation->Keyframes().size();
+				throw GameException("Animation clip has more than one channel for a bone.");
 			}
+
+			AddBoneAnimation(boneAnimation);
 		}
 	}
 
 	AnimationClip::~AnimationClip()
 	{
-		for (BoneAnimation* boneAnimation : mBoneAnimations)
-		{
-			delete boneAnimation;
-		}
+		// Bone animations and keyframes live in an arena and are released with it
 	}
 
 	const std::string& AnimationClip::Name() const
@@ -63,9 +77,14 @@ namespace Library
 		return mBoneAnimations;
 	}
 
-	const std::map<Bone*, BoneAnimation*>& AnimationClip::BoneAnimationsByBone() const
+	const std::vector<BoneAnimation*>& AnimationClip::BoneAnimationsByBoneIndex() const
 	{
-		return mBoneAnimationsByBone;
+		return mBoneAnimationsByBoneIndex;
+	}
+
+	BoneAnimation* AnimationClip::FindBoneAnimation(UINT boneIndex) const
+	{
+		return (boneIndex < mBoneAnimationsByBoneIndex.size() ? mBoneAnimationsByBoneIndex[boneIndex] : nullptr);
 	}
 
 	const UINT AnimationClip::KeyframeCount() const
@@ -73,12 +92,40 @@ namespace Library
 		return mKeyframeCount;
 	}
 
-	UINT AnimationClip::GetTransform(float time, Bone& bone, XMFLOAT4X4& transform) const
+	size_t AnimationClip::SizeInBytes() const
 	{
-		auto foundBoneAnimation = mBoneAnimationsByBone.find(&bone);
-		if (foundBoneAnimation != mBoneAnimationsByBone.end())
+		size_t size = sizeof(AnimationClip) + mName.capacity() + (mBoneAnimations.capacity() + mBoneAnimationsByBoneIndex.capacity()) * sizeof(BoneAnimation*);
+		if (mOwnedArena != nullptr)
 		{
-			return foundBoneAnimation->second->GetTransform(time, transform);
+			return size + mOwnedArena->GetStatistics().BytesReserved;
+		}
+
+		for (BoneAnimation* boneAnimation : mBoneAnimations)
+		{
+			size += sizeof(BoneAnimation) + boneAnimation->mKeyframes.capacity() * (sizeof(Keyframe*) + sizeof(Keyframe));
+		}
+
+		return size;
+	}
+
+	size_t AnimationClip::EstimateArenaSize(const aiAnimation& animation)
+	{
+		// Per channel: the bone animation, its keyframes and the keyframe pointer array, plus alignment slack
+		size_t size = 0;
+		for (UINT i = 0; i < animation.mNumChannels; i++)
+		{
+			size += sizeof(BoneAnimation) + animation.mChannels[i]->mNumPositionKeys * (sizeof(Keyframe) + sizeof(Keyframe*)) + 32;
+		}
+
+		return size;
+	}
+
+	UINT AnimationClip::GetTransform(float time, UINT boneIndex, XMFLOAT4X4& transform) const
+	{
+		BoneAnimation* boneAnimation = FindBoneAnimation(boneIndex);
+		if (boneAnimation != nullptr)
+		{
+			return boneAnimation->GetTransform(time, transform);
 		}
 		else
 		{
@@ -87,20 +134,25 @@ namespace Library
 		}
 	}
 
+	UINT AnimationClip::GetTransform(float time, const Bone& bone, XMFLOAT4X4& transform) const
+	{
+		return GetTransform(time, bone.Index(), transform);
+	}
+
 	void AnimationClip::GetTransforms(float time, std::vector<XMFLOAT4X4>& boneTransforms) const
 	{
 		for (BoneAnimation* boneAnimation : mBoneAnimations)
 		{
-			boneAnimation->GetTransform(time, boneTransforms[boneAnimation->GetBone().Index()]);
+			boneAnimation->GetTransform(time, boneTransforms[boneAnimation->BoneIndex()]);
 		}
 	}
 
-	void AnimationClip::GetTransformAtKeyframe(UINT keyframe, Bone& bone, XMFLOAT4X4& transform) const
+	void AnimationClip::GetTransformAtKeyframe(UINT keyframe, UINT boneIndex, XMFLOAT4X4& transform) const
 	{
-		auto foundBoneAnimation = mBoneAnimationsByBone.find(&bone);
-		if (foundBoneAnimation != mBoneAnimationsByBone.end())
+		BoneAnimation* boneAnimation = FindBoneAnimation(boneIndex);
+		if (boneAnimation != nullptr)
 		{
-			foundBoneAnimation->second->GetTransformAtKeyframe(keyframe, transform);
+			boneAnimation->GetTransformAtKeyframe(keyframe, transform);
 		}
 		else
 		{
@@ -108,20 +160,25 @@ namespace Library
 		}
 	}
 
+	void AnimationClip::GetTransformAtKeyframe(UINT keyframe, const Bone& bone, XMFLOAT4X4& transform) const
+	{
+		GetTransformAtKeyframe(keyframe, bone.Index(), transform);
+	}
+
 	void AnimationClip::GetTransformsAtKeyframe(UINT keyframe, std::vector<XMFLOAT4X4>& boneTransforms) const
 	{
 		for (BoneAnimation* boneAnimation : mBoneAnimations)
 		{
-			boneAnimation->GetTransformAtKeyframe(keyframe, boneTransforms[boneAnimation->GetBone().Index()]);
+			boneAnimation->GetTransformAtKeyframe(keyframe, boneTransforms[boneAnimation->BoneIndex()]);
 		}
 	}
 
-	void AnimationClip::GetInteropolatedTransform(float time, Bone& bone, XMFLOAT4X4& transform) const
+	void AnimationClip::GetInteropolatedTransform(float time, UINT boneIndex, XMFLOAT4X4& transform) const
 	{
-		auto foundBoneAnimation = mBoneAnimationsByBone.find(&bone);
-		if (foundBoneAnimation != mBoneAnimationsByBone.end())
+		BoneAnimation* boneAnimation = FindBoneAnimation(boneIndex);
+		if (boneAnimation != nullptr)
 		{
-			foundBoneAnimation->second->GetInteropolatedTransform(time, transform);
+			boneAnimation->GetInteropolatedTransform(time, transform);
 		}
 		else
 		{
@@ -129,11 +186,42 @@ namespace Library
 		}
 	}
 
+	void AnimationClip::GetInteropolatedTransform(float time, const Bone& bone, XMFLOAT4X4& transform) const
+	{
+		GetInteropolatedTransform(time, bone.Index(), transform);
+	}
+
 	void AnimationClip::GetInteropolatedTransforms(float time, std::vector<XMFLOAT4X4>& boneTransforms) const
 	{
 		for (BoneAnimation* boneAnimation : mBoneAnimations)
 		{
-			boneAnimation->GetInteropolatedTransform(time, boneTransforms[boneAnimation->GetBone().Index()]);
+			boneAnimation->GetInteropolatedTransform(time, boneTransforms[boneAnimation->BoneIndex()]);
+		}
+	}
+
+	void AnimationClip::AddBoneAnimation(BoneAnimation* boneAnimation)
+	{
+		mBoneAnimations.push_back(boneAnimation);
+
+		assert(mBoneAnimationsByBoneIndex[boneAnimation->BoneIndex()] == nullptr);
+		mBoneAnimationsByBoneIndex[boneAnimation->BoneIndex()] = boneAnimation;
+
+		if (boneAnimation->Keyframes().size() > mKeyframeCount)
+		{
+			mKeyframeCount = boneAnimation->Keyframes().size();
+		}
+	}
+
+	void AnimationClip::Write(std::ostream& stream) const
+	{
+		StreamHelper::WriteString(stream, mName);
+		StreamHelper::Write(stream, mDuration);
+		StreamHelper::Write(stream, mTicksPerSecond);
+		StreamHelper::Write(stream, static_cast<UINT>(mBoneAnimations.size()));
+
+		for (BoneAnimation* boneAnimation : mBoneAnimations)
+		{
+			boneAnimation->Write(stream);
 		}
 	}
 }
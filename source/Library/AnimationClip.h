@@ -8,10 +8,14 @@ namespace Library
 {
 	class Bone;
 	class BoneAnimation;
+	class Skeleton;
+	class MemoryArena;
 
 	class AnimationClip
 	{
-		friend class Model;
+		friend class AnimationLibrary;
+		friend class AnimationClipArchive;
+		friend class MemoryArena;
 
 	public:
 		~AnimationClip();
@@ -20,30 +24,42 @@ namespace Library
 		float Duration() const;
 		float TicksPerSecond() const;
 		const std::vector<BoneAnimation*>& BoneAnimations() const;
-		const std::map<Bone*, BoneAnimation*>& BoneAnimationsByBone() const;
+		const std::vector<BoneAnimation*>& BoneAnimationsByBoneIndex() const;
+		BoneAnimation* FindBoneAnimation(UINT boneIndex) const;
 		const UINT KeyframeCount() const;
+		size_t SizeInBytes() const;
 
-		UINT GetTransform(float time, Bone& bone, XMFLOAT4X4& transform) const;
+		static size_t EstimateArenaSize(const aiAnimation& animation);
+
+		UINT GetTransform(float time, UINT boneIndex, XMFLOAT4X4& transform) const;
+		UINT GetTransform(float time, const Bone& bone, XMFLOAT4X4& transform) const;
 		void GetTransforms(float time, std::vector<XMFLOAT4X4>& boneTransforms) const;
 
-		void GetTransformAtKeyframe(UINT keyframe, Bone& bone, XMFLOAT4X4& transform) const;
+		void GetTransformAtKeyframe(UINT keyframe, UINT boneIndex, XMFLOAT4X4& transform) const;
+		void GetTransformAtKeyframe(UINT keyframe, const Bone& bone, XMFLOAT4X4& transform) const;
 		void GetTransformsAtKeyframe(UINT keyframe, std::vector<XMFLOAT4X4>& boneTransforms) const;
 
-		void GetInteropolatedTransform(float time, Bone& bone, XMFLOAT4X4& transform) const;
+		void GetInteropolatedTransform(float time, UINT boneIndex, XMFLOAT4X4& transform) const;
+		void GetInteropolatedTransform(float time, const Bone& bone, XMFLOAT4X4& transform) const;
 		void GetInteropolatedTransforms(float time, std::vector<XMFLOAT4X4>& boneTransforms) const;
 
 	private:
-		AnimationClip(Model& model, aiAnimation& animation);
+		AnimationClip(const Skeleton& skeleton, aiAnimation& animation, MemoryArena& arena);
+		AnimationClip(const Skeleton& skeleton, std::istream& stream, size_t arenaSize);
 
 		AnimationClip();
 		AnimationClip(const AnimationClip& rhs);
 		AnimationClip& operator=(const AnimationClip& rhs);
 
+		void AddBoneAnimation(BoneAnimation* boneAnimation);
+		void Write(std::ostream& stream) const;
+
+		std::unique_ptr<MemoryArena> mOwnedArena;		// Set for clips decoded on their own; library clips share the library's arena
 		std::string mName;
 		float mDuration;
 		float mTicksPerSecond;
 		std::vector<BoneAnimation*> mBoneAnimations;
-		std::map<Bone*, BoneAnimation*> mBoneAnimationsByBone;
+		std::vector<BoneAnimation*> mBoneAnimationsByBoneIndex;	// Indexed by skeleton bone index; null for bones without a channel
 		UINT mKeyframeCount;
 	};
 }
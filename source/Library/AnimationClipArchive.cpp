@@ -0,0 +1,174 @@
+#include "AnimationClipArchive.h"
+#include "AnimationClip.h"
+#include "AnimationLibrary.h"
+#include "Skeleton.h"
+#include "StreamHelper.h"
+#include "GameException.h"
+#include "MemoryTracker.h"
+#include <fstream>
+#include <sstream>
+
+namespace Library
+{
+	const UINT AnimationClipArchive::Signature = 0x41434C50;	// "ACLP"
+	const UINT AnimationClipArchive::Version = 1;
+
+	AnimationClipArchive::AnimationClipArchive(const std::string& filename)
+		: mFilename(filename), mBoneCount(0), mEntries(), mEntryIndexMapping()
+	{
+		std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+		if (file.bad() || file.is_open() == false)
+		{
+			throw GameException("Could not open animation clip archive.");
+		}
+
+		UINT signature;
+		UINT version;
+		StreamHelper::Read(file, signature);
+		StreamHelper::Read(file, version);
+		if (signature != Signature || version != Version)
+		{
+			throw GameException("Unsupported animation clip archive.");
+		}
+
+		UINT entryCount;
+		StreamHelper::Read(file, mBoneCount);
+		StreamHelper::Read(file, entryCount);
+
+		mEntries.resize(entryCount);
+		for (UINT i = 0; i < entryCount; i++)
+		{
+			Entry& entry = mEntries[i];
+			StreamHelper::ReadString(file, entry.Name);
+			StreamHelper::Read(file, entry.Offset);
+			StreamHelper::Read(file, entry.Size);
+			StreamHelper::Read(file, entry.Duration);
+
+			mEntryIndexMapping[entry.Name] = i;
+		}
+	}
+
+	const std::string& AnimationClipArchive::Filename() const
+	{
+		return mFilename;
+	}
+
+	UINT AnimationClipArchive::BoneCount() const
+	{
+		return mBoneCount;
+	}
+
+	const std::vector<AnimationClipArchive::Entry>& AnimationClipArchive::Entries() const
+	{
+		return mEntries;
+	}
+
+	bool AnimationClipArchive::TryGetEntryIndex(const std::string& clipName, UINT& entryIndex) const
+	{
+		auto foundEntry = mEntryIndexMapping.find(clipName);
+		if (foundEntry == mEntryIndexMapping.end())
+		{
+			return false;
+		}
+
+		entryIndex = foundEntry->second;
+		return true;
+	}
+
+	AnimationClip* AnimationClipArchive::ReadClip(UINT entryIndex, const Skeleton& skeleton) const
+	{
+		MemoryScope memoryScope(MemorySubsystemAnimation);
+
+		if (skeleton.BoneCount() != mBoneCount)
+		{
+			throw GameException("Animation clip archive was written for a different skeleton.");
+		}
+
+		const Entry& entry = mEntries.at(entryIndex);
+
+		std::ifstream file(mFilename.c_str(), std::ios::in | std::ios::binary);
+		if (file.bad() || file.is_open() == false)
+		{
+			throw GameException("Could not open animation clip archive.");
+		}
+
+		// Pull the whole entry in with one read and decode from memory
+		std::string data(entry.Size, '\0');
+		file.seekg(static_cast<std::streamoff>(entry.Offset));
+		if (entry.Size > 0)
+		{
+			file.read(&data[0], entry.Size);
+		}
+
+		if (file.fail())
+		{
+			throw GameException("Animation clip archive is truncated.");
+		}
+
+		// Decoded keyframes carry a pointer each on top of their encoded size
+		std::istringstream stream(data);
+		return new AnimationClip(skeleton, stream, entry.Size * 2);
+	}
+
+	void AnimationClipArchive::Write(const std::string& filename, const Skeleton& skeleton, const std::vector<AnimationClip*>& clips)
+	{
+		// Encode the clips first so the table of contents can be written with final offsets
+		std::vector<std::string> encodedClips;
+		encodedClips.reserve(clips.size());
+
+		std::map<std::string, UINT> clipNames;
+		UINT64 tableSize = sizeof(UINT) * 4;
+		for (AnimationClip* clip : clips)
+		{
+			if (clipNames.insert(std::pair<std::string, UINT>(clip->Name(), encodedClips.size())).second == false)
+			{
+				throw GameException("Animation clip names must be unique within an archive.");
+			}
+
+			std::ostringstream stream(std::ios::out | std::ios::binary);
+			clip->Write(stream);
+			encodedClips.push_back(stream.str());
+
+			tableSize += sizeof(UINT) + clip->Name().size() + sizeof(UINT64) + sizeof(UINT) + sizeof(float);
+		}
+
+		std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (file.bad() || file.is_open() == false)
+		{
+			throw GameException("Could not create animation clip archive.");
+		}
+
+		StreamHelper::Write(file, Signature);
+		StreamHelper::Write(file, Version);
+		StreamHelper::Write(file, skeleton.BoneCount());
+		StreamHelper::Write(file, static_cast<UINT>(clips.size()));
+
+		UINT64 offset = tableSize;
+		for (UINT i = 0; i < clips.size(); i++)
+		{
+			UINT size = encodedClips[i].size();
+
+			StreamHelper::WriteString(file, clips[i]->Name());
+			StreamHelper::Write(file, offset);
+			StreamHelper::Write(file, size);
+			StreamHelper::Write(file, clips[i]->Duration());
+
+			offset += size;
+		}
+
+		for (const std::string& encodedClip : encodedClips)
+		{
+			file.write(encodedClip.c_str(), encodedClip.size());
+		}
+
+		if (file.fail())
+		{
+			throw GameException("Could not write animation clip archive.");
+		}
+	}
+
+	void AnimationClipArchive::Write(const std::string& filename, const AnimationLibrary& library)
+	{
+		Write(filename, *(library.GetSkeleton()), library.Clips());
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	class Skeleton;
+	class AnimationClip;
+	class AnimationLibrary;
+
+	// A seekable file of encoded animation clips. The table of contents is read up front; clip data stays
+	// on disk until ReadClip decodes a single entry. ReadClip opens its own stream and may be called from any thread.
+	class AnimationClipArchive
+	{
+	public:
+		struct Entry
+		{
+			std::string Name;
+			UINT64 Offset;
+			UINT Size;
+			float Duration;
+
+			Entry()
+				: Name(), Offset(0), Size(0), Duration(0.0f) { }
+		};
+
+		AnimationClipArchive(const std::string& filename);
+
+		const std::string& Filename() const;
+		UINT BoneCount() const;
+		const std::vector<Entry>& Entries() const;
+		bool TryGetEntryIndex(const std::string& clipName, UINT& entryIndex) const;
+
+		AnimationClip* ReadClip(UINT entryIndex, const Skeleton& skeleton) const;
+
+		static void Write(const std::string& filename, const Skeleton& skeleton, const std::vector<AnimationClip*>& clips);
+		static void Write(const std::string& filename, const AnimationLibrary& library);
+
+	private:
+		AnimationClipArchive();
+		AnimationClipArchive(const AnimationClipArchive& rhs);
+		AnimationClipArchive& operator=(const AnimationClipArchive& rhs);
+
+		static const UINT Signature;
+		static const UINT Version;
+
+		std::string mFilename;
+		UINT mBoneCount;
+		std::vector<Entry> mEntries;
+		std::map<std::string, UINT> mEntryIndexMapping;
+	};
+}
@@ -0,0 +1,88 @@
+#include "AnimationLibrary.h"
+#include "AnimationClip.h"
+#include "Skeleton.h"
+#include "MemoryArena.h"
+#include "MemoryTracker.h"
+#include "GameException.h"
+#include "Importer.hpp"
+#include "scene.h"
+
+namespace Library
+{
+	AnimationLibrary::AnimationLibrary(std::shared_ptr<Skeleton> skeleton)
+		: mArena(new MemoryArena()), mSkeleton(skeleton), mClips(), mClipsByName()
+	{
+		if (mSkeleton == nullptr)
+		{
+			throw GameException("An animation library requires a skeleton.");
+		}
+	}
+
+	AnimationLibrary::~AnimationLibrary()
+	{
+		// Clips are destroyed with the arena
+	}
+
+	std::shared_ptr<Skeleton> AnimationLibrary::GetSkeleton() const
+	{
+		return mSkeleton;
+	}
+
+	bool AnimationLibrary::HasClips() const
+	{
+		return (mClips.size() > 0);
+	}
+
+	const std::vector<AnimationClip*>& AnimationLibrary::Clips() const
+	{
+		return mClips;
+	}
+
+	const std::map<std::string, AnimationClip*>& AnimationLibrary::ClipsByName() const
+	{
+		return mClipsByName;
+	}
+
+	AnimationClip* AnimationLibrary::FindClip(const std::string& name) const
+	{
+		auto foundClip = mClipsByName.find(name);
+
+		return (foundClip != mClipsByName.end() ? foundClip->second : nullptr);
+	}
+
+	void AnimationLibrary::LoadClips(const std::string& filename)
+	{
+		// Animation-only files for the same rig need no geometry post-processing
+		MemoryScope memoryScope(MemorySubsystemAnimation);
+		Assimp::Importer importer;
+
+		const aiScene* scene = importer.ReadFile(filename, 0);
+		if (scene == nullptr)
+		{
+			throw GameException(importer.GetErrorString());
+		}
+
+		AddClips(*scene);
+	}
+
+	void AnimationLibrary::AddClips(const aiScene& scene)
+	{
+		MemoryScope memoryScope(MemorySubsystemAnimation);
+
+		size_t arenaSize = 0;
+		for (UINT i = 0; i < scene.mNumAnimations; i++)
+		{
+			arenaSize += sizeof(AnimationClip) + AnimationClip::EstimateArenaSize(*(scene.mAnimations[i]));
+		}
+
+		mArena->Reserve(arenaSize);
+		mClips.reserve(mClips.size() + scene.mNumAnimations);
+		for (UINT i = 0; i < scene.mNumAnimations; i++)
+		{
+			AnimationClip* clip = mArena->Create<AnimationClip>(*mSkeleton, *(scene.mAnimations[i]), *mArena);
+
+			mClips.push_back(clip);
+			mClipsByName.insert(std::pair<std::string, AnimationClip*>(clip->Name(), clip));
+		}
+	}
+}
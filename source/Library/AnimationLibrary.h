@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Common.h"
+
+struct aiScene;
+
+namespace Library
+{
+	class Skeleton;
+	class AnimationClip;
+	class MemoryArena;
+
+	// A set of animation clips bound to a single skeleton. Models that share a rig share one library,
+	// so every clip is decoded and stored once regardless of how many models play it.
+	// Clips are allocated from the library's own arena, so a shared library outlives the model that loaded it without
+	// keeping that model's memory alive.
+	class AnimationLibrary
+	{
+		friend class Model;
+
+	public:
+		AnimationLibrary(std::shared_ptr<Skeleton> skeleton);
+		~AnimationLibrary();
+
+		std::shared_ptr<Skeleton> GetSkeleton() const;
+		bool HasClips() const;
+		const std::vector<AnimationClip*>& Clips() const;
+		const std::map<std::string, AnimationClip*>& ClipsByName() const;
+		AnimationClip* FindClip(const std::string& name) const;
+
+		void LoadClips(const std::string& filename);
+
+	private:
+		AnimationLibrary();
+		AnimationLibrary(const AnimationLibrary& rhs);
+		AnimationLibrary& operator=(const AnimationLibrary& rhs);
+
+		void AddClips(const aiScene& scene);
+
+		std::unique_ptr<MemoryArena> mArena;
+		std::shared_ptr<Skeleton> mSkeleton;
+		std::vector<AnimationClip*> mClips;
+		std::map<std::string, AnimationClip*> mClipsByName;
+	};
+}
@@ -2,7 +2,10 @@
 #include "GameTime.h"
 #include "Model.h"
 #include "Bone.h"
+#include "Skeleton.h"
 #include "AnimationClip.h"
+#include "StreamingAnimationLibrary.h"
+#include "GameException.h"
 #include "BoneAnimation.h"
 #include "Keyframe.h"
 #include "MatrixHelper.h"
@@ -13,10 +16,18 @@ namespace Library
 
 		AnimationPlayer::AnimationPlayer(Game& game, Model& model, bool interpolationEnabled)
 		: GameComponent(game),
-		mModel(&model), mCurrentClip(nullptr), mCurrentTime(0.0f), mCurrentKeyframe(0U), mToRootTransforms(), mFinalTransforms(),
+		mModel(&model), mSkeleton(model.GetSkeleton()), mCurrentClip(nullptr), mStreamingLibrary(nullptr), mCurrentTime(0.0f), mCurrentKeyframe(0U), mPose(), mFinalTransforms(),
 		mInverseRootTransform(MatrixHelper::Identity), mInterpolationEnabled(interpolationEnabled), mIsPlayingClip(false), mIsClipLooped(true)
 	{
 		mFinalTransforms.resize(model.Bones().size());
+
+		DeclareRead(mModel);
+		DeclareWrite(this);
+	}
+
+	AnimationPlayer::~AnimationPlayer()
+	{
+		ReleaseStreamedClip();
 	}
 
 	const Model& AnimationPlayer::GetModel() const
@@ -66,14 +77,30 @@ namespace Library
 
 	void AnimationPlayer::StartClip(AnimationClip& clip)
 	{
+		ReleaseStreamedClip();
+
 		mCurrentClip = &clip;
 		mCurrentTime = 0.0f;
 		mCurrentKeyframe = 0;
 		mIsPlayingClip = true;
 
-		XMMATRIX inverseRootTransform = XMMatrixInverse(&XMMatrixDeterminant(mModel->RootNode()->TransformMatrix()), mModel->RootNode()->TransformMatrix());
+		XMMATRIX rootTransform = mSkeleton->Hierarchy().LocalTransformMatrix(mSkeleton->RootTransform());
+		XMMATRIX inverseRootTransform = XMMatrixInverse(&XMMatrixDeterminant(rootTransform), rootTransform);
 		XMStoreFloat4x4(&mInverseRootTransform, inverseRootTransform);
-		GetBindPose(*(mModel->RootNode()));
+		GetBindPose();
+	}
+
+	void AnimationPlayer::StartClip(StreamingAnimationLibrary& library, const std::string& clipName)
+	{
+		if (library.GetSkeleton() != mModel->GetSkeleton())
+		{
+			throw GameException("Streaming animation library is bound to a different skeleton.");
+		}
+
+		// Pin the new clip before releasing the current one so restarting a clip never evicts it
+		AnimationClip* clip = library.Acquire(clipName);
+		StartClip(*clip);
+		mStreamingLibrary = &library;
 	}
 
 	void AnimationPlayer::PauseClip()
@@ -111,11 +138,11 @@ namespace Library
 
 			if (mInterpolationEnabled)
 			{
-				GetInterpolatedPose(mCurrentTime, *(mModel->RootNode()));
+				GetInterpolatedPose(mCurrentTime);
 			}
 			else
 			{
-				GetPose(mCurrentTime, *(mModel->RootNode()));
+				GetPose(mCurrentTime);
 			}
 		}
 	}
@@ -123,128 +150,92 @@ namespace Library
 	void AnimationPlayer::SetCurrentKeyFrame(UINT keyframe)
 	{
 		mCurrentKeyframe = keyframe;
-		GetPoseAtKeyframe(mCurrentKeyframe, *(mModel->RootNode()));
+		GetPoseAtKeyframe(mCurrentKeyframe);
 	}
 
-	void AnimationPlayer::GetBindPoseBottomUp(SceneNode& sceneNode)
+	void AnimationPlayer::ReleaseStreamedClip()
 	{
-		XMMATRIX toRootTransform = sceneNode.TransformMatrix();
-
-		SceneNode* parentNode = sceneNode.GetParent();
-		while (parentNode != nullptr)
+		if (mStreamingLibrary != nullptr)
 		{
-			toRootTransform = toRootTransform * parentNode->TransformMatrix();
-			parentNode = parentNode->GetParent();
-		}
-
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
-		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() *  toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
+			assert(mCurrentClip != nullptr);
+			mStreamingLibrary->Release(*mCurrentClip);
+			mStreamingLibrary = nullptr;
 		}
+	}
 
-		for (SceneNode* childNode : sceneNode.Children())
-		{
-			GetBindPoseBottomUp(*childNode);
-		}
+	void AnimationPlayer::GetBindPose()
+	{
+		mPose = mSkeleton->Hierarchy();
+		UpdateFinalTransforms(true);
 	}
 
-	void AnimationPlayer::GetBindPose(SceneNode& sceneNode)
+	void AnimationPlayer::GetPose(float time)
 	{
-		XMMATRIX toParentTransform = sceneNode.TransformMatrix();
-		XMMATRIX toRootTransform = (sceneNode.GetParent() != nullptr ? toParentTransform * XMLoadFloat4x4(&(mToRootTransforms.at(sceneNode.GetParent()))) : toParentTransform);
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);
+		const std::vector<TransformHierarchy::Handle>& boneTransforms = mSkeleton->BoneTransforms();
+		XMFLOAT4X4 toParentTransform;
 
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
+		for (UINT i = 0; i < boneTransforms.size(); i++)
 		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
+			if (boneTransforms[i] != TransformHierarchy::InvalidHandle)
+			{
+				mCurrentKeyframe = mCurrentClip->GetTransform(time, i, toParentTransform);
+				mPose.SetLocalTransform(boneTransforms[i], toParentTransform);
+			}
 		}
 
-		for (SceneNode* childNode : sceneNode.Children())
-		{
-			GetBindPose(*childNode);
-		}
+		UpdateFinalTransforms();
 	}
 
-	void AnimationPlayer::GetPose(float time, SceneNode& sceneNode)
+	void AnimationPlayer::GetPoseAtKeyframe(UINT keyframe)
 	{
+		const std::vector<TransformHierarchy::Handle>& boneTransforms = mSkeleton->BoneTransforms();
 		XMFLOAT4X4 toParentTransform;
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
-		{
-			mCurrentKeyframe = mCurrentClip->GetTransform(time, *bone, toParentTransform);
-		}
-		else
-		{
-			toParentTransform = sceneNode.Transform();
-		}
 
-		XMMATRIX toRootTransform = (sceneNode.GetParent() != nullptr ? XMLoadFloat4x4(&toParentTransform) * XMLoadFloat4x4(&(mToRootTransforms.at(sceneNode.GetParent()))) : XMLoadFloat4x4(&toParentTransform));
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);
-
-		if (bone != nullptr)
+		for (UINT i = 0; i < boneTransforms.size(); i++)
 		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
+			if (boneTransforms[i] != TransformHierarchy::InvalidHandle)
+			{
+				mCurrentClip->GetTransformAtKeyframe(keyframe, i, toParentTransform);
+				mPose.SetLocalTransform(boneTransforms[i], toParentTransform);
+			}
 		}
 
-		for (SceneNode* childNode : sceneNode.Children())
-		{
-			GetPose(time, *childNode);
-		}
+		UpdateFinalTransforms();
 	}
 
-	void AnimationPlayer::GetPoseAtKeyframe(UINT keyframe, SceneNode& sceneNode)
+	void AnimationPlayer::GetInterpolatedPose(float time)
 	{
+		const std::vector<TransformHierarchy::Handle>& boneTransforms = mSkeleton->BoneTransforms();
 		XMFLOAT4X4 toParentTransform;
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
-		{
-			mCurrentClip->GetTransformAtKeyframe(keyframe, *bone, toParentTransform);
-		}
-		else
-		{
-			toParentTransform = sceneNode.Transform();
-		}
-
-		XMMATRIX toRootTransform = (sceneNode.GetParent() != nullptr ? XMLoadFloat4x4(&toParentTransform) * XMLoadFloat4x4(&(mToRootTransforms.at(sceneNode.GetParent()))) : XMLoadFloat4x4(&toParentTransform));
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);
 
-		if (bone != nullptr)
+		for (UINT i = 0; i < boneTransforms.size(); i++)
 		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
+			if (boneTransforms[i] != TransformHierarchy::InvalidHandle)
+			{
+				mCurrentClip->GetInteropolatedTransform(time, i, toParentTransform);
+				mPose.SetLocalTransform(boneTransforms[i], toParentTransform);
+			}
 		}
 
-		for (SceneNode* childNode : sceneNode.Children())
-		{
-			GetPoseAtKeyframe(keyframe, *childNode);
-		}
+		UpdateFinalTransforms();
 	}
 
-	void AnimationPlayer::GetInterpolatedPose(float time, SceneNode& sceneNode)
+	void AnimationPlayer::UpdateFinalTransforms(bool updateAllBones)
 	{
-		XMFLOAT4X4 toParentTransform;
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
-		{
-			mCurrentClip->GetInteropolatedTransform(time, *bone, toParentTransform);
-		}
-		else
-		{
-			toParentTransform = sceneNode.Transform();
-		}
-
-		XMMATRIX toRootTransform = (sceneNode.GetParent() != nullptr ? XMLoadFloat4x4(&toParentTransform) * XMLoadFloat4x4(&(mToRootTransforms.at(sceneNode.GetParent()))) : XMLoadFloat4x4(&toParentTransform));
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);
+		// Non-bone nodes keep their bind-pose locals; the forward pass only revisits bones whose pose or ancestors moved.
+		// Levels too small to split, as most skeletons' are, run on this thread.
+		mPose.UpdateParallel();
 
-		if (bone != nullptr)
-		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
-		}
+		const std::vector<Bone*>& bones = mSkeleton->Bones();
+		const std::vector<TransformHierarchy::Handle>& boneTransforms = mSkeleton->BoneTransforms();
+		XMMATRIX inverseRootTransform = XMLoadFloat4x4(&mInverseRootTransform);
 
-		for (SceneNode* childNode : sceneNode.Children())
+		for (UINT i = 0; i < boneTransforms.size(); i++)
 		{
-			GetInterpolatedPose(time, *childNode);
+			if (boneTransforms[i] != TransformHierarchy::InvalidHandle && (updateAllBones || mPose.HasChanged(boneTransforms[i])))
+			{
+				XMStoreFloat4x4(&(mFinalTransforms[i]), bones[i]->OffsetTransformMatrix() * mPose.WorldTransformMatrix(boneTransforms[i]) * inverseRootTransform);
+			}
 		}
 	}
 }
@@ -1,13 +1,15 @@
 #pragma once
 
 #include "GameComponent.h"
+#include "TransformHierarchy.h"
 
 namespace Library
 {
 	class GameTime;
 	class Model;
-	class SceneNode;
+	class Skeleton;
 	class AnimationClip;
+	class StreamingAnimationLibrary;
 
 	class AnimationPlayer : GameComponent
 	{
@@ -15,6 +17,7 @@ namespace Library
 
 	public:
 		AnimationPlayer(Game& game, Model& model, bool interpolationEnabled = true);
+		~AnimationPlayer();
 
 		const Model& GetModel() const;
 		const AnimationClip* CurrentClip() const;
@@ -29,6 +32,7 @@ namespace Library
 		void SetInterpolationEnabled(bool interpolationEnabled);
 
 		void StartClip(AnimationClip& clip);
+		void StartClip(StreamingAnimationLibrary& library, const std::string& clipName);
 		void PauseClip();
 		void ResumeClip();
 		virtual void Update(const GameTime& gameTime) override;
@@ -39,17 +43,20 @@ namespace Library
 		AnimationPlayer(const AnimationPlayer& rhs);
 		AnimationPlayer& operator=(const AnimationPlayer& rhs);
 
-		void GetBindPose(SceneNode& sceneNode);
-		void GetBindPoseBottomUp(SceneNode& sceneNode);
-		void GetPose(float time, SceneNode& sceneNode);
-		void GetPoseAtKeyframe(UINT keyframe, SceneNode& sceneNode);
-		void GetInterpolatedPose(float time, SceneNode& sceneNode);
+		void ReleaseStreamedClip();
+		void GetBindPose();
+		void GetPose(float time);
+		void GetPoseAtKeyframe(UINT keyframe);
+		void GetInterpolatedPose(float time);
+		void UpdateFinalTransforms(bool updateAllBones = false);
 
 		Model* mModel;
+		std::shared_ptr<Skeleton> mSkeleton;
 		AnimationClip* mCurrentClip;
+		StreamingAnimationLibrary* mStreamingLibrary;	// Library holding a pin on mCurrentClip, if any
 		float mCurrentTime;
 		UINT mCurrentKeyframe;
-		std::map<SceneNode*, XMFLOAT4X4> mToRootTransforms;
+		TransformHierarchy mPose;
 		std::vector<XMFLOAT4X4> mFinalTransforms;
 		XMFLOAT4X4 mInverseRootTransform;
 		bool mInterpolationEnabled;
@@ -0,0 +1,375 @@
+#include "AssetLoader.h"
+#include "ClockSource.h"
+#include "Game.h"
+#include "GameException.h"
+#include "ModelCache.h"
+#include "Utility.h"
+#include "MemoryTracker.h"
+#include <WICTextureLoader.h>
+#include <DDSTextureLoader.h>
+#include <algorithm>
+#include <fstream>
+
+namespace Library
+{
+	AssetLoader::AssetLoader(Game& game, JobSystem& jobSystem)
+		: mGame(game), mJobSystem(jobSystem), mEntries(), mStartMilliseconds(RealClockSource::Milliseconds()),
+		  mTimelineMutex(), mTimeline(), mThreadIds(), mStatistics()
+	{
+		mThreadIds.push_back(std::this_thread::get_id());
+		mStatistics.ThreadCount = 1;
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		Clear();
+	}
+
+	void AssetLoader::Request(const AssetRequest& request)
+	{
+		mStatistics.RequestCount++;
+
+		std::wstring key = MakeKey(request);
+		if (FindEntry(key) != nullptr)
+		{
+			mStatistics.CollapsedRequests++;
+			return;
+		}
+
+		// Jobs load by absolute path, since the working directory may change while they run
+		AssetRequest resolvedRequest(request.Type, key, request.FlipUVs);
+		Entry* entry = new Entry(resolvedRequest);
+		mEntries.insert(std::pair<std::wstring, Entry*>(key, entry));
+
+		if (request.Type == AssetTypeModel)
+		{
+			mGame.Models().LoadAsync(Utility::ToUtf8String(key), request.FlipUVs);
+		}
+		else
+		{
+			mJobSystem.Run([this, entry]() { Load(*entry); }, entry->Remaining);
+		}
+	}
+
+	void AssetLoader::WaitFor(const std::vector<AssetRequest>& requests)
+	{
+		std::vector<Entry*> entries;
+		for (const AssetRequest& request : requests)
+		{
+			Entry* entry = FindEntry(MakeKey(request));
+			if (entry != nullptr)
+			{
+				WaitForLoad(*entry);
+				entries.push_back(entry);
+			}
+		}
+
+		CompleteFinishedLoads();
+
+		for (Entry* entry : entries)
+		{
+			if (entry->Exception != nullptr)
+			{
+				std::rethrow_exception(entry->Exception);
+			}
+		}
+	}
+
+	void AssetLoader::WaitForAll()
+	{
+		for (auto& keyAndEntry : mEntries)
+		{
+			WaitForLoad(*(keyAndEntry.second));
+		}
+
+		CompleteFinishedLoads();
+
+		for (auto& keyAndEntry : mEntries)
+		{
+			if (keyAndEntry.second->Exception != nullptr)
+			{
+				std::rethrow_exception(keyAndEntry.second->Exception);
+			}
+		}
+	}
+
+	void AssetLoader::LoadFile(const std::wstring& filename, std::vector<char>& data)
+	{
+		Entry* entry = FindEntry(MakeKey(AssetRequest(AssetTypeEffect, filename)));
+		if (entry == nullptr)
+		{
+			Utility::LoadBinaryFile(filename, data);
+			return;
+		}
+
+		WaitFor(std::vector<AssetRequest>(1, entry->Request));
+		data = entry->Data;
+	}
+
+	ID3D11ShaderResourceView* AssetLoader::AcquireTexture(const std::wstring& filename)
+	{
+		Entry* entry = FindEntry(MakeKey(AssetRequest(AssetTypeTexture, filename)));
+		if (entry == nullptr)
+		{
+			std::vector<char> data;
+			Utility::LoadBinaryFile(filename, data);
+
+			return CreateTexture(mGame, filename, data);
+		}
+
+		WaitFor(std::vector<AssetRequest>(1, entry->Request));
+		if (entry->Texture != nullptr)
+		{
+			entry->Texture->AddRef();
+		}
+
+		return entry->Texture;
+	}
+
+	void AssetLoader::Clear()
+	{
+		for (auto& keyAndEntry : mEntries)
+		{
+			Entry* entry = keyAndEntry.second;
+			mJobSystem.Wait(entry->Remaining);
+			ReleaseObject(entry->Texture);
+			delete entry;
+		}
+
+		mEntries.clear();
+	}
+
+	double AssetLoader::ElapsedMilliseconds() const
+	{
+		return RealClockSource::Milliseconds() - mStartMilliseconds;
+	}
+
+	void AssetLoader::RecordSpan(const std::wstring& name, double startMilliseconds, double endMilliseconds)
+	{
+		UINT threadIndex = ThreadIndex();
+
+		TimelineEntry timelineEntry = { name, threadIndex, startMilliseconds, endMilliseconds };
+		std::lock_guard<std::mutex> lock(mTimelineMutex);
+		mTimeline.push_back(timelineEntry);
+	}
+
+	const std::vector<AssetLoader::TimelineEntry>& AssetLoader::Timeline() const
+	{
+		return mTimeline;
+	}
+
+	const AssetLoader::Statistics& AssetLoader::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void AssetLoader::WriteTimeline(const std::wstring& filename) const
+	{
+		std::ofstream file(filename.c_str());
+		if (file.bad())
+		{
+			throw GameException("Could not open the timeline file for writing.");
+		}
+
+		file << "[";
+		for (UINT i = 0; i < mTimeline.size(); i++)
+		{
+			const TimelineEntry& timelineEntry = mTimeline[i];
+
+			std::string name = Utility::ToUtf8String(timelineEntry.Name);
+			std::replace(name.begin(), name.end(), '\\', '/');
+			std::replace(name.begin(), name.end(), '"', '\'');
+
+			// Trace events are timed in microseconds
+			file << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << timelineEntry.ThreadIndex
+				<< ",\"ts\":" << static_cast<UINT64>(timelineEntry.StartMilliseconds * 1000.0)
+				<< ",\"dur\":" << static_cast<UINT64>((timelineEntry.EndMilliseconds - timelineEntry.StartMilliseconds) * 1000.0) << "}";
+		}
+
+		file << "\n]\n";
+	}
+
+	void AssetLoader::Load(Entry& entry)
+	{
+		double startMilliseconds = ElapsedMilliseconds();
+
+		try
+		{
+			switch (entry.Request.Type)
+			{
+			case AssetTypeEffect:
+			{
+				MemoryScope memoryScope(MemorySubsystemEffects);
+				Utility::LoadBinaryFile(entry.Request.Filename, entry.Data);
+				break;
+			}
+
+			default:
+				Utility::LoadBinaryFile(entry.Request.Filename, entry.Data);
+				break;
+			}
+		}
+		catch (...)
+		{
+			entry.Exception = std::current_exception();
+		}
+
+		double endMilliseconds = ElapsedMilliseconds();
+		RecordSpan(entry.Request.Filename, startMilliseconds, endMilliseconds);
+
+		std::lock_guard<std::mutex> lock(mTimelineMutex);
+		mStatistics.LoadMilliseconds += endMilliseconds - startMilliseconds;
+	}
+
+	void AssetLoader::WaitForLoad(Entry& entry)
+	{
+		if (entry.Request.Type == AssetTypeModel)
+		{
+			WaitForModel(entry);
+		}
+		else
+		{
+			mJobSystem.Wait(entry.Remaining);
+		}
+	}
+
+	void AssetLoader::WaitForModel(Entry& entry)
+	{
+		if (entry.IsCompleted)
+		{
+			return;
+		}
+
+		// Load joins the import LoadAsync started and returns once it has finished, or throws why it failed
+		double startMilliseconds = ElapsedMilliseconds();
+		entry.IsCompleted = true;
+
+		try
+		{
+			mGame.Models().Load(Utility::ToUtf8String(entry.Request.Filename), entry.Request.FlipUVs);
+		}
+		catch (...)
+		{
+			entry.Exception = std::current_exception();
+		}
+
+		RecordSpan(L"Wait for " + entry.Request.Filename, startMilliseconds, ElapsedMilliseconds());
+	}
+
+	void AssetLoader::Complete(Entry& entry)
+	{
+		entry.IsCompleted = true;
+		if (entry.Exception != nullptr)
+		{
+			return;
+		}
+
+		try
+		{
+			if (entry.Request.Type == AssetTypeTexture && mGame.IsHeadless() == false)
+			{
+				entry.Texture = CreateTexture(mGame, entry.Request.Filename, entry.Data);
+				std::vector<char>().swap(entry.Data);
+			}
+		}
+		catch (...)
+		{
+			entry.Exception = std::current_exception();
+		}
+	}
+
+	void AssetLoader::CompleteFinishedLoads()
+	{
+		double startMilliseconds = ElapsedMilliseconds();
+		UINT textureCount = 0;
+
+		for (auto& keyAndEntry : mEntries)
+		{
+			Entry* entry = keyAndEntry.second;
+			if (entry->Request.Type != AssetTypeModel && entry->IsCompleted == false && entry->Remaining == 0)
+			{
+				Complete(*entry);
+				if (entry->Request.Type == AssetTypeTexture)
+				{
+					textureCount++;
+				}
+			}
+		}
+
+		if (textureCount > 0)
+		{
+			mStatistics.TextureBatchCount++;
+			RecordSpan(L"Create textures", startMilliseconds, ElapsedMilliseconds());
+		}
+	}
+
+	AssetLoader::Entry* AssetLoader::FindEntry(const std::wstring& key) const
+	{
+		auto foundEntry = mEntries.find(key);
+
+		return (foundEntry != mEntries.end() ? foundEntry->second : nullptr);
+	}
+
+	UINT AssetLoader::ThreadIndex()
+	{
+		std::thread::id threadId = std::this_thread::get_id();
+
+		std::lock_guard<std::mutex> lock(mTimelineMutex);
+		auto foundThreadId = std::find(mThreadIds.begin(), mThreadIds.end(), threadId);
+		if (foundThreadId != mThreadIds.end())
+		{
+			return static_cast<UINT>(foundThreadId - mThreadIds.begin());
+		}
+
+		mThreadIds.push_back(threadId);
+		mStatistics.ThreadCount = mThreadIds.size();
+
+		return mThreadIds.size() - 1;
+	}
+
+	std::wstring AssetLoader::MakeKey(const AssetRequest& request)
+	{
+		wchar_t fullPath[MAX_PATH];
+		if (GetFullPathName(request.Filename.c_str(), MAX_PATH, fullPath, nullptr) == 0)
+		{
+			throw GameException("GetFullPathName() failed.");
+		}
+
+		std::wstring key(fullPath);
+		std::transform(key.begin(), key.end(), key.begin(), ::towlower);
+
+		return key;
+	}
+
+	ID3D11ShaderResourceView* AssetLoader::CreateTexture(Game& game, const std::wstring& filename, const std::vector<char>& data)
+	{
+		if (data.empty())
+		{
+			throw GameException("Texture file is empty.");
+		}
+
+		std::wstring extension;
+		Utility::GetPathExtension(filename, extension);
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+
+		HRESULT hr;
+		ID3D11ShaderResourceView* texture = nullptr;
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data.front());
+		if (extension == L".dds")
+		{
+			if (FAILED(hr = DirectX::CreateDDSTextureFromMemory(game.Direct3DDevice(), bytes, data.size(), nullptr, &texture)))
+			{
+				throw GameException("CreateDDSTextureFromMemory() failed.", hr);
+			}
+		}
+		else
+		{
+			if (FAILED(hr = DirectX::CreateWICTextureFromMemory(game.Direct3DDevice(), game.Direct3DDeviceContext(), bytes, data.size(), nullptr, &texture)))
+			{
+				throw GameException("CreateWICTextureFromMemory() failed.", hr);
+			}
+		}
+
+		return texture;
+	}
+}
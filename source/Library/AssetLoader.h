@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Common.h"
+#include "JobSystem.h"
+
+namespace Library
+{
+	class Game;
+
+	enum AssetType
+	{
+		AssetTypeModel = 0,
+		AssetTypeEffect,
+		AssetTypeTexture,
+		AssetTypeEnd
+	};
+
+	struct AssetRequest
+	{
+		AssetType Type;
+		std::wstring Filename;
+		bool FlipUVs;				// Models only
+
+		AssetRequest(AssetType type, const std::wstring& filename, bool flipUVs = false)
+			: Type(type), Filename(filename), FlipUVs(flipUVs) { }
+	};
+
+	// Loads the assets components declare ahead of their Initialize, as jobs on the JobSystem, so model imports and file
+	// reads overlap one another and the components already initializing. Models are imported through ModelCache::LoadAsync,
+	// so a component that loads the same file from the cache joins the import instead of repeating it. Requests for the
+	// same file collapse into one load. Nothing a job does touches the device context: effects and textures are only read
+	// from disk, and textures are decoded and created afterwards on the calling thread, in one batch for every load that
+	// has finished by the time a component waits. Compiled effects and textures are handed out through LoadFile and
+	// AcquireTexture, which load synchronously whatever was not requested. File reads, time spent waiting on models and
+	// every span recorded by the caller go on a timeline that shows how startup overlapped.
+	class AssetLoader
+	{
+	public:
+		struct TimelineEntry
+		{
+			std::wstring Name;
+			UINT ThreadIndex;			// Zero for the thread that created the loader
+			double StartMilliseconds;	// Since the loader was created
+			double EndMilliseconds;
+		};
+
+		struct Statistics
+		{
+			UINT RequestCount;
+			UINT CollapsedRequests;
+			UINT TextureBatchCount;
+			UINT ThreadCount;			// Threads that appear on the timeline
+			double LoadMilliseconds;	// Summed over every file read, so it exceeds the elapsed time when reads overlap
+
+			Statistics()
+				: RequestCount(0), CollapsedRequests(0), TextureBatchCount(0), ThreadCount(0), LoadMilliseconds(0.0) { }
+		};
+
+		AssetLoader(Game& game, JobSystem& jobSystem);
+		~AssetLoader();
+
+		// Relative filenames are resolved against the current directory when the request is made
+		void Request(const AssetRequest& request);
+
+		// Blocks until the requested assets are loaded, then creates the Direct3D resources of every finished load and
+		// rethrows the first failure among the requests
+		void WaitFor(const std::vector<AssetRequest>& requests);
+		void WaitForAll();
+
+		void LoadFile(const std::wstring& filename, std::vector<char>& data);
+
+		// Returns a new reference, which the caller releases
+		ID3D11ShaderResourceView* AcquireTexture(const std::wstring& filename);
+
+		// Drops everything loaded, once the components have taken what they need; the timeline is kept
+		void Clear();
+
+		double ElapsedMilliseconds() const;
+		void RecordSpan(const std::wstring& name, double startMilliseconds, double endMilliseconds);
+		const std::vector<TimelineEntry>& Timeline() const;
+		const Statistics& GetStatistics() const;
+
+		// In the Trace Event format, for chrome://tracing
+		void WriteTimeline(const std::wstring& filename) const;
+
+	private:
+		struct Entry
+		{
+			AssetRequest Request;
+			JobSystem::Counter Remaining;	// Models are imported by the cache and never have a job of their own
+			std::vector<char> Data;
+			ID3D11ShaderResourceView* Texture;
+			std::exception_ptr Exception;
+			bool IsCompleted;			// Set by the calling thread once the model is cached or the Direct3D resources exist
+
+			Entry(const AssetRequest& request)
+				: Request(request), Remaining(0), Data(), Texture(nullptr), Exception(), IsCompleted(false) { }
+		};
+
+		AssetLoader();
+		AssetLoader(const AssetLoader& rhs);
+		AssetLoader& operator=(const AssetLoader& rhs);
+
+		void Load(Entry& entry);
+		void WaitForLoad(Entry& entry);
+		void WaitForModel(Entry& entry);
+		void Complete(Entry& entry);
+		void CompleteFinishedLoads();
+		Entry* FindEntry(const std::wstring& key) const;
+		UINT ThreadIndex();
+
+		static std::wstring MakeKey(const AssetRequest& request);
+		static ID3D11ShaderResourceView* CreateTexture(Game& game, const std::wstring& filename, const std::vector<char>& data);
+
+		Game& mGame;
+		JobSystem& mJobSystem;
+		std::map<std::wstring, Entry*> mEntries;
+		double mStartMilliseconds;
+
+		std::mutex mTimelineMutex;
+		std::vector<TimelineEntry> mTimeline;
+		std::vector<std::thread::id> mThreadIds;
+		Statistics mStatistics;
+	};
+}
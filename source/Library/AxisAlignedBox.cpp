@@ -0,0 +1,131 @@
+#include "AxisAlignedBox.h"
+#include "Ray.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace Library
+{
+	AxisAlignedBox::AxisAlignedBox()
+		: Minimum(FLT_MAX, FLT_MAX, FLT_MAX), Maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX)
+	{
+	}
+
+	AxisAlignedBox::AxisAlignedBox(const XMFLOAT3& minimum, const XMFLOAT3& maximum)
+		: Minimum(minimum), Maximum(maximum)
+	{
+	}
+
+	AxisAlignedBox AxisAlignedBox::Union(const AxisAlignedBox& lhs, const AxisAlignedBox& rhs)
+	{
+		AxisAlignedBox box(lhs);
+		box.Merge(rhs);
+
+		return box;
+	}
+
+	bool AxisAlignedBox::IsEmpty() const
+	{
+		return (Minimum.x > Maximum.x || Minimum.y > Maximum.y || Minimum.z > Maximum.z);
+	}
+
+	XMFLOAT3 AxisAlignedBox::Center() const
+	{
+		return XMFLOAT3((Minimum.x + Maximum.x) * 0.5f, (Minimum.y + Maximum.y) * 0.5f, (Minimum.z + Maximum.z) * 0.5f);
+	}
+
+	XMFLOAT3 AxisAlignedBox::Extents() const
+	{
+		return XMFLOAT3((Maximum.x - Minimum.x) * 0.5f, (Maximum.y - Minimum.y) * 0.5f, (Maximum.z - Minimum.z) * 0.5f);
+	}
+
+	float AxisAlignedBox::SurfaceArea() const
+	{
+		float width = Maximum.x - Minimum.x;
+		float height = Maximum.y - Minimum.y;
+		float depth = Maximum.z - Minimum.z;
+
+		return 2.0f * (width * height + height * depth + depth * width);
+	}
+
+	bool AxisAlignedBox::Contains(const AxisAlignedBox& box) const
+	{
+		return (Minimum.x <= box.Minimum.x && Minimum.y <= box.Minimum.y && Minimum.z <= box.Minimum.z &&
+			Maximum.x >= box.Maximum.x && Maximum.y >= box.Maximum.y && Maximum.z >= box.Maximum.z);
+	}
+
+	bool AxisAlignedBox::Overlaps(const AxisAlignedBox& box) const
+	{
+		return (Minimum.x <= box.Maximum.x && Maximum.x >= box.Minimum.x &&
+			Minimum.y <= box.Maximum.y && Maximum.y >= box.Minimum.y &&
+			Minimum.z <= box.Maximum.z && Maximum.z >= box.Minimum.z);
+	}
+
+	bool AxisAlignedBox::Intersects(const Ray& ray, float maxDistance, float& distance) const
+	{
+		// Slab test; distances are measured in multiples of the ray's direction vector
+		const float* position = reinterpret_cast<const float*>(&ray.Position());
+		const float* direction = reinterpret_cast<const float*>(&ray.Direction());
+		const float* minimum = reinterpret_cast<const float*>(&Minimum);
+		const float* maximum = reinterpret_cast<const float*>(&Maximum);
+
+		float nearest = 0.0f;
+		float farthest = maxDistance;
+
+		for (UINT axis = 0; axis < 3; axis++)
+		{
+			if (direction[axis] == 0.0f)
+			{
+				if (position[axis] < minimum[axis] || position[axis] > maximum[axis])
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			float inverseDirection = 1.0f / direction[axis];
+			float entry = (minimum[axis] - position[axis]) * inverseDirection;
+			float exit = (maximum[axis] - position[axis]) * inverseDirection;
+			if (entry > exit)
+			{
+				std::swap(entry, exit);
+			}
+
+			nearest = (std::max)(nearest, entry);
+			farthest = (std::min)(farthest, exit);
+			if (nearest > farthest)
+			{
+				return false;
+			}
+		}
+
+		distance = nearest;
+		return true;
+	}
+
+	void AxisAlignedBox::Merge(const XMFLOAT3& point)
+	{
+		Minimum = XMFLOAT3((std::min)(Minimum.x, point.x), (std::min)(Minimum.y, point.y), (std::min)(Minimum.z, point.z));
+		Maximum = XMFLOAT3((std::max)(Maximum.x, point.x), (std::max)(Maximum.y, point.y), (std::max)(Maximum.z, point.z));
+	}
+
+	void AxisAlignedBox::Merge(const AxisAlignedBox& box)
+	{
+		Minimum = XMFLOAT3((std::min)(Minimum.x, box.Minimum.x), (std::min)(Minimum.y, box.Minimum.y), (std::min)(Minimum.z, box.Minimum.z));
+		Maximum = XMFLOAT3((std::max)(Maximum.x, box.Maximum.x), (std::max)(Maximum.y, box.Maximum.y), (std::max)(Maximum.z, box.Maximum.z));
+	}
+
+	void AxisAlignedBox::Expand(float margin)
+	{
+		Minimum = XMFLOAT3(Minimum.x - margin, Minimum.y - margin, Minimum.z - margin);
+		Maximum = XMFLOAT3(Maximum.x + margin, Maximum.y + margin, Maximum.z + margin);
+	}
+
+	void AxisAlignedBox::Expand(const XMFLOAT3& displacement)
+	{
+		// Stretches the box only in the direction of travel
+		(displacement.x < 0.0f ? Minimum.x : Maximum.x) += displacement.x;
+		(displacement.y < 0.0f ? Minimum.y : Maximum.y) += displacement.y;
+		(displacement.z < 0.0f ? Minimum.z : Maximum.z) += displacement.z;
+	}
+}
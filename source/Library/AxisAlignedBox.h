@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	class Ray;
+
+	// A default-constructed box is empty (minimum above maximum) so that merging points or boxes into it yields their bounds.
+	struct AxisAlignedBox
+	{
+		XMFLOAT3 Minimum;
+		XMFLOAT3 Maximum;
+
+		AxisAlignedBox();
+		AxisAlignedBox(const XMFLOAT3& minimum, const XMFLOAT3& maximum);
+
+		static AxisAlignedBox Union(const AxisAlignedBox& lhs, const AxisAlignedBox& rhs);
+
+		bool IsEmpty() const;
+		XMFLOAT3 Center() const;
+		XMFLOAT3 Extents() const;
+		float SurfaceArea() const;
+
+		bool Contains(const AxisAlignedBox& box) const;
+		bool Overlaps(const AxisAlignedBox& box) const;
+		bool Intersects(const Ray& ray, float maxDistance, float& distance) const;
+
+		void Merge(const XMFLOAT3& point);
+		void Merge(const AxisAlignedBox& box);
+		void Expand(float margin);
+		void Expand(const XMFLOAT3& displacement);
+	};
+}
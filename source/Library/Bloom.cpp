@@ -22,14 +22,16 @@ namespace Library
 	Bloom::Bloom(Game& game, Camera& camera)
 		: DrawableGameComponent(game, camera),
 		mBloomEffect(nullptr), mBloomMaterial(nullptr), mSceneTexture(nullptr), mRenderTarget(nullptr),
-		mFullScreenQuad(nullptr), mGaussianBlur(nullptr), mBloomSettings(DefaultBloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions()
+		mFullScreenQuad(nullptr), mGaussianBlur(nullptr), mBloomSettings(DefaultBloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions(),
+		mUpdateExtractMaterial(), mUpdateCompositeMaterial(), mUpdateNoBloomMaterial()
 	{
 	}
 
 	Bloom::Bloom(Game& game, Camera& camera, const BloomSettings& bloomSettings)
 		: DrawableGameComponent(game, camera),
 		mBloomEffect(nullptr), mBloomMaterial(nullptr), mSceneTexture(nullptr), mRenderTarget(nullptr),
-		mFullScreenQuad(nullptr), mGaussianBlur(nullptr), mBloomSettings(bloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions()
+		mFullScreenQuad(nullptr), mGaussianBlur(nullptr), mBloomSettings(bloomSettings), mDrawMode(BloomDrawModeNormal), mDrawFunctions(),
+		mUpdateExtractMaterial(), mUpdateCompositeMaterial(), mUpdateNoBloomMaterial()
 	{
 	}
 
@@ -86,6 +88,10 @@ namespace Library
 		mDrawFunctions[BloomDrawModeNormal] = std::bind(&Bloom::DrawNormal, this, _1);
 		mDrawFunctions[BloomDrawModeExtractedTexture1] = std::bind(&Bloom::DrawExtractedTexture, this, _1);
 		mDrawFunctions[BloomDrawModeBlurredTexture] = std::bind(&Bloom::DrawBlurredTexture, this, _1);
+
+		mUpdateExtractMaterial = std::bind(&Bloom::UpdateBloomExtractMaterial, this);
+		mUpdateCompositeMaterial = std::bind(&Bloom::UpdateBloomCompositeMaterial, this);
+		mUpdateNoBloomMaterial = std::bind(&Bloom::UpdateNoBloomMaterial, this);
 	}
 
 	void Bloom::Draw(const GameTime& gameTime)
@@ -102,7 +108,7 @@ namespace Library
 			mGame->Direct3DDeviceContext()->ClearRenderTargetView(mRenderTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
 			mGame->Direct3DDeviceContext()->ClearDepthStencilView(mRenderTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 			mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_extract", "p0");
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomExtractMaterial, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateExtractMaterial);
 			mFullScreenQuad->Draw(gameTime);
 			mRenderTarget->End();
 			mGame->UnbindPixelShaderResources(0, 1);
@@ -113,14 +119,14 @@ namespace Library
 
 			// Combine the original scene with the blurred bright spot image
 			mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_composite", "p0");
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomCompositeMaterial, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateCompositeMaterial);
 			mFullScreenQuad->Draw(gameTime);
 			mGame->UnbindPixelShaderResources(0, 2);
 		}
 		else
 		{
 			mFullScreenQuad->SetMaterial(*mBloomMaterial, "no_bloom", "p0");
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateNoBloomMaterial, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateNoBloomMaterial);
 			mFullScreenQuad->Draw(gameTime);
 		}
 	}
@@ -128,7 +134,7 @@ namespace Library
 	void Bloom::DrawExtractedTexture(const GameTime& gameTime)
 	{
 		mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_extract", "p0");
-		mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomExtractMaterial, this));
+		mFullScreenQuad->SetCustomUpdateMaterial(mUpdateExtractMaterial);
 		mFullScreenQuad->Draw(gameTime);
 	}
 
@@ -139,7 +145,7 @@ namespace Library
 		mGame->Direct3DDeviceContext()->ClearRenderTargetView(mRenderTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
 		mGame->Direct3DDeviceContext()->ClearDepthStencilView(mRenderTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 		mFullScreenQuad->SetMaterial(*mBloomMaterial, "bloom_extract", "p0");
-		mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&Bloom::UpdateBloomExtractMaterial, this));
+		mFullScreenQuad->SetCustomUpdateMaterial(mUpdateExtractMaterial);
 		mFullScreenQuad->Draw(gameTime);
 		mRenderTarget->End();
 		mGame->UnbindPixelShaderResources(0, 1);
@@ -173,7 +179,7 @@ namespace Library
 		return mDrawMode;
 	}
 
-	std::string Bloom::DrawModeString() const
+	const std::string& Bloom::DrawModeString() const
 	{
 		return DrawModeDisplayNames[(int)mDrawMode];
 	}
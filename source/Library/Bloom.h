@@ -46,7 +46,7 @@ namespace Library
 		void SetBloomSettings(const BloomSettings& bloomSettings);
 
 		BloomDrawMode DrawMode() const;
-		std::string DrawModeString() const;
+		const std::string& DrawModeString() const;
 		void SetDrawMode(BloomDrawMode drawMode);
 
 		virtual void Initialize() override;
@@ -77,5 +77,8 @@ namespace Library
 		BloomSettings mBloomSettings;
 		BloomDrawMode mDrawMode;
 		std::function<void(const GameTime& gameTime)> mDrawFunctions[BloomDrawModeEnd];
+		std::function<void()> mUpdateExtractMaterial;
+		std::function<void()> mUpdateCompositeMaterial;
+		std::function<void()> mUpdateNoBloomMaterial;
 	};
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace Library
 {
 	class BloomMaterial : public PostProcessingMaterial
 	{
-		RTTI_DECLARATIONS(PostProcessingMaterial, BloomMaterial)
+		RTTI_DECLARATIONS(BloomMaterial, PostProcessingMaterial)
 
 		MATERIAL_VARIABLE_DECLARATION(BloomTexture)
 		MATERIAL_VARIABLE_DECLARATION(BloomThreshold)
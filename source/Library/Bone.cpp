@@ -6,19 +6,31 @@
 
 namespace Library
 {
-	const std::vector<BoneVertexWeights::VertexWeight>& BoneVertexWeights::Weights()
+	BoneVertexWeights::BoneVertexWeights()
+		: mWeightCount(0U)
 	{
-		return mWeights;
+	}
+
+	UINT BoneVertexWeights::WeightCount() const
+	{
+		return mWeightCount;
+	}
+
+	const BoneVertexWeights::VertexWeight& BoneVertexWeights::WeightAt(UINT index) const
+	{
+		assert(index < mWeightCount);
+
+		return mWeights[index];
 	}
 
 	void BoneVertexWeights::AddWeight(float weight, UINT boneIndex)
 	{
-		if (mWeights.size() == MaxBoneWeightsPerVertex)
+		if (mWeightCount == MaxBoneWeightsPerVertex)
 		{
 			throw GameException("Maximum number of bone weights per vertex exceeded.");
 		}
 
-		mWeights.push_back(VertexWeight(weight, boneIndex));
+		mWeights[mWeightCount++] = VertexWeight(weight, boneIndex);
 	}
 
 	RTTI_DEFINITIONS(Bone)
@@ -5,6 +5,7 @@
 
 namespace Library
 {
+	// Weights are stored inline, so a mesh's per-vertex weights are a single allocation
 	class BoneVertexWeights
 	{
 	public:
@@ -13,18 +14,25 @@ namespace Library
 			float Weight;
 			UINT BoneIndex;
 
+			_VertexWeight()
+				: Weight(0.0f), BoneIndex(0U) { }
+
 			_VertexWeight(float weight, UINT boneIndex)
 				: Weight(weight), BoneIndex(boneIndex) { }
 		} VertexWeight;
 
-		const std::vector<VertexWeight>& Weights();
+		BoneVertexWeights();
+
+		UINT WeightCount() const;
+		const VertexWeight& WeightAt(UINT index) const;
 
 		void AddWeight(float weight, UINT boneIndex);
 
 		static const UINT MaxBoneWeightsPerVertex = 4U;
 
 	private:
-		std::vector<VertexWeight> mWeights;
+		VertexWeight mWeights[MaxBoneWeightsPerVertex];
+		UINT mWeightCount;
 	};
 
 	class Bone : public SceneNode
@@ -1,22 +1,27 @@
 #include "BoneAnimation.h"
 #include "GameException.h"
-#include "Bone.h"
 #include "Keyframe.h"
-#include "Model.h"
+#include "Skeleton.h"
+#include "StreamHelper.h"
 #include "VectorHelper.h"
 #include "scene.h"
 
 namespace Library
 {
-	BoneAnimation::BoneAnimation(Model& model, aiNodeAnim& nodeAnim)
-		: mModel(&model), mBone(nullptr), mKeyframes()
+	BoneAnimation::BoneAnimation(const Skeleton& skeleton, aiNodeAnim& nodeAnim, MemoryArena& arena)
+		: mBoneIndex(0U), mKeyframes(ArenaAllocator<Keyframe*>(arena))
 	{
-		UINT boneIndex = model.BoneIndexMapping().at(nodeAnim.mNodeName.C_Str());
-		mBone = model.Bones().at(boneIndex);
+		if (skeleton.TryGetBoneIndex(nodeAnim.mNodeName.C_Str(), mBoneIndex) == false)
+		{
+			throw GameException("Animation channel does not match a bone in the skeleton.");
+		}
 
 		assert(nodeAnim.mNumPositionKeys == nodeAnim.mNumRotationKeys);
 		assert(nodeAnim.mNumPositionKeys == nodeAnim.mNumScalingKeys);
 
+		Keyframe* keyframes = arena.Allocate<Keyframe>(nodeAnim.mNumPositionKeys);
+		mKeyframes.reserve(nodeAnim.mNumPositionKeys);
+
 		for (UINT i = 0; i < nodeAnim.mNumPositionKeys; i++)
 		{
 			aiVectorKey positionKey = nodeAnim.mPositionKeys[i];
@@ -26,26 +31,53 @@ namespace Library
 			assert(positionKey.mTime == rotationKey.mTime);
 			assert(positionKey.mTime == scaleKey.mTime);
 
-			Keyframe* keyframe = new Keyframe(static_cast<float>(positionKey.mTime), XMFLOAT3(positionKey.mValue.x, positionKey.mValue.y, positionKey.mValue.z),
+			Keyframe* keyframe = new (&keyframes[i]) Keyframe(static_cast<float>(positionKey.mTime), XMFLOAT3(positionKey.mValue.x, positionKey.mValue.y, positionKey.mValue.z),
 				XMFLOAT4(rotationKey.mValue.x, rotationKey.mValue.y, rotationKey.mValue.z, rotationKey.mValue.w), XMFLOAT3(scaleKey.mValue.x, scaleKey.mValue.y, scaleKey.mValue.z));
 			mKeyframes.push_back(keyframe);
 		}
 	}
 
-	BoneAnimation::~BoneAnimation()
+	BoneAnimation::BoneAnimation(const Skeleton& skeleton, std::istream& stream, MemoryArena& arena)
+		: mBoneIndex(0U), mKeyframes(ArenaAllocator<Keyframe*>(arena))
 	{
-		for (Keyframe* keyframe : mKeyframes)
+		StreamHelper::Read(stream, mBoneIndex);
+		if (mBoneIndex >= skeleton.BoneCount())
+		{
+			throw GameException("Animation channel does not match a bone in the skeleton.");
+		}
+
+		UINT keyframeCount;
+		StreamHelper::Read(stream, keyframeCount);
+		if (keyframeCount == 0)
+		{
+			throw GameException("Animation channel has no keyframes.");
+		}
+
+		Keyframe* keyframes = arena.Allocate<Keyframe>(keyframeCount);
+		mKeyframes.reserve(keyframeCount);
+
+		for (UINT i = 0; i < keyframeCount; i++)
 		{
-			delete keyframe;
+			float time;
+			XMFLOAT3 translation;
+			XMFLOAT4 rotationQuaternion;
+			XMFLOAT3 scale;
+
+			StreamHelper::Read(stream, time);
+			StreamHelper::Read(stream, translation);
+			StreamHelper::Read(stream, rotationQuaternion);
+			StreamHelper::Read(stream, scale);
+
+			mKeyframes.push_back(new (&keyframes[i]) Keyframe(time, translation, rotationQuaternion, scale));
 		}
 	}
 
-	Bone& BoneAnimation::GetBone()
+	UINT BoneAnimation::BoneIndex() const
 	{
-		return *mBone;
+		return mBoneIndex;
 	}
 
-	const std::vector<Keyframe*> BoneAnimation::Keyframes() const
+	const BoneAnimation::KeyframeCollection& BoneAnimation::Keyframes() const
 	{
 		return mKeyframes;
 	}
@@ -133,4 +165,18 @@ namespace Library
 
 		return keyframeIndex - 1;
 	}
+
+	void BoneAnimation::Write(std::ostream& stream) const
+	{
+		StreamHelper::Write(stream, mBoneIndex);
+		StreamHelper::Write(stream, static_cast<UINT>(mKeyframes.size()));
+
+		for (Keyframe* keyframe : mKeyframes)
+		{
+			StreamHelper::Write(stream, keyframe->Time());
+			StreamHelper::Write(stream, keyframe->Translation());
+			StreamHelper::Write(stream, keyframe->RotationQuaternion());
+			StreamHelper::Write(stream, keyframe->Scale());
+		}
+	}
 }
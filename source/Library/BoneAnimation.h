@@ -1,40 +1,43 @@
 #pragma once
 
 #include "Common.h"
+#include "MemoryArena.h"
 
 struct aiNodeAnim;
 
 namespace Library
 {
-	class Model;
-	class Bone;
+	class Skeleton;
 	class Keyframe;
 
+	// Bone animations and their keyframes are placed in their clip's arena and own no other memory,
+	// so they are never destroyed individually.
 	class BoneAnimation
 	{
 		friend class AnimationClip;
 
 	public:
-		~BoneAnimation();
+		typedef std::vector<Keyframe*, ArenaAllocator<Keyframe*>> KeyframeCollection;
 
-		Bone& GetBone();
-		const std::vector<Keyframe*> Keyframes() const;
+		UINT BoneIndex() const;
+		const KeyframeCollection& Keyframes() const;
 
 		UINT GetTransform(float time, XMFLOAT4X4& transform) const;
 		void GetTransformAtKeyframe(UINT keyframeIndex, XMFLOAT4X4& transform) const;
 		void GetInteropolatedTransform(float time, XMFLOAT4X4& transform) const;
 
 	private:
-		BoneAnimation(Model& model, aiNodeAnim& nodeAnim);
+		BoneAnimation(const Skeleton& skeleton, aiNodeAnim& nodeAnim, MemoryArena& arena);
+		BoneAnimation(const Skeleton& skeleton, std::istream& stream, MemoryArena& arena);
 
 		BoneAnimation();
 		BoneAnimation(const BoneAnimation& rhs);
 		BoneAnimation& operator=(const BoneAnimation& rhs);
 
 		UINT FindKeyframeIndex(float time) const;
+		void Write(std::ostream& stream) const;
 
-		Model* mModel;
-		Bone* mBone;
-		std::vector<Keyframe*> mKeyframes;
+		UINT mBoneIndex;		// Index into the skeleton's bone container
+		KeyframeCollection mKeyframes;
 	};
 }
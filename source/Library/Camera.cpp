@@ -1,8 +1,10 @@
 #include "Camera.h"
 #include "Game.h"
 #include "GameTime.h"
+#include "Ray.h"
 #include "VectorHelper.h"
 #include "MatrixHelper.h"
+#include "RenderSnapshot.h"
 
 namespace Library
 {
@@ -15,14 +17,14 @@ namespace Library
 	Camera::Camera(Game& game)
 		: GameComponent(game),
 		mFieldOfView(DefaultFieldOfView), mAspectRatio(game.AspectRatio()), mNearPlaneDistance(DefaultNearPlaneDistance), mFarPlaneDistance(DefaultFarPlaneDistance),
-		mPosition(), mDirection(), mUp(), mRight(), mViewMatrix(), mProjectionMatrix()
+		mPosition(), mDirection(), mUp(), mRight(), mViewMatrix(), mProjectionMatrix(), mViewProjectionVersion(0)
 	{
 	}
 
 	Camera::Camera(Game& game, float fieldOfView, float aspectRatio, float nearPlaneDistance, float farPlaneDistance)
 		: GameComponent(game),
 		mFieldOfView(fieldOfView), mAspectRatio(aspectRatio), mNearPlaneDistance(nearPlaneDistance), mFarPlaneDistance(farPlaneDistance),
-		mPosition(), mDirection(), mUp(), mRight(), mViewMatrix(), mProjectionMatrix()
+		mPosition(), mDirection(), mUp(), mRight(), mViewMatrix(), mProjectionMatrix(), mViewProjectionVersion(0)
 	{
 	}
 
@@ -108,6 +110,24 @@ namespace Library
 		return XMMatrixMultiply(viewMatrix, projectionMatrix);
 	}
 
+	UINT Camera::ViewProjectionVersion() const
+	{
+		return mViewProjectionVersion;
+	}
+
+	Ray Camera::PickingRay(int screenX, int screenY) const
+	{
+		// Unproject the pixel onto the near and far planes; the ray runs between them in world space
+		float x = (2.0f * screenX) / mGame->ScreenWidth() - 1.0f;
+		float y = 1.0f - (2.0f * screenY) / mGame->ScreenHeight();
+
+		XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, ViewProjectionMatrix());
+		XMVECTOR nearPoint = XMVector3TransformCoord(XMVectorSet(x, y, 0.0f, 1.0f), inverseViewProjection);
+		XMVECTOR farPoint = XMVector3TransformCoord(XMVectorSet(x, y, 1.0f, 1.0f), inverseViewProjection);
+
+		return Ray(nearPoint, XMVector3Normalize(farPoint - nearPoint));
+	}
+
 	void Camera::SetPosition(FLOAT x, FLOAT y, FLOAT z)
 	{
 		XMVECTOR position = XMVectorSet(x, y, z, 1.0f);
@@ -145,6 +165,18 @@ namespace Library
 		UpdateViewMatrix();
 	}
 
+	void Camera::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		RenderSnapshot::ViewState view;
+		view.ViewMatrix = mViewMatrix;
+		view.ProjectionMatrix = mProjectionMatrix;
+		XMStoreFloat4x4(&view.ViewProjectionMatrix, ViewProjectionMatrix());
+		view.Position = mPosition;
+		view.Direction = mDirection;
+
+		snapshot.SetView(view);
+	}
+
 	void Camera::UpdateViewMatrix()
 	{
 		XMVECTOR eyePosition = XMLoadFloat3(&mPosition);
@@ -152,13 +184,21 @@ namespace Library
 		XMVECTOR upDirection = XMLoadFloat3(&mUp);
 
 		XMMATRIX viewMatrix = XMMatrixLookToRH(eyePosition, direction, upDirection);
-		XMStoreFloat4x4(&mViewMatrix, viewMatrix);
+		XMFLOAT4X4 view;
+		XMStoreFloat4x4(&view, viewMatrix);
+
+		if (memcmp(&view, &mViewMatrix, sizeof(XMFLOAT4X4)) != 0)
+		{
+			mViewMatrix = view;
+			mViewProjectionVersion++;
+		}
 	}
 
 	void Camera::UpdateProjectionMatrix()
 	{
 		XMMATRIX projectionMatrix = XMMatrixPerspectiveFovRH(mFieldOfView, mAspectRatio, mNearPlaneDistance, mFarPlaneDistance);
 		XMStoreFloat4x4(&mProjectionMatrix, projectionMatrix);
+		mViewProjectionVersion++;
 	}
 
 	void Camera::ApplyRotation(CXMMATRIX transform)
@@ -5,6 +5,7 @@
 namespace Library
 {
 	class GameTime;
+	class Ray;
 
 	class Camera : public GameComponent
 	{
@@ -34,6 +35,8 @@ namespace Library
 		XMMATRIX ViewMatrix() const;
 		XMMATRIX ProjectionMatrix() const;
 		XMMATRIX ViewProjectionMatrix() const;
+		UINT ViewProjectionVersion() const;
+		Ray PickingRay(int screenX, int screenY) const;
 
 		virtual void SetPosition(FLOAT x, FLOAT y, FLOAT z);
 		virtual void SetPosition(FXMVECTOR position);
@@ -42,6 +45,7 @@ namespace Library
 		virtual void Reset();
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void UpdateViewMatrix();
 		virtual void UpdateProjectionMatrix();
 		void ApplyRotation(CXMMATRIX transform);
@@ -65,6 +69,7 @@ namespace Library
 
 		XMFLOAT4X4 mViewMatrix;
 		XMFLOAT4X4 mProjectionMatrix;
+		UINT mViewProjectionVersion;	// Incremented whenever the view or projection matrix changes
 
 	private:
 		Camera(const Camera& rhs);
@@ -0,0 +1,166 @@
+#include "ClockSource.h"
+#include "GameException.h"
+
+#if defined(_WIN32)
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#else
+#include <time.h>
+#endif
+
+namespace Library
+{
+	ClockSource::ClockSource()
+	{
+	}
+
+	ClockSource::~ClockSource()
+	{
+	}
+
+	std::once_flag RealClockSource::sInstanceCreated;
+	std::unique_ptr<RealClockSource> RealClockSource::sInstance;
+
+	RealClockSource::RealClockSource()
+		: ClockSource(), mSecondsPerTick(1.0)
+	{
+#if defined(_WIN32)
+		LARGE_INTEGER frequency;
+		if (QueryPerformanceFrequency(&frequency) == false)
+		{
+			throw GameException("QueryPerformanceFrequency() failed.");
+		}
+
+		mSecondsPerTick = 1.0 / frequency.QuadPart;
+#endif
+	}
+
+	RealClockSource::~RealClockSource()
+	{
+	}
+
+	double RealClockSource::Seconds() const
+	{
+#if defined(_WIN32)
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+
+		return counter.QuadPart * mSecondsPerTick;
+#else
+		timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+
+		return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+	}
+
+	RealClockSource& RealClockSource::Instance()
+	{
+		// Not a function-local static, which VS2013 does not guard against threads racing the first call; a constructor
+		// that throws leaves the flag unset and the exception with the caller, rather than ending the process before main
+		std::call_once(sInstanceCreated, []() { sInstance.reset(new RealClockSource()); });
+		return *sInstance;
+	}
+
+	double RealClockSource::Milliseconds()
+	{
+		return Instance().Seconds() * 1000.0;
+	}
+
+	bool RealClockSource::BeginTimerResolution()
+	{
+#if defined(_WIN32)
+		return (timeBeginPeriod(1) == TIMERR_NOERROR);
+#else
+		return false;
+#endif
+	}
+
+	void RealClockSource::EndTimerResolution()
+	{
+#if defined(_WIN32)
+		timeEndPeriod(1);
+#endif
+	}
+
+	void RealClockSource::Advance()
+	{
+	}
+
+	void RealClockSource::Sleep(double seconds)
+	{
+		if (seconds <= 0.0)
+		{
+			return;
+		}
+
+#if defined(_WIN32)
+		::Sleep(static_cast<DWORD>(seconds * 1000.0));
+#else
+		timespec duration;
+		duration.tv_sec = static_cast<time_t>(seconds);
+		duration.tv_nsec = static_cast<long>((seconds - duration.tv_sec) * 1e9);
+		nanosleep(&duration, nullptr);
+#endif
+	}
+
+	void RealClockSource::WaitUntil(double seconds)
+	{
+		while (Seconds() < seconds)
+		{
+		}
+	}
+
+	const double VirtualClockSource::DefaultFrameSeconds = 1.0 / 60.0;
+
+	VirtualClockSource::VirtualClockSource(double frameSeconds)
+		: ClockSource(), mFrameSeconds(0.0), mSeconds(0.0)
+	{
+		SetFrameSeconds(frameSeconds);
+	}
+
+	VirtualClockSource::~VirtualClockSource()
+	{
+	}
+
+	double VirtualClockSource::FrameSeconds() const
+	{
+		return mFrameSeconds;
+	}
+
+	void VirtualClockSource::SetFrameSeconds(double frameSeconds)
+	{
+		if (frameSeconds < 0.0)
+		{
+			throw GameException("A virtual clock cannot run backwards.");
+		}
+
+		mFrameSeconds = frameSeconds;
+	}
+
+	double VirtualClockSource::Seconds() const
+	{
+		return mSeconds;
+	}
+
+	void VirtualClockSource::Advance()
+	{
+		mSeconds += mFrameSeconds;
+	}
+
+	void VirtualClockSource::Sleep(double seconds)
+	{
+		if (seconds > 0.0)
+		{
+			mSeconds += seconds;
+		}
+	}
+
+	void VirtualClockSource::WaitUntil(double seconds)
+	{
+		if (seconds > mSeconds)
+		{
+			mSeconds = seconds;
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Common.h"
+#include <mutex>
+#include <memory>
+
+namespace Library
+{
+	// Where the game loop gets its time from. Times are seconds from an arbitrary origin and never decrease.
+	// Advance is called once at the start of every frame; Sleep may overshoot, while WaitUntil returns as close to its
+	// deadline as the source can manage.
+	class ClockSource
+	{
+	public:
+		virtual ~ClockSource();
+
+		virtual double Seconds() const = 0;
+		virtual void Advance() = 0;
+		virtual void Sleep(double seconds) = 0;
+		virtual void WaitUntil(double seconds) = 0;
+
+	protected:
+		ClockSource();
+
+	private:
+		ClockSource(const ClockSource& rhs);
+		ClockSource& operator=(const ClockSource& rhs);
+	};
+
+	// The machine's monotonic high-resolution counter: QueryPerformanceCounter on Windows, where the VS2013
+	// std::chrono::steady_clock only ticks at the system timer's resolution, and clock_gettime(CLOCK_MONOTONIC) elsewhere
+	class RealClockSource : public ClockSource
+	{
+	public:
+		RealClockSource();
+		~RealClockSource();
+
+		virtual double Seconds() const override;
+		virtual void Advance() override;
+		virtual void Sleep(double seconds) override;
+		virtual void WaitUntil(double seconds) override;
+
+		// Shared by everything that has not been given another source; created by the first call, from any thread
+		static RealClockSource& Instance();
+
+		// The shared source's time in milliseconds, for timing work in statistics. Safe to call from any thread.
+		static double Milliseconds();
+
+		// Sleep otherwise wakes on the default 15.6ms scheduler tick, far coarser than a frame's slack. Raises the system
+		// timer to 1ms until the matching EndTimerResolution; Windows counts the requests, so they nest. Returns whether
+		// the timer was raised, and only then is EndTimerResolution to be called. Game holds it for its lifetime.
+		static bool BeginTimerResolution();
+		static void EndTimerResolution();
+
+	private:
+		RealClockSource(const RealClockSource& rhs);
+		RealClockSource& operator=(const RealClockSource& rhs);
+
+		static std::once_flag sInstanceCreated;
+		static std::unique_ptr<RealClockSource> sInstance;
+
+		double mSecondsPerTick;
+	};
+
+	// Time that moves only when told to: by FrameSeconds on every Advance, and instantly through Sleep and WaitUntil.
+	// Runs driven by it produce the same game times on every machine, however long their frames really take.
+	class VirtualClockSource : public ClockSource
+	{
+	public:
+		static const double DefaultFrameSeconds;
+
+		VirtualClockSource(double frameSeconds = DefaultFrameSeconds);
+		~VirtualClockSource();
+
+		double FrameSeconds() const;
+		void SetFrameSeconds(double frameSeconds);
+
+		virtual double Seconds() const override;
+		virtual void Advance() override;
+		virtual void Sleep(double seconds) override;
+		virtual void WaitUntil(double seconds) override;
+
+	private:
+		VirtualClockSource(const VirtualClockSource& rhs);
+		VirtualClockSource& operator=(const VirtualClockSource& rhs);
+
+		double mFrameSeconds;
+		double mSeconds;
+	};
+}
@@ -9,7 +9,7 @@ namespace Rendering
 {
 	class ColorFilterMaterial : public PostProcessingMaterial
 	{
-		RTTI_DECLARATIONS(PostProcessingMaterial, ColorFilterMaterial)
+		RTTI_DECLARATIONS(ColorFilterMaterial, PostProcessingMaterial)
 
 			MATERIAL_VARIABLE_DECLARATION(ColorFilter)
 
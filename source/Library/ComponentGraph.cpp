@@ -0,0 +1,389 @@
+#include "ComponentGraph.h"
+#include "ClockSource.h"
+#include "GameComponent.h"
+#include "DrawableGameComponent.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Library
+{
+	const double ComponentGraph::CostSmoothing = 0.1;
+
+	ComponentGraph::ComponentGraph(JobSystem& jobSystem)
+		: mJobSystem(jobSystem), mComponents(), mSuccessors(), mPredecessorCounts(), mStageRoots(), mStageEnds(), mPendingCounts(),
+		  mSchedules(), mCosts(), mComponentTimes(), mIsDue(), mIsThrottledDue(), mThrottledBudget(0.0), mThrottledCursor(0),
+		  mUpdatedCount(0), mExceptionMutex(), mException(), mStatistics()
+	{
+	}
+
+	ComponentGraph::~ComponentGraph()
+	{
+	}
+
+	void ComponentGraph::Build(const std::vector<GameComponent*>& components)
+	{
+		UINT count = components.size();
+
+		// Components still in the list keep their schedule and cost history
+		std::vector<Schedule> schedules(count);
+		std::vector<ComponentCost> costs(count);
+		for (UINT i = 0; i < count; i++)
+		{
+			auto foundComponent = std::find(mComponents.begin(), mComponents.end(), components[i]);
+			if (foundComponent != mComponents.end())
+			{
+				UINT previousIndex = static_cast<UINT>(foundComponent - mComponents.begin());
+				schedules[i] = mSchedules[previousIndex];
+				costs[i] = mCosts[previousIndex];
+			}
+		}
+
+		mSchedules.swap(schedules);
+		mCosts.swap(costs);
+		mComponentTimes.assign(count, GameTime());
+		mIsDue.assign(count, false);
+		mIsThrottledDue.assign(count, false);
+		mThrottledCursor = 0;
+
+		mComponents = components;
+		mSuccessors.assign(count, std::vector<UINT>());
+		mPredecessorCounts.assign(count, 0);
+		mStageRoots.assign(1, std::vector<UINT>());
+		mStageEnds.clear();
+		mPendingCounts.reset(new std::atomic<UINT>[count]);
+
+		mStatistics = Statistics();
+		mStatistics.ComponentCount = count;
+
+		// Component lists are short, so every pair is compared directly; list order decides which way an edge points. Edges
+		// across a stage end are implied by it, so only those within a stage are kept for the jobs to follow.
+		std::vector<UINT> pathLengths(count, 1);
+		UINT stageStart = 0;
+		for (UINT later = 0; later < count; later++)
+		{
+			for (UINT earlier = 0; earlier < later; earlier++)
+			{
+				if (Conflicts(*components[earlier], *components[later]))
+				{
+					if (earlier >= stageStart && components[later]->DeclaresResources())
+					{
+						mSuccessors[earlier].push_back(later);
+						mPredecessorCounts[later]++;
+					}
+
+					pathLengths[later] = (std::max)(pathLengths[later], pathLengths[earlier] + 1);
+					mStatistics.DependencyCount++;
+				}
+			}
+
+			if (components[later]->DeclaresResources() == false)
+			{
+				mStageEnds.push_back(later);
+				mStageRoots.push_back(std::vector<UINT>());
+				stageStart = later + 1;
+				mStatistics.CallingThreadCount++;
+			}
+			else if (mPredecessorCounts[later] == 0)
+			{
+				mStageRoots.back().push_back(later);
+			}
+
+			mStatistics.CriticalPathLength = (std::max)(mStatistics.CriticalPathLength, pathLengths[later]);
+		}
+
+		mStageEnds.push_back(count);
+	}
+
+	void ComponentGraph::Update(const std::vector<GameComponent*>& components, const GameTime& gameTime)
+	{
+		double startTime = RealClockSource::Milliseconds();
+		JobSystem::Statistics startStatistics = mJobSystem.GetStatistics();
+
+		if (components != mComponents)
+		{
+			Build(components);
+		}
+
+		mUpdatedCount = 0;
+		mException = nullptr;
+		ScheduleUpdates(gameTime);
+
+		if (mJobSystem.IsSerial())
+		{
+			for (UINT i = 0; i < mComponents.size(); i++)
+			{
+				if (mIsDue[i] && mComponents[i]->Enabled())
+				{
+					RunUpdate(i);
+				}
+			}
+		}
+		else
+		{
+			for (UINT i = 0; i < mComponents.size(); i++)
+			{
+				mPendingCounts[i] = mPredecessorCounts[i];
+			}
+
+			for (UINT stage = 0; stage < mStageRoots.size(); stage++)
+			{
+				JobSystem::Counter counter(0);
+				for (UINT root : mStageRoots[stage])
+				{
+					mJobSystem.Run([this, root, &counter]()
+					{
+						UpdateComponent(root, counter);
+					}, counter);
+				}
+
+				mJobSystem.Wait(counter);
+
+				if (mStageEnds[stage] < mComponents.size())
+				{
+					TryUpdate(mStageEnds[stage]);
+				}
+			}
+		}
+
+		JobSystem::Statistics endStatistics = mJobSystem.GetStatistics();
+		mStatistics.UpdatedCount = mUpdatedCount;
+		mStatistics.JobCount = endStatistics.JobCount - startStatistics.JobCount;
+		mStatistics.StealCount = endStatistics.StealCount - startStatistics.StealCount;
+		mStatistics.Milliseconds = RealClockSource::Milliseconds() - startTime;
+
+		if (mException != nullptr)
+		{
+			std::rethrow_exception(mException);
+		}
+	}
+
+	const std::vector<GameComponent*>& ComponentGraph::Components() const
+	{
+		return mComponents;
+	}
+
+	const ComponentGraph::Statistics& ComponentGraph::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	const std::vector<ComponentGraph::ComponentCost>& ComponentGraph::ComponentCosts() const
+	{
+		return mCosts;
+	}
+
+	double ComponentGraph::ThrottledBudget() const
+	{
+		return mThrottledBudget;
+	}
+
+	void ComponentGraph::SetThrottledBudget(double throttledBudget)
+	{
+		assert(throttledBudget >= 0.0);
+		mThrottledBudget = throttledBudget;
+	}
+
+	void ComponentGraph::ScheduleUpdates(const GameTime& gameTime)
+	{
+		UINT count = mComponents.size();
+		double elapsedTime = gameTime.ElapsedGameTime();
+		bool hasThrottledDue = false;
+
+		mStatistics.HeldCount = 0;
+		mStatistics.DeferredCount = 0;
+
+		for (UINT i = 0; i < count; i++)
+		{
+			GameComponent* component = mComponents[i];
+			Schedule& schedule = mSchedules[i];
+			ComponentCost& cost = mCosts[i];
+
+			mIsDue[i] = false;
+			mIsThrottledDue[i] = false;
+			cost.WasUpdated = false;
+
+			if (component->Enabled() == false)
+			{
+				schedule.AccumulatedTime = 0.0;
+				schedule.FrameCount = 0;
+				continue;
+			}
+
+			DrawableGameComponent* drawableComponent = component->As<DrawableGameComponent>();
+			bool isHidden = (drawableComponent != nullptr && drawableComponent->Visible() == false);
+			if (isHidden && component->GetHiddenUpdate() == HiddenUpdateSuspended)
+			{
+				schedule.AccumulatedTime = 0.0;
+				schedule.FrameCount = 0;
+				cost.SkippedCount++;
+				mStatistics.HeldCount++;
+				continue;
+			}
+
+			schedule.AccumulatedTime += elapsedTime;
+			schedule.FrameCount++;
+
+			double interval = component->UpdateInterval();
+			if (isHidden && component->GetHiddenUpdate() == HiddenUpdateReduced)
+			{
+				interval = (std::max)(interval, component->HiddenUpdateInterval());
+			}
+
+			double budget = component->UpdateBudget();
+			if (interval <= 0.0 && budget <= 0.0)
+			{
+				Admit(i, gameTime);
+				continue;
+			}
+
+			// A component averaging three times its budget updates every third frame
+			UINT frameInterval = 1;
+			if (budget > 0.0 && cost.AverageMilliseconds > budget)
+			{
+				frameInterval = static_cast<UINT>(ceil(cost.AverageMilliseconds / budget));
+			}
+
+			// An interval is met on the frame that lands nearest it, so a tenth of a second at 60 Hz is every sixth frame
+			bool isIntervalMet = (schedule.AccumulatedTime + elapsedTime * 0.5 >= interval);
+			if (schedule.HasUpdated && (isIntervalMet == false || schedule.FrameCount < frameInterval))
+			{
+				cost.SkippedCount++;
+				mStatistics.HeldCount++;
+				continue;
+			}
+
+			mIsThrottledDue[i] = true;
+			hasThrottledDue = true;
+		}
+
+		if (hasThrottledDue == false)
+		{
+			return;
+		}
+
+		// Taken in turn from the first component the last frame deferred, so a deferred update goes first next time
+		double throttledMilliseconds = 0.0;
+		UINT admittedCount = 0;
+		bool hasDeferred = false;
+		UINT nextCursor = mThrottledCursor;
+
+		for (UINT offset = 0; offset < count; offset++)
+		{
+			UINT i = (mThrottledCursor + offset) % count;
+			if (mIsThrottledDue[i] == false)
+			{
+				continue;
+			}
+
+			double averageMilliseconds = mCosts[i].AverageMilliseconds;
+			bool fits = (mThrottledBudget <= 0.0 || admittedCount == 0 || throttledMilliseconds + averageMilliseconds <= mThrottledBudget);
+			if (fits || mSchedules[i].HasUpdated == false)
+			{
+				throttledMilliseconds += averageMilliseconds;
+				admittedCount++;
+				Admit(i, gameTime);
+			}
+			else
+			{
+				if (hasDeferred == false)
+				{
+					nextCursor = i;
+					hasDeferred = true;
+				}
+
+				mCosts[i].SkippedCount++;
+				mStatistics.DeferredCount++;
+			}
+		}
+
+		mThrottledCursor = nextCursor;
+	}
+
+	void ComponentGraph::Admit(UINT index, const GameTime& gameTime)
+	{
+		Schedule& schedule = mSchedules[index];
+
+		GameTime& componentTime = mComponentTimes[index];
+		componentTime = gameTime;
+		componentTime.SetElapsedGameTime(schedule.AccumulatedTime);
+
+		schedule.AccumulatedTime = 0.0;
+		schedule.FrameCount = 0;
+		schedule.HasUpdated = true;
+		mIsDue[index] = true;
+	}
+
+	void ComponentGraph::RunUpdate(UINT index)
+	{
+		double startTime = RealClockSource::Milliseconds();
+		mComponents[index]->Update(mComponentTimes[index]);
+		double milliseconds = RealClockSource::Milliseconds() - startTime;
+
+		ComponentCost& cost = mCosts[index];
+		cost.AverageMilliseconds = (cost.UpdateCount == 0 ? milliseconds : cost.AverageMilliseconds + (milliseconds - cost.AverageMilliseconds) * CostSmoothing);
+		cost.Milliseconds = milliseconds;
+		cost.UpdateCount++;
+		cost.WasUpdated = true;
+		mUpdatedCount++;
+	}
+
+	void ComponentGraph::TryUpdate(UINT index)
+	{
+		if (mIsDue[index] && mComponents[index]->Enabled())
+		{
+			try
+			{
+				RunUpdate(index);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mExceptionMutex);
+				if (mException == nullptr)
+				{
+					mException = std::current_exception();
+				}
+			}
+		}
+	}
+
+	void ComponentGraph::UpdateComponent(UINT index, JobSystem::Counter& counter)
+	{
+		TryUpdate(index);
+
+		// Successors still run after a failure so the frame drains; the first exception is rethrown once it has
+		for (UINT successor : mSuccessors[index])
+		{
+			if (--mPendingCounts[successor] == 0)
+			{
+				mJobSystem.Run([this, successor, &counter]()
+				{
+					UpdateComponent(successor, counter);
+				}, counter);
+			}
+		}
+	}
+
+	bool ComponentGraph::Conflicts(const GameComponent& earlier, const GameComponent& later)
+	{
+		if (earlier.DeclaresResources() == false || later.DeclaresResources() == false)
+		{
+			return true;
+		}
+
+		return (Intersects(earlier.WriteResources(), later.ReadResources()) || Intersects(earlier.WriteResources(), later.WriteResources()) ||
+			Intersects(earlier.ReadResources(), later.WriteResources()));
+	}
+
+	bool ComponentGraph::Intersects(const std::vector<const void*>& lhs, const std::vector<const void*>& rhs)
+	{
+		for (const void* resource : lhs)
+		{
+			if (std::find(rhs.begin(), rhs.end(), resource) != rhs.end())
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
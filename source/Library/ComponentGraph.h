@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Common.h"
+#include "JobSystem.h"
+#include "GameTime.h"
+
+namespace Library
+{
+	class GameComponent;
+
+	// Updates a list of components as a task graph on a JobSystem. A component must update after every earlier component
+	// in the list that writes a resource it reads or writes, or that reads a resource it writes; a component that declares
+	// no resources conflicts with everything and so updates alone, in list order, on the thread that called Update, as all
+	// components did before. Such components split the list into stages; the components of a stage with no conflict between
+	// them update concurrently on the workers. The graph is rebuilt only when the component list changes, so
+	// dependencies must be declared before a component's first update. In serial mode components update in list order.
+	// Before each Update the graph decides which components are due, from their update intervals, budgets and hidden
+	// update settings; components that are not due keep their place in the graph but skip Update. Every update is timed.
+	class ComponentGraph
+	{
+	public:
+		struct Statistics
+		{
+			UINT ComponentCount;
+			UINT UpdatedCount;			// Enabled components updated by the last Update
+			UINT HeldCount;				// Enabled components their schedule held back
+			UINT DeferredCount;			// Due throttled components moved to a later frame by the throttled budget
+			UINT CallingThreadCount;	// Components that declare no resources
+			UINT DependencyCount;
+			UINT CriticalPathLength;	// Components on the longest dependency chain
+			UINT JobCount;
+			UINT StealCount;
+			double Milliseconds;
+
+			Statistics()
+				: ComponentCount(0), UpdatedCount(0), HeldCount(0), DeferredCount(0), CallingThreadCount(0), DependencyCount(0), CriticalPathLength(0), JobCount(0), StealCount(0), Milliseconds(0.0) { }
+		};
+
+		struct ComponentCost
+		{
+			double Milliseconds;			// Of the component's last update
+			double AverageMilliseconds;
+			UINT UpdateCount;
+			UINT SkippedCount;				// Updates the schedule held back or deferred
+			bool WasUpdated;				// By the last Update
+
+			ComponentCost()
+				: Milliseconds(0.0), AverageMilliseconds(0.0), UpdateCount(0), SkippedCount(0), WasUpdated(false) { }
+		};
+
+		ComponentGraph(JobSystem& jobSystem);
+		~ComponentGraph();
+
+		void Build(const std::vector<GameComponent*>& components);
+		void Update(const std::vector<GameComponent*>& components, const GameTime& gameTime);
+
+		const std::vector<GameComponent*>& Components() const;
+		const Statistics& GetStatistics() const;
+
+		// Indexed as Components(); costs carry over when the component list changes
+		const std::vector<ComponentCost>& ComponentCosts() const;
+
+		// Average cost, in milliseconds, that the throttled components due in one frame may add up to; zero for no limit.
+		// Components that have never updated are never deferred.
+		double ThrottledBudget() const;
+		void SetThrottledBudget(double throttledBudget);
+
+		static const double CostSmoothing;
+
+	private:
+		ComponentGraph();
+		ComponentGraph(const ComponentGraph& rhs);
+		ComponentGraph& operator=(const ComponentGraph& rhs);
+
+		struct Schedule
+		{
+			double AccumulatedTime;			// Game time since the component last updated
+			UINT FrameCount;				// Frames since the component last updated
+			bool HasUpdated;
+
+			Schedule()
+				: AccumulatedTime(0.0), FrameCount(0), HasUpdated(false) { }
+		};
+
+		void ScheduleUpdates(const GameTime& gameTime);
+		void Admit(UINT index, const GameTime& gameTime);
+		void RunUpdate(UINT index);
+		void TryUpdate(UINT index);
+		void UpdateComponent(UINT index, JobSystem::Counter& counter);
+
+		static bool Conflicts(const GameComponent& earlier, const GameComponent& later);
+		static bool Intersects(const std::vector<const void*>& lhs, const std::vector<const void*>& rhs);
+
+		JobSystem& mJobSystem;
+		std::vector<GameComponent*> mComponents;
+		std::vector<std::vector<UINT>> mSuccessors;
+		std::vector<UINT> mPredecessorCounts;
+		std::vector<std::vector<UINT>> mStageRoots;
+		std::vector<UINT> mStageEnds;					// The component that declares no resources closing each stage, or the count
+		std::unique_ptr<std::atomic<UINT>[]> mPendingCounts;
+		std::vector<Schedule> mSchedules;
+		std::vector<ComponentCost> mCosts;
+		std::vector<GameTime> mComponentTimes;
+		std::vector<bool> mIsDue;
+		std::vector<bool> mIsThrottledDue;
+		double mThrottledBudget;
+		UINT mThrottledCursor;
+		std::atomic<UINT> mUpdatedCount;
+		std::mutex mExceptionMutex;
+		std::exception_ptr mException;
+		Statistics mStatistics;
+	};
+}
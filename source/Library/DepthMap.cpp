@@ -1,6 +1,7 @@
 #include "DepthMap.h"
 #include "Game.h"
 #include "GameException.h"
+#include "MemoryTracker.h"
 
 namespace Library
 {
@@ -8,8 +9,10 @@ namespace Library
 
 		DepthMap::DepthMap(Game& game, UINT width, UINT height)
 		: RenderTarget(), mGame(&game), mDepthStencilView(nullptr),
-		mOutputTexture(nullptr), mViewport()
+		mOutputTexture(nullptr), mViewport(), mTextureBytes(0)
 	{
+		MemoryScope memoryScope(MemorySubsystemRenderTargets);
+
 		D3D11_TEXTURE2D_DESC textureDesc;
 		ZeroMemory(&textureDesc, sizeof(textureDesc));
 		textureDesc.Width = width;
@@ -59,10 +62,14 @@ namespace Library
 		mViewport.Height = static_cast<float>(height);
 		mViewport.MinDepth = 0.0f;
 		mViewport.MaxDepth = 1.0f;
+
+		mTextureBytes = static_cast<INT64>(width) * height * 4;
+		MemoryTracker::RecordExternal(MemorySubsystemRenderTargets, mTextureBytes);
 	}
 
 	DepthMap::~DepthMap()
 	{
+		MemoryTracker::RecordExternal(MemorySubsystemRenderTargets, -mTextureBytes);
 		ReleaseObject(mOutputTexture);
 		ReleaseObject(mDepthStencilView);
 	}
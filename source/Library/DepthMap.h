@@ -30,5 +30,6 @@ namespace Library
 		ID3D11DepthStencilView* mDepthStencilView;
 		ID3D11ShaderResourceView* mOutputTexture;
 		D3D11_VIEWPORT mViewport;
+		INT64 mTextureBytes;
 	};
 }
\ No newline at end of file
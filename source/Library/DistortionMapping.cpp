@@ -72,12 +72,12 @@ namespace Library
 
 		mFullScreenQuad = new FullScreenQuad(*mGame, *mDistortionMappingMaterial);
 		mFullScreenQuad->Initialize();
+		mFullScreenQuad->SetActiveTechnique("distortion_composite", "p0");
+		mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&DistortionMapping::UpdateDistortionCompositeMaterial, this));
 	}
 
 	void DistortionMapping::Draw(const GameTime& gameTime)
 	{
-		mFullScreenQuad->SetActiveTechnique("distortion_composite", "p0");
-		mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&DistortionMapping::UpdateDistortionCompositeMaterial, this));
 		mFullScreenQuad->Draw(gameTime);
 
 		mGame->UnbindPixelShaderResources(0, 2);
@@ -8,7 +8,7 @@ namespace Library
 {
 	class DistortionMappingMaterial : public Material
 	{
-		RTTI_DECLARATIONS(Material, DistortionMappingMaterial)
+		RTTI_DECLARATIONS(DistortionMappingMaterial, Material)
 
 		MATERIAL_VARIABLE_DECLARATION(WorldViewProjection)
 		MATERIAL_VARIABLE_DECLARATION(SceneTexture)
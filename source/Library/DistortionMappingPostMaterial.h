@@ -8,7 +8,7 @@ namespace Library
 {
 	class DistortionMappingPostMaterial : public Material
 	{
-		RTTI_DECLARATIONS(Material, DistortionMappingPostMaterial)
+		RTTI_DECLARATIONS(DistortionMappingPostMaterial, Material)
 
 			MATERIAL_VARIABLE_DECLARATION(SceneTexture)
 			MATERIAL_VARIABLE_DECLARATION(DistortionMap)
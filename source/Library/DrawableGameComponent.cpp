@@ -36,4 +36,9 @@ namespace Library
 	{
 
 	}
+
+	bool DrawableGameComponent::DrawsFromSnapshot() const
+	{
+		return false;
+	}
 }
\ No newline at end of file
@@ -24,6 +24,9 @@ namespace Library
 
 		virtual void Draw(const GameTime& gameTime);
 
+		// True when Draw reads simulation state only from the render snapshot, which a pipelined game requires
+		virtual bool DrawsFromSnapshot() const;
+
 	protected:
 		bool mVisible;
 		Camera* mCamera;
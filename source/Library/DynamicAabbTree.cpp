@@ -0,0 +1,557 @@
+#include "DynamicAabbTree.h"
+#include "Frustum.h"
+#include "Ray.h"
+#include <algorithm>
+
+namespace Library
+{
+	const UINT DynamicAabbTree::NullNode = UINT_MAX;
+	const float DynamicAabbTree::DefaultMargin = 0.1f;
+	const float DynamicAabbTree::DefaultDisplacementMultiplier = 2.0f;
+
+	DynamicAabbTree::DynamicAabbTree(float margin, float displacementMultiplier)
+		: mNodes(), mRoot(NullNode), mFreeList(NullNode), mMargin(margin), mDisplacementMultiplier(displacementMultiplier), mStack(), mStatistics()
+	{
+	}
+
+	UINT DynamicAabbTree::CreateProxy(const AxisAlignedBox& box, void* userData)
+	{
+		UINT proxy = AllocateNode();
+
+		Node& node = mNodes[proxy];
+		node.Box = box;
+		node.Box.Expand(mMargin);
+		node.UserData = userData;
+		node.Height = 0;
+
+		InsertLeaf(proxy);
+		mStatistics.ProxyCount++;
+
+		return proxy;
+	}
+
+	void DynamicAabbTree::DestroyProxy(UINT proxy)
+	{
+		assert(proxy < mNodes.size() && mNodes[proxy].IsLeaf() && mNodes[proxy].Height == 0);
+
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		mStatistics.ProxyCount--;
+	}
+
+	bool DynamicAabbTree::MoveProxy(UINT proxy, const AxisAlignedBox& box, const XMFLOAT3& displacement)
+	{
+		assert(proxy < mNodes.size() && mNodes[proxy].IsLeaf() && mNodes[proxy].Height == 0);
+
+		if (mNodes[proxy].Box.Contains(box))
+		{
+			return false;
+		}
+
+		RemoveLeaf(proxy);
+
+		// Enlarge ahead of the motion so that an object moving steadily is reinserted only every few frames
+		AxisAlignedBox& fatBox = mNodes[proxy].Box;
+		fatBox = box;
+		fatBox.Expand(mMargin);
+		fatBox.Expand(XMFLOAT3(displacement.x * mDisplacementMultiplier, displacement.y * mDisplacementMultiplier, displacement.z * mDisplacementMultiplier));
+
+		InsertLeaf(proxy);
+		mStatistics.Reinsertions++;
+
+		return true;
+	}
+
+	void* DynamicAabbTree::UserData(UINT proxy) const
+	{
+		return mNodes[proxy].UserData;
+	}
+
+	const AxisAlignedBox& DynamicAabbTree::FatBox(UINT proxy) const
+	{
+		return mNodes[proxy].Box;
+	}
+
+	void DynamicAabbTree::Query(const AxisAlignedBox& box, std::vector<UINT>& proxies) const
+	{
+		proxies.clear();
+		mStatistics.NodesVisited = 0;
+
+		mStack.clear();
+		mStack.push_back(mRoot);
+		while (mStack.size() > 0)
+		{
+			UINT index = mStack.back();
+			mStack.pop_back();
+			if (index == NullNode)
+			{
+				continue;
+			}
+
+			mStatistics.NodesVisited++;
+
+			const Node& node = mNodes[index];
+			if (node.Box.Overlaps(box))
+			{
+				if (node.IsLeaf())
+				{
+					proxies.push_back(index);
+				}
+				else
+				{
+					mStack.push_back(node.Child1);
+					mStack.push_back(node.Child2);
+				}
+			}
+		}
+	}
+
+	void DynamicAabbTree::Query(const Frustum& frustum, std::vector<UINT>& proxies) const
+	{
+		// Subtrees found entirely inside the frustum are flagged on the stack and collected without further plane tests
+		static const UINT InsideFlag = 0x80000000;
+
+		const XMFLOAT4 planes[] = { frustum.Near(), frustum.Far(), frustum.Left(), frustum.Right(), frustum.Top(), frustum.Bottom() };
+
+		proxies.clear();
+		mStatistics.NodesVisited = 0;
+
+		mStack.clear();
+		mStack.push_back(mRoot);
+		while (mStack.size() > 0)
+		{
+			UINT entry = mStack.back();
+			mStack.pop_back();
+			if (entry == NullNode)
+			{
+				continue;
+			}
+
+			UINT index = (entry & ~InsideFlag);
+			bool isInside = ((entry & InsideFlag) != 0);
+			const Node& node = mNodes[index];
+			mStatistics.NodesVisited++;
+
+			if (isInside == false)
+			{
+				// Planes face outward: the nearest corner decides rejection, the farthest decides containment
+				const XMFLOAT3& minimum = node.Box.Minimum;
+				const XMFLOAT3& maximum = node.Box.Maximum;
+				bool isOutside = false;
+				isInside = true;
+
+				for (const XMFLOAT4& plane : planes)
+				{
+					float nearest = plane.x * (plane.x > 0.0f ? minimum.x : maximum.x) + plane.y * (plane.y > 0.0f ? minimum.y : maximum.y) + plane.z * (plane.z > 0.0f ? minimum.z : maximum.z) + plane.w;
+					if (nearest > 0.0f)
+					{
+						isOutside = true;
+						break;
+					}
+
+					float farthest = plane.x * (plane.x > 0.0f ? maximum.x : minimum.x) + plane.y * (plane.y > 0.0f ? maximum.y : minimum.y) + plane.z * (plane.z > 0.0f ? maximum.z : minimum.z) + plane.w;
+					if (farthest > 0.0f)
+					{
+						isInside = false;
+					}
+				}
+
+				if (isOutside)
+				{
+					continue;
+				}
+			}
+
+			if (node.IsLeaf())
+			{
+				proxies.push_back(index);
+			}
+			else
+			{
+				UINT flag = (isInside ? InsideFlag : 0);
+				mStack.push_back(node.Child1 | flag);
+				mStack.push_back(node.Child2 | flag);
+			}
+		}
+	}
+
+	void DynamicAabbTree::Query(const Ray& ray, float maxDistance, std::vector<UINT>& proxies) const
+	{
+		proxies.clear();
+		mStatistics.NodesVisited = 0;
+
+		mStack.clear();
+		mStack.push_back(mRoot);
+		while (mStack.size() > 0)
+		{
+			UINT index = mStack.back();
+			mStack.pop_back();
+			if (index == NullNode)
+			{
+				continue;
+			}
+
+			mStatistics.NodesVisited++;
+
+			const Node& node = mNodes[index];
+			float distance;
+			if (node.Box.Intersects(ray, maxDistance, distance))
+			{
+				if (node.IsLeaf())
+				{
+					proxies.push_back(index);
+				}
+				else
+				{
+					mStack.push_back(node.Child1);
+					mStack.push_back(node.Child2);
+				}
+			}
+		}
+	}
+
+	UINT DynamicAabbTree::Height() const
+	{
+		return (mRoot != NullNode ? mNodes[mRoot].Height : 0);
+	}
+
+	const DynamicAabbTree::Statistics& DynamicAabbTree::GetStatistics() const
+	{
+		mStatistics.Height = Height();
+
+		return mStatistics;
+	}
+
+	void DynamicAabbTree::Validate() const
+	{
+#if defined( DEBUG ) || defined( _DEBUG )
+		if (mRoot != NullNode)
+		{
+			assert(mNodes[mRoot].Parent == NullNode);
+			ValidateNode(mRoot);
+		}
+
+		UINT freeCount = 0;
+		for (UINT index = mFreeList; index != NullNode; index = mNodes[index].Parent)
+		{
+			assert(mNodes[index].Height == -1);
+			freeCount++;
+		}
+
+		assert(freeCount + mStatistics.NodeCount == mNodes.size());
+#endif
+	}
+
+	UINT DynamicAabbTree::AllocateNode()
+	{
+		UINT index;
+		if (mFreeList == NullNode)
+		{
+			index = mNodes.size();
+			mNodes.push_back(Node());
+		}
+		else
+		{
+			index = mFreeList;
+			mFreeList = mNodes[index].Parent;
+			mNodes[index] = Node();
+		}
+
+		mNodes[index].Height = 0;
+		mStatistics.NodeCount++;
+
+		return index;
+	}
+
+	void DynamicAabbTree::FreeNode(UINT node)
+	{
+		mNodes[node].Parent = mFreeList;
+		mNodes[node].Height = -1;
+		mFreeList = node;
+		mStatistics.NodeCount--;
+	}
+
+	void DynamicAabbTree::InsertLeaf(UINT leaf)
+	{
+		if (mRoot == NullNode)
+		{
+			mRoot = leaf;
+			mNodes[leaf].Parent = NullNode;
+			return;
+		}
+
+		// Descend toward the sibling with the lowest cost: the surface area of the new parent plus the growth it forces on every ancestor
+		AxisAlignedBox leafBox = mNodes[leaf].Box;
+		UINT index = mRoot;
+		while (mNodes[index].IsLeaf() == false)
+		{
+			const Node& node = mNodes[index];
+			float area = node.Box.SurfaceArea();
+			float combinedArea = AxisAlignedBox::Union(node.Box, leafBox).SurfaceArea();
+
+			float cost = 2.0f * combinedArea;
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			const Node& child1 = mNodes[node.Child1];
+			float cost1 = AxisAlignedBox::Union(leafBox, child1.Box).SurfaceArea() + inheritanceCost;
+			if (child1.IsLeaf() == false)
+			{
+				cost1 -= child1.Box.SurfaceArea();
+			}
+
+			const Node& child2 = mNodes[node.Child2];
+			float cost2 = AxisAlignedBox::Union(leafBox, child2.Box).SurfaceArea() + inheritanceCost;
+			if (child2.IsLeaf() == false)
+			{
+				cost2 -= child2.Box.SurfaceArea();
+			}
+
+			if (cost < cost1 && cost < cost2)
+			{
+				break;
+			}
+
+			index = (cost1 < cost2 ? node.Child1 : node.Child2);
+		}
+
+		UINT sibling = index;
+		UINT oldParent = mNodes[sibling].Parent;
+		UINT newParent = AllocateNode();
+
+		Node& parentNode = mNodes[newParent];
+		parentNode.Parent = oldParent;
+		parentNode.Box = AxisAlignedBox::Union(leafBox, mNodes[sibling].Box);
+		parentNode.Height = mNodes[sibling].Height + 1;
+		parentNode.Child1 = sibling;
+		parentNode.Child2 = leaf;
+
+		if (oldParent != NullNode)
+		{
+			if (mNodes[oldParent].Child1 == sibling)
+			{
+				mNodes[oldParent].Child1 = newParent;
+			}
+			else
+			{
+				mNodes[oldParent].Child2 = newParent;
+			}
+		}
+		else
+		{
+			mRoot = newParent;
+		}
+
+		mNodes[sibling].Parent = newParent;
+		mNodes[leaf].Parent = newParent;
+
+		Refit(mNodes[leaf].Parent);
+	}
+
+	void DynamicAabbTree::RemoveLeaf(UINT leaf)
+	{
+		if (leaf == mRoot)
+		{
+			mRoot = NullNode;
+			return;
+		}
+
+		UINT parent = mNodes[leaf].Parent;
+		UINT grandParent = mNodes[parent].Parent;
+		UINT sibling = (mNodes[parent].Child1 == leaf ? mNodes[parent].Child2 : mNodes[parent].Child1);
+
+		if (grandParent != NullNode)
+		{
+			if (mNodes[grandParent].Child1 == parent)
+			{
+				mNodes[grandParent].Child1 = sibling;
+			}
+			else
+			{
+				mNodes[grandParent].Child2 = sibling;
+			}
+
+			mNodes[sibling].Parent = grandParent;
+			FreeNode(parent);
+			Refit(grandParent);
+		}
+		else
+		{
+			mRoot = sibling;
+			mNodes[sibling].Parent = NullNode;
+			FreeNode(parent);
+		}
+	}
+
+	void DynamicAabbTree::Refit(UINT node)
+	{
+		UINT index = node;
+		while (index != NullNode)
+		{
+			index = Balance(index);
+
+			Node& current = mNodes[index];
+			const Node& child1 = mNodes[current.Child1];
+			const Node& child2 = mNodes[current.Child2];
+
+			current.Height = 1 + (std::max)(child1.Height, child2.Height);
+			current.Box = AxisAlignedBox::Union(child1.Box, child2.Box);
+
+			index = current.Parent;
+		}
+	}
+
+	UINT DynamicAabbTree::Balance(UINT node)
+	{
+		// Promotes the taller grandchild when the two subtrees of node differ in height by more than one
+		UINT iA = node;
+		Node& a = mNodes[iA];
+		if (a.IsLeaf() || a.Height < 2)
+		{
+			return iA;
+		}
+
+		UINT iB = a.Child1;
+		UINT iC = a.Child2;
+		Node& b = mNodes[iB];
+		Node& c = mNodes[iC];
+
+		int balance = c.Height - b.Height;
+
+		if (balance > 1)
+		{
+			UINT iF = c.Child1;
+			UINT iG = c.Child2;
+			Node& f = mNodes[iF];
+			Node& g = mNodes[iG];
+
+			c.Child1 = iA;
+			c.Parent = a.Parent;
+			a.Parent = iC;
+
+			if (c.Parent != NullNode)
+			{
+				if (mNodes[c.Parent].Child1 == iA)
+				{
+					mNodes[c.Parent].Child1 = iC;
+				}
+				else
+				{
+					mNodes[c.Parent].Child2 = iC;
+				}
+			}
+			else
+			{
+				mRoot = iC;
+			}
+
+			if (f.Height > g.Height)
+			{
+				c.Child2 = iF;
+				a.Child2 = iG;
+				g.Parent = iA;
+				a.Box = AxisAlignedBox::Union(b.Box, g.Box);
+				c.Box = AxisAlignedBox::Union(a.Box, f.Box);
+				a.Height = 1 + (std::max)(b.Height, g.Height);
+				c.Height = 1 + (std::max)(a.Height, f.Height);
+			}
+			else
+			{
+				c.Child2 = iG;
+				a.Child2 = iF;
+				f.Parent = iA;
+				a.Box = AxisAlignedBox::Union(b.Box, f.Box);
+				c.Box = AxisAlignedBox::Union(a.Box, g.Box);
+				a.Height = 1 + (std::max)(b.Height, f.Height);
+				c.Height = 1 + (std::max)(a.Height, g.Height);
+			}
+
+			mStatistics.Rotations++;
+			return iC;
+		}
+
+		if (balance < -1)
+		{
+			UINT iD = b.Child1;
+			UINT iE = b.Child2;
+			Node& d = mNodes[iD];
+			Node& e = mNodes[iE];
+
+			b.Child1 = iA;
+			b.Parent = a.Parent;
+			a.Parent = iB;
+
+			if (b.Parent != NullNode)
+			{
+				if (mNodes[b.Parent].Child1 == iA)
+				{
+					mNodes[b.Parent].Child1 = iB;
+				}
+				else
+				{
+					mNodes[b.Parent].Child2 = iB;
+				}
+			}
+			else
+			{
+				mRoot = iB;
+			}
+
+			if (d.Height > e.Height)
+			{
+				b.Child2 = iD;
+				a.Child1 = iE;
+				e.Parent = iA;
+				a.Box = AxisAlignedBox::Union(c.Box, e.Box);
+				b.Box = AxisAlignedBox::Union(a.Box, d.Box);
+				a.Height = 1 + (std::max)(c.Height, e.Height);
+				b.Height = 1 + (std::max)(a.Height, d.Height);
+			}
+			else
+			{
+				b.Child2 = iE;
+				a.Child1 = iD;
+				d.Parent = iA;
+				a.Box = AxisAlignedBox::Union(c.Box, d.Box);
+				b.Box = AxisAlignedBox::Union(a.Box, e.Box);
+				a.Height = 1 + (std::max)(c.Height, d.Height);
+				b.Height = 1 + (std::max)(a.Height, e.Height);
+			}
+
+			mStatistics.Rotations++;
+			return iB;
+		}
+
+		return iA;
+	}
+
+	UINT DynamicAabbTree::ComputeHeight(UINT node) const
+	{
+		const Node& current = mNodes[node];
+		if (current.IsLeaf())
+		{
+			return 0;
+		}
+
+		return 1 + (std::max)(ComputeHeight(current.Child1), ComputeHeight(current.Child2));
+	}
+
+	void DynamicAabbTree::ValidateNode(UINT node) const
+	{
+		const Node& current = mNodes[node];
+		if (current.IsLeaf())
+		{
+			assert(current.Child2 == NullNode);
+			assert(current.Height == 0);
+			return;
+		}
+
+		assert(mNodes[current.Child1].Parent == node);
+		assert(mNodes[current.Child2].Parent == node);
+		assert(current.Height == static_cast<int>(ComputeHeight(node)));
+		assert(current.Box.Contains(mNodes[current.Child1].Box));
+		assert(current.Box.Contains(mNodes[current.Child2].Box));
+
+		ValidateNode(current.Child1);
+		ValidateNode(current.Child2);
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Common.h"
+#include "AxisAlignedBox.h"
+
+namespace Library
+{
+	class Frustum;
+	class Ray;
+
+	// A bounding volume hierarchy over moving objects. Each object is stored as a leaf whose box is enlarged by a margin
+	// and by its last displacement, so small movements are absorbed without touching the tree. Leaves are inserted beside
+	// the sibling that minimizes the growth in surface area, and every ancestor is rebalanced with a single rotation on the
+	// way back up, which keeps the tree shallow under continuous insertion and removal without ever rebuilding it.
+	// Proxies are indices into the node pool and stay valid until destroyed. The tree is not thread-safe.
+	class DynamicAabbTree
+	{
+	public:
+		struct Statistics
+		{
+			UINT ProxyCount;
+			UINT NodeCount;
+			UINT Height;
+			UINT Reinsertions;		// Moves that left their enlarged box
+			UINT Rotations;
+			UINT NodesVisited;		// By the most recent query; a brute-force scan would test ProxyCount objects
+
+			Statistics()
+				: ProxyCount(0), NodeCount(0), Height(0), Reinsertions(0), Rotations(0), NodesVisited(0) { }
+		};
+
+		static const UINT NullNode;
+		static const float DefaultMargin;
+		static const float DefaultDisplacementMultiplier;
+
+		DynamicAabbTree(float margin = DefaultMargin, float displacementMultiplier = DefaultDisplacementMultiplier);
+
+		UINT CreateProxy(const AxisAlignedBox& box, void* userData = nullptr);
+		void DestroyProxy(UINT proxy);
+		bool MoveProxy(UINT proxy, const AxisAlignedBox& box, const XMFLOAT3& displacement);
+
+		void* UserData(UINT proxy) const;
+		const AxisAlignedBox& FatBox(UINT proxy) const;
+
+		void Query(const AxisAlignedBox& box, std::vector<UINT>& proxies) const;
+		void Query(const Frustum& frustum, std::vector<UINT>& proxies) const;
+		void Query(const Ray& ray, float maxDistance, std::vector<UINT>& proxies) const;
+
+		UINT Height() const;
+		const Statistics& GetStatistics() const;
+		void Validate() const;
+
+	private:
+		struct Node
+		{
+			AxisAlignedBox Box;
+			void* UserData;
+			UINT Parent;			// Next free node while on the free list
+			UINT Child1;
+			UINT Child2;
+			int Height;				// Leaves are zero; free nodes are -1
+
+			Node()
+				: Box(), UserData(nullptr), Parent(NullNode), Child1(NullNode), Child2(NullNode), Height(-1) { }
+
+			bool IsLeaf() const { return (Child1 == NullNode); }
+		};
+
+		DynamicAabbTree(const DynamicAabbTree& rhs);
+		DynamicAabbTree& operator=(const DynamicAabbTree& rhs);
+
+		UINT AllocateNode();
+		void FreeNode(UINT node);
+		void InsertLeaf(UINT leaf);
+		void RemoveLeaf(UINT leaf);
+		void Refit(UINT node);
+		UINT Balance(UINT node);
+		UINT ComputeHeight(UINT node) const;
+		void ValidateNode(UINT node) const;
+
+		std::vector<Node> mNodes;
+		UINT mRoot;
+		UINT mFreeList;
+		float mMargin;
+		float mDisplacementMultiplier;
+		mutable std::vector<UINT> mStack;
+		mutable Statistics mStatistics;
+	};
+}
@@ -2,6 +2,8 @@
 #include "Game.h"
 #include "GameException.h"
 #include "Utility.h"
+#include "MemoryTracker.h"
+#include "AssetLoader.h"
 #include "D3Dcompiler.h"
 
 namespace Library
@@ -30,6 +32,7 @@ namespace Library
 
 	void Effect::CompileEffectFromFile(ID3D11Device* direct3DDevice, ID3DX11Effect** effect, const std::wstring& filename)
 	{
+		MemoryScope memoryScope(MemorySubsystemEffects);
 		UINT shaderFlags = 0;
 
 #if defined( DEBUG ) || defined( _DEBUG )
@@ -60,9 +63,20 @@ namespace Library
 
 	void Effect::LoadCompiledEffect(ID3D11Device* direct3DDevice, ID3DX11Effect** effect, const std::wstring& filename)
 	{
+		MemoryScope memoryScope(MemorySubsystemEffects);
 		std::vector<char> compiledShader;
 		Utility::LoadBinaryFile(filename, compiledShader);
 
+		CreateEffectFromMemory(direct3DDevice, effect, compiledShader);
+	}
+
+	void Effect::CreateEffectFromMemory(ID3D11Device* direct3DDevice, ID3DX11Effect** effect, const std::vector<char>& compiledShader)
+	{
+		if (compiledShader.empty())
+		{
+			throw GameException("Compiled effect file is empty.");
+		}
+
 		HRESULT hr = D3DX11CreateEffectFromMemory(&compiledShader.front(), compiledShader.size(), NULL, direct3DDevice, effect);
 		if (FAILED(hr))
 		{
@@ -134,12 +148,17 @@ namespace Library
 
 	void Effect::LoadCompiledEffect(const std::wstring& filename)
 	{
-		LoadCompiledEffect(mGame.Direct3DDevice(), &mEffect, filename);
+		MemoryScope memoryScope(MemorySubsystemEffects);
+		std::vector<char> compiledShader;
+		mGame.Assets().LoadFile(filename, compiledShader);
+
+		CreateEffectFromMemory(mGame.Direct3DDevice(), &mEffect, compiledShader);
 		Initialize();
 	}
 
 	void Effect::Initialize()
 	{
+		MemoryScope memoryScope(MemorySubsystemEffects);
 		HRESULT hr = mEffect->GetDesc(&mEffectDesc);
 		if (FAILED(hr))
 		{
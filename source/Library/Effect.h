@@ -28,12 +28,16 @@ namespace Library
 		const std::map<std::string, Variable*>& VariablesByName() const;
 
 		void CompileFromFile(const std::wstring& filename);
+
+		// Takes the file from the game's AssetLoader when it was declared ahead of time
 		void LoadCompiledEffect(const std::wstring& filename);
 
 	private:
 		Effect(const Effect& rhs);
 		Effect& operator=(const Effect& rhs);
 
+		static void CreateEffectFromMemory(ID3D11Device* direct3DDevice, ID3DX11Effect** effect, const std::vector<char>& compiledShader);
+
 		void Initialize();
 
 		Game& mGame;
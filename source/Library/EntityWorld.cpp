@@ -0,0 +1,760 @@
+#include "EntityWorld.h"
+#include "ClockSource.h"
+#include "Frustum.h"
+#include "GameException.h"
+#include "MatrixHelper.h"
+#include "VectorHelper.h"
+#include "Parallel.h"
+#include <cmath>
+
+namespace Library
+{
+	const EntityWorld::Entity EntityWorld::InvalidEntity;
+	const UINT EntityWorld::ChunkCapacity = 1024;
+	const UINT EntityWorld::InvalidIndex = UINT_MAX;
+
+	EntityWorld::Transform::Transform()
+		: Position(Vector3Helper::Zero), Rotation(0.0f, 0.0f, 0.0f, 1.0f), Scale(Vector3Helper::One)
+	{
+	}
+
+	EntityWorld::Transform::Transform(const XMFLOAT3& position, const XMFLOAT4& rotation, const XMFLOAT3& scale)
+		: Position(position), Rotation(rotation), Scale(scale)
+	{
+	}
+
+	EntityWorld::AnimationState::AnimationState()
+		: Clip(0), Time(0.0f), Duration(0.0f), Speed(1.0f), IsLooping(true)
+	{
+	}
+
+	EntityWorld::Chunk::Chunk(UINT componentMask)
+		: ComponentMask(componentMask), Entities(nullptr), Positions(nullptr), Rotations(nullptr), Scales(nullptr), WorldTransforms(nullptr),
+		  LocalBounds(nullptr), WorldMinimumX(nullptr), WorldMinimumY(nullptr), WorldMinimumZ(nullptr), WorldMaximumX(nullptr), WorldMaximumY(nullptr), WorldMaximumZ(nullptr),
+		  VisibilityMask(nullptr), VisibleCount(0), Meshes(nullptr), Materials(nullptr),
+		  AnimationClips(nullptr), AnimationTimes(nullptr), AnimationDurations(nullptr), AnimationSpeeds(nullptr), AnimationLoops(nullptr),
+		  mBlock(nullptr), mCount(0)
+	{
+		// The columns hold plain data, so rows are assigned as they are pushed rather than constructed here
+		UINT size = PlaceColumns(nullptr);
+		mBlock = new byte[size + ColumnAlignment - 1];
+
+		size_t padding = (ColumnAlignment - (reinterpret_cast<size_t>(mBlock) & (ColumnAlignment - 1))) & (ColumnAlignment - 1);
+		PlaceColumns(mBlock + padding);
+	}
+
+	EntityWorld::Chunk::~Chunk()
+	{
+		delete[] mBlock;
+	}
+
+	UINT EntityWorld::Chunk::Count() const
+	{
+		return mCount;
+	}
+
+	bool EntityWorld::Chunk::Has(EntityComponentType type) const
+	{
+		return ((ComponentMask & ComponentBit(type)) != 0);
+	}
+
+	bool EntityWorld::Chunk::IsVisible(UINT row) const
+	{
+		// Without bounds there is nothing to cull
+		return (Has(EntityComponentBounds) == false || (VisibilityMask[row >> 5] & (1 << (row & 31))) != 0);
+	}
+
+	FrustumCuller::BoxColumns EntityWorld::Chunk::WorldBounds() const
+	{
+		return FrustumCuller::BoxColumns(WorldMinimumX, WorldMinimumY, WorldMinimumZ, WorldMaximumX, WorldMaximumY, WorldMaximumZ, mCount);
+	}
+
+	template <typename T>
+	T* EntityWorld::Chunk::PlaceColumn(byte* block, UINT& size)
+	{
+		return PlaceColumn<T>(block, size, ChunkCapacity);
+	}
+
+	template <typename T>
+	T* EntityWorld::Chunk::PlaceColumn(byte* block, UINT& size, UINT count)
+	{
+		UINT offset = (size + ColumnAlignment - 1) & ~(ColumnAlignment - 1);
+		size = offset + sizeof(T) * count;
+
+		return (block != nullptr ? reinterpret_cast<T*>(block + offset) : nullptr);
+	}
+
+	UINT EntityWorld::Chunk::PlaceColumns(byte* block)
+	{
+		UINT size = 0;
+		Entities = PlaceColumn<Entity>(block, size);
+
+		if (Has(EntityComponentTransform))
+		{
+			Positions = PlaceColumn<XMFLOAT3>(block, size);
+			Rotations = PlaceColumn<XMFLOAT4>(block, size);
+			Scales = PlaceColumn<XMFLOAT3>(block, size);
+			WorldTransforms = PlaceColumn<XMFLOAT4X4>(block, size);
+		}
+
+		if (Has(EntityComponentBounds))
+		{
+			LocalBounds = PlaceColumn<AxisAlignedBox>(block, size);
+			WorldMinimumX = PlaceColumn<float>(block, size);
+			WorldMinimumY = PlaceColumn<float>(block, size);
+			WorldMinimumZ = PlaceColumn<float>(block, size);
+			WorldMaximumX = PlaceColumn<float>(block, size);
+			WorldMaximumY = PlaceColumn<float>(block, size);
+			WorldMaximumZ = PlaceColumn<float>(block, size);
+
+			VisibilityMask = PlaceColumn<UINT>(block, size, (ChunkCapacity + 31) / 32);
+		}
+
+		if (Has(EntityComponentMesh))
+		{
+			Meshes = PlaceColumn<Mesh*>(block, size);
+		}
+
+		if (Has(EntityComponentMaterial))
+		{
+			Materials = PlaceColumn<Material*>(block, size);
+		}
+
+		if (Has(EntityComponentAnimation))
+		{
+			AnimationClips = PlaceColumn<UINT>(block, size);
+			AnimationTimes = PlaceColumn<float>(block, size);
+			AnimationDurations = PlaceColumn<float>(block, size);
+			AnimationSpeeds = PlaceColumn<float>(block, size);
+			AnimationLoops = PlaceColumn<byte>(block, size);
+		}
+
+		return size;
+	}
+
+	UINT EntityWorld::ComponentBit(EntityComponentType type)
+	{
+		return (1 << type);
+	}
+
+	EntityWorld::EntityWorld()
+		: mArchetypes(), mSlots(), mFreeSlots(), mChunks(), mAreChunksDirty(false), mStatistics()
+	{
+	}
+
+	EntityWorld::~EntityWorld()
+	{
+		for (Archetype& archetype : mArchetypes)
+		{
+			for (Chunk* chunk : archetype.Chunks)
+			{
+				delete chunk;
+			}
+		}
+	}
+
+	UINT EntityWorld::EntityCount() const
+	{
+		return mStatistics.EntityCount;
+	}
+
+	bool EntityWorld::IsValid(Entity entity) const
+	{
+		return (entity.Index < mSlots.size() && mSlots[entity.Index].Generation == entity.Generation && mSlots[entity.Index].ArchetypeIndex != InvalidIndex);
+	}
+
+	EntityWorld::Entity EntityWorld::Create(UINT componentMask)
+	{
+		if (componentMask >= ComponentBit(EntityComponentTypeCount))
+		{
+			throw GameException("Unknown entity component type.");
+		}
+
+		UINT slotIndex;
+		if (mFreeSlots.empty())
+		{
+			slotIndex = mSlots.size();
+			mSlots.push_back(Slot());
+		}
+		else
+		{
+			slotIndex = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		}
+
+		Insert(slotIndex, FindArchetype(componentMask));
+		mStatistics.EntityCount++;
+
+		return Entity(slotIndex, mSlots[slotIndex].Generation);
+	}
+
+	void EntityWorld::Destroy(Entity entity)
+	{
+		Slot slot = GetSlot(entity);
+		RemoveRow(slot.ArchetypeIndex, slot.ChunkIndex, slot.Row);
+
+		Slot& freedSlot = mSlots[entity.Index];
+		freedSlot.ArchetypeIndex = InvalidIndex;
+		freedSlot.Generation++;
+		mFreeSlots.push_back(entity.Index);
+		mStatistics.EntityCount--;
+	}
+
+	UINT EntityWorld::ComponentMask(Entity entity) const
+	{
+		return mArchetypes[GetSlot(entity).ArchetypeIndex].ComponentMask;
+	}
+
+	bool EntityWorld::HasComponent(Entity entity, EntityComponentType type) const
+	{
+		return ((ComponentMask(entity) & ComponentBit(type)) != 0);
+	}
+
+	void EntityWorld::AddComponents(Entity entity, UINT componentMask)
+	{
+		UINT currentMask = ComponentMask(entity);
+		UINT newMask = currentMask | componentMask;
+		if (newMask >= ComponentBit(EntityComponentTypeCount))
+		{
+			throw GameException("Unknown entity component type.");
+		}
+
+		if (newMask == currentMask)
+		{
+			return;
+		}
+
+		Slot oldSlot = mSlots[entity.Index];
+		Insert(entity.Index, FindArchetype(newMask));
+
+		const Slot& newSlot = mSlots[entity.Index];
+		CopyRow(ChunkAt(oldSlot), oldSlot.Row, ChunkAt(newSlot), newSlot.Row);
+		RemoveRow(oldSlot.ArchetypeIndex, oldSlot.ChunkIndex, oldSlot.Row);
+	}
+
+	void EntityWorld::RemoveComponents(Entity entity, UINT componentMask)
+	{
+		UINT currentMask = ComponentMask(entity);
+		UINT newMask = currentMask & ~componentMask;
+		if (newMask == currentMask)
+		{
+			return;
+		}
+
+		Slot oldSlot = mSlots[entity.Index];
+		Insert(entity.Index, FindArchetype(newMask));
+
+		const Slot& newSlot = mSlots[entity.Index];
+		CopyRow(ChunkAt(oldSlot), oldSlot.Row, ChunkAt(newSlot), newSlot.Row);
+		RemoveRow(oldSlot.ArchetypeIndex, oldSlot.ChunkIndex, oldSlot.Row);
+	}
+
+	EntityWorld::Transform EntityWorld::GetTransform(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentTransform);
+		const Chunk& chunk = ChunkAt(slot);
+
+		return Transform(chunk.Positions[slot.Row], chunk.Rotations[slot.Row], chunk.Scales[slot.Row]);
+	}
+
+	void EntityWorld::SetTransform(Entity entity, const Transform& transform)
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentTransform);
+		Chunk& chunk = ChunkAt(slot);
+
+		chunk.Positions[slot.Row] = transform.Position;
+		chunk.Rotations[slot.Row] = transform.Rotation;
+		chunk.Scales[slot.Row] = transform.Scale;
+	}
+
+	const XMFLOAT4X4& EntityWorld::WorldTransform(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentTransform);
+
+		return ChunkAt(slot).WorldTransforms[slot.Row];
+	}
+
+	const AxisAlignedBox& EntityWorld::LocalBounds(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentBounds);
+
+		return ChunkAt(slot).LocalBounds[slot.Row];
+	}
+
+	void EntityWorld::SetLocalBounds(Entity entity, const AxisAlignedBox& bounds)
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentBounds);
+
+		ChunkAt(slot).LocalBounds[slot.Row] = bounds;
+	}
+
+	AxisAlignedBox EntityWorld::WorldBounds(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentBounds);
+		const Chunk& chunk = ChunkAt(slot);
+		UINT row = slot.Row;
+
+		return AxisAlignedBox(XMFLOAT3(chunk.WorldMinimumX[row], chunk.WorldMinimumY[row], chunk.WorldMinimumZ[row]), XMFLOAT3(chunk.WorldMaximumX[row], chunk.WorldMaximumY[row], chunk.WorldMaximumZ[row]));
+	}
+
+	bool EntityWorld::IsVisible(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity);
+
+		return ChunkAt(slot).IsVisible(slot.Row);
+	}
+
+	Mesh* EntityWorld::GetMesh(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentMesh);
+
+		return ChunkAt(slot).Meshes[slot.Row];
+	}
+
+	void EntityWorld::SetMesh(Entity entity, Mesh* mesh)
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentMesh);
+
+		ChunkAt(slot).Meshes[slot.Row] = mesh;
+	}
+
+	Material* EntityWorld::GetMaterial(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentMaterial);
+
+		return ChunkAt(slot).Materials[slot.Row];
+	}
+
+	void EntityWorld::SetMaterial(Entity entity, Material* material)
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentMaterial);
+
+		ChunkAt(slot).Materials[slot.Row] = material;
+	}
+
+	EntityWorld::AnimationState EntityWorld::GetAnimationState(Entity entity) const
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentAnimation);
+		const Chunk& chunk = ChunkAt(slot);
+		UINT row = slot.Row;
+
+		AnimationState state;
+		state.Clip = chunk.AnimationClips[row];
+		state.Time = chunk.AnimationTimes[row];
+		state.Duration = chunk.AnimationDurations[row];
+		state.Speed = chunk.AnimationSpeeds[row];
+		state.IsLooping = (chunk.AnimationLoops[row] != 0);
+
+		return state;
+	}
+
+	void EntityWorld::SetAnimationState(Entity entity, const AnimationState& state)
+	{
+		const Slot& slot = GetSlot(entity, EntityComponentAnimation);
+		Chunk& chunk = ChunkAt(slot);
+		UINT row = slot.Row;
+
+		chunk.AnimationClips[row] = state.Clip;
+		chunk.AnimationTimes[row] = state.Time;
+		chunk.AnimationDurations[row] = state.Duration;
+		chunk.AnimationSpeeds[row] = state.Speed;
+		chunk.AnimationLoops[row] = (state.IsLooping ? 1 : 0);
+	}
+
+	void EntityWorld::UpdateAnimations(float elapsedSeconds)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		ForEachChunkParallel(ComponentBit(EntityComponentAnimation), [elapsedSeconds](Chunk& chunk)
+		{
+			UINT count = chunk.Count();
+			float* times = chunk.AnimationTimes;
+			const float* durations = chunk.AnimationDurations;
+			const float* speeds = chunk.AnimationSpeeds;
+
+			for (UINT i = 0; i < count; i++)
+			{
+				times[i] += elapsedSeconds * speeds[i];
+			}
+
+			for (UINT i = 0; i < count; i++)
+			{
+				float duration = durations[i];
+				if (times[i] >= duration || times[i] < 0.0f)
+				{
+					if (chunk.AnimationLoops[i] != 0 && duration > 0.0f)
+					{
+						times[i] = std::fmod(times[i], duration);
+						if (times[i] < 0.0f)
+						{
+							times[i] += duration;
+						}
+					}
+					else
+					{
+						times[i] = (times[i] < 0.0f ? 0.0f : duration);
+					}
+				}
+			}
+		});
+
+		mStatistics.AnimationMilliseconds = RealClockSource::Milliseconds() - startTime;
+	}
+
+	void EntityWorld::UpdateTransforms()
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		const std::vector<Chunk*>& chunks = AllChunks();
+		Parallel::For(0, chunks.size(), 1, [&chunks](UINT begin, UINT end)
+		{
+			for (UINT i = begin; i < end; i++)
+			{
+				UpdateChunkTransforms(*chunks[i]);
+			}
+		});
+
+		mStatistics.TransformMilliseconds = RealClockSource::Milliseconds() - startTime;
+	}
+
+	UINT EntityWorld::Cull(const Frustum& frustum)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		std::vector<Chunk*> chunks;
+		ForEachChunk(ComponentBit(EntityComponentBounds), [&chunks](Chunk& chunk)
+		{
+			chunks.push_back(&chunk);
+		});
+
+		// Each range culls with a culler of its own; they only share the frustum
+		Parallel::For(0, chunks.size(), 1, [&chunks, &frustum](UINT begin, UINT end)
+		{
+			FrustumCuller culler(frustum);
+			for (UINT i = begin; i < end; i++)
+			{
+				Chunk& chunk = *chunks[i];
+				UINT visibleCount = culler.GetStatistics().VisibleCount;
+				culler.Cull(chunk.WorldBounds(), chunk.VisibilityMask);
+				chunk.VisibleCount = culler.GetStatistics().VisibleCount - visibleCount;
+			}
+		});
+
+		mStatistics.CulledCount = 0;
+		mStatistics.VisibleCount = 0;
+		for (Chunk* chunk : chunks)
+		{
+			mStatistics.CulledCount += chunk->Count();
+			mStatistics.VisibleCount += chunk->VisibleCount;
+		}
+
+		mStatistics.CullMilliseconds = RealClockSource::Milliseconds() - startTime;
+
+		return mStatistics.VisibleCount;
+	}
+
+	void EntityWorld::ForEachChunk(UINT componentMask, const std::function<void(Chunk&)>& function)
+	{
+		for (Archetype& archetype : mArchetypes)
+		{
+			if ((archetype.ComponentMask & componentMask) == componentMask)
+			{
+				for (Chunk* chunk : archetype.Chunks)
+				{
+					function(*chunk);
+				}
+			}
+		}
+	}
+
+	void EntityWorld::ForEachChunkParallel(UINT componentMask, const std::function<void(Chunk&)>& function)
+	{
+		std::vector<Chunk*> chunks;
+		ForEachChunk(componentMask, [&chunks](Chunk& chunk)
+		{
+			chunks.push_back(&chunk);
+		});
+
+		Parallel::For(0, chunks.size(), 1, [&chunks, &function](UINT begin, UINT end)
+		{
+			for (UINT i = begin; i < end; i++)
+			{
+				function(*chunks[i]);
+			}
+		});
+	}
+
+	const EntityWorld::Statistics& EntityWorld::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	const EntityWorld::Slot& EntityWorld::GetSlot(Entity entity) const
+	{
+		if (IsValid(entity) == false)
+		{
+			throw GameException("Invalid entity handle.");
+		}
+
+		return mSlots[entity.Index];
+	}
+
+	const EntityWorld::Slot& EntityWorld::GetSlot(Entity entity, EntityComponentType type) const
+	{
+		const Slot& slot = GetSlot(entity);
+		if ((mArchetypes[slot.ArchetypeIndex].ComponentMask & ComponentBit(type)) == 0)
+		{
+			throw GameException("The entity does not have the requested component.");
+		}
+
+		return slot;
+	}
+
+	EntityWorld::Chunk& EntityWorld::ChunkAt(const Slot& slot) const
+	{
+		return *mArchetypes[slot.ArchetypeIndex].Chunks[slot.ChunkIndex];
+	}
+
+	UINT EntityWorld::FindArchetype(UINT componentMask)
+	{
+		for (UINT i = 0; i < mArchetypes.size(); i++)
+		{
+			if (mArchetypes[i].ComponentMask == componentMask)
+			{
+				return i;
+			}
+		}
+
+		Archetype archetype;
+		archetype.ComponentMask = componentMask;
+		mArchetypes.push_back(archetype);
+		mStatistics.ArchetypeCount = mArchetypes.size();
+
+		return mArchetypes.size() - 1;
+	}
+
+	void EntityWorld::Insert(UINT slotIndex, UINT archetypeIndex)
+	{
+		// Only the last chunk of an archetype can have room, since removals refill from the end
+		Archetype& archetype = mArchetypes[archetypeIndex];
+		if (archetype.Chunks.empty() || archetype.Chunks.back()->Count() == ChunkCapacity)
+		{
+			archetype.Chunks.push_back(new Chunk(archetype.ComponentMask));
+			mAreChunksDirty = true;
+			mStatistics.ChunkCount++;
+		}
+
+		Chunk& chunk = *archetype.Chunks.back();
+		PushRow(chunk);
+
+		Slot& slot = mSlots[slotIndex];
+		slot.ArchetypeIndex = archetypeIndex;
+		slot.ChunkIndex = archetype.Chunks.size() - 1;
+		slot.Row = chunk.Count() - 1;
+		chunk.Entities[slot.Row] = Entity(slotIndex, slot.Generation);
+	}
+
+	void EntityWorld::RemoveRow(UINT archetypeIndex, UINT chunkIndex, UINT row)
+	{
+		Archetype& archetype = mArchetypes[archetypeIndex];
+		UINT lastChunkIndex = archetype.Chunks.size() - 1;
+		Chunk& lastChunk = *archetype.Chunks[lastChunkIndex];
+		UINT lastRow = lastChunk.Count() - 1;
+
+		if (chunkIndex != lastChunkIndex || row != lastRow)
+		{
+			Chunk& chunk = *archetype.Chunks[chunkIndex];
+			CopyRow(lastChunk, lastRow, chunk, row);
+
+			Entity moved = lastChunk.Entities[lastRow];
+			chunk.Entities[row] = moved;
+
+			Slot& movedSlot = mSlots[moved.Index];
+			movedSlot.ChunkIndex = chunkIndex;
+			movedSlot.Row = row;
+		}
+
+		PopRow(lastChunk);
+		if (lastChunk.Count() == 0)
+		{
+			delete archetype.Chunks.back();
+			archetype.Chunks.pop_back();
+			mAreChunksDirty = true;
+			mStatistics.ChunkCount--;
+		}
+	}
+
+	const std::vector<EntityWorld::Chunk*>& EntityWorld::AllChunks()
+	{
+		if (mAreChunksDirty)
+		{
+			mChunks.clear();
+			for (Archetype& archetype : mArchetypes)
+			{
+				mChunks.insert(mChunks.end(), archetype.Chunks.begin(), archetype.Chunks.end());
+			}
+
+			mAreChunksDirty = false;
+		}
+
+		return mChunks;
+	}
+
+	void EntityWorld::PushRow(Chunk& chunk)
+	{
+		assert(chunk.mCount < ChunkCapacity);
+		UINT row = chunk.mCount++;
+		chunk.Entities[row] = InvalidEntity;
+
+		if (chunk.Has(EntityComponentTransform))
+		{
+			chunk.Positions[row] = Vector3Helper::Zero;
+			chunk.Rotations[row] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+			chunk.Scales[row] = Vector3Helper::One;
+			chunk.WorldTransforms[row] = MatrixHelper::Identity;
+		}
+
+		if (chunk.Has(EntityComponentBounds))
+		{
+			// Visible until the first cull says otherwise; a row's word is cleared when the row starts a new one
+			chunk.LocalBounds[row] = AxisAlignedBox(Vector3Helper::Zero, Vector3Helper::Zero);
+			chunk.WorldMinimumX[row] = 0.0f;
+			chunk.WorldMinimumY[row] = 0.0f;
+			chunk.WorldMinimumZ[row] = 0.0f;
+			chunk.WorldMaximumX[row] = 0.0f;
+			chunk.WorldMaximumY[row] = 0.0f;
+			chunk.WorldMaximumZ[row] = 0.0f;
+
+			UINT& word = chunk.VisibilityMask[row >> 5];
+			word = ((row & 31) == 0 ? 0 : word) | (1 << (row & 31));
+		}
+
+		if (chunk.Has(EntityComponentMesh))
+		{
+			chunk.Meshes[row] = nullptr;
+		}
+
+		if (chunk.Has(EntityComponentMaterial))
+		{
+			chunk.Materials[row] = nullptr;
+		}
+
+		if (chunk.Has(EntityComponentAnimation))
+		{
+			AnimationState state;
+			chunk.AnimationClips[row] = state.Clip;
+			chunk.AnimationTimes[row] = state.Time;
+			chunk.AnimationDurations[row] = state.Duration;
+			chunk.AnimationSpeeds[row] = state.Speed;
+			chunk.AnimationLoops[row] = (state.IsLooping ? 1 : 0);
+		}
+	}
+
+	void EntityWorld::PopRow(Chunk& chunk)
+	{
+		// The row's data is simply left behind; only its visibility bit is cleared, since Cull writes whole words
+		UINT row = --chunk.mCount;
+
+		if (chunk.Has(EntityComponentBounds))
+		{
+			chunk.VisibilityMask[row >> 5] &= ~(1 << (row & 31));
+		}
+	}
+
+	void EntityWorld::CopyRow(const Chunk& source, UINT sourceRow, Chunk& destination, UINT destinationRow)
+	{
+		UINT sharedMask = source.ComponentMask & destination.ComponentMask;
+
+		if ((sharedMask & ComponentBit(EntityComponentTransform)) != 0)
+		{
+			destination.Positions[destinationRow] = source.Positions[sourceRow];
+			destination.Rotations[destinationRow] = source.Rotations[sourceRow];
+			destination.Scales[destinationRow] = source.Scales[sourceRow];
+			destination.WorldTransforms[destinationRow] = source.WorldTransforms[sourceRow];
+		}
+
+		if ((sharedMask & ComponentBit(EntityComponentBounds)) != 0)
+		{
+			destination.LocalBounds[destinationRow] = source.LocalBounds[sourceRow];
+			destination.WorldMinimumX[destinationRow] = source.WorldMinimumX[sourceRow];
+			destination.WorldMinimumY[destinationRow] = source.WorldMinimumY[sourceRow];
+			destination.WorldMinimumZ[destinationRow] = source.WorldMinimumZ[sourceRow];
+			destination.WorldMaximumX[destinationRow] = source.WorldMaximumX[sourceRow];
+			destination.WorldMaximumY[destinationRow] = source.WorldMaximumY[sourceRow];
+			destination.WorldMaximumZ[destinationRow] = source.WorldMaximumZ[sourceRow];
+
+			UINT bit = (1 << (destinationRow & 31));
+			UINT& word = destination.VisibilityMask[destinationRow >> 5];
+			word = (source.IsVisible(sourceRow) ? word | bit : word & ~bit);
+		}
+
+		if ((sharedMask & ComponentBit(EntityComponentMesh)) != 0)
+		{
+			destination.Meshes[destinationRow] = source.Meshes[sourceRow];
+		}
+
+		if ((sharedMask & ComponentBit(EntityComponentMaterial)) != 0)
+		{
+			destination.Materials[destinationRow] = source.Materials[sourceRow];
+		}
+
+		if ((sharedMask & ComponentBit(EntityComponentAnimation)) != 0)
+		{
+			destination.AnimationClips[destinationRow] = source.AnimationClips[sourceRow];
+			destination.AnimationTimes[destinationRow] = source.AnimationTimes[sourceRow];
+			destination.AnimationDurations[destinationRow] = source.AnimationDurations[sourceRow];
+			destination.AnimationSpeeds[destinationRow] = source.AnimationSpeeds[sourceRow];
+			destination.AnimationLoops[destinationRow] = source.AnimationLoops[sourceRow];
+		}
+	}
+
+	void EntityWorld::UpdateChunkTransforms(Chunk& chunk)
+	{
+		UINT count = chunk.Count();
+		bool hasTransform = chunk.Has(EntityComponentTransform);
+		bool hasBounds = chunk.Has(EntityComponentBounds);
+
+		if (hasTransform)
+		{
+			for (UINT i = 0; i < count; i++)
+			{
+				XMMATRIX transform = XMMatrixAffineTransformation(XMLoadFloat3(&chunk.Scales[i]), XMVectorZero(), XMLoadFloat4(&chunk.Rotations[i]), XMLoadFloat3(&chunk.Positions[i]));
+				XMStoreFloat4x4(&chunk.WorldTransforms[i], transform);
+			}
+		}
+
+		if (hasBounds == false)
+		{
+			return;
+		}
+
+		for (UINT i = 0; i < count; i++)
+		{
+			const AxisAlignedBox& localBounds = chunk.LocalBounds[i];
+			XMVECTOR center = XMLoadFloat3(&localBounds.Minimum) + XMLoadFloat3(&localBounds.Maximum);
+			XMVECTOR extents = XMLoadFloat3(&localBounds.Maximum) - XMLoadFloat3(&localBounds.Minimum);
+			center *= 0.5f;
+			extents *= 0.5f;
+
+			if (hasTransform)
+			{
+				// The box around a transformed box: the centre moves with the matrix, the extents through its absolute value
+				XMMATRIX transform = XMLoadFloat4x4(&chunk.WorldTransforms[i]);
+				center = XMVector3Transform(center, transform);
+				extents = XMVectorAbs(transform.r[0]) * XMVectorSplatX(extents) + XMVectorAbs(transform.r[1]) * XMVectorSplatY(extents) + XMVectorAbs(transform.r[2]) * XMVectorSplatZ(extents);
+			}
+
+			XMFLOAT3 minimum;
+			XMFLOAT3 maximum;
+			XMStoreFloat3(&minimum, center - extents);
+			XMStoreFloat3(&maximum, center + extents);
+
+			chunk.WorldMinimumX[i] = minimum.x;
+			chunk.WorldMinimumY[i] = minimum.y;
+			chunk.WorldMinimumZ[i] = minimum.z;
+			chunk.WorldMaximumX[i] = maximum.x;
+			chunk.WorldMaximumY[i] = maximum.y;
+			chunk.WorldMaximumZ[i] = maximum.z;
+		}
+	}
+}
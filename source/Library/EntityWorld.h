@@ -0,0 +1,239 @@
+#pragma once
+
+#include "Common.h"
+#include "AxisAlignedBox.h"
+#include "FrustumCuller.h"
+#include <functional>
+
+namespace Library
+{
+	class Frustum;
+	class Mesh;
+	class Material;
+
+	enum EntityComponentType
+	{
+		EntityComponentTransform = 0,
+		EntityComponentBounds,
+		EntityComponentMesh,
+		EntityComponentMaterial,
+		EntityComponentAnimation,
+		EntityComponentTypeCount
+	};
+
+	// Storage for large numbers of plain-data scene objects. An entity is a set of components (a mask of
+	// EntityComponentType bits); all entities with the same set form an archetype, whose data lives in fixed-capacity
+	// chunks with every component field in a column of its own, so systems stream over exactly the fields they touch.
+	// A chunk's columns are laid out by offset in a single block, so creating a chunk is one allocation.
+	// Archetypes stay dense: removing an entity moves the archetype's last entity into its place. Entities are referenced
+	// through generation-checked handles, while chunk rows are only stable until the next structural change.
+	// The world is not thread-safe, but its systems split their own work across chunks.
+	class EntityWorld
+	{
+	public:
+		struct Entity
+		{
+			UINT Index;
+			UINT Generation;
+
+			Entity()
+				: Index(UINT_MAX), Generation(0) { }
+
+			Entity(UINT index, UINT generation)
+				: Index(index), Generation(generation) { }
+
+			bool operator==(const Entity& rhs) const { return (Index == rhs.Index && Generation == rhs.Generation); }
+			bool operator!=(const Entity& rhs) const { return !(*this == rhs); }
+		};
+
+		struct Transform
+		{
+			XMFLOAT3 Position;
+			XMFLOAT4 Rotation;
+			XMFLOAT3 Scale;
+
+			Transform();
+			Transform(const XMFLOAT3& position, const XMFLOAT4& rotation, const XMFLOAT3& scale);
+		};
+
+		// Time within a clip; looping clips wrap at Duration while the rest hold their last pose
+		struct AnimationState
+		{
+			UINT Clip;
+			float Time;
+			float Duration;
+			float Speed;
+			bool IsLooping;
+
+			AnimationState();
+		};
+
+		// Every column has room for ChunkCapacity rows and starts on a cache line of the chunk's block; columns of
+		// components outside ComponentMask are null. The world bounds (WorldMinimumX through WorldMaximumZ) and
+		// VisibilityMask (bit i of word i / 32) are written by UpdateTransforms and Cull respectively.
+		struct Chunk
+		{
+			UINT ComponentMask;
+			Entity* Entities;
+
+			XMFLOAT3* Positions;
+			XMFLOAT4* Rotations;
+			XMFLOAT3* Scales;
+			XMFLOAT4X4* WorldTransforms;
+
+			AxisAlignedBox* LocalBounds;
+			float* WorldMinimumX;
+			float* WorldMinimumY;
+			float* WorldMinimumZ;
+			float* WorldMaximumX;
+			float* WorldMaximumY;
+			float* WorldMaximumZ;
+			UINT* VisibilityMask;
+			UINT VisibleCount;
+
+			Mesh** Meshes;
+			Material** Materials;
+
+			UINT* AnimationClips;
+			float* AnimationTimes;
+			float* AnimationDurations;
+			float* AnimationSpeeds;
+			byte* AnimationLoops;
+
+			Chunk(UINT componentMask);
+			~Chunk();
+
+			UINT Count() const;
+			bool Has(EntityComponentType type) const;
+			bool IsVisible(UINT row) const;
+			FrustumCuller::BoxColumns WorldBounds() const;
+
+		private:
+			friend class EntityWorld;
+
+			Chunk(const Chunk& rhs);
+			Chunk& operator=(const Chunk& rhs);
+
+			static const UINT ColumnAlignment = 64;
+
+			// Points the columns into block, or only measures them when block is null, and returns the block's size
+			UINT PlaceColumns(byte* block);
+
+			template <typename T>
+			static T* PlaceColumn(byte* block, UINT& size);
+			template <typename T>
+			static T* PlaceColumn(byte* block, UINT& size, UINT count);
+
+			byte* mBlock;
+			UINT mCount;
+		};
+
+		struct Statistics
+		{
+			UINT EntityCount;
+			UINT ArchetypeCount;
+			UINT ChunkCount;
+			UINT CulledCount;
+			UINT VisibleCount;
+			double AnimationMilliseconds;
+			double TransformMilliseconds;
+			double CullMilliseconds;
+
+			Statistics()
+				: EntityCount(0), ArchetypeCount(0), ChunkCount(0), CulledCount(0), VisibleCount(0),
+				  AnimationMilliseconds(0.0), TransformMilliseconds(0.0), CullMilliseconds(0.0) { }
+		};
+
+		static const Entity InvalidEntity;
+		static const UINT ChunkCapacity;
+
+		static UINT ComponentBit(EntityComponentType type);
+
+		EntityWorld();
+		~EntityWorld();
+
+		UINT EntityCount() const;
+		bool IsValid(Entity entity) const;
+
+		Entity Create(UINT componentMask);
+		void Destroy(Entity entity);
+
+		// Changing an entity's components moves it to another archetype; the components it keeps keep their values
+		UINT ComponentMask(Entity entity) const;
+		bool HasComponent(Entity entity, EntityComponentType type) const;
+		void AddComponents(Entity entity, UINT componentMask);
+		void RemoveComponents(Entity entity, UINT componentMask);
+
+		Transform GetTransform(Entity entity) const;
+		void SetTransform(Entity entity, const Transform& transform);
+		const XMFLOAT4X4& WorldTransform(Entity entity) const;
+
+		const AxisAlignedBox& LocalBounds(Entity entity) const;
+		void SetLocalBounds(Entity entity, const AxisAlignedBox& bounds);
+		AxisAlignedBox WorldBounds(Entity entity) const;
+		bool IsVisible(Entity entity) const;
+
+		Mesh* GetMesh(Entity entity) const;
+		void SetMesh(Entity entity, Mesh* mesh);
+		Material* GetMaterial(Entity entity) const;
+		void SetMaterial(Entity entity, Material* material);
+
+		AnimationState GetAnimationState(Entity entity) const;
+		void SetAnimationState(Entity entity, const AnimationState& state);
+
+		// Systems, each run over whole chunks and spread across workers through Parallel::For
+		void UpdateAnimations(float elapsedSeconds);
+		void UpdateTransforms();
+		UINT Cull(const Frustum& frustum);
+
+		// Visits every chunk whose archetype includes all of componentMask; the parallel form may visit several at once
+		void ForEachChunk(UINT componentMask, const std::function<void(Chunk&)>& function);
+		void ForEachChunkParallel(UINT componentMask, const std::function<void(Chunk&)>& function);
+
+		const Statistics& GetStatistics() const;
+
+	private:
+		EntityWorld(const EntityWorld& rhs);
+		EntityWorld& operator=(const EntityWorld& rhs);
+
+		struct Archetype
+		{
+			UINT ComponentMask;
+			std::vector<Chunk*> Chunks;
+		};
+
+		// Where a live entity's data is; ArchetypeIndex is InvalidIndex for free slots
+		struct Slot
+		{
+			UINT ArchetypeIndex;
+			UINT ChunkIndex;
+			UINT Row;
+			UINT Generation;
+
+			Slot()
+				: ArchetypeIndex(InvalidIndex), ChunkIndex(0), Row(0), Generation(0) { }
+		};
+
+		static const UINT InvalidIndex;
+
+		const Slot& GetSlot(Entity entity) const;
+		const Slot& GetSlot(Entity entity, EntityComponentType type) const;
+		Chunk& ChunkAt(const Slot& slot) const;
+		UINT FindArchetype(UINT componentMask);
+		void Insert(UINT slotIndex, UINT archetypeIndex);
+		void RemoveRow(UINT archetypeIndex, UINT chunkIndex, UINT row);
+		const std::vector<Chunk*>& AllChunks();
+
+		static void PushRow(Chunk& chunk);
+		static void PopRow(Chunk& chunk);
+		static void CopyRow(const Chunk& source, UINT sourceRow, Chunk& destination, UINT destinationRow);
+		static void UpdateChunkTransforms(Chunk& chunk);
+
+		std::vector<Archetype> mArchetypes;
+		std::vector<Slot> mSlots;
+		std::vector<UINT> mFreeSlots;
+		std::vector<Chunk*> mChunks;		// Every archetype's chunks together, rebuilt after chunks are added or freed
+		bool mAreChunksDirty;
+		Statistics mStatistics;
+	};
+}
@@ -0,0 +1,68 @@
+#include "EntityWorldComponent.h"
+#include "Camera.h"
+#include "Frustum.h"
+#include "GameTime.h"
+
+namespace Library
+{
+	RTTI_DEFINITIONS(EntityWorldComponent)
+
+	const UINT EntityWorldComponent::DefaultDrawComponentMask = EntityWorld::ComponentBit(EntityComponentTransform) | EntityWorld::ComponentBit(EntityComponentMesh) | EntityWorld::ComponentBit(EntityComponentMaterial);
+
+	EntityWorldComponent::EntityWorldComponent(Game& game, EntityWorld& world)
+		: DrawableGameComponent(game), mWorld(&world), mDrawFunction(), mDrawComponentMask(DefaultDrawComponentMask)
+	{
+		DeclareWrite(mWorld);
+	}
+
+	EntityWorldComponent::EntityWorldComponent(Game& game, Camera& camera, EntityWorld& world)
+		: DrawableGameComponent(game, camera), mWorld(&world), mDrawFunction(), mDrawComponentMask(DefaultDrawComponentMask)
+	{
+		DeclareWrite(mWorld);
+		DeclareRead(mCamera);
+	}
+
+	EntityWorldComponent::~EntityWorldComponent()
+	{
+	}
+
+	EntityWorld& EntityWorldComponent::World() const
+	{
+		return *mWorld;
+	}
+
+	UINT EntityWorldComponent::DrawComponentMask() const
+	{
+		return mDrawComponentMask;
+	}
+
+	void EntityWorldComponent::SetDrawFunction(const DrawFunction& drawFunction, UINT drawComponentMask)
+	{
+		mDrawFunction = drawFunction;
+		mDrawComponentMask = drawComponentMask;
+	}
+
+	void EntityWorldComponent::Update(const GameTime& gameTime)
+	{
+		mWorld->UpdateAnimations(static_cast<float>(gameTime.ElapsedGameTime()));
+		mWorld->UpdateTransforms();
+
+		if (mCamera != nullptr)
+		{
+			mWorld->Cull(Frustum(mCamera->ViewProjectionMatrix()));
+		}
+	}
+
+	void EntityWorldComponent::Draw(const GameTime& gameTime)
+	{
+		if (mDrawFunction == nullptr)
+		{
+			return;
+		}
+
+		mWorld->ForEachChunk(mDrawComponentMask, [this, &gameTime](EntityWorld::Chunk& chunk)
+		{
+			mDrawFunction(chunk, gameTime);
+		});
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "DrawableGameComponent.h"
+#include "EntityWorld.h"
+#include <functional>
+
+namespace Library
+{
+	// Runs an EntityWorld's systems as an ordinary component, so entities and GameComponents share one game loop.
+	// Update advances animations, recomputes transforms and, given a camera, culls against its frustum; it declares a
+	// write of the world and a read of the camera, so components that only touch other resources update alongside it.
+	// Draw hands each chunk holding drawable entities to the draw function, which renders the rows IsVisible reports.
+	class EntityWorldComponent : public DrawableGameComponent
+	{
+		RTTI_DECLARATIONS(EntityWorldComponent, DrawableGameComponent)
+
+	public:
+		typedef std::function<void(const EntityWorld::Chunk& chunk, const GameTime& gameTime)> DrawFunction;
+
+		static const UINT DefaultDrawComponentMask;
+
+		EntityWorldComponent(Game& game, EntityWorld& world);
+		EntityWorldComponent(Game& game, Camera& camera, EntityWorld& world);
+		~EntityWorldComponent();
+
+		EntityWorld& World() const;
+
+		UINT DrawComponentMask() const;
+		void SetDrawFunction(const DrawFunction& drawFunction, UINT drawComponentMask = DefaultDrawComponentMask);
+
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void Draw(const GameTime& gameTime) override;
+
+	private:
+		EntityWorldComponent();
+		EntityWorldComponent(const EntityWorldComponent& rhs);
+		EntityWorldComponent& operator=(const EntityWorldComponent& rhs);
+
+		EntityWorld* mWorld;
+		DrawFunction mDrawFunction;
+		UINT mDrawComponentMask;
+	};
+}
@@ -73,6 +73,10 @@ namespace Library
 		mKeyboard = (Keyboard*)mGame->Services().GetService(Keyboard::TypeIdClass());
 		mMouse = (Mouse*)mGame->Services().GetService(Mouse::TypeIdClass());
 
+		DeclareRead(mKeyboard);
+		DeclareRead(mMouse);
+		DeclareWrite(this);
+
 		Camera::Initialize();
 	}
 
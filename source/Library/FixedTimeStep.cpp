@@ -0,0 +1,101 @@
+#include "FixedTimeStep.h"
+#include "GameTime.h"
+#include "GameException.h"
+#include <cmath>
+#include <algorithm>
+
+namespace Library
+{
+	const double FixedTimeStep::DefaultStepSeconds = 1.0 / 60.0;
+	const UINT FixedTimeStep::DefaultMaxStepsPerFrame = 5;
+	const double FixedTimeStep::StepTolerance = 1e-6;
+
+	FixedTimeStep::FixedTimeStep(double stepSeconds, UINT maxStepsPerFrame)
+		: mStepSeconds(0.0), mMaxStepsPerFrame(0), mAccumulatedSeconds(0.0), mSimulatedSeconds(0.0), mStatistics()
+	{
+		SetStepSeconds(stepSeconds);
+		SetMaxStepsPerFrame(maxStepsPerFrame);
+	}
+
+	double FixedTimeStep::StepSeconds() const
+	{
+		return mStepSeconds;
+	}
+
+	void FixedTimeStep::SetStepSeconds(double stepSeconds)
+	{
+		if (stepSeconds <= 0.0)
+		{
+			throw GameException("A fixed time step must be longer than zero.");
+		}
+
+		mStepSeconds = stepSeconds;
+	}
+
+	UINT FixedTimeStep::MaxStepsPerFrame() const
+	{
+		return mMaxStepsPerFrame;
+	}
+
+	void FixedTimeStep::SetMaxStepsPerFrame(UINT maxStepsPerFrame)
+	{
+		if (maxStepsPerFrame == 0)
+		{
+			throw GameException("A fixed time step must allow at least one step per frame.");
+		}
+
+		mMaxStepsPerFrame = maxStepsPerFrame;
+	}
+
+	void FixedTimeStep::Reset()
+	{
+		mAccumulatedSeconds = 0.0;
+		mSimulatedSeconds = 0.0;
+		mStatistics = Statistics();
+	}
+
+	UINT FixedTimeStep::Advance(double elapsedSeconds)
+	{
+		mStatistics.FrameCount++;
+		mAccumulatedSeconds += (elapsedSeconds > 0.0 ? elapsedSeconds : 0.0);
+
+		double maxAccumulatedSeconds = mStepSeconds * mMaxStepsPerFrame;
+		if (mAccumulatedSeconds > maxAccumulatedSeconds)
+		{
+			mStatistics.ClampedFrameCount++;
+			mStatistics.DroppedSeconds += mAccumulatedSeconds - maxAccumulatedSeconds;
+			mAccumulatedSeconds = maxAccumulatedSeconds;
+		}
+
+		// Frames that match the step exactly would otherwise alternate between none and two steps through rounding
+		UINT stepCount = static_cast<UINT>(std::floor(mAccumulatedSeconds / mStepSeconds + StepTolerance));
+		mAccumulatedSeconds = (std::max)(mAccumulatedSeconds - stepCount * mStepSeconds, 0.0);
+		mStatistics.StepCount += stepCount;
+
+		return stepCount;
+	}
+
+	void FixedTimeStep::Step(GameTime& gameTime)
+	{
+		mSimulatedSeconds += mStepSeconds;
+
+		gameTime.SetTotalGameTime(mSimulatedSeconds);
+		gameTime.SetElapsedGameTime(mStepSeconds);
+		gameTime.SetInterpolationAlpha(1.0);
+	}
+
+	double FixedTimeStep::Alpha() const
+	{
+		return mAccumulatedSeconds / mStepSeconds;
+	}
+
+	double FixedTimeStep::SimulatedSeconds() const
+	{
+		return mSimulatedSeconds;
+	}
+
+	const FixedTimeStep::Statistics& FixedTimeStep::GetStatistics() const
+	{
+		return mStatistics;
+	}
+}
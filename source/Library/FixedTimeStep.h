@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	class GameTime;
+
+	// Turns variable frame times into a whole number of fixed simulation steps. Elapsed time accumulates and each frame
+	// runs as many steps as fit in it; what remains, as a fraction of a step, is the interpolation alpha for drawing
+	// between the last two simulated states. After a stall the accumulator is clamped to MaxStepsPerFrame steps and the
+	// rest of the time is dropped, so a slow frame cannot trigger an ever-growing run of catch-up steps.
+	// The class reads no clock itself; the caller supplies each frame's elapsed time.
+	class FixedTimeStep
+	{
+	public:
+		struct Statistics
+		{
+			UINT FrameCount;
+			UINT StepCount;
+			UINT ClampedFrameCount;
+			double DroppedSeconds;
+
+			Statistics()
+				: FrameCount(0), StepCount(0), ClampedFrameCount(0), DroppedSeconds(0.0) { }
+		};
+
+		static const double DefaultStepSeconds;
+		static const UINT DefaultMaxStepsPerFrame;
+
+		FixedTimeStep(double stepSeconds = DefaultStepSeconds, UINT maxStepsPerFrame = DefaultMaxStepsPerFrame);
+
+		double StepSeconds() const;
+		void SetStepSeconds(double stepSeconds);
+
+		UINT MaxStepsPerFrame() const;
+		void SetMaxStepsPerFrame(UINT maxStepsPerFrame);
+
+		void Reset();
+
+		// Returns the number of steps to simulate this frame; call Step once before each of them
+		UINT Advance(double elapsedSeconds);
+		void Step(GameTime& gameTime);
+
+		double Alpha() const;
+		double SimulatedSeconds() const;
+		const Statistics& GetStatistics() const;
+
+	private:
+		FixedTimeStep(const FixedTimeStep& rhs);
+		FixedTimeStep& operator=(const FixedTimeStep& rhs);
+
+		static const double StepTolerance;		// As a fraction of a step
+
+		double mStepSeconds;
+		UINT mMaxStepsPerFrame;
+		double mAccumulatedSeconds;
+		double mSimulatedSeconds;
+		Statistics mStatistics;
+	};
+}
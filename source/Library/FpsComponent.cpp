@@ -1,10 +1,9 @@
 #include "FpsComponent.h"
-#include <sstream>
-#include <iomanip>
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include "Game.h"
 #include "Utility.h"
+#include "TextBuilder.h"
 
 namespace Library
 {
@@ -52,9 +51,10 @@ namespace Library
 	{
 		mSpriteBatch->Begin();
 
-		std::wostringstream fpsLabel;
-		fpsLabel << std::setprecision(4) << L"Frame Rate: " << mFrameRate << "     Total Elapsed Time: " << gameTime.TotalGameTime();
-		mSpriteFont->DrawString(mSpriteBatch, fpsLabel.str().c_str(), mTextPosition);
+		TextBuilder fpsLabel(mGame->FrameArena());
+		fpsLabel.SetPrecision(4);
+		fpsLabel << L"Frame Rate: " << mFrameRate << "     Total Elapsed Time: " << gameTime.TotalGameTime();
+		mSpriteFont->DrawString(mSpriteBatch, fpsLabel.Text(), mTextPosition);
 
 		mSpriteBatch->End();
 	}
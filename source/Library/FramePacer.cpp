@@ -0,0 +1,111 @@
+#include "FramePacer.h"
+#include "ClockSource.h"
+#include "GameException.h"
+
+namespace Library
+{
+	const UINT FramePacer::DefaultTargetFrameRate = 60;
+	const double FramePacer::DefaultSpinSeconds = 0.002;
+
+	FramePacer::FramePacer(UINT targetFrameRate)
+		: mTargetFrameRate(targetFrameRate), mSpinSeconds(DefaultSpinSeconds), mClockSource(&RealClockSource::Instance()),
+		  mHasDeadline(false), mDeadline(0.0), mStatistics()
+	{
+	}
+
+	FramePacer::FramePacer(UINT targetFrameRate, ClockSource& clockSource)
+		: mTargetFrameRate(targetFrameRate), mSpinSeconds(DefaultSpinSeconds), mClockSource(&clockSource),
+		  mHasDeadline(false), mDeadline(0.0), mStatistics()
+	{
+	}
+
+	FramePacer::~FramePacer()
+	{
+	}
+
+	ClockSource& FramePacer::Source() const
+	{
+		return *mClockSource;
+	}
+
+	void FramePacer::SetSource(ClockSource& clockSource)
+	{
+		mClockSource = &clockSource;
+		mHasDeadline = false;
+	}
+
+	UINT FramePacer::TargetFrameRate() const
+	{
+		return mTargetFrameRate;
+	}
+
+	void FramePacer::SetTargetFrameRate(UINT targetFrameRate)
+	{
+		mTargetFrameRate = targetFrameRate;
+		mHasDeadline = false;
+	}
+
+	double FramePacer::SpinSeconds() const
+	{
+		return mSpinSeconds;
+	}
+
+	void FramePacer::SetSpinSeconds(double spinSeconds)
+	{
+		if (spinSeconds < 0.0)
+		{
+			throw GameException("Frame pacing cannot spin for a negative time.");
+		}
+
+		mSpinSeconds = spinSeconds;
+	}
+
+	void FramePacer::Reset()
+	{
+		mHasDeadline = false;
+		mStatistics = Statistics();
+	}
+
+	void FramePacer::Wait()
+	{
+		if (mTargetFrameRate == 0)
+		{
+			return;
+		}
+
+		double period = 1.0 / mTargetFrameRate;
+		double now = mClockSource->Seconds();
+		mStatistics.FrameCount++;
+
+		if (mHasDeadline == false)
+		{
+			mDeadline = now + period;
+			mHasDeadline = true;
+		}
+
+		if (now >= mDeadline)
+		{
+			mStatistics.MissedFrameCount++;
+			mDeadline = (now - mDeadline > period ? now : mDeadline) + period;
+			return;
+		}
+
+		double sleepSeconds = mDeadline - now - mSpinSeconds;
+		if (sleepSeconds > 0.0)
+		{
+			mClockSource->Sleep(sleepSeconds);
+			double afterSleep = mClockSource->Seconds();
+			mStatistics.SleptSeconds += afterSleep - now;
+			now = afterSleep;
+		}
+
+		mClockSource->WaitUntil(mDeadline);
+		mStatistics.SpunSeconds += mClockSource->Seconds() - now;
+		mDeadline += period;
+	}
+
+	const FramePacer::Statistics& FramePacer::GetStatistics() const
+	{
+		return mStatistics;
+	}
+}
\ No newline at end of file
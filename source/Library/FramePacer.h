@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	class ClockSource;
+
+	// Holds frames to a target rate by waiting at the end of each one for its deadline, so the loop stops burning a core
+	// once it is ahead. It sleeps until SpinSeconds before the deadline, since sleeps only wake at scheduler granularity,
+	// then waits on the clock for the remainder. Deadlines advance by exactly one period so the average rate stays on
+	// target; a frame that runs more than a period late restarts the schedule from now rather than rushing to catch up.
+	// Given a VirtualClockSource, pacing runs without waiting at all.
+	class FramePacer
+	{
+	public:
+		struct Statistics
+		{
+			UINT FrameCount;
+			UINT MissedFrameCount;
+			double SleptSeconds;
+			double SpunSeconds;
+
+			Statistics()
+				: FrameCount(0), MissedFrameCount(0), SleptSeconds(0.0), SpunSeconds(0.0) { }
+		};
+
+		static const UINT DefaultTargetFrameRate;
+		static const double DefaultSpinSeconds;
+
+		FramePacer(UINT targetFrameRate = DefaultTargetFrameRate);
+		FramePacer(UINT targetFrameRate, ClockSource& clockSource);
+		~FramePacer();
+
+		ClockSource& Source() const;
+		void SetSource(ClockSource& clockSource);
+
+		// Zero disables pacing
+		UINT TargetFrameRate() const;
+		void SetTargetFrameRate(UINT targetFrameRate);
+
+		double SpinSeconds() const;
+		void SetSpinSeconds(double spinSeconds);
+
+		void Reset();
+		void Wait();
+
+		const Statistics& GetStatistics() const;
+
+	private:
+		FramePacer(const FramePacer& rhs);
+		FramePacer& operator=(const FramePacer& rhs);
+
+		UINT mTargetFrameRate;
+		double mSpinSeconds;
+		ClockSource* mClockSource;
+		bool mHasDeadline;
+		double mDeadline;
+		Statistics mStatistics;
+	};
+}
@@ -73,6 +73,42 @@ namespace Library
 		return mCorners;
 	}
 
+	bool Frustum::Contains(const XMFLOAT3& point) const
+	{
+		return Intersects(point, 0.0f);
+	}
+
+	bool Frustum::Intersects(const XMFLOAT3& center, float radius) const
+	{
+		for (const XMFLOAT4& plane : mPlanes)
+		{
+			if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w > radius)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Frustum::Intersects(const XMFLOAT3& minimum, const XMFLOAT3& maximum) const
+	{
+		// Conservative: a box is rejected only when the corner nearest the inside of some plane is still outside it
+		for (const XMFLOAT4& plane : mPlanes)
+		{
+			float x = (plane.x > 0.0f ? minimum.x : maximum.x);
+			float y = (plane.y > 0.0f ? minimum.y : maximum.y);
+			float z = (plane.z > 0.0f ? minimum.z : maximum.z);
+
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w > 0.0f)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	XMMATRIX Frustum::Matrix() const
 	{
 		return XMLoadFloat4x4(&mMatrix);
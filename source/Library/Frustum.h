@@ -15,6 +15,7 @@ namespace Library
 		FrustumPlaneBottom
 	};
 
+	// Planes are normalized and face outward, so a point is inside when its signed distance to every plane is not positive.
 	class Frustum
 	{
 	public:
@@ -36,6 +37,10 @@ namespace Library
 
 		const XMFLOAT3* Corners() const;
 
+		bool Contains(const XMFLOAT3& point) const;
+		bool Intersects(const XMFLOAT3& center, float radius) const;
+		bool Intersects(const XMFLOAT3& minimum, const XMFLOAT3& maximum) const;
+
 		XMMATRIX Matrix() const;
 		void SetMatrix(CXMMATRIX matrix);
 		void SetMatrix(const XMFLOAT4X4& matrix);
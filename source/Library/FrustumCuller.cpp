@@ -0,0 +1,337 @@
+#include "FrustumCuller.h"
+#include "ClockSource.h"
+#include "Frustum.h"
+#include <algorithm>
+
+namespace Library
+{
+	const UINT FrustumCuller::LaneBitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+	void FrustumCuller::SphereArray::Add(const XMFLOAT3& center, float radius)
+	{
+		CenterX.push_back(center.x);
+		CenterY.push_back(center.y);
+		CenterZ.push_back(center.z);
+		Radius.push_back(radius);
+	}
+
+	void FrustumCuller::SphereArray::Set(UINT index, const XMFLOAT3& center, float radius)
+	{
+		CenterX[index] = center.x;
+		CenterY[index] = center.y;
+		CenterZ[index] = center.z;
+		Radius[index] = radius;
+	}
+
+	void FrustumCuller::SphereArray::Reserve(UINT count)
+	{
+		CenterX.reserve(count);
+		CenterY.reserve(count);
+		CenterZ.reserve(count);
+		Radius.reserve(count);
+	}
+
+	void FrustumCuller::SphereArray::Clear()
+	{
+		CenterX.clear();
+		CenterY.clear();
+		CenterZ.clear();
+		Radius.clear();
+	}
+
+	void FrustumCuller::BoxArray::Add(const XMFLOAT3& minimum, const XMFLOAT3& maximum)
+	{
+		MinimumX.push_back(minimum.x);
+		MinimumY.push_back(minimum.y);
+		MinimumZ.push_back(minimum.z);
+		MaximumX.push_back(maximum.x);
+		MaximumY.push_back(maximum.y);
+		MaximumZ.push_back(maximum.z);
+	}
+
+	void FrustumCuller::BoxArray::Set(UINT index, const XMFLOAT3& minimum, const XMFLOAT3& maximum)
+	{
+		MinimumX[index] = minimum.x;
+		MinimumY[index] = minimum.y;
+		MinimumZ[index] = minimum.z;
+		MaximumX[index] = maximum.x;
+		MaximumY[index] = maximum.y;
+		MaximumZ[index] = maximum.z;
+	}
+
+	void FrustumCuller::BoxArray::Reserve(UINT count)
+	{
+		MinimumX.reserve(count);
+		MinimumY.reserve(count);
+		MinimumZ.reserve(count);
+		MaximumX.reserve(count);
+		MaximumY.reserve(count);
+		MaximumZ.reserve(count);
+	}
+
+	void FrustumCuller::BoxArray::Clear()
+	{
+		MinimumX.clear();
+		MinimumY.clear();
+		MinimumZ.clear();
+		MaximumX.clear();
+		MaximumY.clear();
+		MaximumZ.clear();
+	}
+
+	FrustumCuller::BoxColumns::BoxColumns(const BoxArray& boxes)
+		: MinimumX(boxes.MinimumX.data()), MinimumY(boxes.MinimumY.data()), MinimumZ(boxes.MinimumZ.data()),
+		  MaximumX(boxes.MaximumX.data()), MaximumY(boxes.MaximumY.data()), MaximumZ(boxes.MaximumZ.data()), Count(boxes.Count())
+	{
+	}
+
+	FrustumCuller::FrustumCuller(const Frustum& frustum)
+		: mPlanes(), mStatistics()
+	{
+		SetFrustum(frustum);
+	}
+
+	void FrustumCuller::SetFrustum(const Frustum& frustum)
+	{
+		mPlanes[FrustumPlaneNear] = frustum.Near();
+		mPlanes[FrustumPlaneFar] = frustum.Far();
+		mPlanes[FrustumPlaneLeft] = frustum.Left();
+		mPlanes[FrustumPlaneRight] = frustum.Right();
+		mPlanes[FrustumPlaneTop] = frustum.Top();
+		mPlanes[FrustumPlaneBottom] = frustum.Bottom();
+	}
+
+	void FrustumCuller::Cull(const SphereArray& spheres, std::vector<UINT>& visibilityMask)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		PlaneVectors planes;
+		LoadPlanes(planes);
+
+		UINT count = spheres.Count();
+		UINT visibleCount = 0;
+		visibilityMask.assign((count + 31) / 32, 0);
+
+		// Groups of four never straddle a 32-bit word
+		for (UINT i = 0; i < count; i += 4)
+		{
+			UINT laneMask = (count - i >= 4 ? 0xF : (1 << (count - i)) - 1);
+			UINT visible = ~SphereOutsideMask(planes, spheres, i) & laneMask;
+
+			visibilityMask[i >> 5] |= (visible << (i & 31));
+			visibleCount += LaneBitCounts[visible];
+		}
+
+		mStatistics.TestedCount += count;
+		mStatistics.VisibleCount += visibleCount;
+		mStatistics.Milliseconds += RealClockSource::Milliseconds() - startTime;
+	}
+
+	void FrustumCuller::Cull(const BoxArray& boxes, std::vector<UINT>& visibilityMask)
+	{
+		visibilityMask.resize((boxes.Count() + 31) / 32);
+		Cull(BoxColumns(boxes), visibilityMask.data());
+	}
+
+	void FrustumCuller::Cull(const BoxColumns& boxes, UINT* visibilityMask)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		PlaneVectors planes;
+		LoadPlanes(planes);
+
+		UINT count = boxes.Count;
+		UINT visibleCount = 0;
+		std::fill(visibilityMask, visibilityMask + (count + 31) / 32, 0);
+
+		for (UINT i = 0; i < count; i += 4)
+		{
+			UINT laneMask = (count - i >= 4 ? 0xF : (1 << (count - i)) - 1);
+			UINT visible = ~BoxOutsideMask(planes, boxes, i) & laneMask;
+
+			visibilityMask[i >> 5] |= (visible << (i & 31));
+			visibleCount += LaneBitCounts[visible];
+		}
+
+		mStatistics.TestedCount += count;
+		mStatistics.VisibleCount += visibleCount;
+		mStatistics.Milliseconds += RealClockSource::Milliseconds() - startTime;
+	}
+
+	UINT FrustumCuller::CollectVisible(const SphereArray& spheres, std::vector<UINT>& visibleIndices)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		PlaneVectors planes;
+		LoadPlanes(planes);
+
+		// Sized for the worst case up front so the inner loop writes without growing the vector
+		UINT count = spheres.Count();
+		UINT visibleCount = 0;
+		visibleIndices.resize(count);
+
+		for (UINT i = 0; i < count; i += 4)
+		{
+			UINT laneMask = (count - i >= 4 ? 0xF : (1 << (count - i)) - 1);
+			UINT visible = ~SphereOutsideMask(planes, spheres, i) & laneMask;
+
+			for (UINT lane = 0; visible != 0; lane++, visible >>= 1)
+			{
+				if (visible & 1)
+				{
+					visibleIndices[visibleCount++] = i + lane;
+				}
+			}
+		}
+
+		visibleIndices.resize(visibleCount);
+
+		mStatistics.TestedCount += count;
+		mStatistics.VisibleCount += visibleCount;
+		mStatistics.Milliseconds += RealClockSource::Milliseconds() - startTime;
+
+		return visibleCount;
+	}
+
+	UINT FrustumCuller::CollectVisible(const BoxArray& boxes, std::vector<UINT>& visibleIndices)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		PlaneVectors planes;
+		LoadPlanes(planes);
+
+		BoxColumns columns(boxes);
+		UINT count = columns.Count;
+		UINT visibleCount = 0;
+		visibleIndices.resize(count);
+
+		for (UINT i = 0; i < count; i += 4)
+		{
+			UINT laneMask = (count - i >= 4 ? 0xF : (1 << (count - i)) - 1);
+			UINT visible = ~BoxOutsideMask(planes, columns, i) & laneMask;
+
+			for (UINT lane = 0; visible != 0; lane++, visible >>= 1)
+			{
+				if (visible & 1)
+				{
+					visibleIndices[visibleCount++] = i + lane;
+				}
+			}
+		}
+
+		visibleIndices.resize(visibleCount);
+
+		mStatistics.TestedCount += count;
+		mStatistics.VisibleCount += visibleCount;
+		mStatistics.Milliseconds += RealClockSource::Milliseconds() - startTime;
+
+		return visibleCount;
+	}
+
+	const FrustumCuller::Statistics& FrustumCuller::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void FrustumCuller::ResetStatistics()
+	{
+		mStatistics = Statistics();
+	}
+
+	bool FrustumCuller::IsVisible(const std::vector<UINT>& visibilityMask, UINT index)
+	{
+		return ((visibilityMask[index >> 5] & (1 << (index & 31))) != 0);
+	}
+
+	void FrustumCuller::LoadPlanes(PlaneVectors& planes) const
+	{
+		for (UINT i = 0; i < PlaneCount; i++)
+		{
+			const XMFLOAT4& plane = mPlanes[i];
+			planes.X[i] = XMVectorReplicate(plane.x);
+			planes.Y[i] = XMVectorReplicate(plane.y);
+			planes.Z[i] = XMVectorReplicate(plane.z);
+			planes.W[i] = XMVectorReplicate(plane.w);
+
+			// Planes face outward, so the corner that reaches furthest inside takes the minimum along positive normal components
+			planes.SelectMinimumX[i] = (plane.x > 0.0f ? XMVectorTrueInt() : XMVectorFalseInt());
+			planes.SelectMinimumY[i] = (plane.y > 0.0f ? XMVectorTrueInt() : XMVectorFalseInt());
+			planes.SelectMinimumZ[i] = (plane.z > 0.0f ? XMVectorTrueInt() : XMVectorFalseInt());
+		}
+	}
+
+	UINT FrustumCuller::SphereOutsideMask(const PlaneVectors& planes, const SphereArray& spheres, UINT index)
+	{
+		XMVECTOR x = LoadLanes(spheres.CenterX, index);
+		XMVECTOR y = LoadLanes(spheres.CenterY, index);
+		XMVECTOR z = LoadLanes(spheres.CenterZ, index);
+		XMVECTOR radius = LoadLanes(spheres.Radius, index);
+
+		XMVECTOR outside = XMVectorFalseInt();
+		for (UINT i = 0; i < PlaneCount; i++)
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(x, planes.X[i], XMVectorMultiplyAdd(y, planes.Y[i], XMVectorMultiplyAdd(z, planes.Z[i], planes.W[i])));
+			outside = XMVectorOrInt(outside, XMVectorGreater(distance, radius));
+		}
+
+		return OutsideMask(outside);
+	}
+
+	UINT FrustumCuller::BoxOutsideMask(const PlaneVectors& planes, const BoxColumns& boxes, UINT index)
+	{
+		XMVECTOR minimumX = LoadLanes(boxes.MinimumX, boxes.Count, index);
+		XMVECTOR minimumY = LoadLanes(boxes.MinimumY, boxes.Count, index);
+		XMVECTOR minimumZ = LoadLanes(boxes.MinimumZ, boxes.Count, index);
+		XMVECTOR maximumX = LoadLanes(boxes.MaximumX, boxes.Count, index);
+		XMVECTOR maximumY = LoadLanes(boxes.MaximumY, boxes.Count, index);
+		XMVECTOR maximumZ = LoadLanes(boxes.MaximumZ, boxes.Count, index);
+
+		XMVECTOR outside = XMVectorFalseInt();
+		for (UINT i = 0; i < PlaneCount; i++)
+		{
+			XMVECTOR x = XMVectorSelect(maximumX, minimumX, planes.SelectMinimumX[i]);
+			XMVECTOR y = XMVectorSelect(maximumY, minimumY, planes.SelectMinimumY[i]);
+			XMVECTOR z = XMVectorSelect(maximumZ, minimumZ, planes.SelectMinimumZ[i]);
+
+			XMVECTOR distance = XMVectorMultiplyAdd(x, planes.X[i], XMVectorMultiplyAdd(y, planes.Y[i], XMVectorMultiplyAdd(z, planes.Z[i], planes.W[i])));
+			outside = XMVectorOrInt(outside, XMVectorGreater(distance, XMVectorZero()));
+		}
+
+		return OutsideMask(outside);
+	}
+
+	XMVECTOR FrustumCuller::LoadLanes(const std::vector<float>& values, UINT index)
+	{
+		return LoadLanes(values.data(), values.size(), index);
+	}
+
+	XMVECTOR FrustumCuller::LoadLanes(const float* values, UINT count, UINT index)
+	{
+		if (count - index >= 4)
+		{
+			return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+		}
+
+		// The final partial group is padded with zeros; its unused lanes are masked off by the caller
+		XMFLOAT4 lanes(0.0f, 0.0f, 0.0f, 0.0f);
+		float* lane = reinterpret_cast<float*>(&lanes);
+		for (UINT i = index; i < count; i++)
+		{
+			*lane++ = values[i];
+		}
+
+		return XMLoadFloat4(&lanes);
+	}
+
+	UINT FrustumCuller::OutsideMask(FXMVECTOR outside)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		return static_cast<UINT>(_mm_movemask_ps(outside));
+#else
+		XMUINT4 lanes;
+		XMStoreUInt4(&lanes, outside);
+
+		return ((lanes.x & 1) | ((lanes.y & 1) << 1) | ((lanes.z & 1) << 2) | ((lanes.w & 1) << 3));
+#endif
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	class Frustum;
+
+	// Tests large batches of bounding spheres or boxes against a frustum four objects at a time. Bounds are kept in
+	// structure-of-arrays form so each register holds one coordinate of four objects, and the per-plane choice of box
+	// corner is made once per batch as a set of select masks built from the plane signs rather than once per object.
+	// Results are written either as a visibility bitmask (bit i of word i / 32) or as a compacted list of visible indices.
+	class FrustumCuller
+	{
+	public:
+		struct SphereArray
+		{
+			std::vector<float> CenterX;
+			std::vector<float> CenterY;
+			std::vector<float> CenterZ;
+			std::vector<float> Radius;
+
+			SphereArray()
+				: CenterX(), CenterY(), CenterZ(), Radius() { }
+
+			UINT Count() const { return CenterX.size(); }
+			void Add(const XMFLOAT3& center, float radius);
+			void Set(UINT index, const XMFLOAT3& center, float radius);
+			void Reserve(UINT count);
+			void Clear();
+		};
+
+		struct BoxArray
+		{
+			std::vector<float> MinimumX;
+			std::vector<float> MinimumY;
+			std::vector<float> MinimumZ;
+			std::vector<float> MaximumX;
+			std::vector<float> MaximumY;
+			std::vector<float> MaximumZ;
+
+			BoxArray()
+				: MinimumX(), MinimumY(), MinimumZ(), MaximumX(), MaximumY(), MaximumZ() { }
+
+			UINT Count() const { return MinimumX.size(); }
+			void Add(const XMFLOAT3& minimum, const XMFLOAT3& maximum);
+			void Set(UINT index, const XMFLOAT3& minimum, const XMFLOAT3& maximum);
+			void Reserve(UINT count);
+			void Clear();
+		};
+
+		// Boxes in the same layout whose columns are stored elsewhere, such as in an entity chunk
+		struct BoxColumns
+		{
+			const float* MinimumX;
+			const float* MinimumY;
+			const float* MinimumZ;
+			const float* MaximumX;
+			const float* MaximumY;
+			const float* MaximumZ;
+			UINT Count;
+
+			BoxColumns(const float* minimumX, const float* minimumY, const float* minimumZ, const float* maximumX, const float* maximumY, const float* maximumZ, UINT count)
+				: MinimumX(minimumX), MinimumY(minimumY), MinimumZ(minimumZ), MaximumX(maximumX), MaximumY(maximumY), MaximumZ(maximumZ), Count(count) { }
+
+			BoxColumns(const BoxArray& boxes);
+		};
+
+		struct Statistics
+		{
+			UINT TestedCount;
+			UINT VisibleCount;
+			double Milliseconds;
+
+			Statistics()
+				: TestedCount(0), VisibleCount(0), Milliseconds(0.0) { }
+		};
+
+		FrustumCuller(const Frustum& frustum);
+
+		void SetFrustum(const Frustum& frustum);
+
+		void Cull(const SphereArray& spheres, std::vector<UINT>& visibilityMask);
+		void Cull(const BoxArray& boxes, std::vector<UINT>& visibilityMask);
+		void Cull(const BoxColumns& boxes, UINT* visibilityMask);	// Writes (boxes.Count + 31) / 32 words
+		UINT CollectVisible(const SphereArray& spheres, std::vector<UINT>& visibleIndices);
+		UINT CollectVisible(const BoxArray& boxes, std::vector<UINT>& visibleIndices);
+
+		const Statistics& GetStatistics() const;
+		void ResetStatistics();
+
+		static bool IsVisible(const std::vector<UINT>& visibilityMask, UINT index);
+
+	private:
+		FrustumCuller();
+		FrustumCuller(const FrustumCuller& rhs);
+		FrustumCuller& operator=(const FrustumCuller& rhs);
+
+		static const UINT PlaneCount = 6;
+
+		// Plane coefficients and corner selects replicated across all four lanes, built once per call on the stack
+		struct PlaneVectors
+		{
+			XMVECTOR X[PlaneCount];
+			XMVECTOR Y[PlaneCount];
+			XMVECTOR Z[PlaneCount];
+			XMVECTOR W[PlaneCount];
+			XMVECTOR SelectMinimumX[PlaneCount];
+			XMVECTOR SelectMinimumY[PlaneCount];
+			XMVECTOR SelectMinimumZ[PlaneCount];
+		};
+
+		void LoadPlanes(PlaneVectors& planes) const;
+		static UINT SphereOutsideMask(const PlaneVectors& planes, const SphereArray& spheres, UINT index);
+		static UINT BoxOutsideMask(const PlaneVectors& planes, const BoxColumns& boxes, UINT index);
+		static XMVECTOR LoadLanes(const std::vector<float>& values, UINT index);
+		static XMVECTOR LoadLanes(const float* values, UINT count, UINT index);
+		static UINT OutsideMask(FXMVECTOR outside);
+
+		static const UINT LaneBitCounts[16];
+
+		XMFLOAT4 mPlanes[PlaneCount];
+		Statistics mStatistics;
+	};
+}
@@ -49,7 +49,7 @@ namespace Library
 		mInputLayout = mMaterial->InputLayouts().at(mPass);
 	}
 
-	void FullScreenQuad::SetCustomUpdateMaterial(std::function<void()> callback)
+	void FullScreenQuad::SetCustomUpdateMaterial(const std::function<void()>& callback)
 	{
 		mCustomUpdateMaterial = callback;
 	}
@@ -21,7 +21,9 @@ namespace Library
 		Material* GetMaterial();
 		void SetMaterial(Material& material, const std::string& techniqueName, const std::string& passName);
 		void SetActiveTechnique(const std::string& techniqueName, const std::string& passName);
-		void SetCustomUpdateMaterial(std::function<void()> callback);
+				// The callback is copied on every call, so callers that switch callbacks each frame keep them in members rather
+		// than binding new ones
+		void SetCustomUpdateMaterial(const std::function<void()>& callback);
 
 		virtual void Initialize() override;
 		virtual void Draw(const GameTime& gameTime) override;
@@ -1,12 +1,15 @@
 #include "FullScreenRenderTarget.h"
 #include "Game.h"
 #include "GameException.h"
+#include "MemoryTracker.h"
 
 namespace Library
 {
 	FullScreenRenderTarget::FullScreenRenderTarget(Game& game)
-		: mGame(&game), mRenderTargetView(nullptr), mDepthStencilView(nullptr), mOutputTexture(nullptr)
+		: mGame(&game), mRenderTargetView(nullptr), mDepthStencilView(nullptr), mOutputTexture(nullptr), mTextureBytes(0)
 	{
+		MemoryScope memoryScope(MemorySubsystemRenderTargets);
+
 		D3D11_TEXTURE2D_DESC fullScreenTextureDesc;
 		ZeroMemory(&fullScreenTextureDesc, sizeof(fullScreenTextureDesc));
 		fullScreenTextureDesc.Width = game.ScreenWidth();
@@ -64,10 +67,15 @@ namespace Library
 		}
 
 		ReleaseObject(depthStencilBuffer);
+
+		// Four bytes a pixel for color and four for depth and stencil
+		mTextureBytes = static_cast<INT64>(game.ScreenWidth()) * game.ScreenHeight() * 8;
+		MemoryTracker::RecordExternal(MemorySubsystemRenderTargets, mTextureBytes);
 	}
 
 	FullScreenRenderTarget::~FullScreenRenderTarget()
 	{
+		MemoryTracker::RecordExternal(MemorySubsystemRenderTargets, -mTextureBytes);
 		ReleaseObject(mOutputTexture);
 		ReleaseObject(mDepthStencilView);
 		ReleaseObject(mRenderTargetView);
@@ -28,5 +28,6 @@ namespace Library
 		ID3D11RenderTargetView* mRenderTargetView;
 		ID3D11DepthStencilView* mDepthStencilView;
 		ID3D11ShaderResourceView* mOutputTexture;
+		INT64 mTextureBytes;
 	};
 }
\ No newline at end of file
@@ -1,6 +1,18 @@
 #include "Game.h"
 #include "DrawableGameComponent.h"
 #include "GameException.h"
+#include "ModelCache.h"
+#include "JobSystem.h"
+#include "ComponentGraph.h"
+#include "Parallel.h"
+#include "ClockSource.h"
+#include "RenderPipeline.h"
+#include "MemoryArena.h"
+#include "MemoryTracker.h"
+#include "AssetLoader.h"
+#include "Utility.h"
+#include <algorithm>
+#include <typeinfo>
 
 namespace Library
 {
@@ -10,22 +22,46 @@ namespace Library
 	const UINT Game::DefaultScreenHeight = 768;
 	const UINT Game::DefaultFrameRate = 60;
 	const UINT Game::DefaultMultiSamplingCount = 4;
+	const UINT Game::AllocationCheckWarmUpFrames = 60;
+
+#if defined( DEBUG ) || defined( _DEBUG )
+	_CRT_ALLOC_HOOK Game::sPreviousAllocationHook = nullptr;
+	volatile DWORD Game::sDrawThreadId = 0;
+	UINT Game::sDrawAllocationCount = 0;
+#endif
 
 	Game::Game(HINSTANCE instance, const std::wstring& windowClass, const std::wstring& windowTitle, int showCommand)
-		: RenderTarget(), mInstance(instance), mWindowClass(windowClass), mWindowTitle(windowTitle), mShowCommand(showCommand),
+		: RenderTarget(), mInstance(instance), mWindowClass(windowClass), mWindowTitle(windowTitle), mShowCommand(showCommand), mIsHeadless(false),
 		mWindowHandle(), mWindow(),
 		mScreenWidth(DefaultScreenWidth), mScreenHeight(DefaultScreenHeight),
-		mGameClock(), mGameTime(),
+		mGameClock(), mGameTime(), mIsFixedTimeStep(false), mFixedTimeStep(), mSimulationTime(), mFramePacer(0), mHasTimerResolution(false), mIsPipelined(false),
 		mFeatureLevel(D3D_FEATURE_LEVEL_9_1), mDirect3DDevice(nullptr), mDirect3DDeviceContext(nullptr), mSwapChain(nullptr),
 		mFrameRate(DefaultFrameRate), mIsFullScreen(false),
 		mDepthStencilBufferEnabled(false), mMultiSamplingEnabled(false), mMultiSamplingCount(DefaultMultiSamplingCount), mMultiSamplingQualityLevels(0),
 		mDepthStencilBuffer(nullptr), mRenderTargetView(nullptr), mDepthStencilView(nullptr), mViewport(),
-		mComponents(), mServices()
+		mServices(), mModelCache(nullptr), mJobSystem(nullptr), mAssetLoader(nullptr), mUpdateGraph(nullptr), mRenderPipeline(nullptr), mFrameArena(nullptr),
+		mComponents(), mDrawableComponents(), mSteadyStateDrawAllocations(0), mPeakDrawAllocations(0)
 	{
+		mJobSystem = new JobSystem();
+		mModelCache = new ModelCache(*this, *mJobSystem);
+		mAssetLoader = new AssetLoader(*this, *mJobSystem);
+		mUpdateGraph = new ComponentGraph(*mJobSystem);
+		mRenderPipeline = new RenderPipeline([this](const RenderSnapshot& snapshot) { DrawFrame(snapshot); });
+		mFrameArena = new MemoryArena();
+		Parallel::SetJobSystem(mJobSystem);
+
+		mHasTimerResolution = RealClockSource::BeginTimerResolution();
 	}
 
 	Game::~Game()
 	{
+		// Shutdown has already done this unless Run never got that far
+		DeleteServices();
+
+		if (mHasTimerResolution)
+		{
+			RealClockSource::EndTimerResolution();
+		}
 	}
 
 	HINSTANCE Game::Instance() const
@@ -128,11 +164,87 @@ namespace Library
 		return mComponents;
 	}
 
+	const std::vector<DrawableGameComponent*>& Game::DrawableComponents() const
+	{
+		return mDrawableComponents;
+	}
+
 	const ServiceContainer& Game::Services() const
 	{
 		return mServices;
 	}
 
+	ModelCache& Game::Models() const
+	{
+		return *mModelCache;
+	}
+
+	JobSystem& Game::Jobs() const
+	{
+		return *mJobSystem;
+	}
+
+	AssetLoader& Game::Assets() const
+	{
+		return *mAssetLoader;
+	}
+
+	const ComponentGraph& Game::UpdateGraph() const
+	{
+		return *mUpdateGraph;
+	}
+
+	ComponentGraph& Game::UpdateGraph()
+	{
+		return *mUpdateGraph;
+	}
+
+	bool Game::IsFixedTimeStep() const
+	{
+		return mIsFixedTimeStep;
+	}
+
+	const FixedTimeStep& Game::TimeStep() const
+	{
+		return mFixedTimeStep;
+	}
+
+	const FramePacer& Game::Pacer() const
+	{
+		return mFramePacer;
+	}
+
+	RenderPipeline& Game::Pipeline() const
+	{
+		return *mRenderPipeline;
+	}
+
+	bool Game::IsPipelined() const
+	{
+		return mRenderPipeline->IsPipelined();
+	}
+
+	MemoryArena& Game::FrameArena() const
+	{
+		return *mFrameArena;
+	}
+
+	UINT Game::SteadyStateDrawAllocations() const
+	{
+		return mSteadyStateDrawAllocations;
+	}
+
+	bool Game::IsHeadless() const
+	{
+		return mIsHeadless;
+	}
+
+	void Game::SetClockSource(ClockSource& clockSource)
+	{
+		mGameClock.SetSource(clockSource);
+		mFramePacer.SetSource(clockSource);
+	}
+
 	void Game::Run()
 	{
 		InitializeWindow();
@@ -142,7 +254,7 @@ namespace Library
 		MSG message;
 		ZeroMemory(&message, sizeof(message));
 
-		mGameClock.Reset();
+		BeginFrames();
 
 		while (message.message != WM_QUIT)
 		{
@@ -153,15 +265,96 @@ namespace Library
 			}
 			else
 			{
-				mGameClock.UpdateGameTime(mGameTime);
-				Update(mGameTime);
-				Draw(mGameTime);
+				Tick();
 			}
 		}
 
+		EndFrames();
 		Shutdown();
 	}
 
+	double Game::RunHeadless(UINT frameCount)
+	{
+		mIsHeadless = true;
+		Initialize();
+		BeginFrames();
+
+		RealClockSource& realClock = RealClockSource::Instance();
+		double startTime = realClock.Seconds();
+
+		for (UINT i = 0; i < frameCount; i++)
+		{
+			Tick();
+		}
+
+		EndFrames();
+		double seconds = realClock.Seconds() - startTime;
+		Shutdown();
+
+		return seconds;
+	}
+
+	void Game::Tick()
+	{
+		mGameClock.Source().Advance();
+		mGameClock.UpdateGameTime(mGameTime);
+
+		if (mIsFixedTimeStep)
+		{
+			UINT stepCount = mFixedTimeStep.Advance(mGameTime.ElapsedGameTime());
+			for (UINT i = 0; i < stepCount; i++)
+			{
+				// The frame is drawn between the states before and after its last step, by the alpha left over
+				if (i == stepCount - 1)
+				{
+					CaptureFrame(mRenderPipeline->BeginCapture(mSimulationTime));
+					mRenderPipeline->KeepAsPreviousStep();
+				}
+
+				mFixedTimeStep.Step(mSimulationTime);
+				Update(mSimulationTime);
+			}
+
+			mSimulationTime.SetInterpolationAlpha(mFixedTimeStep.Alpha());
+			SubmitFrame(mSimulationTime);
+		}
+		else
+		{
+			Update(mGameTime);
+			SubmitFrame(mGameTime);
+		}
+
+		MemoryTracker::EndFrame();
+		mFramePacer.Wait();
+	}
+
+	void Game::AddComponent(GameComponent* component)
+	{
+		if (component == nullptr)
+		{
+			throw GameException("Cannot add a null component.");
+		}
+
+		mComponents.push_back(component);
+
+		DrawableGameComponent* drawableGameComponent = component->As<DrawableGameComponent>();
+		if (drawableGameComponent != nullptr)
+		{
+			mDrawableComponents.push_back(drawableGameComponent);
+		}
+	}
+
+	void Game::RemoveComponent(GameComponent* component)
+	{
+		mComponents.erase(std::remove(mComponents.begin(), mComponents.end(), component), mComponents.end());
+
+		DrawableGameComponent* drawableGameComponent = (component != nullptr ? component->As<DrawableGameComponent>() : nullptr);
+		if (drawableGameComponent != nullptr)
+		{
+			mDrawableComponents.erase(std::remove(mDrawableComponents.begin(), mDrawableComponents.end(), drawableGameComponent), mDrawableComponents.end());
+		}
+	}
+
 	void Game::Exit()
 	{
 		PostQuitMessage(0);
@@ -169,6 +362,8 @@ namespace Library
 
 	void Game::Shutdown()
 	{
+		DeleteServices();
+
 		ReleaseObject(mRenderTargetView);
 		ReleaseObject(mDepthStencilView);
 		ReleaseObject(mSwapChain);
@@ -182,40 +377,69 @@ namespace Library
 		ReleaseObject(mDirect3DDeviceContext);
 		ReleaseObject(mDirect3DDevice);
 
-		UnregisterClass(mWindowClass.c_str(), mWindow.hInstance);
+		if (mIsHeadless == false)
+		{
+			UnregisterClass(mWindowClass.c_str(), mWindow.hInstance);
+		}
+
+		// Derived games release their components before calling down, so every tagged subsystem should be empty here
+		MemoryTracker::ReportLeaks();
 	}
 
 	void Game::Initialize()
 	{
+		// Declared paths are relative to the executable, as every component loads them
+		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
+
+		for (GameComponent* component : mComponents)
+		{
+			for (const AssetRequest& request : component->DeclaredAssets())
+			{
+				mAssetLoader->Request(request);
+			}
+		}
+
 		for (GameComponent* component : mComponents)
 		{
+			mAssetLoader->WaitFor(component->DeclaredAssets());
+
+			double startMilliseconds = mAssetLoader->ElapsedMilliseconds();
 			component->Initialize();
+			mAssetLoader->RecordSpan(Utility::ToWideString(typeid(*component).name()), startMilliseconds, mAssetLoader->ElapsedMilliseconds());
 		}
+
+		mAssetLoader->WaitForAll();
+		mAssetLoader->Clear();
+
+#if defined( DEBUG ) || defined( _DEBUG )
+		const AssetLoader::Statistics& statistics = mAssetLoader->GetStatistics();
+
+		wchar_t message[160];
+		swprintf_s(message, L"Startup: %u asset requests took %.1f ms of loading on %u threads; components ready after %.1f ms.\n",
+			statistics.RequestCount, statistics.LoadMilliseconds, statistics.ThreadCount, mAssetLoader->ElapsedMilliseconds());
+		OutputDebugString(message);
+#endif
 	}
 
 	void Game::Update(const GameTime& gameTime)
 	{
-		for (GameComponent* component : mComponents)
-		{
-			if (component->Enabled())
-			{
-				component->Update(gameTime);
-			}
-		}
+		mModelCache->Update();
+		mUpdateGraph->Update(mComponents, gameTime);
 	}
 
 	void Game::Draw(const GameTime& gameTime)
 	{
-		for (GameComponent* component : mComponents)
+		// Visibility as captured, since a component may be hidden or shown while this frame draws
+		for (DrawableGameComponent* drawableGameComponent : mRenderPipeline->Current().VisibleComponents())
 		{
-			DrawableGameComponent* drawableGameComponent = component->As<DrawableGameComponent>();
-			if (drawableGameComponent != nullptr && drawableGameComponent->Visible())
-			{
-				drawableGameComponent->Draw(gameTime);
-			}
+			drawableGameComponent->Draw(gameTime);
 		}
 	}
 
+	void Game::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+	}
+
 	void Game::ResetRenderTargets()
 	{
 		mDirect3DDeviceContext->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
@@ -436,6 +660,138 @@ namespace Library
 		return DefWindowProc(windowHandle, message, wParam, lParam);
 	}
 
+	void Game::BeginFrames()
+	{
+		if (mIsPipelined)
+		{
+			for (DrawableGameComponent* drawableGameComponent : mDrawableComponents)
+			{
+				if (drawableGameComponent->DrawsFromSnapshot() == false)
+				{
+					throw GameException("Every drawable component of a pipelined game must draw from the render snapshot.");
+				}
+			}
+		}
+
+		mGameClock.Reset();
+		mFixedTimeStep.Reset();
+		mRenderPipeline->ClearPreviousStep();
+		mFramePacer.Reset();
+
+#if defined( DEBUG ) || defined( _DEBUG )
+		sPreviousAllocationHook = _CrtSetAllocHook(&Game::CountDrawAllocation);
+#endif
+
+		mRenderPipeline->SetPipelined(mIsPipelined);
+	}
+
+	void Game::EndFrames()
+	{
+		// Hands the device context and every component back to this thread before anything is released
+		mRenderPipeline->SetPipelined(false);
+
+#if defined( DEBUG ) || defined( _DEBUG )
+		_CrtSetAllocHook(sPreviousAllocationHook);
+		sPreviousAllocationHook = nullptr;
+#endif
+	}
+
+	void Game::SubmitFrame(const GameTime& gameTime)
+	{
+		CaptureFrame(mRenderPipeline->BeginCapture(gameTime));
+		mRenderPipeline->Submit();
+	}
+
+	void Game::CaptureFrame(RenderSnapshot& snapshot)
+	{
+		for (GameComponent* component : mComponents)
+		{
+			component->CaptureRenderState(snapshot);
+		}
+
+		for (DrawableGameComponent* drawableGameComponent : mDrawableComponents)
+		{
+			if (drawableGameComponent->Visible())
+			{
+				snapshot.AddVisibleComponent(drawableGameComponent);
+			}
+		}
+
+		CaptureRenderState(snapshot);
+	}
+
+	void Game::DrawFrame(const RenderSnapshot& snapshot)
+	{
+		BeginAllocationCheck();
+		Draw(snapshot.Time());
+		EndAllocationCheck(snapshot.FrameNumber());
+
+		mFrameArena->Reset();
+	}
+
+	void Game::DeleteServices()
+	{
+		// Waits for loads still in flight, some of which hand their models to the cache
+		DeleteObject(mAssetLoader);
+
+		// Waits for imports still in flight; models held by components outlive the cache
+		DeleteObject(mModelCache);
+
+		if (mJobSystem != nullptr && Parallel::CurrentJobSystem() == mJobSystem)
+		{
+			Parallel::SetJobSystem(nullptr);
+		}
+
+		DeleteObject(mRenderPipeline);
+		DeleteObject(mFrameArena);
+		DeleteObject(mUpdateGraph);
+		DeleteObject(mJobSystem);
+	}
+
+	void Game::BeginAllocationCheck()
+	{
+#if defined( DEBUG ) || defined( _DEBUG )
+		sDrawAllocationCount = 0;
+		sDrawThreadId = GetCurrentThreadId();
+#endif
+	}
+
+	void Game::EndAllocationCheck(UINT frameNumber)
+	{
+#if defined( DEBUG ) || defined( _DEBUG )
+		sDrawThreadId = 0;
+
+		// Only the worst frame so far is reported, which keeps a steady leak from flooding the output
+		if (frameNumber >= AllocationCheckWarmUpFrames && sDrawAllocationCount > 0)
+		{
+			mSteadyStateDrawAllocations += sDrawAllocationCount;
+			if (sDrawAllocationCount > mPeakDrawAllocations)
+			{
+				mPeakDrawAllocations = sDrawAllocationCount;
+
+				wchar_t message[128];
+				swprintf_s(message, L"Frame %u made %u heap allocations while drawing; use Game::FrameArena() instead.\n", frameNumber, sDrawAllocationCount);
+				OutputDebugString(message);
+			}
+		}
+#else
+		UNREFERENCED_PARAMETER(frameNumber);
+#endif
+	}
+
+#if defined( DEBUG ) || defined( _DEBUG )
+	int __cdecl Game::CountDrawAllocation(int allocationType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* fileName, int lineNumber)
+	{
+		// Blocks the CRT allocates for itself are not ours to count
+		if (blockType != _CRT_BLOCK && allocationType != _HOOK_FREE && GetCurrentThreadId() == sDrawThreadId)
+		{
+			sDrawAllocationCount++;
+		}
+
+		return (sPreviousAllocationHook != nullptr ? sPreviousAllocationHook(allocationType, userData, size, blockType, requestNumber, fileName, lineNumber) : TRUE);
+	}
+#endif
+
 	POINT Game::CenterWindow(int windowWidth, int windowHeight)
 	{
 		int screenWidth = GetSystemMetrics(SM_CXSCREEN);
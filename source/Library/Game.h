@@ -3,12 +3,28 @@
 #include "Common.h"
 #include "GameClock.h"
 #include "GameTime.h"
+#include "FixedTimeStep.h"
+#include "FramePacer.h"
 #include "GameComponent.h"
 #include "ServiceContainer.h"
 #include "RenderTarget.h"
 
+#if defined( DEBUG ) || defined( _DEBUG )
+#include <crtdbg.h>
+#endif
+
 namespace Library
 {
+	class DrawableGameComponent;
+	class ModelCache;
+	class ClockSource;
+	class JobSystem;
+	class ComponentGraph;
+	class RenderPipeline;
+	class RenderSnapshot;
+	class MemoryArena;
+	class AssetLoader;
+
 	class Game : public RenderTarget
 	{
 		RTTI_DECLARATIONS(Game, RenderTarget)
@@ -39,14 +55,43 @@ namespace Library
 		UINT MultiSamplingQualityLevels() const;
 
 		const std::vector<GameComponent*>& Components() const;
+		const std::vector<DrawableGameComponent*>& DrawableComponents() const;
 		const ServiceContainer& Services() const;
+		ModelCache& Models() const;
+		JobSystem& Jobs() const;
+		AssetLoader& Assets() const;
+		const ComponentGraph& UpdateGraph() const;
+		ComponentGraph& UpdateGraph();
+		bool IsFixedTimeStep() const;
+		const FixedTimeStep& TimeStep() const;
+		const FramePacer& Pacer() const;
+		RenderPipeline& Pipeline() const;
+		bool IsPipelined() const;
+
+		// Scratch memory for Draw, reset after every frame is drawn; while pipelined only the render stage may use it
+		MemoryArena& FrameArena() const;
+
+		// Debug builds count general heap allocations made while drawing; once a few frames have warmed the caches up, any
+		// is reported to the debugger. Always zero in release builds.
+		UINT SteadyStateDrawAllocations() const;
+		bool IsHeadless() const;
+
+		// Drives both the game clock and frame pacing; a VirtualClockSource makes game time independent of real time
+		void SetClockSource(ClockSource& clockSource);
 
 		virtual void Run();
+
+		// Initializes, runs frameCount frames and shuts down without creating a window or a Direct3D device, so components
+		// must leave the device alone while IsHeadless. Returns the real seconds the frames took, whatever the clock source.
+		virtual double RunHeadless(UINT frameCount);
 		virtual void Exit();
 		virtual void Initialize();
 		virtual void Update(const GameTime& gameTime);
 		virtual void Draw(const GameTime& gameTime);
 
+		// Called after the components capture theirs, for whatever the game's own Draw reads besides them
+		virtual void CaptureRenderState(RenderSnapshot& snapshot);
+
 		virtual void ResetRenderTargets();
 		virtual void UnbindPixelShaderResources(UINT startSlot, UINT count);
 
@@ -56,6 +101,12 @@ namespace Library
 		virtual void InitializeWindow();
 		virtual void InitializeDirectX();
 		virtual void Shutdown();
+		virtual void Tick();
+
+		// Components update in the order they are added; the drawable ones are also kept in a list of their own, so Draw
+		// never has to sort them out by type
+		void AddComponent(GameComponent* component);
+		void RemoveComponent(GameComponent* component);
 
 		static const UINT DefaultScreenWidth;
 		static const UINT DefaultScreenHeight;
@@ -66,6 +117,7 @@ namespace Library
 		std::wstring mWindowClass;
 		std::wstring mWindowTitle;
 		int mShowCommand;
+		bool mIsHeadless;
 
 		HWND mWindowHandle;
 		WNDCLASSEX mWindow;
@@ -75,8 +127,26 @@ namespace Library
 
 		GameClock mGameClock;
 		GameTime mGameTime;
-		std::vector<GameComponent*> mComponents;
+
+		// With a fixed time step, Update runs in whole steps of simulated time and Draw receives their interpolation alpha
+		bool mIsFixedTimeStep;
+		FixedTimeStep mFixedTimeStep;
+		GameTime mSimulationTime;
+		FramePacer mFramePacer;
+		bool mHasTimerResolution;
+
+		// Pipelined, each frame is drawn on a render thread from its RenderSnapshot while the next frame updates. Every
+		// drawable component must then draw from the snapshot, and the game's own Draw must keep to render-thread state and
+		// what its CaptureRenderState copied.
+		bool mIsPipelined;
+
 		ServiceContainer mServices;
+		ModelCache* mModelCache;
+		JobSystem* mJobSystem;
+		AssetLoader* mAssetLoader;
+		ComponentGraph* mUpdateGraph;
+		RenderPipeline* mRenderPipeline;
+		MemoryArena* mFrameArena;
 
 		D3D_FEATURE_LEVEL mFeatureLevel;
 		ID3D11Device1* mDirect3DDevice;
@@ -100,7 +170,31 @@ namespace Library
 		Game(const Game& rhs);
 		Game& operator=(const Game& rhs);
 
+		std::vector<GameComponent*> mComponents;
+		std::vector<DrawableGameComponent*> mDrawableComponents;
+
+		void BeginFrames();
+		void EndFrames();
+		void SubmitFrame(const GameTime& gameTime);
+		void CaptureFrame(RenderSnapshot& snapshot);
+		void DrawFrame(const RenderSnapshot& snapshot);
+		void BeginAllocationCheck();
+		void EndAllocationCheck(UINT frameNumber);
+		void DeleteServices();
 		POINT CenterWindow(int windowWidth, int windowHeight);
 		static LRESULT WINAPI WndProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam);
+
+		static const UINT AllocationCheckWarmUpFrames;
+
+		UINT mSteadyStateDrawAllocations;
+		UINT mPeakDrawAllocations;
+
+#if defined( DEBUG ) || defined( _DEBUG )
+		static int __cdecl CountDrawAllocation(int allocationType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* fileName, int lineNumber);
+
+		static _CRT_ALLOC_HOOK sPreviousAllocationHook;
+		static volatile DWORD sDrawThreadId;
+		static UINT sDrawAllocationCount;
+#endif
 	};
 }
\ No newline at end of file
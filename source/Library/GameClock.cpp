@@ -1,58 +1,57 @@
 #include "GameClock.h"
 #include "GameTime.h"
+#include "ClockSource.h"
 
 namespace Library
 {
-	GameClock::GameClock() : mStartTime(), mCurrentTime(), mLastTime(), mFrequency()
+	GameClock::GameClock() : mClockSource(&RealClockSource::Instance()), mStartTime(0.0), mCurrentTime(0.0), mLastTime(0.0)
 	{
-		mFrequency = GetFrequency();
 		Reset();
 	}
 
-	const LARGE_INTEGER& GameClock::StartTime() const
+	GameClock::GameClock(ClockSource& clockSource) : mClockSource(&clockSource), mStartTime(0.0), mCurrentTime(0.0), mLastTime(0.0)
 	{
-		return mStartTime;
+		Reset();
 	}
 
-	const LARGE_INTEGER& GameClock::CurrentTime() const
+	ClockSource& GameClock::Source() const
 	{
-		return mCurrentTime;
+		return *mClockSource;
 	}
 
-	const LARGE_INTEGER& GameClock::LastTime() const
+	void GameClock::SetSource(ClockSource& clockSource)
 	{
-		return mLastTime;
+		mClockSource = &clockSource;
+		Reset();
 	}
 
-	void GameClock::Reset()
+	double GameClock::StartTime() const
 	{
-		GetTime(mStartTime);
-		mCurrentTime = mStartTime;
-		mLastTime = mCurrentTime;
+		return mStartTime;
 	}
 
-	double GameClock::GetFrequency() const
+	double GameClock::CurrentTime() const
 	{
-		LARGE_INTEGER frequency;
-
-		if (QueryPerformanceFrequency(&frequency) == false)
-		{
-			throw std::exception("QueryPerformanceFrequency() failed.");
-		}
+		return mCurrentTime;
+	}
 
-		return (double)frequency.QuadPart;
+	double GameClock::LastTime() const
+	{
+		return mLastTime;
 	}
 
-	void GameClock::GetTime(LARGE_INTEGER& time) const
+	void GameClock::Reset()
 	{
-		QueryPerformanceCounter(&time);
+		mStartTime = mClockSource->Seconds();
+		mCurrentTime = mStartTime;
+		mLastTime = mCurrentTime;
 	}
 
 	void GameClock::UpdateGameTime(GameTime& gameTime)
 	{
-		GetTime(mCurrentTime);
-		gameTime.SetTotalGameTime((mCurrentTime.QuadPart - mStartTime.QuadPart) / mFrequency);
-		gameTime.SetElapsedGameTime((mCurrentTime.QuadPart - mLastTime.QuadPart) / mFrequency);
+		mCurrentTime = mClockSource->Seconds();
+		gameTime.SetTotalGameTime(mCurrentTime - mStartTime);
+		gameTime.SetElapsedGameTime(mCurrentTime - mLastTime);
 
 		mLastTime = mCurrentTime;
 	}
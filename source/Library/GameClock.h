@@ -1,27 +1,28 @@
 #pragma once
-#include <Windows.h>
-#include <exception>
 
 namespace Library
 {
 	class GameTime;
+	class ClockSource;
+
 	class GameClock
 	{
 	public:
 		GameClock();
-		const LARGE_INTEGER& StartTime() const;
-		const LARGE_INTEGER& CurrentTime() const;
-		const LARGE_INTEGER& LastTime() const;
+		GameClock(ClockSource& clockSource);
+		ClockSource& Source() const;
+		void SetSource(ClockSource& clockSource);
+		double StartTime() const;
+		double CurrentTime() const;
+		double LastTime() const;
 		void Reset();
-		double GetFrequency() const;
-		void GetTime(LARGE_INTEGER& time) const;
 		void UpdateGameTime(GameTime& gameTime);
 	private:
 		GameClock(const GameClock& rhs);
 		GameClock& operator=(const GameClock& rhs);
-		LARGE_INTEGER mStartTime;
-		LARGE_INTEGER mCurrentTime;
-		LARGE_INTEGER mLastTime;
-		double mFrequency;
+		ClockSource* mClockSource;
+		double mStartTime;
+		double mCurrentTime;
+		double mLastTime;
 	};
 }
\ No newline at end of file
@@ -1,13 +1,19 @@
 #include "GameComponent.h"
 #include "GameTime.h"
+#include "Utility.h"
+#include <algorithm>
 
 namespace Library
 {
 	RTTI_DEFINITIONS(GameComponent)
 
-	GameComponent::GameComponent() : mGame(nullptr), mEnabled(true) {}
+	const double GameComponent::DefaultHiddenUpdateInterval = 0.25;
 
-	GameComponent::GameComponent(Game& game) : mGame(&game), mEnabled(true) {}
+	GameComponent::GameComponent() : mGame(nullptr), mEnabled(true), mReadResources(), mWriteResources(), mDeclaredAssets(),
+		mUpdateInterval(0.0), mUpdateBudget(0.0), mHiddenUpdate(HiddenUpdateFull), mHiddenUpdateInterval(DefaultHiddenUpdateInterval) {}
+
+	GameComponent::GameComponent(Game& game) : mGame(&game), mEnabled(true), mReadResources(), mWriteResources(), mDeclaredAssets(),
+		mUpdateInterval(0.0), mUpdateBudget(0.0), mHiddenUpdate(HiddenUpdateFull), mHiddenUpdateInterval(DefaultHiddenUpdateInterval) {}
 
 	GameComponent::~GameComponent() {}
 
@@ -41,4 +47,99 @@ namespace Library
 
 	}
 
+	void GameComponent::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+	}
+
+	bool GameComponent::DeclaresResources() const
+	{
+		return (mReadResources.size() > 0 || mWriteResources.size() > 0);
+	}
+
+	const std::vector<const void*>& GameComponent::ReadResources() const
+	{
+		return mReadResources;
+	}
+
+	const std::vector<const void*>& GameComponent::WriteResources() const
+	{
+		return mWriteResources;
+	}
+
+	void GameComponent::DeclareRead(const void* resource)
+	{
+		if (std::find(mReadResources.begin(), mReadResources.end(), resource) == mReadResources.end())
+		{
+			mReadResources.push_back(resource);
+		}
+	}
+
+	void GameComponent::DeclareWrite(const void* resource)
+	{
+		if (std::find(mWriteResources.begin(), mWriteResources.end(), resource) == mWriteResources.end())
+		{
+			mWriteResources.push_back(resource);
+		}
+	}
+
+	const std::vector<AssetRequest>& GameComponent::DeclaredAssets() const
+	{
+		return mDeclaredAssets;
+	}
+
+	void GameComponent::DeclareModel(const std::string& filename, bool flipUVs)
+	{
+		mDeclaredAssets.push_back(AssetRequest(AssetTypeModel, Utility::ToWideString(filename), flipUVs));
+	}
+
+	void GameComponent::DeclareEffect(const std::wstring& filename)
+	{
+		mDeclaredAssets.push_back(AssetRequest(AssetTypeEffect, filename));
+	}
+
+	void GameComponent::DeclareTexture(const std::wstring& filename)
+	{
+		mDeclaredAssets.push_back(AssetRequest(AssetTypeTexture, filename));
+	}
+
+	double GameComponent::UpdateInterval() const
+	{
+		return mUpdateInterval;
+	}
+
+	void GameComponent::SetUpdateInterval(double updateInterval)
+	{
+		assert(updateInterval >= 0.0);
+		mUpdateInterval = updateInterval;
+	}
+
+	double GameComponent::UpdateBudget() const
+	{
+		return mUpdateBudget;
+	}
+
+	void GameComponent::SetUpdateBudget(double updateBudget)
+	{
+		assert(updateBudget >= 0.0);
+		mUpdateBudget = updateBudget;
+	}
+
+	HiddenUpdate GameComponent::GetHiddenUpdate() const
+	{
+		return mHiddenUpdate;
+	}
+
+	double GameComponent::HiddenUpdateInterval() const
+	{
+		return mHiddenUpdateInterval;
+	}
+
+	void GameComponent::SetHiddenUpdate(HiddenUpdate hiddenUpdate, double hiddenUpdateInterval)
+	{
+		assert(hiddenUpdate < HiddenUpdateEnd);
+		assert(hiddenUpdateInterval > 0.0);
+
+		mHiddenUpdate = hiddenUpdate;
+		mHiddenUpdateInterval = hiddenUpdateInterval;
+	}
 }
\ No newline at end of file
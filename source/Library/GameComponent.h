@@ -1,11 +1,22 @@
 #pragma once
 
 #include "Common.h"
+#include "AssetLoader.h"
 
 namespace Library
 {
 	class Game;
 	class GameTime;
+	class RenderSnapshot;
+
+	// How a drawable component that is not visible updates
+	enum HiddenUpdate
+	{
+		HiddenUpdateFull = 0,
+		HiddenUpdateReduced,		// No more often than the hidden update interval
+		HiddenUpdateSuspended,		// Not at all; the first update once visible again sees only that frame's elapsed time
+		HiddenUpdateEnd
+	};
 
 	class GameComponent : public RTTI
 	{
@@ -24,9 +35,49 @@ namespace Library
 		virtual void Initialize();
 		virtual void Update(const GameTime& gameTime);
 
+		// Called after the frame's updates to copy whatever Draw will need into the snapshot rendered next
+		virtual void CaptureRenderState(RenderSnapshot& snapshot);
+
+		// Resources Update reads and writes, any object's address serving as its identity. Components that declare at least
+		// one resource can update concurrently with those they share no writes with; the rest update alone, in order.
+		bool DeclaresResources() const;
+		const std::vector<const void*>& ReadResources() const;
+		const std::vector<const void*>& WriteResources() const;
+
+		// Assets Initialize will load, declared from the constructor; Game::Initialize starts loading all of them before
+		// the first component initializes and holds each component back only until its own assets are ready
+		const std::vector<AssetRequest>& DeclaredAssets() const;
+
+		// How often the update graph runs Update. With an interval, in seconds, Update runs once that much game time has
+		// gathered, and is passed all of it as the elapsed time. With a budget, in milliseconds, Update skips enough frames
+		// to bring its measured average cost per frame under the budget. A component with either is throttled: when the
+		// graph's throttled budget for a frame is spent, its due update moves to a later frame, in round-robin order.
+		double UpdateInterval() const;
+		void SetUpdateInterval(double updateInterval);
+		double UpdateBudget() const;
+		void SetUpdateBudget(double updateBudget);
+		HiddenUpdate GetHiddenUpdate() const;
+		double HiddenUpdateInterval() const;
+		void SetHiddenUpdate(HiddenUpdate hiddenUpdate, double hiddenUpdateInterval = DefaultHiddenUpdateInterval);
+
+		static const double DefaultHiddenUpdateInterval;
+
 	protected:
+		void DeclareRead(const void* resource);
+		void DeclareWrite(const void* resource);
+		void DeclareModel(const std::string& filename, bool flipUVs = false);
+		void DeclareEffect(const std::wstring& filename);
+		void DeclareTexture(const std::wstring& filename);
+
 		Game* mGame;
 		bool mEnabled;
+		std::vector<const void*> mReadResources;
+		std::vector<const void*> mWriteResources;
+		std::vector<AssetRequest> mDeclaredAssets;
+		double mUpdateInterval;
+		double mUpdateBudget;
+		HiddenUpdate mHiddenUpdate;
+		double mHiddenUpdateInterval;
 
 	private:
 		GameComponent(const GameComponent& rhs);
@@ -3,7 +3,7 @@
 namespace Library
 {
 
-	GameTime::GameTime() : mTotalGameTime(0.0), mElapsedGameTime(0.0) {}
+	GameTime::GameTime() : mTotalGameTime(0.0), mElapsedGameTime(0.0), mInterpolationAlpha(1.0) {}
 
 	double GameTime::TotalGameTime() const
 	{
@@ -24,4 +24,14 @@ namespace Library
 	{
 		mElapsedGameTime = elapsedGameTime;
 	}
+
+	double GameTime::InterpolationAlpha() const
+	{
+		return mInterpolationAlpha;
+	}
+
+	void GameTime::SetInterpolationAlpha(double interpolationAlpha)
+	{
+		mInterpolationAlpha = interpolationAlpha;
+	}
 }
\ No newline at end of file
@@ -10,8 +10,12 @@ namespace Library
 		void SetTotalGameTime(double totalGameTime);
 		double ElapsedGameTime() const;
 		void SetElapsedGameTime(double elapsedGameTime);
+		// Fraction of a fixed step the drawn frame lies beyond the last simulated state; one under a variable time step
+		double InterpolationAlpha() const;
+		void SetInterpolationAlpha(double interpolationAlpha);
 	private:
 		double mTotalGameTime;
 		double mElapsedGameTime;
+		double mInterpolationAlpha;
 	};
 }
\ No newline at end of file
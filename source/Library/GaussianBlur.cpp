@@ -19,14 +19,16 @@ namespace Library
 	GaussianBlur::GaussianBlur(Game& game, Camera& camera)
 		: DrawableGameComponent(game, camera),
 		mEffect(nullptr), mMaterial(nullptr), mSceneTexture(nullptr), mOutputTexture(nullptr), mHorizontalBlurTarget(nullptr), mVerticalBlurTarget(nullptr), mFullScreenQuad(nullptr),
-		mHorizontalSampleOffsets(), mVerticalSampleOffsets(), mSampleWeights(), mBlurAmount(DefaultBlurAmount)
+		mHorizontalSampleOffsets(), mVerticalSampleOffsets(), mSampleWeights(), mBlurAmount(DefaultBlurAmount),
+		mUpdateHorizontalMaterial(), mUpdateVerticalMaterial(), mUpdateNoBlurMaterial()
 	{
 	}
 
 	GaussianBlur::GaussianBlur(Game& game, Camera& camera, float blurAmount)
 		: DrawableGameComponent(game, camera),
 		mEffect(nullptr), mMaterial(nullptr), mSceneTexture(nullptr), mOutputTexture(nullptr), mHorizontalBlurTarget(nullptr), mVerticalBlurTarget(nullptr), mFullScreenQuad(nullptr),
-		mHorizontalSampleOffsets(), mVerticalSampleOffsets(), mSampleWeights(), mBlurAmount(blurAmount)
+		mHorizontalSampleOffsets(), mVerticalSampleOffsets(), mSampleWeights(), mBlurAmount(blurAmount),
+		mUpdateHorizontalMaterial(), mUpdateVerticalMaterial(), mUpdateNoBlurMaterial()
 	{
 	}
 
@@ -83,6 +85,10 @@ namespace Library
 
 		mHorizontalBlurTarget = new FullScreenRenderTarget(*mGame);
 		mVerticalBlurTarget = new FullScreenRenderTarget(*mGame);
+
+		mUpdateHorizontalMaterial = std::bind(&GaussianBlur::UpdateGaussianMaterialWithHorizontalOffsets, this);
+		mUpdateVerticalMaterial = std::bind(&GaussianBlur::UpdateGaussianMaterialWithVerticalOffsets, this);
+		mUpdateNoBlurMaterial = std::bind(&GaussianBlur::UpdateGaussianMaterialNoBlur, this);
 	}
 
 	void GaussianBlur::Draw(const GameTime& gameTime)
@@ -96,18 +102,18 @@ namespace Library
 			mGame->Direct3DDeviceContext()->ClearRenderTargetView(mHorizontalBlurTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
 			mGame->Direct3DDeviceContext()->ClearDepthStencilView(mHorizontalBlurTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 			mFullScreenQuad->SetActiveTechnique("blur", "p0");
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialWithHorizontalOffsets, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateHorizontalMaterial);
 			mFullScreenQuad->Draw(gameTime);
 			mHorizontalBlurTarget->End();
 
 			// Vertical blur for the final image
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialWithVerticalOffsets, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateVerticalMaterial);
 			mFullScreenQuad->Draw(gameTime);
 		}
 		else
 		{
 			mFullScreenQuad->SetActiveTechnique("no_blur", "p0");
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialNoBlur, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateNoBlurMaterial);
 			mFullScreenQuad->Draw(gameTime);
 		}
 	}
@@ -121,7 +127,7 @@ namespace Library
 			mGame->Direct3DDeviceContext()->ClearRenderTargetView(mHorizontalBlurTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
 			mGame->Direct3DDeviceContext()->ClearDepthStencilView(mHorizontalBlurTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 			mFullScreenQuad->SetActiveTechnique("blur", "p0");
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialWithHorizontalOffsets, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateHorizontalMaterial);
 			mFullScreenQuad->Draw(gameTime);
 			mHorizontalBlurTarget->End();
 
@@ -131,7 +137,7 @@ namespace Library
 			mVerticalBlurTarget->Begin();
 			mGame->Direct3DDeviceContext()->ClearRenderTargetView(mVerticalBlurTarget->RenderTargetView(), reinterpret_cast<const float*>(&ColorHelper::Purple));
 			mGame->Direct3DDeviceContext()->ClearDepthStencilView(mVerticalBlurTarget->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialWithVerticalOffsets, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateVerticalMaterial);
 			mFullScreenQuad->Draw(gameTime);
 			mVerticalBlurTarget->End();
 
@@ -142,7 +148,7 @@ namespace Library
 		{
 			mHorizontalBlurTarget->Begin();
 			mFullScreenQuad->SetActiveTechnique("no_blur", "p0");
-			mFullScreenQuad->SetCustomUpdateMaterial(std::bind(&GaussianBlur::UpdateGaussianMaterialNoBlur, this));
+			mFullScreenQuad->SetCustomUpdateMaterial(mUpdateNoBlurMaterial);
 			mFullScreenQuad->Draw(gameTime);
 			mHorizontalBlurTarget->End();
 
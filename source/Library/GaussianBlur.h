@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include "Common.h"
 #include "DrawableGameComponent.h"
 
@@ -58,5 +59,9 @@ namespace Library
 		std::vector<XMFLOAT2> mVerticalSampleOffsets;
 		std::vector<float> mSampleWeights;
 		float mBlurAmount;
+
+		std::function<void()> mUpdateHorizontalMaterial;
+		std::function<void()> mUpdateVerticalMaterial;
+		std::function<void()> mUpdateNoBlurMaterial;
 	};
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace Library
 {
 	class GaussianBlurMaterial : public PostProcessingMaterial
 	{
-		RTTI_DECLARATIONS(PostProcessingMaterial, GaussianBlurMaterial)
+		RTTI_DECLARATIONS(GaussianBlurMaterial, PostProcessingMaterial)
 
 			MATERIAL_VARIABLE_DECLARATION(SampleOffsets)
 			MATERIAL_VARIABLE_DECLARATION(SampleWeights)
@@ -8,6 +8,7 @@
 #include "VectorHelper.h"
 #include "MatrixHelper.h"
 #include "Utility.h"
+#include "RenderPipeline.h"
 
 namespace Library
 {
@@ -19,14 +20,16 @@ namespace Library
 
 	Grid::Grid(Game& game, Camera& camera)
 		: DrawableGameComponent(game), mMaterial(nullptr), mVertexBuffer(nullptr),
-		mPosition(Vector3Helper::Zero), mSize(DefaultSize), mScale(DefaultScale), mColor(DefaultColor), mWorldMatrix(MatrixHelper::Identity)
+		mPosition(Vector3Helper::Zero), mSize(DefaultSize), mScale(DefaultScale), mColor(DefaultColor), mWorldMatrix(MatrixHelper::Identity),
+		mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mCameraVersion(0), mWorldViewProjectionSlot(0)
 	{
 		mCamera = &camera;
 	}
 
 	Grid::Grid(Game& game, Camera& camera, UINT size, UINT scale, XMFLOAT4 color)
 		: DrawableGameComponent(game), mMaterial(nullptr), mVertexBuffer(nullptr),
-		mPosition(Vector3Helper::Zero), mSize(size), mScale(scale), mColor(color), mWorldMatrix(MatrixHelper::Identity)
+		mPosition(Vector3Helper::Zero), mSize(size), mScale(scale), mColor(color), mWorldMatrix(MatrixHelper::Identity),
+		mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mCameraVersion(0), mWorldViewProjectionSlot(0)
 	{
 		mCamera = &camera;
 	}
@@ -69,6 +72,7 @@ namespace Library
 
 		XMMATRIX translation = XMMatrixTranslation(mPosition.x, mPosition.y, mPosition.z);
 		XMStoreFloat4x4(&mWorldMatrix, translation);
+		mIsWorldDirty = true;
 	}
 
 	void Grid::SetPosition(float x, float y, float z)
@@ -79,6 +83,7 @@ namespace Library
 
 		XMMATRIX translation = XMMatrixTranslation(mPosition.x, mPosition.y, mPosition.z);
 		XMStoreFloat4x4(&mWorldMatrix, translation);
+		mIsWorldDirty = true;
 	}
 
 	void Grid::SetColor(const XMFLOAT4& color)
@@ -118,14 +123,28 @@ namespace Library
 		mMaterial->Initialize(*gridEffect);
 
 		InitializeGrid();
+
+		mWorldViewProjectionSlot = game->Pipeline().AllocateTransforms();
 	}
 
 	void Grid::Update(const GameTime& gameTime)
 	{
+		// Only recomputed when the grid or the camera moved
+		if (mIsWorldDirty == false && mCameraVersion == mCamera->ViewProjectionVersion())
+		{
+			return;
+		}
+
+		mIsWorldDirty = false;
+		mCameraVersion = mCamera->ViewProjectionVersion();
+
 		XMMATRIX world = XMLoadFloat4x4(&mWorldMatrix);
-		XMMATRIX wvp = world * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+		XMStoreFloat4x4(&mWorldViewProjectionMatrix, world * mCamera->ViewMatrix() * mCamera->ProjectionMatrix());
+	}
 
-		mMaterial->WorldViewProjection() << wvp;
+	void Grid::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		snapshot.SetTransform(mWorldViewProjectionSlot, mWorldViewProjectionMatrix);
 	}
 
 	void Grid::Draw(const GameTime& gameTime)
@@ -143,11 +162,19 @@ namespace Library
 			Pass* pass = mMaterial->CurrentTechnique()->Passes().at(0);
 			ID3D11InputLayout* inputLayout = mMaterial->InputLayouts().at(pass);
 			direct3DDeviceContext->IASetInputLayout(inputLayout);
+
+			mMaterial->WorldViewProjection() << game->Pipeline().Current().TransformMatrix(mWorldViewProjectionSlot);
+
 			pass->Apply(0, direct3DDeviceContext);
 			direct3DDeviceContext->Draw((mSize + 1) * 4, 0);
 		}
 	}
 
+	bool Grid::DrawsFromSnapshot() const
+	{
+		return true;
+	}
+
 	void Grid::InitializeGrid()
 	{
 		ID3D11Device* direct3DDevice = GetGame()->Direct3DDevice();
@@ -29,7 +29,9 @@ namespace Library
 
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void Draw(const GameTime& gameTime) override;
+		virtual bool DrawsFromSnapshot() const override;
 
 	private:
 		Grid();
@@ -50,5 +52,9 @@ namespace Library
 		UINT mScale;
 		XMFLOAT4 mColor;
 		XMFLOAT4X4 mWorldMatrix;
+		XMFLOAT4X4 mWorldViewProjectionMatrix;
+		bool mIsWorldDirty;
+		UINT mCameraVersion;
+		UINT mWorldViewProjectionSlot;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace Library
+{
+	const UINT JobSystem::DefaultWorkerCount = 0;
+
+	JobSystem::JobSystem(UINT workerCount)
+		: mQueues(), mThreads(), mThreadIds(), mWakeMutex(), mWakeCondition(), mCompletionCondition(), mQueuedCount(0), mWaitingCount(0),
+		  mIsShuttingDown(false), mIsSerial(false), mJobCount(0), mStealCount(0)
+	{
+		if (workerCount == 0)
+		{
+			workerCount = (std::max)(std::thread::hardware_concurrency(), 2U) - 1;
+		}
+
+		for (UINT i = 0; i <= workerCount; i++)
+		{
+			mQueues.push_back(new Queue());
+		}
+
+		mThreads.reserve(workerCount);
+		mThreadIds.reserve(workerCount);
+		for (UINT i = 1; i <= workerCount; i++)
+		{
+			mThreads.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+			mThreadIds.push_back(mThreads.back().get_id());
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mWakeMutex);
+			mIsShuttingDown = true;
+		}
+
+		mWakeCondition.notify_all();
+
+		for (std::thread& thread : mThreads)
+		{
+			thread.join();
+		}
+
+		for (Queue* queue : mQueues)
+		{
+			delete queue;
+		}
+	}
+
+	UINT JobSystem::WorkerCount() const
+	{
+		return mThreads.size();
+	}
+
+	bool JobSystem::IsSerial() const
+	{
+		return mIsSerial;
+	}
+
+	void JobSystem::SetSerial(bool isSerial)
+	{
+		mIsSerial = isSerial;
+	}
+
+	void JobSystem::Run(const Job& job, Counter& counter)
+	{
+		if (mIsSerial)
+		{
+			mJobCount++;
+			job();
+			return;
+		}
+
+		counter++;
+
+		Queue& queue = *mQueues[QueueIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			queue.Entries.push_back(Entry(job, &counter));
+		}
+
+		// Taking the lock orders the count against a worker that has just found nothing to do and is about to sleep
+		mQueuedCount++;
+		{
+			std::lock_guard<std::mutex> lock(mWakeMutex);
+		}
+
+		mWakeCondition.notify_one();
+	}
+
+	void JobSystem::Wait(Counter& counter)
+	{
+		UINT queueIndex = QueueIndex();
+
+		while (counter > 0)
+		{
+			if (queueIndex != 0 && TryExecute(queueIndex))
+			{
+				continue;
+			}
+
+			// Counting the waiter before the lock lets a completion that races it see there is someone to wake
+			mWaitingCount++;
+			{
+				std::unique_lock<std::mutex> lock(mWakeMutex);
+				if (queueIndex == 0)
+				{
+					mCompletionCondition.wait(lock, [&]() { return (counter == 0); });
+				}
+				else
+				{
+					mWakeCondition.wait(lock, [&]() { return (counter == 0 || mQueuedCount > 0); });
+				}
+			}
+			mWaitingCount--;
+		}
+	}
+
+	JobSystem::Statistics JobSystem::GetStatistics() const
+	{
+		Statistics statistics;
+		statistics.JobCount = mJobCount;
+		statistics.StealCount = mStealCount;
+
+		return statistics;
+	}
+
+	void JobSystem::WorkerLoop(UINT queueIndex)
+	{
+		while (true)
+		{
+			if (TryExecute(queueIndex))
+			{
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(mWakeMutex);
+			mWakeCondition.wait(lock, [&]() { return (mQueuedCount > 0 || mIsShuttingDown); });
+
+			if (mIsShuttingDown && mQueuedCount == 0)
+			{
+				return;
+			}
+		}
+	}
+
+	bool JobSystem::TryExecute(UINT queueIndex)
+	{
+		Entry entry;
+		bool isStolen = false;
+
+		{
+			Queue& queue = *mQueues[queueIndex];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (queue.Entries.empty() == false)
+			{
+				entry = queue.Entries.back();
+				queue.Entries.pop_back();
+			}
+		}
+
+		for (UINT i = 1; entry.Remaining == nullptr && i < mQueues.size(); i++)
+		{
+			Queue& queue = *mQueues[(queueIndex + i) % mQueues.size()];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (queue.Entries.empty() == false)
+			{
+				entry = queue.Entries.front();
+				queue.Entries.pop_front();
+				isStolen = true;
+			}
+		}
+
+		if (entry.Remaining == nullptr)
+		{
+			return false;
+		}
+
+		mQueuedCount--;
+		mJobCount++;
+		if (isStolen)
+		{
+			mStealCount++;
+		}
+
+		entry.Work();
+		if (--(*entry.Remaining) == 0 && mWaitingCount > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mWakeMutex);
+			}
+
+			mWakeCondition.notify_all();
+			mCompletionCondition.notify_all();
+		}
+
+		return true;
+	}
+
+	UINT JobSystem::QueueIndex() const
+	{
+		std::thread::id threadId = std::this_thread::get_id();
+		for (UINT i = 0; i < mThreadIds.size(); i++)
+		{
+			if (mThreadIds[i] == threadId)
+			{
+				return i + 1;
+			}
+		}
+
+		return 0;
+	}
+}
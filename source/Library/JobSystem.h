@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Common.h"
+#include <functional>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace Library
+{
+	// A pool of worker threads running small jobs. Every worker owns a queue: jobs submitted from a worker go to the back of
+	// its own queue and it takes from the back, so nested work stays on the thread that produced it and in cache, while idle
+	// workers steal from the front of the others' queues, taking the oldest and usually largest pieces. Jobs submitted from
+	// any other thread go to a shared queue. Completion is tracked through counters that Run increments and the job's
+	// completion decrements. A worker that waits executes queued jobs until its counter reaches zero, so waiting from inside
+	// a job cannot deadlock the pool, and sleeps while there are none; any other thread sleeps until its counter reaches zero
+	// and never runs jobs itself, so work submitted to the pool stays on the workers. In serial mode Run executes each job
+	// immediately on the calling thread, which makes scheduling deterministic for debugging. Jobs must not throw; callers
+	// that can fail capture their own exceptions.
+	class JobSystem
+	{
+	public:
+		typedef std::function<void()> Job;
+		typedef std::atomic<UINT> Counter;
+
+		struct Statistics
+		{
+			UINT JobCount;
+			UINT StealCount;			// Jobs run by a thread other than the one whose queue they were taken from
+
+			Statistics()
+				: JobCount(0), StealCount(0) { }
+		};
+
+		static const UINT DefaultWorkerCount;		// Zero leaves one hardware thread for the caller
+
+		JobSystem(UINT workerCount = DefaultWorkerCount);
+		~JobSystem();
+
+		UINT WorkerCount() const;
+
+		// Only changed between frames, while no jobs are in flight
+		bool IsSerial() const;
+		void SetSerial(bool isSerial);
+
+		void Run(const Job& job, Counter& counter);
+		void Wait(Counter& counter);
+
+		// Totals since construction; take differences for per-frame figures
+		Statistics GetStatistics() const;
+
+	private:
+		struct Entry
+		{
+			Job Work;
+			Counter* Remaining;
+
+			Entry()
+				: Work(), Remaining(nullptr) { }
+
+			Entry(const Job& work, Counter* remaining)
+				: Work(work), Remaining(remaining) { }
+		};
+
+		struct Queue
+		{
+			std::mutex Mutex;
+			std::deque<Entry> Entries;
+		};
+
+		JobSystem(const JobSystem& rhs);
+		JobSystem& operator=(const JobSystem& rhs);
+
+		void WorkerLoop(UINT queueIndex);
+		bool TryExecute(UINT queueIndex);
+		UINT QueueIndex() const;
+
+		std::vector<Queue*> mQueues;			// The shared queue first, then one per worker
+		std::vector<std::thread> mThreads;
+		std::vector<std::thread::id> mThreadIds;
+		std::mutex mWakeMutex;
+		std::condition_variable mWakeCondition;
+		std::condition_variable mCompletionCondition;	// Other threads waiting on a counter
+		std::atomic<UINT> mQueuedCount;
+		std::atomic<UINT> mWaitingCount;				// Threads asleep in Wait
+		bool mIsShuttingDown;
+		bool mIsSerial;
+		std::atomic<UINT> mJobCount;
+		std::atomic<UINT> mStealCount;
+	};
+}
@@ -12,6 +12,8 @@ namespace Library
 		assert(mDirectInput != nullptr);
 		ZeroMemory(mCurrentState, sizeof(mCurrentState));
 		ZeroMemory(mLastState, sizeof(mLastState));
+
+		// Declares no resources, so the device is polled on the thread that updates the game, never on a worker
 	}
 
 	Keyboard::~Keyboard()
@@ -8,6 +8,7 @@ namespace Library
 		Light::Light(Game& game)
 		: GameComponent(game), mColor(reinterpret_cast<const float*>(&ColorHelper::White))
 	{
+		DeclareWrite(this);
 	}
 
 	Light::~Light()
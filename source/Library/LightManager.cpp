@@ -0,0 +1,435 @@
+#include "LightManager.h"
+#include "ClockSource.h"
+#include "Camera.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "Parallel.h"
+#include "GameException.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Library
+{
+	const UINT LightManager::DefaultTileSize = 64;
+	const UINT LightManager::DefaultSliceCount = 16;
+	const float LightManager::DefaultFirstSliceDepth = 1.0f;
+	const UINT LightManager::MinimumLightsPerWorker = 1024;
+
+	LightManager::LightManager(UINT tileSize, UINT sliceCount, float firstSliceDepth)
+		: mTileSize(tileSize), mSliceCount(sliceCount), mFirstSliceDepth(firstSliceDepth), mPointLights(), mSpotLights(),
+		  mScreenWidth(0), mScreenHeight(0), mFieldOfView(0.0f), mAspectRatio(0.0f), mNearDistance(0.0f), mFarDistance(0.0f),
+		  mColumnCount(0), mRowCount(0), mTangentX(0.0f), mTangentY(0.0f), mColumnScale(0.0f), mRowScale(0.0f), mFirstLogarithmicSlice(0), mSliceScale(0.0f),
+		  mSliceDepths(), mClusterBoxes(), mClusterSpheres(), mViewLights(), mSliceLights(), mClusterLights(), mClusters(), mLightIndices(), mStatistics()
+	{
+		if (tileSize == 0 || sliceCount == 0)
+		{
+			throw GameException("Light cluster tiles and slices must be non-empty.");
+		}
+	}
+
+	UINT LightManager::AddPointLight(const XMFLOAT3& position, float radius)
+	{
+		mPointLights.PositionX.push_back(position.x);
+		mPointLights.PositionY.push_back(position.y);
+		mPointLights.PositionZ.push_back(position.z);
+		mPointLights.Radius.push_back(radius);
+
+		return mPointLights.Count() - 1;
+	}
+
+	UINT LightManager::AddPointLight(const PointLight& light)
+	{
+		XMFLOAT3 position;
+		XMStoreFloat3(&position, light.PositionVector());
+
+		return AddPointLight(position, light.Radius());
+	}
+
+	void LightManager::SetPointLight(UINT index, const XMFLOAT3& position, float radius)
+	{
+		mPointLights.PositionX[index] = position.x;
+		mPointLights.PositionY[index] = position.y;
+		mPointLights.PositionZ[index] = position.z;
+		mPointLights.Radius[index] = radius;
+	}
+
+	UINT LightManager::AddSpotLight(const XMFLOAT3& position, float radius, const XMFLOAT3& direction, float outerAngle)
+	{
+		mSpotLights.PositionX.push_back(position.x);
+		mSpotLights.PositionY.push_back(position.y);
+		mSpotLights.PositionZ.push_back(position.z);
+		mSpotLights.Radius.push_back(radius);
+		mSpotLights.DirectionX.push_back(direction.x);
+		mSpotLights.DirectionY.push_back(direction.y);
+		mSpotLights.DirectionZ.push_back(direction.z);
+		mSpotLights.OuterAngle.push_back(outerAngle);
+
+		return mSpotLights.Count() - 1;
+	}
+
+	UINT LightManager::AddSpotLight(const SpotLight& light)
+	{
+		XMFLOAT3 position;
+		XMStoreFloat3(&position, light.PositionVector());
+
+		return AddSpotLight(position, light.Radius(), light.Direction(), light.OuterAngle());
+	}
+
+	void LightManager::SetSpotLight(UINT index, const XMFLOAT3& position, float radius, const XMFLOAT3& direction, float outerAngle)
+	{
+		mSpotLights.PositionX[index] = position.x;
+		mSpotLights.PositionY[index] = position.y;
+		mSpotLights.PositionZ[index] = position.z;
+		mSpotLights.Radius[index] = radius;
+		mSpotLights.DirectionX[index] = direction.x;
+		mSpotLights.DirectionY[index] = direction.y;
+		mSpotLights.DirectionZ[index] = direction.z;
+		mSpotLights.OuterAngle[index] = outerAngle;
+	}
+
+	void LightManager::Clear()
+	{
+		mPointLights = PointLightArray();
+		mSpotLights = SpotLightArray();
+	}
+
+	const LightManager::PointLightArray& LightManager::PointLights() const
+	{
+		return mPointLights;
+	}
+
+	const LightManager::SpotLightArray& LightManager::SpotLights() const
+	{
+		return mSpotLights;
+	}
+
+	void LightManager::Build(const Camera& camera, UINT screenWidth, UINT screenHeight)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		UpdateGrid(camera, screenWidth, screenHeight);
+		TransformLights(camera);
+
+		for (std::vector<UINT>& lights : mSliceLights)
+		{
+			lights.clear();
+		}
+
+		for (UINT i = 0; i < mViewLights.size(); i++)
+		{
+			for (UINT slice = mViewLights[i].FirstSlice; slice <= mViewLights[i].LastSlice; slice++)
+			{
+				mSliceLights[slice].push_back(i);
+			}
+		}
+
+		// Each slice owns its clusters, so slices bin independently
+		Parallel::For(0, mSliceCount, 1, [&](UINT begin, UINT end)
+		{
+			for (UINT slice = begin; slice < end; slice++)
+			{
+				BinSlice(slice);
+			}
+		});
+
+		UINT pointLightCount = mPointLights.Count();
+		mLightIndices.clear();
+		mStatistics = Statistics();
+		mStatistics.ClusterCount = mClusters.size();
+
+		for (UINT i = 0; i < mClusters.size(); i++)
+		{
+			// Lights were binned in index order, so the point lights lead each list
+			const std::vector<UINT>& lights = mClusterLights[i];
+			UINT clusterPointLightCount = std::lower_bound(lights.begin(), lights.end(), pointLightCount) - lights.begin();
+
+			Cluster& cluster = mClusters[i];
+			cluster.Offset = mLightIndices.size();
+			cluster.PointLightCount = clusterPointLightCount;
+			cluster.SpotLightCount = lights.size() - clusterPointLightCount;
+
+			for (UINT light : lights)
+			{
+				mLightIndices.push_back(light < pointLightCount ? light : light - pointLightCount);
+			}
+
+			if (lights.size() > 0)
+			{
+				mStatistics.OccupiedClusterCount++;
+				mStatistics.MaxLightsPerCluster = (std::max)(mStatistics.MaxLightsPerCluster, static_cast<UINT>(lights.size()));
+			}
+		}
+
+		mStatistics.IndexCount = mLightIndices.size();
+		mStatistics.Milliseconds = RealClockSource::Milliseconds() - startTime;
+	}
+
+	UINT LightManager::ColumnCount() const
+	{
+		return mColumnCount;
+	}
+
+	UINT LightManager::RowCount() const
+	{
+		return mRowCount;
+	}
+
+	UINT LightManager::SliceCount() const
+	{
+		return mSliceCount;
+	}
+
+	UINT LightManager::ClusterIndex(UINT screenX, UINT screenY, float viewDepth) const
+	{
+		UINT column = (std::min)(screenX / mTileSize, mColumnCount - 1);
+		UINT row = (std::min)(screenY / mTileSize, mRowCount - 1);
+
+		return (SliceIndex(viewDepth) * mRowCount + row) * mColumnCount + column;
+	}
+
+	const std::vector<LightManager::Cluster>& LightManager::Clusters() const
+	{
+		return mClusters;
+	}
+
+	const std::vector<UINT>& LightManager::LightIndices() const
+	{
+		return mLightIndices;
+	}
+
+	const LightManager::Statistics& LightManager::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void LightManager::UpdateGrid(const Camera& camera, UINT screenWidth, UINT screenHeight)
+	{
+		if (screenWidth == mScreenWidth && screenHeight == mScreenHeight && camera.FieldOfView() == mFieldOfView && camera.AspectRatio() == mAspectRatio &&
+			camera.NearPlaneDistance() == mNearDistance && camera.FarPlaneDistance() == mFarDistance)
+		{
+			return;
+		}
+
+		mScreenWidth = screenWidth;
+		mScreenHeight = screenHeight;
+		mFieldOfView = camera.FieldOfView();
+		mAspectRatio = camera.AspectRatio();
+		mNearDistance = camera.NearPlaneDistance();
+		mFarDistance = camera.FarPlaneDistance();
+
+		mColumnCount = (std::max)((screenWidth + mTileSize - 1) / mTileSize, 1U);
+		mRowCount = (std::max)((screenHeight + mTileSize - 1) / mTileSize, 1U);
+		mTangentY = std::tan(mFieldOfView * 0.5f);
+		mTangentX = mTangentY * mAspectRatio;
+		mColumnScale = (std::max)(screenWidth, 1U) / (2.0f * mTileSize);
+		mRowScale = (std::max)(screenHeight, 1U) / (2.0f * mTileSize);
+
+		// Geometric slices after the optional linear first slice
+		mFirstLogarithmicSlice = (mFirstSliceDepth > mNearDistance && mFirstSliceDepth < mFarDistance && mSliceCount > 1 ? 1 : 0);
+		float logarithmicNear = (mFirstLogarithmicSlice > 0 ? mFirstSliceDepth : mNearDistance);
+		UINT logarithmicCount = mSliceCount - mFirstLogarithmicSlice;
+		mSliceScale = logarithmicCount / std::log(mFarDistance / logarithmicNear);
+
+		mSliceDepths.resize(mSliceCount + 1);
+		mSliceDepths[0] = mNearDistance;
+		for (UINT i = 0; i <= logarithmicCount; i++)
+		{
+			mSliceDepths[mFirstLogarithmicSlice + i] = logarithmicNear * std::pow(mFarDistance / logarithmicNear, static_cast<float>(i) / logarithmicCount);
+		}
+
+		mSliceDepths[mSliceCount] = mFarDistance;
+
+		UINT clusterCount = mColumnCount * mRowCount * mSliceCount;
+		mClusterBoxes.resize(clusterCount);
+		mClusterSpheres.resize(clusterCount);
+		mClusterLights.resize(clusterCount);
+		mClusters.resize(clusterCount);
+		mSliceLights.resize(mSliceCount);
+
+		for (UINT slice = 0; slice < mSliceCount; slice++)
+		{
+			float nearDepth = mSliceDepths[slice];
+			float farDepth = mSliceDepths[slice + 1];
+
+			for (UINT row = 0; row < mRowCount; row++)
+			{
+				// Rows run down the screen, so view y falls as the row rises
+				float top = (1.0f - row / mRowScale) * mTangentY;
+				float bottom = (1.0f - (row + 1) / mRowScale) * mTangentY;
+
+				for (UINT column = 0; column < mColumnCount; column++)
+				{
+					float left = (column / mColumnScale - 1.0f) * mTangentX;
+					float right = ((column + 1) / mColumnScale - 1.0f) * mTangentX;
+
+					UINT index = (slice * mRowCount + row) * mColumnCount + column;
+					AxisAlignedBox& box = mClusterBoxes[index];
+					box.Minimum = XMFLOAT3((std::min)(left * nearDepth, left * farDepth), (std::min)(bottom * nearDepth, bottom * farDepth), -farDepth);
+					box.Maximum = XMFLOAT3((std::max)(right * nearDepth, right * farDepth), (std::max)(top * nearDepth, top * farDepth), -nearDepth);
+
+					XMFLOAT3 center = box.Center();
+					XMFLOAT3 extents = box.Extents();
+					mClusterSpheres[index] = XMFLOAT4(center.x, center.y, center.z, std::sqrt(extents.x * extents.x + extents.y * extents.y + extents.z * extents.z));
+				}
+			}
+		}
+	}
+
+	void LightManager::TransformLights(const Camera& camera)
+	{
+		UINT pointLightCount = mPointLights.Count();
+		mViewLights.resize(pointLightCount + mSpotLights.Count());
+
+		XMMATRIX viewMatrix = camera.ViewMatrix();
+
+		Parallel::For(0, mViewLights.size(), MinimumLightsPerWorker, [&](UINT begin, UINT end)
+		{
+			for (UINT i = begin; i < end; i++)
+			{
+				ViewLight& light = mViewLights[i];
+				XMVECTOR position;
+
+				if (i < pointLightCount)
+				{
+					position = XMVectorSet(mPointLights.PositionX[i], mPointLights.PositionY[i], mPointLights.PositionZ[i], 1.0f);
+					light.Radius = mPointLights.Radius[i];
+					light.Direction = XMFLOAT3(0.0f, 0.0f, 0.0f);
+					light.Cosine = -1.0f;
+					light.Sine = 0.0f;
+				}
+				else
+				{
+					UINT spot = i - pointLightCount;
+					position = XMVectorSet(mSpotLights.PositionX[spot], mSpotLights.PositionY[spot], mSpotLights.PositionZ[spot], 1.0f);
+					light.Radius = mSpotLights.Radius[spot];
+
+					XMVECTOR direction = XMVectorSet(mSpotLights.DirectionX[spot], mSpotLights.DirectionY[spot], mSpotLights.DirectionZ[spot], 0.0f);
+					XMStoreFloat3(&light.Direction, XMVector3Normalize(XMVector3TransformNormal(direction, viewMatrix)));
+					light.Cosine = (std::max)((std::min)(mSpotLights.OuterAngle[spot], 1.0f), -1.0f);
+					light.Sine = std::sqrt(1.0f - light.Cosine * light.Cosine);
+				}
+
+				XMStoreFloat3(&light.Position, XMVector3Transform(position, viewMatrix));
+
+				// The camera looks down negative z
+				float depth = -light.Position.z;
+				if (depth + light.Radius < mNearDistance || depth - light.Radius > mFarDistance)
+				{
+					light.FirstSlice = 1;
+					light.LastSlice = 0;
+				}
+				else
+				{
+					light.FirstSlice = SliceIndex(depth - light.Radius);
+					light.LastSlice = SliceIndex(depth + light.Radius);
+				}
+			}
+		});
+	}
+
+	void LightManager::BinSlice(UINT slice)
+	{
+		float nearDepth = mSliceDepths[slice];
+		float farDepth = mSliceDepths[slice + 1];
+		UINT pointLightCount = mPointLights.Count();
+		UINT firstCluster = slice * mRowCount * mColumnCount;
+
+		for (UINT i = firstCluster; i < firstCluster + mRowCount * mColumnCount; i++)
+		{
+			mClusterLights[i].clear();
+		}
+
+		for (UINT index : mSliceLights[slice])
+		{
+			const ViewLight& light = mViewLights[index];
+
+			UINT firstColumn;
+			UINT lastColumn;
+			UINT firstRow;
+			UINT lastRow;
+			if (TileRange(light.Position.x - light.Radius, light.Position.x + light.Radius, nearDepth, farDepth, mTangentX, mColumnScale, mColumnCount, firstColumn, lastColumn) == false ||
+				TileRange(-light.Position.y - light.Radius, -light.Position.y + light.Radius, nearDepth, farDepth, mTangentY, mRowScale, mRowCount, firstRow, lastRow) == false)
+			{
+				continue;
+			}
+
+			for (UINT row = firstRow; row <= lastRow; row++)
+			{
+				for (UINT column = firstColumn; column <= lastColumn; column++)
+				{
+					UINT cluster = firstCluster + row * mColumnCount + column;
+					if (IntersectsBox(light, mClusterBoxes[cluster]) == false)
+					{
+						continue;
+					}
+
+					if (index >= pointLightCount && IntersectsCone(light, mClusterSpheres[cluster]) == false)
+					{
+						continue;
+					}
+
+					mClusterLights[cluster].push_back(index);
+				}
+			}
+		}
+	}
+
+	UINT LightManager::SliceIndex(float viewDepth) const
+	{
+		if (viewDepth < mSliceDepths[mFirstLogarithmicSlice])
+		{
+			return 0;
+		}
+
+		float slice = mFirstLogarithmicSlice + std::log(viewDepth / mSliceDepths[mFirstLogarithmicSlice]) * mSliceScale;
+
+		return (std::min)(static_cast<UINT>(slice), mSliceCount - 1);
+	}
+
+	bool LightManager::TileRange(float minimum, float maximum, float nearDepth, float farDepth, float tangent, float tileScale, UINT tileCount, UINT& firstTile, UINT& lastTile)
+	{
+		// Tile i spans [a, b] * depth in view space, with a and b its normalized device bounds times the tangent. Over a slice
+		// its box reaches furthest on each side at the far depth when that side lies away from the centre, and at the near
+		// depth otherwise, which lets the overlapping tiles be solved for directly.
+		float low = minimum / ((minimum > 0.0f ? farDepth : nearDepth) * tangent);
+		float high = maximum / ((maximum < 0.0f ? farDepth : nearDepth) * tangent);
+
+		// Clamped as floats first so distant lights cannot overflow the conversion
+		float first = (std::max)(std::ceil((low + 1.0f) * tileScale) - 1.0f, 0.0f);
+		float last = (std::min)(std::floor((high + 1.0f) * tileScale), tileCount - 1.0f);
+		if (first > last)
+		{
+			return false;
+		}
+
+		firstTile = static_cast<UINT>(first);
+		lastTile = static_cast<UINT>(last);
+
+		return true;
+	}
+
+	bool LightManager::IntersectsBox(const ViewLight& light, const AxisAlignedBox& box)
+	{
+		float x = (std::max)((std::max)(box.Minimum.x - light.Position.x, light.Position.x - box.Maximum.x), 0.0f);
+		float y = (std::max)((std::max)(box.Minimum.y - light.Position.y, light.Position.y - box.Maximum.y), 0.0f);
+		float z = (std::max)((std::max)(box.Minimum.z - light.Position.z, light.Position.z - box.Maximum.z), 0.0f);
+
+		return (x * x + y * y + z * z <= light.Radius * light.Radius);
+	}
+
+	bool LightManager::IntersectsCone(const ViewLight& light, const XMFLOAT4& sphere)
+	{
+		// Distance from the sphere's centre to the cone's surface, measured perpendicular to the nearest edge
+		XMFLOAT3 offset(sphere.x - light.Position.x, sphere.y - light.Position.y, sphere.z - light.Position.z);
+		float lengthSquared = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+		float along = offset.x * light.Direction.x + offset.y * light.Direction.y + offset.z * light.Direction.z;
+		float across = std::sqrt((std::max)(lengthSquared - along * along, 0.0f));
+		float distance = light.Cosine * across - along * light.Sine;
+
+		bool isOutsideAngle = (distance > sphere.w);
+		bool isBeyondRange = (along > sphere.w + light.Radius);
+		bool isBehind = (along < -sphere.w);
+
+		return !(isOutsideAngle || isBeyondRange || isBehind);
+	}
+}
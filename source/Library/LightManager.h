@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Common.h"
+#include "AxisAlignedBox.h"
+
+namespace Library
+{
+	class Camera;
+	class PointLight;
+	class SpotLight;
+
+	// Assigns point and spot lights to the clusters of a view-space froxel grid so shading only visits the lights that can
+	// reach a pixel. The grid divides the screen into square tiles and the view depth into slices that grow geometrically
+	// (after an optional first slice ending at FirstSliceDepth, which keeps the nearest slices from being uselessly thin).
+	// Lights are kept in structure-of-arrays form; each build transforms them into view space, buckets them by the slices
+	// their spheres span, then bins each slice on a worker thread, testing only the tiles a light's sphere can project into
+	// against the cluster's box, and spot light cones against the cluster's bounding sphere. The result is one compact list
+	// of light indices per cluster: point light indices first, then spot light indices.
+	class LightManager
+	{
+	public:
+		struct PointLightArray
+		{
+			std::vector<float> PositionX;
+			std::vector<float> PositionY;
+			std::vector<float> PositionZ;
+			std::vector<float> Radius;
+
+			PointLightArray()
+				: PositionX(), PositionY(), PositionZ(), Radius() { }
+
+			UINT Count() const { return PositionX.size(); }
+		};
+
+		struct SpotLightArray
+		{
+			std::vector<float> PositionX;
+			std::vector<float> PositionY;
+			std::vector<float> PositionZ;
+			std::vector<float> Radius;
+			std::vector<float> DirectionX;
+			std::vector<float> DirectionY;
+			std::vector<float> DirectionZ;
+			std::vector<float> OuterAngle;		// Cosine of the cone's half-angle, as SpotLight::OuterAngle
+
+			SpotLightArray()
+				: PositionX(), PositionY(), PositionZ(), Radius(), DirectionX(), DirectionY(), DirectionZ(), OuterAngle() { }
+
+			UINT Count() const { return PositionX.size(); }
+		};
+
+		struct Cluster
+		{
+			UINT Offset;			// Into LightIndices()
+			UINT PointLightCount;
+			UINT SpotLightCount;
+		};
+
+		struct Statistics
+		{
+			UINT ClusterCount;
+			UINT OccupiedClusterCount;
+			UINT IndexCount;
+			UINT MaxLightsPerCluster;
+			double Milliseconds;		// Of the most recent Build
+
+			Statistics()
+				: ClusterCount(0), OccupiedClusterCount(0), IndexCount(0), MaxLightsPerCluster(0), Milliseconds(0.0) { }
+		};
+
+		static const UINT DefaultTileSize;
+		static const UINT DefaultSliceCount;
+		static const float DefaultFirstSliceDepth;
+
+		LightManager(UINT tileSize = DefaultTileSize, UINT sliceCount = DefaultSliceCount, float firstSliceDepth = DefaultFirstSliceDepth);
+
+		UINT AddPointLight(const XMFLOAT3& position, float radius);
+		UINT AddPointLight(const PointLight& light);
+		void SetPointLight(UINT index, const XMFLOAT3& position, float radius);
+
+		UINT AddSpotLight(const XMFLOAT3& position, float radius, const XMFLOAT3& direction, float outerAngle);
+		UINT AddSpotLight(const SpotLight& light);
+		void SetSpotLight(UINT index, const XMFLOAT3& position, float radius, const XMFLOAT3& direction, float outerAngle);
+
+		void Clear();
+
+		const PointLightArray& PointLights() const;
+		const SpotLightArray& SpotLights() const;
+
+		void Build(const Camera& camera, UINT screenWidth, UINT screenHeight);
+
+		UINT ColumnCount() const;
+		UINT RowCount() const;
+		UINT SliceCount() const;
+		UINT ClusterIndex(UINT screenX, UINT screenY, float viewDepth) const;
+
+		const std::vector<Cluster>& Clusters() const;
+		const std::vector<UINT>& LightIndices() const;
+		const Statistics& GetStatistics() const;
+
+	private:
+		LightManager(const LightManager& rhs);
+		LightManager& operator=(const LightManager& rhs);
+
+		static const UINT MinimumLightsPerWorker;
+
+		// A light in view space; spot lights follow the point lights in one index space while binning
+		struct ViewLight
+		{
+			XMFLOAT3 Position;
+			float Radius;
+			XMFLOAT3 Direction;
+			float Cosine;
+			float Sine;
+			UINT FirstSlice;
+			UINT LastSlice;			// Less than FirstSlice when the light is outside the grid's depth range
+		};
+
+		void UpdateGrid(const Camera& camera, UINT screenWidth, UINT screenHeight);
+		void TransformLights(const Camera& camera);
+		void BinSlice(UINT slice);
+		UINT SliceIndex(float viewDepth) const;
+
+		static bool TileRange(float minimum, float maximum, float nearDepth, float farDepth, float tangent, float tileScale, UINT tileCount, UINT& firstTile, UINT& lastTile);
+		static bool IntersectsBox(const ViewLight& light, const AxisAlignedBox& box);
+		static bool IntersectsCone(const ViewLight& light, const XMFLOAT4& sphere);
+
+		UINT mTileSize;
+		UINT mSliceCount;
+		float mFirstSliceDepth;
+		PointLightArray mPointLights;
+		SpotLightArray mSpotLights;
+
+		// Grid geometry, rebuilt only when the projection or screen size changes
+		UINT mScreenWidth;
+		UINT mScreenHeight;
+		float mFieldOfView;
+		float mAspectRatio;
+		float mNearDistance;
+		float mFarDistance;
+		UINT mColumnCount;
+		UINT mRowCount;
+		float mTangentX;
+		float mTangentY;
+		float mColumnScale;			// Tiles per unit of normalized device x, and of y for rows
+		float mRowScale;
+		UINT mFirstLogarithmicSlice;
+		float mSliceScale;
+		std::vector<float> mSliceDepths;
+		std::vector<AxisAlignedBox> mClusterBoxes;
+		std::vector<XMFLOAT4> mClusterSpheres;
+
+		std::vector<ViewLight> mViewLights;
+		std::vector<std::vector<UINT>> mSliceLights;
+		std::vector<std::vector<UINT>> mClusterLights;
+		std::vector<Cluster> mClusters;
+		std::vector<UINT> mLightIndices;
+		Statistics mStatistics;
+	};
+}
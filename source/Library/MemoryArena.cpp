@@ -0,0 +1,114 @@
+#include "MemoryArena.h"
+#include <algorithm>
+
+namespace Library
+{
+	const size_t MemoryArena::DefaultBlockSize = 64 * 1024;
+
+	MemoryArena::MemoryArena(size_t blockSize)
+		: mBlockSize(blockSize), mBlocks(), mCurrent(nullptr), mEnd(nullptr), mFinalizers(), mStatistics()
+	{
+	}
+
+	MemoryArena::~MemoryArena()
+	{
+		for (auto finalizer = mFinalizers.rbegin(); finalizer != mFinalizers.rend(); ++finalizer)
+		{
+			finalizer->Destroy(finalizer->Object);
+		}
+
+		for (byte* block : mBlocks)
+		{
+			delete[] block;
+		}
+	}
+
+	void MemoryArena::Reserve(size_t size)
+	{
+		if (static_cast<size_t>(mEnd - mCurrent) < size)
+		{
+			AllocateBlock(size);
+		}
+	}
+
+	void* MemoryArena::Allocate(size_t size, size_t alignment)
+	{
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		size_t padding = (alignment - (reinterpret_cast<size_t>(mCurrent) & (alignment - 1))) & (alignment - 1);
+		if (mCurrent == nullptr || static_cast<size_t>(mEnd - mCurrent) < size + padding)
+		{
+			AllocateBlock(size + alignment);
+			padding = (alignment - (reinterpret_cast<size_t>(mCurrent) & (alignment - 1))) & (alignment - 1);
+		}
+
+		byte* memory = mCurrent + padding;
+		mCurrent = memory + size;
+
+		mStatistics.AllocationCount++;
+		mStatistics.BytesAllocated += size;
+
+		return memory;
+	}
+
+	void MemoryArena::Reset()
+	{
+		for (auto finalizer = mFinalizers.rbegin(); finalizer != mFinalizers.rend(); ++finalizer)
+		{
+			finalizer->Destroy(finalizer->Object);
+		}
+
+		mFinalizers.clear();
+
+		if (mBlocks.size() > 1)
+		{
+			size_t bytesReserved = mStatistics.BytesReserved;
+			for (byte* block : mBlocks)
+			{
+				delete[] block;
+			}
+
+			mBlocks.clear();
+			mStatistics.BlockCount = 0;
+			mStatistics.BytesReserved = 0;
+			AllocateBlock(bytesReserved);
+		}
+		else if (mBlocks.size() == 1)
+		{
+			mCurrent = mBlocks.front();
+		}
+
+		mStatistics.PeakBytesAllocated = (std::max)(mStatistics.PeakBytesAllocated, mStatistics.BytesAllocated);
+		mStatistics.AllocationCount = 0;
+		mStatistics.FinalizerCount = 0;
+		mStatistics.BytesAllocated = 0;
+		mStatistics.ResetCount++;
+	}
+
+	const MemoryArena::Statistics& MemoryArena::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void MemoryArena::AddFinalizer(void* object, Finalizer finalizer)
+	{
+		FinalizerEntry entry = { object, finalizer };
+		mFinalizers.push_back(entry);
+
+		mStatistics.FinalizerCount++;
+	}
+
+	void MemoryArena::AllocateBlock(size_t minimumSize)
+	{
+		// The remainder of the current block is abandoned; blocks are large enough that the waste is small
+		size_t blockSize = (std::max)(mBlockSize, minimumSize);
+		byte* block = new byte[blockSize];
+		mBlocks.push_back(block);
+
+		mCurrent = block;
+		mEnd = block + blockSize;
+
+		mStatistics.BlockCount++;
+		mStatistics.BytesReserved += blockSize;
+	}
+}
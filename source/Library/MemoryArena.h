@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Common.h"
+#include <type_traits>
+#include <new>
+
+namespace Library
+{
+	// A bump allocator for objects that share one lifetime. Memory is carved from large blocks and released all at once
+	// when the arena is reset or destroyed; individual frees are not supported. Objects with non-trivial destructors that
+	// are registered with the arena are destroyed in reverse order of registration before the memory is released.
+	// An arena is not thread-safe.
+	class MemoryArena
+	{
+	public:
+		struct Statistics
+		{
+			UINT AllocationCount;
+			UINT FinalizerCount;
+			UINT BlockCount;
+			size_t BytesAllocated;
+			size_t BytesReserved;
+			size_t PeakBytesAllocated;		// Largest BytesAllocated seen by Reset
+			UINT ResetCount;
+
+			Statistics()
+				: AllocationCount(0), FinalizerCount(0), BlockCount(0), BytesAllocated(0), BytesReserved(0), PeakBytesAllocated(0), ResetCount(0) { }
+		};
+
+		MemoryArena(size_t blockSize = DefaultBlockSize);
+		~MemoryArena();
+
+		void Reserve(size_t size);
+		void* Allocate(size_t size, size_t alignment);
+
+		// Destroys the registered objects and rewinds to the start of the memory. An arena that spilled into more than one
+		// block swaps them for a single block as large as all of them, so once a workload fits it never allocates again.
+		// Allocation and finalizer counts start over; the reserve and the peak are kept.
+		void Reset();
+		const Statistics& GetStatistics() const;
+
+		template <typename T>
+		T* Allocate(size_t count = 1)
+		{
+			return static_cast<T*>(Allocate(sizeof(T) * count, __alignof(T)));
+		}
+
+		// Objects placed with placement new from a class that has access to a private constructor register here
+		template <typename T>
+		void RegisterDestructor(T* object)
+		{
+			if (std::is_trivially_destructible<T>::value == false)
+			{
+				AddFinalizer(object, &MemoryArena::Destroy<T>);
+			}
+		}
+
+		template <typename T, typename... Args>
+		T* Create(Args&&... args)
+		{
+			T* object = new (Allocate<T>()) T(std::forward<Args>(args)...);
+			RegisterDestructor(object);
+
+			return object;
+		}
+
+		static const size_t DefaultBlockSize;
+
+	private:
+		MemoryArena(const MemoryArena& rhs);
+		MemoryArena& operator=(const MemoryArena& rhs);
+
+		typedef void(*Finalizer)(void* object);
+
+		struct FinalizerEntry
+		{
+			void* Object;
+			Finalizer Destroy;
+		};
+
+		template <typename T>
+		static void Destroy(void* object)
+		{
+			static_cast<T*>(object)->~T();
+		}
+
+		void AddFinalizer(void* object, Finalizer finalizer);
+		void AllocateBlock(size_t minimumSize);
+
+		size_t mBlockSize;
+		std::vector<byte*> mBlocks;
+		byte* mCurrent;
+		byte* mEnd;
+		std::vector<FinalizerEntry> mFinalizers;
+		Statistics mStatistics;
+	};
+
+	// Standard allocator adapter so containers inside arena-allocated objects draw from the same arena.
+	// Deallocation is a no-op; the memory is reclaimed with the arena.
+	template <typename T>
+	class ArenaAllocator
+	{
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef ArenaAllocator<U> other;
+		};
+
+		ArenaAllocator(MemoryArena& arena)
+			: mArena(&arena) { }
+
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& rhs)
+			: mArena(&rhs.Arena()) { }
+
+		MemoryArena& Arena() const
+		{
+			return *mArena;
+		}
+
+		T* allocate(size_t count)
+		{
+			return mArena->Allocate<T>(count);
+		}
+
+		void deallocate(T* pointer, size_t count)
+		{
+		}
+
+		template <typename U>
+		bool operator==(const ArenaAllocator<U>& rhs) const
+		{
+			return (mArena == &rhs.Arena());
+		}
+
+		template <typename U>
+		bool operator!=(const ArenaAllocator<U>& rhs) const
+		{
+			return (mArena != &rhs.Arena());
+		}
+
+	private:
+		MemoryArena* mArena;
+	};
+
+	typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
+}
@@ -0,0 +1,319 @@
+#include "MemoryTracker.h"
+#include <new>
+#include <cstdlib>
+
+namespace Library
+{
+	const wchar_t* const MemoryTracker::SubsystemNames[] = { L"General", L"Models", L"Animation", L"Effects", L"Render Targets" };
+
+	MemoryTracker::Counters MemoryTracker::sCounters[MemorySubsystemEnd];
+	LONG64 MemoryTracker::sFrameStartAllocationCounts[MemorySubsystemEnd];
+	LONG64 MemoryTracker::sFrameStartBytesAllocated[MemorySubsystemEnd];
+	UINT MemoryTracker::sFrameAllocationCounts[MemorySubsystemEnd];
+	size_t MemoryTracker::sFrameBytesAllocated[MemorySubsystemEnd];
+	size_t MemoryTracker::sBudgets[MemorySubsystemEnd];
+	bool MemoryTracker::sIsOverBudget[MemorySubsystemEnd];
+	MemoryTracker::Shard MemoryTracker::sShards[ShardCount];
+	__declspec(thread) MemorySubsystem MemoryTracker::sCurrentSubsystem = MemorySubsystemGeneral;
+	__declspec(thread) UINT MemoryTracker::sThreadAllocationCount = 0;
+
+	bool MemoryTracker::IsEnabled()
+	{
+#if defined( MEMORY_TRACKING )
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	const wchar_t* MemoryTracker::SubsystemName(MemorySubsystem subsystem)
+	{
+		assert(subsystem < MemorySubsystemEnd);
+		return SubsystemNames[subsystem];
+	}
+
+	MemorySubsystem MemoryTracker::CurrentSubsystem()
+	{
+		return sCurrentSubsystem;
+	}
+
+	UINT MemoryTracker::ThreadAllocationCount()
+	{
+		return sThreadAllocationCount;
+	}
+
+	MemoryTracker::Statistics MemoryTracker::GetStatistics(MemorySubsystem subsystem)
+	{
+		assert(subsystem < MemorySubsystemEnd);
+		const Counters& counters = sCounters[subsystem];
+
+		Statistics statistics;
+		statistics.BytesInUse = static_cast<size_t>(counters.BytesInUse);
+		statistics.PeakBytesInUse = static_cast<size_t>(counters.PeakBytesInUse);
+		statistics.AllocationsInUse = static_cast<UINT>(counters.AllocationsInUse);
+		statistics.AllocationCount = static_cast<UINT>(counters.AllocationCount);
+		statistics.FrameAllocationCount = sFrameAllocationCounts[subsystem];
+		statistics.FrameBytesAllocated = sFrameBytesAllocated[subsystem];
+		statistics.Budget = sBudgets[subsystem];
+
+		return statistics;
+	}
+
+	void MemoryTracker::SetBudget(MemorySubsystem subsystem, size_t budget)
+	{
+		assert(subsystem < MemorySubsystemEnd);
+		sBudgets[subsystem] = budget;
+		sIsOverBudget[subsystem] = false;
+	}
+
+	void MemoryTracker::RecordExternal(MemorySubsystem subsystem, INT64 size)
+	{
+		assert(subsystem < MemorySubsystemEnd);
+		Charge(subsystem, size, (size >= 0 ? 1 : -1));
+	}
+
+	void MemoryTracker::EndFrame()
+	{
+		for (UINT i = 0; i < MemorySubsystemEnd; i++)
+		{
+			LONG64 allocationCount = sCounters[i].AllocationCount;
+			LONG64 bytesAllocated = sCounters[i].BytesAllocated;
+			sFrameAllocationCounts[i] = static_cast<UINT>(allocationCount - sFrameStartAllocationCounts[i]);
+			sFrameBytesAllocated[i] = static_cast<size_t>(bytesAllocated - sFrameStartBytesAllocated[i]);
+			sFrameStartAllocationCounts[i] = allocationCount;
+			sFrameStartBytesAllocated[i] = bytesAllocated;
+
+			if (sBudgets[i] == 0)
+			{
+				continue;
+			}
+
+			size_t bytesInUse = static_cast<size_t>(sCounters[i].BytesInUse);
+			bool isOverBudget = (bytesInUse > sBudgets[i]);
+			if (isOverBudget && sIsOverBudget[i] == false)
+			{
+				wchar_t message[160];
+				swprintf_s(message, L"Memory budget exceeded: %s is using %Iu bytes of its %Iu byte budget.\n", SubsystemNames[i], bytesInUse, sBudgets[i]);
+				OutputDebugString(message);
+			}
+
+			sIsOverBudget[i] = isOverBudget;
+		}
+	}
+
+	UINT MemoryTracker::ReportLeaks()
+	{
+		UINT leakCount = 0;
+		for (UINT i = MemorySubsystemGeneral + 1; i < MemorySubsystemEnd; i++)
+		{
+			if (sCounters[i].AllocationsInUse > 0)
+			{
+				wchar_t message[160];
+				swprintf_s(message, L"Memory leak: %s still holds %Iu bytes in %I64d allocations.\n", SubsystemNames[i], static_cast<size_t>(sCounters[i].BytesInUse), sCounters[i].AllocationsInUse);
+				OutputDebugString(message);
+				leakCount++;
+			}
+		}
+
+		return leakCount;
+	}
+
+	void* MemoryTracker::Allocate(size_t size)
+	{
+		void* memory = malloc(size);
+		if (memory == nullptr)
+		{
+			return nullptr;
+		}
+
+		MemorySubsystem subsystem = sCurrentSubsystem;
+		if (AddRecord(memory, size, subsystem) == false)
+		{
+			free(memory);
+			return nullptr;
+		}
+
+		Charge(subsystem, static_cast<INT64>(size), 1);
+		sThreadAllocationCount++;
+
+		return memory;
+	}
+
+	void MemoryTracker::Free(void* memory)
+	{
+		if (memory == nullptr)
+		{
+			return;
+		}
+
+		// The record goes before the memory does, so another thread cannot be handed the address and record it first
+		size_t size;
+		MemorySubsystem subsystem;
+		if (RemoveRecord(memory, size, subsystem))
+		{
+			Charge(subsystem, -static_cast<INT64>(size), -1);
+		}
+
+		free(memory);
+	}
+
+	void MemoryTracker::Charge(MemorySubsystem subsystem, INT64 size, INT64 allocationCount)
+	{
+		Counters& counters = sCounters[subsystem];
+		LONG64 bytesInUse = InterlockedExchangeAdd64(&counters.BytesInUse, size) + size;
+		InterlockedExchangeAdd64(&counters.AllocationsInUse, allocationCount);
+
+		if (allocationCount < 0)
+		{
+			return;
+		}
+
+		InterlockedIncrement64(&counters.AllocationCount);
+		InterlockedExchangeAdd64(&counters.BytesAllocated, size);
+
+		// Raising the peak only contends when it actually moves
+		LONG64 peak = counters.PeakBytesInUse;
+		while (bytesInUse > peak)
+		{
+			LONG64 previousPeak = InterlockedCompareExchange64(&counters.PeakBytesInUse, bytesInUse, peak);
+			if (previousPeak == peak)
+			{
+				break;
+			}
+
+			peak = previousPeak;
+		}
+	}
+
+	MemoryTracker::Shard& MemoryTracker::FindShard(const void* address, UINT& bucket)
+	{
+		// Heap blocks are at least 8-byte aligned, so the low bits carry nothing; the multiply spreads the rest
+		UINT64 hash = (static_cast<UINT64>(reinterpret_cast<size_t>(address)) >> 3) * 0x9E3779B97F4A7C15ULL;
+		UINT index = static_cast<UINT>(hash >> 32) % (ShardCount * BucketsPerShard);
+		bucket = index / ShardCount;
+
+		return sShards[index % ShardCount];
+	}
+
+	bool MemoryTracker::AddRecord(void* address, size_t size, MemorySubsystem subsystem)
+	{
+		UINT bucket;
+		Shard& shard = FindShard(address, bucket);
+		AcquireSRWLockExclusive(&shard.Lock);
+
+		if (shard.FreeRecords == nullptr)
+		{
+			AllocationRecord* block = static_cast<AllocationRecord*>(HeapAlloc(GetProcessHeap(), 0, RecordBlockSize));
+			if (block == nullptr)
+			{
+				ReleaseSRWLockExclusive(&shard.Lock);
+				return false;
+			}
+
+			for (size_t i = 0; i < RecordBlockSize / sizeof(AllocationRecord); i++)
+			{
+				block[i].Next = shard.FreeRecords;
+				shard.FreeRecords = &block[i];
+			}
+		}
+
+		AllocationRecord* record = shard.FreeRecords;
+		shard.FreeRecords = record->Next;
+		record->Address = address;
+		record->Size = size;
+		record->Subsystem = subsystem;
+		record->Next = shard.Buckets[bucket];
+		shard.Buckets[bucket] = record;
+
+		ReleaseSRWLockExclusive(&shard.Lock);
+		return true;
+	}
+
+	bool MemoryTracker::RemoveRecord(void* address, size_t& size, MemorySubsystem& subsystem)
+	{
+		UINT bucket;
+		Shard& shard = FindShard(address, bucket);
+		AcquireSRWLockExclusive(&shard.Lock);
+
+		bool found = false;
+		for (AllocationRecord** link = &shard.Buckets[bucket]; *link != nullptr; link = &(*link)->Next)
+		{
+			AllocationRecord* record = *link;
+			if (record->Address == address)
+			{
+				size = record->Size;
+				subsystem = record->Subsystem;
+				*link = record->Next;
+				record->Next = shard.FreeRecords;
+				shard.FreeRecords = record;
+				found = true;
+				break;
+			}
+		}
+
+		ReleaseSRWLockExclusive(&shard.Lock);
+		return found;
+	}
+
+	MemoryScope::MemoryScope(MemorySubsystem subsystem)
+		: mPreviousSubsystem(MemoryTracker::sCurrentSubsystem)
+	{
+		assert(subsystem < MemorySubsystemEnd);
+		MemoryTracker::sCurrentSubsystem = subsystem;
+	}
+
+	MemoryScope::~MemoryScope()
+	{
+		MemoryTracker::sCurrentSubsystem = mPreviousSubsystem;
+	}
+}
+
+#if defined( MEMORY_TRACKING )
+
+void* operator new(size_t size)
+{
+	void* memory = Library::MemoryTracker::Allocate(size);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&)
+{
+	return Library::MemoryTracker::Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&)
+{
+	return Library::MemoryTracker::Allocate(size);
+}
+
+void operator delete(void* memory)
+{
+	Library::MemoryTracker::Free(memory);
+}
+
+void operator delete[](void* memory)
+{
+	Library::MemoryTracker::Free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&)
+{
+	Library::MemoryTracker::Free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&)
+{
+	Library::MemoryTracker::Free(memory);
+}
+
+#endif
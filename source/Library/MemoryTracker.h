@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Common.h"
+
+// Tracking replaces the global operator new and delete. Debug builds always have it; profiling builds turn it on by
+// defining MEMORY_TRACKING for the Library project.
+#if !defined( MEMORY_TRACKING ) && ( defined( DEBUG ) || defined( _DEBUG ) )
+#define MEMORY_TRACKING
+#endif
+
+namespace Library
+{
+	enum MemorySubsystem
+	{
+		MemorySubsystemGeneral = 0,
+		MemorySubsystemModels,
+		MemorySubsystemAnimation,
+		MemorySubsystemEffects,
+		MemorySubsystemRenderTargets,
+		MemorySubsystemEnd
+	};
+
+	// Counts heap memory by subsystem. Each allocation is charged to the subsystem of the innermost MemoryScope on the
+	// allocating thread, or to General outside any scope, and is credited back to the same subsystem when it is freed,
+	// whichever thread frees it. Memory the heap never sees, such as Direct3D resources, can be charged with
+	// RecordExternal. Counters are updated with interlocked operations, and each allocation's size and subsystem are kept
+	// in a table keyed by its address rather than in a header in front of it, so the cost is a few atomic adds and a short
+	// locked lookup per allocation. A block that crosses into a module with its own heap, such as the Assimp DLL, is then
+	// still the pointer that module's allocator returned; freeing one the table does not know frees it uncounted.
+	class MemoryTracker
+	{
+	public:
+		struct Statistics
+		{
+			size_t BytesInUse;
+			size_t PeakBytesInUse;
+			UINT AllocationsInUse;
+			UINT AllocationCount;
+			UINT FrameAllocationCount;		// Allocations made during the last completed frame
+			size_t FrameBytesAllocated;
+			size_t Budget;					// Zero for no budget
+
+			Statistics()
+				: BytesInUse(0), PeakBytesInUse(0), AllocationsInUse(0), AllocationCount(0), FrameAllocationCount(0), FrameBytesAllocated(0), Budget(0) { }
+		};
+
+		static bool IsEnabled();
+		static const wchar_t* SubsystemName(MemorySubsystem subsystem);
+		static MemorySubsystem CurrentSubsystem();
+
+		// Heap allocations the calling thread has made in any subsystem; the difference across a stretch of work counts its
+		// allocations without picking up those of other threads
+		static UINT ThreadAllocationCount();
+
+		static Statistics GetStatistics(MemorySubsystem subsystem);
+		static void SetBudget(MemorySubsystem subsystem, size_t budget);
+
+		// Charges (or, with a negative size, credits) memory allocated outside the heap
+		static void RecordExternal(MemorySubsystem subsystem, INT64 size);
+
+		// Closes the frame counters, then warns once each time a subsystem goes over its budget. Called once per Tick.
+		static void EndFrame();
+
+		// Reports every subsystem other than General that still holds memory; returns how many do. Called at shutdown,
+		// once everything a subsystem owns should have been released.
+		static UINT ReportLeaks();
+
+		// Used by the global operator new and delete; not for direct use
+		static void* Allocate(size_t size);
+		static void Free(void* memory);
+
+	private:
+		friend class MemoryScope;
+
+		MemoryTracker();
+		MemoryTracker(const MemoryTracker& rhs);
+		MemoryTracker& operator=(const MemoryTracker& rhs);
+
+		static const UINT ShardCount = 64;
+		static const UINT BucketsPerShard = 4096;
+		static const size_t RecordBlockSize = 64 * 1024;
+
+		// One cache line per subsystem, so threads charging different subsystems do not contend
+		struct __declspec(align(64)) Counters
+		{
+			volatile LONG64 BytesInUse;
+			volatile LONG64 PeakBytesInUse;
+			volatile LONG64 AllocationsInUse;
+			volatile LONG64 AllocationCount;
+			volatile LONG64 BytesAllocated;
+		};
+
+		struct AllocationRecord
+		{
+			void* Address;
+			size_t Size;
+			MemorySubsystem Subsystem;
+			AllocationRecord* Next;
+		};
+
+		// A slice of the address table with its own lock. Records are recycled through a free list and come from blocks
+		// taken straight from the process heap, since operator new would lead back here.
+		struct __declspec(align(64)) Shard
+		{
+			SRWLOCK Lock;
+			AllocationRecord* FreeRecords;
+			AllocationRecord* Buckets[BucketsPerShard];
+		};
+
+		static void Charge(MemorySubsystem subsystem, INT64 size, INT64 allocationCount);
+		static Shard& FindShard(const void* address, UINT& bucket);
+		static bool AddRecord(void* address, size_t size, MemorySubsystem subsystem);
+		static bool RemoveRecord(void* address, size_t& size, MemorySubsystem& subsystem);
+
+		static const wchar_t* const SubsystemNames[];
+
+		// Plain data throughout, so allocations made before static initialization reaches this file are counted too
+		static Counters sCounters[MemorySubsystemEnd];
+		static LONG64 sFrameStartAllocationCounts[MemorySubsystemEnd];
+		static LONG64 sFrameStartBytesAllocated[MemorySubsystemEnd];
+		static UINT sFrameAllocationCounts[MemorySubsystemEnd];
+		static size_t sFrameBytesAllocated[MemorySubsystemEnd];
+		static size_t sBudgets[MemorySubsystemEnd];
+		static bool sIsOverBudget[MemorySubsystemEnd];
+		static Shard sShards[ShardCount];
+		static __declspec(thread) MemorySubsystem sCurrentSubsystem;
+		static __declspec(thread) UINT sThreadAllocationCount;
+	};
+
+	// Charges the calling thread's allocations to a subsystem until the scope ends; scopes nest
+	class MemoryScope
+	{
+	public:
+		MemoryScope(MemorySubsystem subsystem);
+		~MemoryScope();
+
+	private:
+		MemoryScope();
+		MemoryScope(const MemoryScope& rhs);
+		MemoryScope& operator=(const MemoryScope& rhs);
+
+		MemorySubsystem mPreviousSubsystem;
+	};
+}
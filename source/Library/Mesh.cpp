@@ -2,6 +2,10 @@
 #include "Model.h"
 #include "Material.h"
 #include "Bone.h"
+#include "Skeleton.h"
+#include "MorphTarget.h"
+#include "MeshBvh.h"
+#include "MemoryArena.h"
 #include "Game.h"
 #include "GameException.h"
 #include "scene.h"
@@ -10,10 +14,13 @@ namespace Library
 {
 	Mesh::Mesh(Model& model, aiMesh& mesh)
 		: mModel(model), mMaterial(nullptr), mName(mesh.mName.C_Str()), mVertices(), mNormals(), mTangents(), mBiNormals(), mTextureCoordinates(), mVertexColors(),
-		mFaceCount(0), mIndices(), mBoneWeights(), mVertexBuffer(), mIndexBuffer()
+		mFaceCount(0), mIndices(), mBoneWeights(), mMorphTargets(), mBvh(nullptr), mVertexBuffer(), mIndexBuffer()
 	{
 		mMaterial = mModel.Materials().at(mesh.mMaterialIndex);
 
+		// Every container is reserved to its final size, so each is allocated once
+		MemoryArena& arena = *(mModel.mArena);
+
 		// Vertices
 		mVertices.reserve(mesh.mNumVertices);
 		for (UINT i = 0; i < mesh.mNumVertices; i++)
@@ -45,9 +52,10 @@ namespace Library
 
 		// Texture Coordinates
 		UINT uvChannelCount = mesh.GetNumUVChannels();
+		mTextureCoordinates.reserve(uvChannelCount);
 		for (UINT i = 0; i < uvChannelCount; i++)
 		{
-			std::vector<XMFLOAT3>* textureCoordinates = new std::vector<XMFLOAT3>();
+			std::vector<XMFLOAT3>* textureCoordinates = arena.Create<std::vector<XMFLOAT3>>();
 			textureCoordinates->reserve(mesh.mNumVertices);
 			mTextureCoordinates.push_back(textureCoordinates);
 
@@ -60,9 +68,10 @@ namespace Library
 
 		// Vertex Colors
 		UINT colorChannelCount = mesh.GetNumColorChannels();
+		mVertexColors.reserve(colorChannelCount);
 		for (UINT i = 0; i < colorChannelCount; i++)
 		{
-			std::vector<XMFLOAT4>* vertexColors = new std::vector<XMFLOAT4>();
+			std::vector<XMFLOAT4>* vertexColors = arena.Create<std::vector<XMFLOAT4>>();
 			vertexColors->reserve(mesh.mNumVertices);
 			mVertexColors.push_back(vertexColors);
 
@@ -73,10 +82,18 @@ namespace Library
 			}
 		}
 
-		// Faces (note: could pre-reserve if we limit primitive types)
+		// Faces
 		if (mesh.HasFaces())
 		{
 			mFaceCount = mesh.mNumFaces;
+
+			UINT indexCount = 0;
+			for (UINT i = 0; i < mFaceCount; i++)
+			{
+				indexCount += mesh.mFaces[i].mNumIndices;
+			}
+
+			mIndices.reserve(indexCount);
 			for (UINT i = 0; i < mFaceCount; i++)
 			{
 				aiFace* face = &mesh.mFaces[i];
@@ -97,24 +114,22 @@ namespace Library
 			{
 				aiBone* meshBone = mesh.mBones[i];
 
-				// Look up the bone in the model's hierarchy, or add it if not found.
+				// Look up the bone in the model's skeleton, or add it if the model owns the skeleton.
 				UINT boneIndex = 0U;
 				std::string boneName = meshBone->mName.C_Str();
-				auto boneMappingIterator = mModel.mBoneIndexMapping.find(boneName);
-				if (boneMappingIterator != mModel.mBoneIndexMapping.end())
-				{
-					boneIndex = boneMappingIterator->second;
-				}
-				else
+				Skeleton& skeleton = *(mModel.mSkeleton);
+				if (skeleton.TryGetBoneIndex(boneName, boneIndex) == false)
 				{
-					boneIndex = mModel.mBones.size();
-					XMMATRIX offsetMatrix = XMLoadFloat4x4(&(XMFLOAT4X4(reinterpret_cast<const float*>(meshBone->mOffsetMatrix[0]))));
+					if (mModel.mOwnsSkeleton == false)
+					{
+						throw GameException("Mesh references a bone that is not in the shared skeleton.");
+					}
+
+					XMFLOAT4X4 offsetMatrix(reinterpret_cast<const float*>(meshBone->mOffsetMatrix[0]));
 					XMFLOAT4X4 offset;
-					XMStoreFloat4x4(&offset, XMMatrixTranspose(offsetMatrix));
+					XMStoreFloat4x4(&offset, XMMatrixTranspose(XMLoadFloat4x4(&offsetMatrix)));
 
-					Bone* modelBone = new Bone(boneName, boneIndex, offset);
-					mModel.mBones.push_back(modelBone);
-					mModel.mBoneIndexMapping[boneName] = boneIndex;
+					boneIndex = skeleton.AddBone(boneName, offset);
 				}
 
 				for (UINT i = 0; i < meshBone->mNumWeights; i++)
@@ -124,20 +139,18 @@ namespace Library
 				}
 			}
 		}
-	}
-
-	Mesh::~Mesh()
-	{
-		for (std::vector<XMFLOAT3>* textureCoordinates : mTextureCoordinates)
-		{
-			delete textureCoordinates;
-		}
 
-		for (std::vector<XMFLOAT4>* vertexColors : mVertexColors)
+		// Morph targets
+		mMorphTargets.reserve(mesh.mNumAnimMeshes);
+		for (UINT i = 0; i < mesh.mNumAnimMeshes; i++)
 		{
-			delete vertexColors;
+			mMorphTargets.push_back(arena.Create<MorphTarget>(i, mesh, *(mesh.mAnimMeshes[i]), arena));
 		}
+	}
 
+	Mesh::~Mesh()
+	{
+		// Channel lists, morph targets and the hierarchy are released with the model's arena
 		mVertexBuffer.ReleaseBuffer();
 		mIndexBuffer.ReleaseBuffer();
 	}
@@ -202,6 +215,27 @@ namespace Library
 		return mBoneWeights;
 	}
 
+	const std::vector<MorphTarget*>& Mesh::MorphTargets() const
+	{
+		return mMorphTargets;
+	}
+
+	const MeshBvh* Mesh::Bvh() const
+	{
+		return mBvh;
+	}
+
+	const MeshBvh* Mesh::CreateBvh()
+	{
+		// Ray queries need a triangle list; meshes with points, lines or polygons are left without a hierarchy
+		if (mBvh == nullptr && mFaceCount > 0 && mIndices.size() == mFaceCount * 3)
+		{
+			mBvh = mModel.mArena->Create<MeshBvh>(mVertices, mIndices, *(mModel.mArena));
+		}
+
+		return mBvh;
+	}
+
 	BufferContainer& Mesh::VertexBuffer()
 	{
 		return mVertexBuffer;
@@ -7,10 +7,15 @@ struct aiMesh;
 
 namespace Library
 {
+	class Model;
 	class Material;
 	class ModelMaterial;
 	class BoneVertexWeights;
+	class MorphTarget;
+	class MeshBvh;
 
+	// Each vertex channel, the indices and the bone weights are reserved at their final size, so each is a single heap
+	// allocation. Morph targets, the ray query hierarchy and the channel lists' entries live in the model's arena.
 	class Mesh
 	{
 		friend class Model;
@@ -31,6 +36,12 @@ namespace Library
 		UINT FaceCount() const;
 		const std::vector<UINT>& Indices() const;
 		const std::vector<BoneVertexWeights>& BoneWeights() const;
+		const std::vector<MorphTarget*>& MorphTargets() const;
+		const MeshBvh* Bvh() const;
+
+		// Builds the ray query hierarchy on first use; until then Bvh returns null. The hierarchy is allocated from the
+		// model's arena, so call this on the thread that owns the model, before it is shared. It covers the bind pose only.
+		const MeshBvh* CreateBvh();
 
 		BufferContainer& VertexBuffer();
 		BufferContainer& IndexBuffer();
@@ -58,6 +69,8 @@ namespace Library
 		UINT mFaceCount;
 		std::vector<UINT> mIndices;
 		std::vector<BoneVertexWeights> mBoneWeights;
+		std::vector<MorphTarget*> mMorphTargets;
+		MeshBvh* mBvh;
 
 		BufferContainer mVertexBuffer;
 		BufferContainer mIndexBuffer;
@@ -0,0 +1,572 @@
+#include "MeshBvh.h"
+#include "ClockSource.h"
+#include "Ray.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <mutex>
+
+namespace Library
+{
+	const UINT MeshBvh::InvalidTriangle = UINT_MAX;
+	const UINT MeshBvh::ParallelBinningThreshold = 16384;
+	const UINT MeshBvh::MinimumTrianglesPerWorker = 4096;
+	const UINT MeshBvh::MinimumRaysPerWorker = 256;
+
+	MeshBvh::MeshBvh(const std::vector<XMFLOAT3>& vertices, const std::vector<UINT>& indices, MemoryArena& arena)
+		: mNodes(ArenaAllocator<Node>(arena)), mPackets(ArenaAllocator<TrianglePacket>(arena)), mBuildNodes(), mBuildPackets(),
+		mTriangleBounds(), mTriangleCentroids(), mTriangleOrder(), mStatistics()
+	{
+		Build(vertices, indices);
+	}
+
+	bool MeshBvh::Intersect(const Ray& ray, float maxDistance, Hit& hit) const
+	{
+		std::vector<StackEntry> stack;
+		stack.reserve(mStatistics.Depth + 1);
+
+		return Intersect(ray, maxDistance, hit, stack);
+	}
+
+	UINT MeshBvh::Trace(const std::vector<Ray>& rays, float maxDistance, std::vector<Hit>& hits)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		UINT rayCount = rays.size();
+		hits.resize(rayCount);
+
+		Parallel::For(0, rayCount, MinimumRaysPerWorker, [&](UINT begin, UINT end)
+		{
+			std::vector<StackEntry> stack;
+			stack.reserve(mStatistics.Depth + 1);
+
+			for (UINT i = begin; i < end; i++)
+			{
+				hits[i] = Hit();
+				Intersect(rays[i], maxDistance, hits[i], stack);
+			}
+		});
+
+		UINT hitCount = 0;
+		for (const Hit& hit : hits)
+		{
+			if (hit.Triangle != InvalidTriangle)
+			{
+				hitCount++;
+			}
+		}
+
+		mStatistics.RayCount += rayCount;
+		mStatistics.HitCount += hitCount;
+		mStatistics.TraceMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		return hitCount;
+	}
+
+	AxisAlignedBox MeshBvh::Bounds() const
+	{
+		return (mNodes.size() > 0 ? mNodes[0].Box : AxisAlignedBox());
+	}
+
+	const MeshBvh::Statistics& MeshBvh::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void MeshBvh::ResetCounters()
+	{
+		mStatistics.RayCount = 0;
+		mStatistics.HitCount = 0;
+		mStatistics.TraceMilliseconds = 0.0;
+	}
+
+	void MeshBvh::Build(const std::vector<XMFLOAT3>& vertices, const std::vector<UINT>& indices)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		UINT triangleCount = indices.size() / 3;
+		mStatistics.TriangleCount = triangleCount;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		mTriangleBounds.resize(triangleCount);
+		mTriangleCentroids.resize(triangleCount);
+		mTriangleOrder.resize(triangleCount);
+
+		Parallel::For(0, triangleCount, MinimumTrianglesPerWorker, [&](UINT begin, UINT end)
+		{
+			for (UINT i = begin; i < end; i++)
+			{
+				AxisAlignedBox bounds;
+				bounds.Merge(vertices[indices[i * 3]]);
+				bounds.Merge(vertices[indices[i * 3 + 1]]);
+				bounds.Merge(vertices[indices[i * 3 + 2]]);
+
+				mTriangleBounds[i] = bounds;
+				mTriangleCentroids[i] = bounds.Center();
+				mTriangleOrder[i] = i;
+			}
+		});
+
+		struct BuildTask
+		{
+			UINT Node;
+			UINT Begin;
+			UINT End;
+			UINT Depth;
+		};
+
+		// A binary tree with at least one triangle per leaf never needs more than 2n - 1 nodes
+		mBuildNodes.reserve(triangleCount * 2);
+		mBuildNodes.push_back(Node());
+
+		std::vector<BuildTask> tasks;
+		BuildTask rootTask = { 0, 0, triangleCount, 1 };
+		tasks.push_back(rootTask);
+
+		while (tasks.size() > 0)
+		{
+			BuildTask task = tasks.back();
+			tasks.pop_back();
+
+			mStatistics.Depth = (std::max)(mStatistics.Depth, task.Depth);
+
+			AxisAlignedBox centroidBounds;
+			ComputeBounds(task.Begin, task.End, mBuildNodes[task.Node].Box, centroidBounds);
+
+			if (task.End - task.Begin <= MaxLeafSize)
+			{
+				CreateLeaf(mBuildNodes[task.Node], task.Begin, task.End, vertices, indices);
+				continue;
+			}
+
+			UINT middle = task.Begin;
+			UINT splitAxis;
+			UINT splitBin;
+			if (FindSplit(task.Begin, task.End, centroidBounds, splitAxis, splitBin))
+			{
+				const float* minimum = reinterpret_cast<const float*>(&centroidBounds.Minimum);
+				const float* maximum = reinterpret_cast<const float*>(&centroidBounds.Maximum);
+				float scale = BinCount / (maximum[splitAxis] - minimum[splitAxis]);
+
+				UINT* first = &mTriangleOrder[0] + task.Begin;
+				UINT* last = &mTriangleOrder[0] + task.End;
+				middle = static_cast<UINT>(std::partition(first, last, [&](UINT triangle)
+				{
+					const float* centroid = reinterpret_cast<const float*>(&mTriangleCentroids[triangle]);
+					return (BinIndex(centroid[splitAxis], minimum[splitAxis], scale) < splitBin);
+				}) - &mTriangleOrder[0]);
+			}
+
+			if (middle == task.Begin || middle == task.End)
+			{
+				// Every centroid coincides; any division is as good as another, so halve the range to bound the depth
+				middle = task.Begin + (task.End - task.Begin) / 2;
+			}
+
+			UINT firstChild = mBuildNodes.size();
+			mBuildNodes.push_back(Node());
+			mBuildNodes.push_back(Node());
+
+			Node& node = mBuildNodes[task.Node];
+			node.Offset = firstChild;
+			node.Count = 0;
+
+			BuildTask rightTask = { firstChild + 1, middle, task.End, task.Depth + 1 };
+			BuildTask leftTask = { firstChild, task.Begin, middle, task.Depth + 1 };
+			tasks.push_back(rightTask);
+			tasks.push_back(leftTask);
+		}
+
+		mStatistics.NodeCount = mBuildNodes.size();
+		mStatistics.LeafCount = mBuildPackets.size();
+
+		mNodes.assign(mBuildNodes.begin(), mBuildNodes.end());
+		mPackets.assign(mBuildPackets.begin(), mBuildPackets.end());
+
+		std::vector<Node>().swap(mBuildNodes);
+		std::vector<TrianglePacket>().swap(mBuildPackets);
+		std::vector<AxisAlignedBox>().swap(mTriangleBounds);
+		std::vector<XMFLOAT3>().swap(mTriangleCentroids);
+		std::vector<UINT>().swap(mTriangleOrder);
+
+		mStatistics.BuildMilliseconds = RealClockSource::Milliseconds() - startTime;
+	}
+
+	void MeshBvh::ComputeBounds(UINT begin, UINT end, AxisAlignedBox& bounds, AxisAlignedBox& centroidBounds) const
+	{
+		auto computeRange = [this](UINT rangeBegin, UINT rangeEnd, AxisAlignedBox& rangeBounds, AxisAlignedBox& rangeCentroidBounds)
+		{
+			for (UINT i = rangeBegin; i < rangeEnd; i++)
+			{
+				UINT triangle = mTriangleOrder[i];
+				rangeBounds.Merge(mTriangleBounds[triangle]);
+				rangeCentroidBounds.Merge(mTriangleCentroids[triangle]);
+			}
+		};
+
+		bounds = AxisAlignedBox();
+		centroidBounds = AxisAlignedBox();
+
+		if (end - begin < ParallelBinningThreshold)
+		{
+			computeRange(begin, end, bounds, centroidBounds);
+			return;
+		}
+
+		std::mutex mutex;
+		Parallel::For(begin, end, MinimumTrianglesPerWorker, [&](UINT rangeBegin, UINT rangeEnd)
+		{
+			AxisAlignedBox rangeBounds;
+			AxisAlignedBox rangeCentroidBounds;
+			computeRange(rangeBegin, rangeEnd, rangeBounds, rangeCentroidBounds);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			bounds.Merge(rangeBounds);
+			centroidBounds.Merge(rangeCentroidBounds);
+		});
+	}
+
+	void MeshBvh::ComputeBins(UINT begin, UINT end, const AxisAlignedBox& centroidBounds, Bin (&bins)[3][BinCount]) const
+	{
+		const float* minimum = reinterpret_cast<const float*>(&centroidBounds.Minimum);
+		const float* maximum = reinterpret_cast<const float*>(&centroidBounds.Maximum);
+
+		float scales[3];
+		for (UINT axis = 0; axis < 3; axis++)
+		{
+			float extent = maximum[axis] - minimum[axis];
+			scales[axis] = (extent > 0.0f ? BinCount / extent : 0.0f);
+		}
+
+		auto binRange = [&](UINT rangeBegin, UINT rangeEnd, Bin (&rangeBins)[3][BinCount])
+		{
+			for (UINT i = rangeBegin; i < rangeEnd; i++)
+			{
+				UINT triangle = mTriangleOrder[i];
+				const float* centroid = reinterpret_cast<const float*>(&mTriangleCentroids[triangle]);
+
+				for (UINT axis = 0; axis < 3; axis++)
+				{
+					Bin& bin = rangeBins[axis][BinIndex(centroid[axis], minimum[axis], scales[axis])];
+					bin.Bounds.Merge(mTriangleBounds[triangle]);
+					bin.Count++;
+				}
+			}
+		};
+
+		if (end - begin < ParallelBinningThreshold)
+		{
+			binRange(begin, end, bins);
+			return;
+		}
+
+		// Large nodes are binned in ranges on worker threads and the partial bins merged afterwards
+		std::mutex mutex;
+		Parallel::For(begin, end, MinimumTrianglesPerWorker, [&](UINT rangeBegin, UINT rangeEnd)
+		{
+			Bin rangeBins[3][BinCount];
+			binRange(rangeBegin, rangeEnd, rangeBins);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			for (UINT axis = 0; axis < 3; axis++)
+			{
+				for (UINT i = 0; i < BinCount; i++)
+				{
+					bins[axis][i].Bounds.Merge(rangeBins[axis][i].Bounds);
+					bins[axis][i].Count += rangeBins[axis][i].Count;
+				}
+			}
+		});
+	}
+
+	bool MeshBvh::FindSplit(UINT begin, UINT end, const AxisAlignedBox& centroidBounds, UINT& splitAxis, UINT& splitBin) const
+	{
+		Bin bins[3][BinCount];
+		ComputeBins(begin, end, centroidBounds, bins);
+
+		const float* minimum = reinterpret_cast<const float*>(&centroidBounds.Minimum);
+		const float* maximum = reinterpret_cast<const float*>(&centroidBounds.Maximum);
+
+		float bestCost = FLT_MAX;
+		bool isFound = false;
+
+		for (UINT axis = 0; axis < 3; axis++)
+		{
+			if (maximum[axis] <= minimum[axis])
+			{
+				continue;
+			}
+
+			// Sweep from the right to collect suffix areas, then from the left to price each plane between bins
+			float rightAreas[BinCount];
+			UINT rightCounts[BinCount];
+			AxisAlignedBox rightBounds;
+			UINT rightCount = 0;
+			for (UINT i = BinCount - 1; i > 0; i--)
+			{
+				rightBounds.Merge(bins[axis][i].Bounds);
+				rightCount += bins[axis][i].Count;
+				rightAreas[i] = (rightCount > 0 ? rightBounds.SurfaceArea() : 0.0f);
+				rightCounts[i] = rightCount;
+			}
+
+			AxisAlignedBox leftBounds;
+			UINT leftCount = 0;
+			for (UINT i = 1; i < BinCount; i++)
+			{
+				leftBounds.Merge(bins[axis][i - 1].Bounds);
+				leftCount += bins[axis][i - 1].Count;
+				if (leftCount == 0 || rightCounts[i] == 0)
+				{
+					continue;
+				}
+
+				float cost = leftCount * leftBounds.SurfaceArea() + rightCounts[i] * rightAreas[i];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					splitAxis = axis;
+					splitBin = i;
+					isFound = true;
+				}
+			}
+		}
+
+		return isFound;
+	}
+
+	void MeshBvh::CreateLeaf(Node& node, UINT begin, UINT end, const std::vector<XMFLOAT3>& vertices, const std::vector<UINT>& indices)
+	{
+		node.Offset = mBuildPackets.size();
+		node.Count = end - begin;
+
+		// Unused lanes keep zero edges, which the intersection test rejects as degenerate
+		TrianglePacket packet;
+		ZeroMemory(&packet, sizeof(packet));
+
+		for (UINT lane = 0; lane < MaxLeafSize; lane++)
+		{
+			packet.Triangles[lane] = InvalidTriangle;
+			if (begin + lane >= end)
+			{
+				continue;
+			}
+
+			UINT triangle = mTriangleOrder[begin + lane];
+			const XMFLOAT3& vertex0 = vertices[indices[triangle * 3]];
+			const XMFLOAT3& vertex1 = vertices[indices[triangle * 3 + 1]];
+			const XMFLOAT3& vertex2 = vertices[indices[triangle * 3 + 2]];
+
+			const float vertex0Coordinates[] = { vertex0.x, vertex0.y, vertex0.z };
+			const float edge1Coordinates[] = { vertex1.x - vertex0.x, vertex1.y - vertex0.y, vertex1.z - vertex0.z };
+			const float edge2Coordinates[] = { vertex2.x - vertex0.x, vertex2.y - vertex0.y, vertex2.z - vertex0.z };
+
+			for (UINT axis = 0; axis < 3; axis++)
+			{
+				reinterpret_cast<float*>(&packet.Vertex0[axis])[lane] = vertex0Coordinates[axis];
+				reinterpret_cast<float*>(&packet.Edge1[axis])[lane] = edge1Coordinates[axis];
+				reinterpret_cast<float*>(&packet.Edge2[axis])[lane] = edge2Coordinates[axis];
+			}
+
+			packet.Triangles[lane] = triangle;
+		}
+
+		mBuildPackets.push_back(packet);
+	}
+
+	bool MeshBvh::Intersect(const Ray& ray, float maxDistance, Hit& hit, std::vector<StackEntry>& stack) const
+	{
+		hit = Hit();
+		if (mNodes.empty())
+		{
+			return false;
+		}
+
+		const XMFLOAT3& origin = ray.Position();
+		const XMFLOAT3& direction = ray.Direction();
+
+		// Zero direction components get a large finite reciprocal so the slab test never multiplies zero by infinity
+		XMFLOAT3 inverseDirection(
+			(direction.x != 0.0f ? 1.0f / direction.x : 1e30f),
+			(direction.y != 0.0f ? 1.0f / direction.y : 1e30f),
+			(direction.z != 0.0f ? 1.0f / direction.z : 1e30f));
+
+		const XMVECTOR rayLanes[] =
+		{
+			XMVectorReplicate(origin.x), XMVectorReplicate(origin.y), XMVectorReplicate(origin.z),
+			XMVectorReplicate(direction.x), XMVectorReplicate(direction.y), XMVectorReplicate(direction.z)
+		};
+
+		Hit closestHit;
+		closestHit.Distance = maxDistance;
+
+		float distance;
+		if (IntersectBox(mNodes[0].Box, origin, inverseDirection, closestHit.Distance, distance) == false)
+		{
+			return false;
+		}
+
+		stack.clear();
+		StackEntry rootEntry = { 0, distance };
+		stack.push_back(rootEntry);
+
+		while (stack.size() > 0)
+		{
+			StackEntry entry = stack.back();
+			stack.pop_back();
+
+			// Skip nodes that a hit found since they were pushed has already moved out of reach
+			if (entry.Distance > closestHit.Distance)
+			{
+				continue;
+			}
+
+			const Node& node = mNodes[entry.Node];
+			if (node.Count > 0)
+			{
+				IntersectPacket(mPackets[node.Offset], rayLanes, closestHit);
+				continue;
+			}
+
+			float firstDistance;
+			float secondDistance;
+			bool isFirstHit = IntersectBox(mNodes[node.Offset].Box, origin, inverseDirection, closestHit.Distance, firstDistance);
+			bool isSecondHit = IntersectBox(mNodes[node.Offset + 1].Box, origin, inverseDirection, closestHit.Distance, secondDistance);
+
+			StackEntry first = { node.Offset, firstDistance };
+			StackEntry second = { node.Offset + 1, secondDistance };
+
+			// The nearer child is pushed last so it is visited first and tightens the search for its sibling
+			if (isFirstHit && isSecondHit)
+			{
+				if (firstDistance < secondDistance)
+				{
+					stack.push_back(second);
+					stack.push_back(first);
+				}
+				else
+				{
+					stack.push_back(first);
+					stack.push_back(second);
+				}
+			}
+			else if (isFirstHit)
+			{
+				stack.push_back(first);
+			}
+			else if (isSecondHit)
+			{
+				stack.push_back(second);
+			}
+		}
+
+		if (closestHit.Triangle == InvalidTriangle)
+		{
+			return false;
+		}
+
+		hit = closestHit;
+		return true;
+	}
+
+	bool MeshBvh::IntersectPacket(const TrianglePacket& packet, const XMVECTOR* rayLanes, Hit& hit)
+	{
+		// Moller-Trumbore for four triangles at once; lanes are one triangle each
+		XMVECTOR originX = rayLanes[0];
+		XMVECTOR originY = rayLanes[1];
+		XMVECTOR originZ = rayLanes[2];
+		XMVECTOR directionX = rayLanes[3];
+		XMVECTOR directionY = rayLanes[4];
+		XMVECTOR directionZ = rayLanes[5];
+
+		XMVECTOR edge1X = XMLoadFloat4(&packet.Edge1[0]);
+		XMVECTOR edge1Y = XMLoadFloat4(&packet.Edge1[1]);
+		XMVECTOR edge1Z = XMLoadFloat4(&packet.Edge1[2]);
+		XMVECTOR edge2X = XMLoadFloat4(&packet.Edge2[0]);
+		XMVECTOR edge2Y = XMLoadFloat4(&packet.Edge2[1]);
+		XMVECTOR edge2Z = XMLoadFloat4(&packet.Edge2[2]);
+
+		XMVECTOR pX = XMVectorSubtract(XMVectorMultiply(directionY, edge2Z), XMVectorMultiply(directionZ, edge2Y));
+		XMVECTOR pY = XMVectorSubtract(XMVectorMultiply(directionZ, edge2X), XMVectorMultiply(directionX, edge2Z));
+		XMVECTOR pZ = XMVectorSubtract(XMVectorMultiply(directionX, edge2Y), XMVectorMultiply(directionY, edge2X));
+
+		XMVECTOR determinant = XMVectorMultiplyAdd(edge1X, pX, XMVectorMultiplyAdd(edge1Y, pY, XMVectorMultiply(edge1Z, pZ)));
+		XMVECTOR inverseDeterminant = XMVectorReciprocal(determinant);
+
+		XMVECTOR tX = XMVectorSubtract(originX, XMLoadFloat4(&packet.Vertex0[0]));
+		XMVECTOR tY = XMVectorSubtract(originY, XMLoadFloat4(&packet.Vertex0[1]));
+		XMVECTOR tZ = XMVectorSubtract(originZ, XMLoadFloat4(&packet.Vertex0[2]));
+
+		XMVECTOR u = XMVectorMultiply(XMVectorMultiplyAdd(tX, pX, XMVectorMultiplyAdd(tY, pY, XMVectorMultiply(tZ, pZ))), inverseDeterminant);
+
+		XMVECTOR qX = XMVectorSubtract(XMVectorMultiply(tY, edge1Z), XMVectorMultiply(tZ, edge1Y));
+		XMVECTOR qY = XMVectorSubtract(XMVectorMultiply(tZ, edge1X), XMVectorMultiply(tX, edge1Z));
+		XMVECTOR qZ = XMVectorSubtract(XMVectorMultiply(tX, edge1Y), XMVectorMultiply(tY, edge1X));
+
+		XMVECTOR v = XMVectorMultiply(XMVectorMultiplyAdd(directionX, qX, XMVectorMultiplyAdd(directionY, qY, XMVectorMultiply(directionZ, qZ))), inverseDeterminant);
+		XMVECTOR t = XMVectorMultiply(XMVectorMultiplyAdd(edge2X, qX, XMVectorMultiplyAdd(edge2Y, qY, XMVectorMultiply(edge2Z, qZ))), inverseDeterminant);
+
+		XMVECTOR zero = XMVectorZero();
+		XMVECTOR isHit = XMVectorGreater(XMVectorAbs(determinant), XMVectorReplicate(1e-12f));
+		isHit = XMVectorAndInt(isHit, XMVectorGreaterOrEqual(u, zero));
+		isHit = XMVectorAndInt(isHit, XMVectorGreaterOrEqual(v, zero));
+		isHit = XMVectorAndInt(isHit, XMVectorLessOrEqual(XMVectorAdd(u, v), XMVectorSplatOne()));
+		isHit = XMVectorAndInt(isHit, XMVectorGreater(t, zero));
+		isHit = XMVectorAndInt(isHit, XMVectorLess(t, XMVectorReplicate(hit.Distance)));
+
+		XMUINT4 hitLanes;
+		XMStoreUInt4(&hitLanes, isHit);
+		const UINT* hitMasks = reinterpret_cast<const UINT*>(&hitLanes);
+		if ((hitLanes.x | hitLanes.y | hitLanes.z | hitLanes.w) == 0)
+		{
+			return false;
+		}
+
+		XMFLOAT4 distances;
+		XMFLOAT4 us;
+		XMFLOAT4 vs;
+		XMStoreFloat4(&distances, t);
+		XMStoreFloat4(&us, u);
+		XMStoreFloat4(&vs, v);
+
+		for (UINT lane = 0; lane < MaxLeafSize; lane++)
+		{
+			float distance = reinterpret_cast<const float*>(&distances)[lane];
+			if (hitMasks[lane] != 0 && distance < hit.Distance)
+			{
+				hit.Distance = distance;
+				hit.Triangle = packet.Triangles[lane];
+				hit.U = reinterpret_cast<const float*>(&us)[lane];
+				hit.V = reinterpret_cast<const float*>(&vs)[lane];
+			}
+		}
+
+		return true;
+	}
+
+	UINT MeshBvh::BinIndex(float centroid, float minimum, float scale)
+	{
+		UINT index = static_cast<UINT>((centroid - minimum) * scale);
+
+		return (std::min)(index, BinCount - 1);
+	}
+
+	bool MeshBvh::IntersectBox(const AxisAlignedBox& box, const XMFLOAT3& origin, const XMFLOAT3& inverseDirection, float maxDistance, float& distance)
+	{
+		float entryX = (box.Minimum.x - origin.x) * inverseDirection.x;
+		float exitX = (box.Maximum.x - origin.x) * inverseDirection.x;
+		float entryY = (box.Minimum.y - origin.y) * inverseDirection.y;
+		float exitY = (box.Maximum.y - origin.y) * inverseDirection.y;
+		float entryZ = (box.Minimum.z - origin.z) * inverseDirection.z;
+		float exitZ = (box.Maximum.z - origin.z) * inverseDirection.z;
+
+		float nearest = (std::max)((std::max)((std::min)(entryX, exitX), (std::min)(entryY, exitY)), (std::max)((std::min)(entryZ, exitZ), 0.0f));
+		float farthest = (std::min)((std::min)((std::max)(entryX, exitX), (std::max)(entryY, exitY)), (std::min)((std::max)(entryZ, exitZ), maxDistance));
+
+		distance = nearest;
+		return (nearest <= farthest);
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Common.h"
+#include "AxisAlignedBox.h"
+#include "Mesh.h"
+#include "MemoryArena.h"
+
+namespace Library
+{
+	class Ray;
+
+	// A bounding volume hierarchy over the triangles of a mesh, in model space, for ray queries such as picking.
+	// The tree is built top-down with a binned surface area heuristic; binning of large nodes is spread across worker threads.
+	// Each leaf holds at most four triangles, stored as one structure-of-arrays packet, so a leaf is tested against a ray
+	// with a single four-wide Moller-Trumbore pass. The finished nodes and packets are copied into the given arena at their
+	// exact size; only the build's scratch data uses the heap.
+	// The tree is a snapshot of the vertices it was built from. For a skinned or morphed mesh that is the bind pose, so
+	// hits are only meaningful while the mesh is drawn undeformed.
+	// Intersect is const and may be called from any number of threads at once. Trace updates the statistics, so it must not
+	// overlap another Trace or ResetCounters; it spreads its own rays across worker threads.
+	class MeshBvh
+	{
+	public:
+		struct Hit
+		{
+			float Distance;		// In multiples of the ray direction
+			UINT Triangle;		// Index of the triangle's first index divided by three
+			float U;			// Barycentric weights of the second and third vertices
+			float V;
+
+			Hit()
+				: Distance(0.0f), Triangle(InvalidTriangle), U(0.0f), V(0.0f) { }
+		};
+
+		struct Statistics
+		{
+			UINT TriangleCount;
+			UINT NodeCount;
+			UINT LeafCount;
+			UINT Depth;
+			double BuildMilliseconds;
+			UINT RayCount;			// Rays traced through Trace
+			UINT HitCount;
+			double TraceMilliseconds;
+
+			Statistics()
+				: TriangleCount(0), NodeCount(0), LeafCount(0), Depth(0), BuildMilliseconds(0.0), RayCount(0), HitCount(0), TraceMilliseconds(0.0) { }
+		};
+
+		static const UINT InvalidTriangle;
+
+		MeshBvh(const std::vector<XMFLOAT3>& vertices, const std::vector<UINT>& indices, MemoryArena& arena);
+
+		bool Intersect(const Ray& ray, float maxDistance, Hit& hit) const;
+		UINT Trace(const std::vector<Ray>& rays, float maxDistance, std::vector<Hit>& hits);
+
+		AxisAlignedBox Bounds() const;
+		const Statistics& GetStatistics() const;
+		void ResetCounters();
+
+	private:
+		MeshBvh();
+		MeshBvh(const MeshBvh& rhs);
+		MeshBvh& operator=(const MeshBvh& rhs);
+
+		static const UINT MaxLeafSize = 4;
+		static const UINT BinCount = 16;
+		static const UINT ParallelBinningThreshold;
+		static const UINT MinimumTrianglesPerWorker;
+		static const UINT MinimumRaysPerWorker;
+
+		struct Node
+		{
+			AxisAlignedBox Box;
+			UINT Offset;		// First child for interior nodes (the second follows it); packet index for leaves
+			UINT Count;			// Triangles in the leaf; zero for interior nodes
+		};
+
+		struct TrianglePacket
+		{
+			XMFLOAT4 Vertex0[3];	// Each XMFLOAT4 holds one coordinate of all four triangles
+			XMFLOAT4 Edge1[3];
+			XMFLOAT4 Edge2[3];
+			UINT Triangles[MaxLeafSize];
+		};
+
+		struct StackEntry
+		{
+			UINT Node;
+			float Distance;		// Where the ray enters the node's box
+		};
+
+		struct Bin
+		{
+			AxisAlignedBox Bounds;
+			UINT Count;
+
+			Bin()
+				: Bounds(), Count(0) { }
+		};
+
+		void Build(const std::vector<XMFLOAT3>& vertices, const std::vector<UINT>& indices);
+		void ComputeBounds(UINT begin, UINT end, AxisAlignedBox& bounds, AxisAlignedBox& centroidBounds) const;
+		void ComputeBins(UINT begin, UINT end, const AxisAlignedBox& centroidBounds, Bin (&bins)[3][BinCount]) const;
+		bool FindSplit(UINT begin, UINT end, const AxisAlignedBox& centroidBounds, UINT& splitAxis, UINT& splitBin) const;
+		void CreateLeaf(Node& node, UINT begin, UINT end, const std::vector<XMFLOAT3>& vertices, const std::vector<UINT>& indices);
+		bool Intersect(const Ray& ray, float maxDistance, Hit& hit, std::vector<StackEntry>& stack) const;
+		static bool IntersectPacket(const TrianglePacket& packet, const XMVECTOR* rayLanes, Hit& hit);
+
+		static UINT BinIndex(float centroid, float minimum, float scale);
+		static bool IntersectBox(const AxisAlignedBox& box, const XMFLOAT3& origin, const XMFLOAT3& inverseDirection, float maxDistance, float& distance);
+
+		typedef std::vector<Node, ArenaAllocator<Node>> NodeCollection;
+		typedef std::vector<TrianglePacket, ArenaAllocator<TrianglePacket>> PacketCollection;
+
+		NodeCollection mNodes;
+		PacketCollection mPackets;
+		std::vector<Node> mBuildNodes;						// Build-time only
+		std::vector<TrianglePacket> mBuildPackets;			// Build-time only
+		std::vector<AxisAlignedBox> mTriangleBounds;		// Build-time only
+		std::vector<XMFLOAT3> mTriangleCentroids;			// Build-time only
+		std::vector<UINT> mTriangleOrder;					// Build-time only
+		Statistics mStatistics;
+	};
+}
@@ -4,8 +4,12 @@
 #include "Mesh.h"
 #include "ModelMaterial.h"
 #include "AnimationClip.h"
+#include "AnimationLibrary.h"
+#include "Skeleton.h"
 #include "Bone.h"
-#include "MatrixHelper.h"
+#include "MorphTarget.h"
+#include "MemoryArena.h"
+#include "MemoryTracker.h"
 #include "Importer.hpp"
 #include "scene.h"
 #include "postprocess.h"
@@ -13,8 +17,66 @@
 namespace Library
 {
 	Model::Model(Game& game, const std::string& filename, bool flipUVs)
-		: mGame(game), mMeshes(), mMaterials(), mAnimations(), mBones(), mBoneIndexMapping(), mRootNode(nullptr)
+		: mGame(game), mArena(new MemoryArena()), mMeshes(), mMaterials(), mSkeleton(), mAnimationLibrary(), mOwnsSkeleton(true), mOwnsAnimationLibrary(true), mLoadStatistics()
 	{
+		mSkeleton = std::shared_ptr<Skeleton>(new Skeleton());
+		mAnimationLibrary = std::shared_ptr<AnimationLibrary>(new AnimationLibrary(mSkeleton));
+		Load(filename, flipUVs);
+	}
+
+	Model::Model(Game& game, const aiScene& scene, const std::string& name)
+		: mGame(game), mArena(new MemoryArena()), mMeshes(), mMaterials(), mSkeleton(), mAnimationLibrary(), mOwnsSkeleton(true), mOwnsAnimationLibrary(true), mLoadStatistics()
+	{
+		mSkeleton = std::shared_ptr<Skeleton>(new Skeleton());
+		mAnimationLibrary = std::shared_ptr<AnimationLibrary>(new AnimationLibrary(mSkeleton));
+		Build(scene, name);
+	}
+
+	Model::Model(Game& game, const std::string& filename, std::shared_ptr<Skeleton> skeleton, std::shared_ptr<AnimationLibrary> animationLibrary, bool flipUVs)
+		: mGame(game), mArena(new MemoryArena()), mMeshes(), mMaterials(), mSkeleton(skeleton), mAnimationLibrary(animationLibrary),
+		mOwnsSkeleton(skeleton == nullptr), mOwnsAnimationLibrary(animationLibrary == nullptr), mLoadStatistics()
+	{
+		if (mSkeleton == nullptr)
+		{
+			if (mAnimationLibrary != nullptr)
+			{
+				mSkeleton = mAnimationLibrary->GetSkeleton();
+				mOwnsSkeleton = false;
+			}
+			else
+			{
+				mSkeleton = std::shared_ptr<Skeleton>(new Skeleton());
+			}
+		}
+
+		if (mAnimationLibrary == nullptr)
+		{
+			mAnimationLibrary = std::shared_ptr<AnimationLibrary>(new AnimationLibrary(mSkeleton));
+		}
+		else if (mAnimationLibrary->GetSkeleton() != mSkeleton)
+		{
+			throw GameException("Animation library is bound to a different skeleton.");
+		}
+
+		Load(filename, flipUVs);
+	}
+
+	Model::~Model()
+	{
+		for (Mesh* mesh : mMeshes)
+		{
+			delete mesh;
+		}
+
+		for (ModelMaterial* material : mMaterials)
+		{
+			delete material;
+		}
+	}
+
+	void Model::Load(const std::string& filename, bool flipUVs)
+	{
+		MemoryScope memoryScope(MemorySubsystemModels);
 		Assimp::Importer importer;
 
 		UINT flags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType | aiProcess_FlipWindingOrder;
@@ -23,79 +85,85 @@ namespace Library
 			flags |= aiProcess_FlipUVs;
 		}
 
+		UINT startAllocationCount = MemoryTracker::ThreadAllocationCount();
 		const aiScene* scene = importer.ReadFile(filename, flags);
 		if (scene == nullptr)
 		{
 			throw GameException(importer.GetErrorString());
 		}
 
-		if (scene->HasMaterials())
+		mLoadStatistics.ImportAllocationCount = MemoryTracker::ThreadAllocationCount() - startAllocationCount;
+		Build(*scene, filename);
+	}
+
+	void Model::Build(const aiScene& scene, const std::string& name)
+	{
+		MemoryScope memoryScope(MemorySubsystemModels);
+		UINT startAllocationCount = MemoryTracker::ThreadAllocationCount();
+
+		mArena->Reserve(EstimateArenaSize(scene));
+		if (mOwnsSkeleton)
 		{
-			for (UINT i = 0; i < scene->mNumMaterials; i++)
-			{
-				mMaterials.push_back(new ModelMaterial(*this, scene->mMaterials[i]));
-			}
+			mSkeleton->mArena->Reserve(Skeleton::EstimateArenaSize(scene));
 		}
 
-		if (scene->HasMeshes())
+		if (scene.HasMaterials())
 		{
-			for (UINT i = 0; i < scene->mNumMeshes; i++)
+			for (UINT i = 0; i < scene.mNumMaterials; i++)
 			{
-				Mesh* mesh = new Mesh(*this, *(scene->mMeshes[i]));
-				mMeshes.push_back(mesh);
+				mMaterials.push_back(new ModelMaterial(*this, scene.mMaterials[i]));
 			}
 		}
 
-		if (scene->HasAnimations())
+		if (scene.HasMeshes())
 		{
-			assert(scene->mRootNode != nullptr);
-			mRootNode = BuildSkeleton(*scene->mRootNode, nullptr);
-
-			mAnimations.reserve(scene->mNumAnimations);
-			for (UINT i = 0; i < scene->mNumAnimations; i++)
+			for (UINT i = 0; i < scene.mNumMeshes; i++)
 			{
-				AnimationClip* animationClip = new AnimationClip(*this, *(scene->mAnimations[i]));
-				mAnimations.push_back(animationClip);
-				mAnimationsByName.insert(std::pair<std::string, AnimationClip*>(animationClip->Name(), animationClip));
+				Mesh* mesh = new Mesh(*this, *(scene.mMeshes[i]));
+				mMeshes.push_back(mesh);
 			}
 		}
 
-#if defined( DEBUG ) || defined( _DEBUG )
-		ValidateModel();
-#endif
-	}
-
-	Model::~Model()
-	{
-		for (Mesh* mesh : mMeshes)
+		// A shared skeleton already carries its hierarchy; only build one for a skeleton this model populated
+		if (mOwnsSkeleton && (scene.HasAnimations() || mSkeleton->BoneCount() > 0))
 		{
-			delete mesh;
+			assert(scene.mRootNode != nullptr);
+			mSkeleton->BuildHierarchy(*scene.mRootNode);
 		}
 
-		for (ModelMaterial* material : mMaterials)
+		// Clips embedded in the file are skipped when the caller supplies a library; they are already decoded there
+		if (mOwnsAnimationLibrary && scene.HasAnimations())
 		{
-			delete material;
+			mAnimationLibrary->AddClips(scene);
 		}
 
-		for (AnimationClip* animation : mAnimations)
+		mLoadStatistics.HeapAllocationCount = MemoryTracker::ThreadAllocationCount() - startAllocationCount;
+
+		std::vector<const MemoryArena*> arenas(1, mArena.get());
+		if (mOwnsSkeleton)
 		{
-			delete animation;
+			arenas.push_back(mSkeleton->mArena.get());
 		}
 
-		if (mRootNode != nullptr)
+		if (mOwnsAnimationLibrary)
 		{
-			DeleteSceneNode(mRootNode);
+			arenas.push_back(mAnimationLibrary->mArena.get());
 		}
-	}
 
-	void Model::DeleteSceneNode(SceneNode* sceneNode)
-	{
-		for (SceneNode* childNode : sceneNode->Children())
+		for (const MemoryArena* arena : arenas)
 		{
-			DeleteSceneNode(childNode);
+			mLoadStatistics.ArenaAllocationCount += arena->GetStatistics().AllocationCount;
+			mLoadStatistics.ArenaBytesAllocated += arena->GetStatistics().BytesAllocated;
 		}
 
-		DeleteObject(sceneNode);
+#if defined( DEBUG ) || defined( _DEBUG )
+		ValidateModel();
+
+		wchar_t message[256];
+		swprintf_s(message, L"Model %S: %u heap allocations to build (%u more in the importer), %u arena allocations totalling %Iu bytes.\n",
+			name.c_str(), mLoadStatistics.HeapAllocationCount, mLoadStatistics.ImportAllocationCount, mLoadStatistics.ArenaAllocationCount, mLoadStatistics.ArenaBytesAllocated);
+		OutputDebugString(message);
+#endif
 	}
 
 	Game& Model::GetGame()
@@ -115,7 +183,7 @@ namespace Library
 
 	bool Model::HasAnimations() const
 	{
-		return (mAnimations.size() > 0);
+		return mAnimationLibrary->HasClips();
 	}
 
 	const std::vector<Mesh*>& Model::Meshes() const
@@ -130,54 +198,67 @@ namespace Library
 
 	const std::vector<AnimationClip*>& Model::Animations() const
 	{
-		return mAnimations;
+		return mAnimationLibrary->Clips();
 	}
 
 	const std::map<std::string, AnimationClip*>& Model::AnimationsbyName() const
 	{
-		return mAnimationsByName;
+		return mAnimationLibrary->ClipsByName();
 	}
 
-	const std::vector<Bone*> Model::Bones() const
+	const std::vector<Bone*>& Model::Bones() const
 	{
-		return mBones;
+		return mSkeleton->Bones();
 	}
 
-	const std::map<std::string, UINT> Model::BoneIndexMapping() const
+	const std::map<std::string, UINT>& Model::BoneIndexMapping() const
 	{
-		return mBoneIndexMapping;
+		return mSkeleton->BoneIndexMapping();
 	}
 
 	SceneNode* Model::RootNode()
 	{
-		return mRootNode;
+		return mSkeleton->RootNode();
 	}
 
-	SceneNode* Model::BuildSkeleton(aiNode& node, SceneNode* parentSceneNode)
+	std::shared_ptr<Skeleton> Model::GetSkeleton() const
 	{
-		SceneNode* sceneNode = nullptr;
+		return mSkeleton;
+	}
 
-		auto boneMapping = mBoneIndexMapping.find(node.mName.C_Str());
-		if (boneMapping == mBoneIndexMapping.end())
-		{
-			sceneNode = new SceneNode(node.mName.C_Str());
-		}
-		else
-		{
-			sceneNode = mBones[boneMapping->second];
-		}
+	std::shared_ptr<AnimationLibrary> Model::GetAnimationLibrary() const
+	{
+		return mAnimationLibrary;
+	}
 
-		XMMATRIX transform = XMLoadFloat4x4(&(XMFLOAT4X4(reinterpret_cast<const float*>(node.mTransformation[0]))));
-		sceneNode->SetTransform(XMMatrixTranspose(transform));
-		sceneNode->SetParent(parentSceneNode);
+	MemoryArena& Model::GetArena() const
+	{
+		return *mArena;
+	}
+
+	const Model::LoadStatistics& Model::GetLoadStatistics() const
+	{
+		return mLoadStatistics;
+	}
 
-		for (UINT i = 0; i < node.mNumChildren; i++)
+	size_t Model::EstimateArenaSize(const aiScene& scene)
+	{
+		// Vertex data lives in the meshes' own vectors; only the channel lists and morph targets come from the arena
+		size_t size = 0;
+
+		for (UINT i = 0; i < scene.mNumMeshes; i++)
 		{
-			SceneNode* childSceneNode = BuildSkeleton(*(node.mChildren[i]), sceneNode);
-			sceneNode->Children().push_back(childSceneNode);
+			const aiMesh& mesh = *(scene.mMeshes[i]);
+			size += mesh.GetNumUVChannels() * sizeof(std::vector<XMFLOAT3>);
+			size += mesh.GetNumColorChannels() * sizeof(std::vector<XMFLOAT4>);
+
+			// Morph deltas are sparse and their size is only known once decoded; they spill into further blocks
+			size += mesh.mNumAnimMeshes * sizeof(MorphTarget);
 		}
 
-		return sceneNode;
+		size += scene.mNumMaterials * TextureTypeEnd * sizeof(std::vector<std::wstring>);
+
+		return size;
 	}
 
 	void Model::ValidateModel()
@@ -185,15 +266,16 @@ namespace Library
 		// Validate bone weights
 		for (Mesh* mesh : mMeshes)
 		{
-			for (BoneVertexWeights boneWeight : mesh->mBoneWeights)
+			for (const BoneVertexWeights& boneWeight : mesh->mBoneWeights)
 			{
 				float totalWeight = 0.0f;
 
-				for (BoneVertexWeights::VertexWeight vertexWeight : boneWeight.Weights())
+				for (UINT i = 0; i < boneWeight.WeightCount(); i++)
 				{
+					const BoneVertexWeights::VertexWeight& vertexWeight = boneWeight.WeightAt(i);
 					totalWeight += vertexWeight.Weight;
 					assert(vertexWeight.BoneIndex >= 0);
-					assert(vertexWeight.BoneIndex < mBones.size());
+					assert(vertexWeight.BoneIndex < mSkeleton->BoneCount());
 				}
 
 				assert(totalWeight <= 1.05f);
@@ -2,7 +2,7 @@
 
 #include "Common.h"
 
-struct aiNode;
+struct aiScene;
 
 namespace Library
 {
@@ -12,13 +12,37 @@ namespace Library
 	class AnimationClip;
 	class SceneNode;
 	class Bone;
+	class Skeleton;
+	class AnimationLibrary;
+	class MemoryArena;
 
+	// The small objects a model imports (morph targets, per-channel lists and material texture lists) are allocated from
+	// the model's arena, which is reserved up front from the scene's contents and released with the model. A skeleton or
+	// clip library the model creates has an arena of its own, so sharing it with other models never pins this one.
 	class Model
 	{
 		friend class Mesh;
+		friend class ModelMaterial;
 
 	public:
+		struct LoadStatistics
+		{
+			UINT ImportAllocationCount;		// Heap allocations made by the importer while reading the file
+			UINT HeapAllocationCount;		// Heap allocations made building the model from the imported scene
+			UINT ArenaAllocationCount;		// Summed over the model's arena and those of the skeleton and clip library it owns
+			size_t ArenaBytesAllocated;
+
+			LoadStatistics()
+				: ImportAllocationCount(0), HeapAllocationCount(0), ArenaAllocationCount(0), ArenaBytesAllocated(0) { }
+		};
+
 		Model(Game& game, const std::string& filename, bool flipUVs = false);
+		Model(Game& game, const std::string& filename, std::shared_ptr<Skeleton> skeleton, std::shared_ptr<AnimationLibrary> animationLibrary, bool flipUVs = false);
+
+		// Builds the model from a scene already in memory, such as one generated rather than read from a file; the scene is
+		// only read during construction and stays owned by the caller
+		Model(Game& game, const aiScene& scene, const std::string& name);
+
 		~Model();
 
 		Game& GetGame();
@@ -30,25 +54,36 @@ namespace Library
 		const std::vector<ModelMaterial*>& Materials() const;
 		const std::vector<AnimationClip*>& Animations() const;
 		const std::map<std::string, AnimationClip*>& AnimationsbyName() const;
-		const std::vector<Bone*> Bones() const;
-		const std::map<std::string, UINT> BoneIndexMapping() const;
+		const std::vector<Bone*>& Bones() const;
+		const std::map<std::string, UINT>& BoneIndexMapping() const;
 		SceneNode* RootNode();
 
+		std::shared_ptr<Skeleton> GetSkeleton() const;
+		std::shared_ptr<AnimationLibrary> GetAnimationLibrary() const;
+		MemoryArena& GetArena() const;
+
+		// Heap allocation counts come from the memory tracker and are zero when it is compiled out; they cover only the
+		// loading thread, so work the load hands to other threads is not included
+		const LoadStatistics& GetLoadStatistics() const;
+
 	private:
 		Model(const Model& rhs);
 		Model& operator=(const Model& rhs);
 
-		SceneNode* BuildSkeleton(aiNode& node, SceneNode* parentSceneNode);
+		void Load(const std::string& filename, bool flipUVs);
+		void Build(const aiScene& scene, const std::string& name);
 		void ValidateModel();
-		void DeleteSceneNode(SceneNode* sceneNode);
+
+		static size_t EstimateArenaSize(const aiScene& scene);
 
 		Game& mGame;
+		std::unique_ptr<MemoryArena> mArena;
 		std::vector<Mesh*> mMeshes;
 		std::vector<ModelMaterial*> mMaterials;
-		std::vector<AnimationClip*> mAnimations;
-		std::map<std::string, AnimationClip*> mAnimationsByName;
-		std::vector<Bone*> mBones;
-		std::map<std::string, UINT> mBoneIndexMapping;
-		SceneNode* mRootNode;
+		std::shared_ptr<Skeleton> mSkeleton;
+		std::shared_ptr<AnimationLibrary> mAnimationLibrary;
+		bool mOwnsSkeleton;
+		bool mOwnsAnimationLibrary;
+		LoadStatistics mLoadStatistics;
 	};
 }
@@ -0,0 +1,281 @@
+#include "ModelCache.h"
+#include "Model.h"
+#include "GameException.h"
+#include "Utility.h"
+#include <algorithm>
+#include <cctype>
+
+namespace Library
+{
+	ModelCache::ModelCache(Game& game, JobSystem& jobSystem)
+		: mGame(game), mJobSystem(jobSystem), mEntries(), mStatistics()
+	{
+	}
+
+	ModelCache::~ModelCache()
+	{
+		Clear();
+	}
+
+	std::shared_ptr<Model> ModelCache::Load(const std::string& filename, bool flipUVs)
+	{
+		Key key = MakeKey(filename, flipUVs);
+		Entry* entry = FindEntry(key);
+
+		if (entry != nullptr)
+		{
+			if (entry->LoadedModel != nullptr)
+			{
+				mStatistics.Hits++;
+				return entry->LoadedModel;
+			}
+
+			// Block on the import already in flight rather than starting a second one
+			mStatistics.CollapsedLoads++;
+			if (entry->IsPending)
+			{
+				mJobSystem.Wait(entry->Remaining);
+			}
+
+			if (entry->IsPending && CompleteLoad(*entry))
+			{
+				return entry->LoadedModel;
+			}
+
+			// Callers of LoadAsync still waiting on the same import hear about the failure at the next Update
+			std::string error = entry->Error;
+			if (entry->Callbacks.empty())
+			{
+				RemoveEntry(key);
+			}
+
+			throw GameException(error.c_str());
+		}
+
+		mStatistics.Misses++;
+		std::shared_ptr<Model> model(new Model(mGame, key.first, flipUVs));
+
+		entry = new Entry();
+		entry->LoadedModel = model;
+		mEntries.insert(std::pair<Key, Entry*>(key, entry));
+		mStatistics.ModelCount++;
+
+		return model;
+	}
+
+	void ModelCache::LoadAsync(const std::string& filename, bool flipUVs, LoadCallback callback)
+	{
+		Key key = MakeKey(filename, flipUVs);
+		Entry* entry = FindEntry(key);
+
+		if (entry != nullptr)
+		{
+			if (entry->LoadedModel == nullptr)
+			{
+				mStatistics.CollapsedLoads++;
+			}
+			else
+			{
+				mStatistics.Hits++;
+			}
+		}
+		else
+		{
+			mStatistics.Misses++;
+
+			entry = new Entry();
+			mEntries.insert(std::pair<Key, Entry*>(key, entry));
+
+			// The key holds the absolute path, so the import is unaffected by later changes to the working directory. Jobs
+			// must not throw, so the job keeps the reason an import failed for CompleteLoad.
+			Game* game = &mGame;
+			std::string path = key.first;
+			entry->IsPending = true;
+			mJobSystem.Run([game, path, flipUVs, entry]()
+			{
+				try
+				{
+					entry->ImportedModel = std::shared_ptr<Model>(new Model(*game, path, flipUVs));
+				}
+				catch (const std::exception& exception)
+				{
+					entry->Error = exception.what();
+				}
+				catch (...)
+				{
+				}
+			}, entry->Remaining);
+
+			mStatistics.PendingCount++;
+		}
+
+		// Callbacks for models that are already loaded still wait for the next Update, so they always run at the same point in the frame
+		if (callback != nullptr)
+		{
+			entry->Callbacks.push_back(callback);
+		}
+	}
+
+	bool ModelCache::IsLoaded(const std::string& filename, bool flipUVs) const
+	{
+		return (Find(filename, flipUVs) != nullptr);
+	}
+
+	std::shared_ptr<Model> ModelCache::Find(const std::string& filename, bool flipUVs) const
+	{
+		Entry* entry = FindEntry(MakeKey(filename, flipUVs));
+
+		return (entry != nullptr ? entry->LoadedModel : nullptr);
+	}
+
+	void ModelCache::Update()
+	{
+		struct ReadyCallback
+		{
+			LoadCallback Callback;
+			std::shared_ptr<Model> LoadedModel;
+			std::string Error;
+		};
+
+		std::vector<ReadyCallback> readyCallbacks;
+		std::vector<Key> failedKeys;
+
+		for (auto& keyAndEntry : mEntries)
+		{
+			Entry& entry = *(keyAndEntry.second);
+
+			if (entry.IsPending)
+			{
+				if (entry.Remaining > 0)
+				{
+					continue;
+				}
+
+				CompleteLoad(entry);
+			}
+
+			for (LoadCallback& callback : entry.Callbacks)
+			{
+				ReadyCallback readyCallback = { callback, entry.LoadedModel, entry.Error };
+				readyCallbacks.push_back(readyCallback);
+			}
+
+			entry.Callbacks.clear();
+
+			if (entry.LoadedModel == nullptr)
+			{
+				failedKeys.push_back(keyAndEntry.first);
+			}
+		}
+
+		for (const Key& key : failedKeys)
+		{
+			RemoveEntry(key);
+		}
+
+		// Callbacks run after the walk so they are free to load, trim or clear
+		for (ReadyCallback& readyCallback : readyCallbacks)
+		{
+			readyCallback.Callback(readyCallback.LoadedModel, readyCallback.Error);
+		}
+	}
+
+	void ModelCache::Trim()
+	{
+		for (auto keyAndEntry = mEntries.begin(); keyAndEntry != mEntries.end();)
+		{
+			Entry* entry = keyAndEntry->second;
+
+			if (entry->LoadedModel != nullptr && entry->LoadedModel.use_count() == 1 && entry->Callbacks.empty())
+			{
+				delete entry;
+				keyAndEntry = mEntries.erase(keyAndEntry);
+				mStatistics.ModelCount--;
+			}
+			else
+			{
+				++keyAndEntry;
+			}
+		}
+	}
+
+	void ModelCache::Clear()
+	{
+		for (auto& keyAndEntry : mEntries)
+		{
+			Entry* entry = keyAndEntry.second;
+			mJobSystem.Wait(entry->Remaining);
+
+			delete entry;
+		}
+
+		mEntries.clear();
+		mStatistics.ModelCount = 0;
+		mStatistics.PendingCount = 0;
+	}
+
+	const ModelCache::Statistics& ModelCache::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	ModelCache::Key ModelCache::MakeKey(const std::string& filename, bool flipUVs)
+	{
+		std::string path;
+		Utility::GetFullPath(filename, path);
+		std::transform(path.begin(), path.end(), path.begin(), ::tolower);
+
+		return Key(path, flipUVs);
+	}
+
+	ModelCache::Entry* ModelCache::FindEntry(const Key& key) const
+	{
+		auto foundEntry = mEntries.find(key);
+
+		return (foundEntry != mEntries.end() ? foundEntry->second : nullptr);
+	}
+
+	bool ModelCache::CompleteLoad(Entry& entry)
+	{
+		assert(entry.IsPending && entry.Remaining == 0);
+
+		mStatistics.PendingCount--;
+		entry.IsPending = false;
+		entry.LoadedModel = entry.ImportedModel;
+		entry.ImportedModel = nullptr;
+
+		if (entry.LoadedModel == nullptr)
+		{
+			if (entry.Error.empty())
+			{
+				entry.Error = "Model import failed.";
+			}
+
+			mStatistics.FailedLoads++;
+
+#if defined( DEBUG ) || defined( _DEBUG )
+			OutputDebugString(Utility::ToWideString("Model import failed: " + entry.Error + "\n").c_str());
+#endif
+			return false;
+		}
+
+		mStatistics.ModelCount++;
+
+		return true;
+	}
+
+	void ModelCache::RemoveEntry(const Key& key)
+	{
+		auto foundEntry = mEntries.find(key);
+		if (foundEntry != mEntries.end())
+		{
+			if (foundEntry->second->LoadedModel != nullptr)
+			{
+				mStatistics.ModelCount--;
+			}
+
+			delete foundEntry->second;
+			mEntries.erase(foundEntry);
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Common.h"
+#include "JobSystem.h"
+#include <functional>
+
+namespace Library
+{
+	class Game;
+	class Model;
+
+	// Models shared by every component that loads the same file with the same import flags. Files are keyed by their
+	// normalized absolute path, so requests made from different working directories or with different casing collapse
+	// into a single import. Imports run as jobs on the JobSystem; completion callbacks are dispatched from Update on the main
+	// thread.
+	// The cache holds a reference to every model it has loaded until Trim or Clear releases the ones no one else is using.
+	// A failed asynchronous import is reported to its callbacks rather than thrown from Update, then forgotten, so a later
+	// request retries it.
+	class ModelCache
+	{
+	public:
+		// Receives the model and an empty string, or a null model and the reason the import failed
+		typedef std::function<void(std::shared_ptr<Model> model, const std::string& error)> LoadCallback;
+
+		struct Statistics
+		{
+			UINT ModelCount;
+			UINT PendingCount;
+			UINT Hits;
+			UINT Misses;
+			UINT CollapsedLoads;	// Requests that joined an import already in flight
+			UINT FailedLoads;
+
+			Statistics()
+				: ModelCount(0), PendingCount(0), Hits(0), Misses(0), CollapsedLoads(0), FailedLoads(0) { }
+		};
+
+		ModelCache(Game& game, JobSystem& jobSystem);
+		~ModelCache();
+
+		std::shared_ptr<Model> Load(const std::string& filename, bool flipUVs = false);
+		void LoadAsync(const std::string& filename, bool flipUVs = false, LoadCallback callback = nullptr);
+
+		bool IsLoaded(const std::string& filename, bool flipUVs = false) const;
+		std::shared_ptr<Model> Find(const std::string& filename, bool flipUVs = false) const;
+
+		void Update();
+		void Trim();
+		void Clear();
+
+		const Statistics& GetStatistics() const;
+
+	private:
+		typedef std::pair<std::string, bool> Key;
+
+		struct Entry
+		{
+			std::shared_ptr<Model> LoadedModel;
+			std::shared_ptr<Model> ImportedModel;	// Written by the import job; read once Remaining reaches zero
+			JobSystem::Counter Remaining;
+			bool IsPending;
+			std::vector<LoadCallback> Callbacks;
+			std::string Error;		// Set when the import failed; the entry lives until Update has told its callbacks
+
+			Entry()
+				: LoadedModel(), ImportedModel(), Remaining(0), IsPending(false), Callbacks(), Error() { }
+		};
+
+		ModelCache();
+		ModelCache(const ModelCache& rhs);
+		ModelCache& operator=(const ModelCache& rhs);
+
+		static Key MakeKey(const std::string& filename, bool flipUVs);
+		Entry* FindEntry(const Key& key) const;
+		bool CompleteLoad(Entry& entry);
+		void RemoveEntry(const Key& key);
+
+		Game& mGame;
+		JobSystem& mJobSystem;
+		std::map<Key, Entry*> mEntries;
+		Statistics mStatistics;
+	};
+}
@@ -1,4 +1,6 @@
 #include "ModelMaterial.h"
+#include "Model.h"
+#include "MemoryArena.h"
 #include "GameException.h"
 #include "Utility.h"
 #include "scene.h"
@@ -6,6 +8,7 @@
 namespace Library
 {
 	std::map<TextureType, UINT> ModelMaterial::sTextureTypeMappings;
+	std::once_flag ModelMaterial::sTextureTypeMappingsInitialized;
 
 	ModelMaterial::ModelMaterial(Model& model)
 		: mModel(model), mTextures()
@@ -29,7 +32,7 @@ namespace Library
 			UINT textureCount = material->GetTextureCount(mappedTextureType);
 			if (textureCount > 0)
 			{
-				std::vector<std::wstring>* textures = new std::vector<std::wstring>();
+				std::vector<std::wstring>* textures = mModel.mArena->Create<std::vector<std::wstring>>();
 				mTextures.insert(std::pair<TextureType, std::vector<std::wstring>*>(textureType, textures));
 
 				textures->reserve(textureCount);
@@ -50,10 +53,7 @@ namespace Library
 
 	ModelMaterial::~ModelMaterial()
 	{
-		for (std::pair<TextureType, std::vector<std::wstring>*> textures : mTextures)
-		{
-			DeleteObject(textures.second);
-		}
+		// Texture lists are destroyed with the model's arena
 	}
 
 	Model& ModelMaterial::GetModel()
@@ -73,7 +73,7 @@ namespace Library
 
 	void ModelMaterial::InitializeTextureTypeMappings()
 	{
-		if (sTextureTypeMappings.size() != TextureTypeEnd)
+		std::call_once(sTextureTypeMappingsInitialized, []()
 		{
 			sTextureTypeMappings[TextureTypeDifffuse] = aiTextureType_DIFFUSE;
 			sTextureTypeMappings[TextureTypeSpecularMap] = aiTextureType_SPECULAR;
@@ -83,6 +83,6 @@ namespace Library
 			sTextureTypeMappings[TextureTypeSpecularPowerMap] = aiTextureType_SHININESS;
 			sTextureTypeMappings[TextureTypeDisplacementMap] = aiTextureType_DISPLACEMENT;
 			sTextureTypeMappings[TextureTypeLightMap] = aiTextureType_LIGHTMAP;
-		}
+		});
 	}
 }
\ No newline at end of file
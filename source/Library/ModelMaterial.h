@@ -1,11 +1,14 @@
 #pragma once
 
 #include "Common.h"
+#include <mutex>
 
 struct aiMaterial;
 
 namespace Library
 {
+	class Model;
+
 	enum TextureType
 	{
 		TextureTypeDifffuse = 0,
@@ -35,6 +38,7 @@ namespace Library
 	private:
 		static void InitializeTextureTypeMappings();
 		static std::map<TextureType, UINT> sTextureTypeMappings;
+		static std::once_flag sTextureTypeMappingsInitialized;	// Models may be imported on several threads at once
 
 		ModelMaterial(Model& model, aiMaterial* material);
 		ModelMaterial(const ModelMaterial& rhs);
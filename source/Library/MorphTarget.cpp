@@ -0,0 +1,108 @@
+#include "MorphTarget.h"
+#include "GameException.h"
+#include "scene.h"
+
+namespace Library
+{
+	const float MorphTarget::DeltaEpsilon = 1e-6f;
+
+	MorphTarget::MorphTarget(UINT index, aiMesh& mesh, aiAnimMesh& animMesh, MemoryArena& arena)
+		: mIndex(index), mVertexIndices(ArenaAllocator<UINT>(arena)), mPositionDeltas(ArenaAllocator<XMFLOAT3>(arena)), mNormalDeltas(ArenaAllocator<XMFLOAT3>(arena))
+	{
+		if (animMesh.mNumVertices != mesh.mNumVertices)
+		{
+			throw GameException("Morph target vertex count does not match its mesh.");
+		}
+
+		bool hasNormals = animMesh.HasNormals() && mesh.HasNormals();
+		XMVECTOR positionDelta;
+		XMVECTOR normalDelta;
+
+		// Count the moved vertices first so the arena-backed arrays are allocated once, at their final size
+		UINT deltaCount = 0;
+		for (UINT i = 0; i < mesh.mNumVertices; i++)
+		{
+			if (TryGetDeltas(mesh, animMesh, i, positionDelta, normalDelta))
+			{
+				deltaCount++;
+			}
+		}
+
+		mVertexIndices.reserve(deltaCount);
+		mPositionDeltas.reserve(deltaCount);
+		if (hasNormals)
+		{
+			mNormalDeltas.reserve(deltaCount);
+		}
+
+		for (UINT i = 0; i < mesh.mNumVertices; i++)
+		{
+			if (TryGetDeltas(mesh, animMesh, i, positionDelta, normalDelta) == false)
+			{
+				continue;
+			}
+
+			XMFLOAT3 delta;
+			mVertexIndices.push_back(i);
+
+			XMStoreFloat3(&delta, positionDelta);
+			mPositionDeltas.push_back(delta);
+
+			if (hasNormals)
+			{
+				XMStoreFloat3(&delta, normalDelta);
+				mNormalDeltas.push_back(delta);
+			}
+		}
+	}
+
+	bool MorphTarget::TryGetDeltas(const aiMesh& mesh, const aiAnimMesh& animMesh, UINT vertexIndex, XMVECTOR& positionDelta, XMVECTOR& normalDelta)
+	{
+		// Assimp stores complete replacement attributes; only vertices that differ from the base mesh are kept
+		positionDelta = XMVectorZero();
+		if (animMesh.HasPositions())
+		{
+			positionDelta = XMVectorSubtract(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&animMesh.mVertices[vertexIndex])), XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&mesh.mVertices[vertexIndex])));
+		}
+
+		normalDelta = XMVectorZero();
+		if (animMesh.HasNormals() && mesh.HasNormals())
+		{
+			normalDelta = XMVectorSubtract(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&animMesh.mNormals[vertexIndex])), XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&mesh.mNormals[vertexIndex])));
+		}
+
+		XMVECTOR epsilon = XMVectorReplicate(DeltaEpsilon);
+
+		return (XMVector3NearEqual(positionDelta, XMVectorZero(), epsilon) == false || XMVector3NearEqual(normalDelta, XMVectorZero(), epsilon) == false);
+	}
+
+	UINT MorphTarget::Index() const
+	{
+		return mIndex;
+	}
+
+	UINT MorphTarget::DeltaCount() const
+	{
+		return mVertexIndices.size();
+	}
+
+	bool MorphTarget::HasNormalDeltas() const
+	{
+		return (mNormalDeltas.size() > 0);
+	}
+
+	const MorphTarget::IndexCollection& MorphTarget::VertexIndices() const
+	{
+		return mVertexIndices;
+	}
+
+	const MorphTarget::DeltaCollection& MorphTarget::PositionDeltas() const
+	{
+		return mPositionDeltas;
+	}
+
+	const MorphTarget::DeltaCollection& MorphTarget::NormalDeltas() const
+	{
+		return mNormalDeltas;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Common.h"
+#include "MemoryArena.h"
+
+struct aiMesh;
+struct aiAnimMesh;
+
+namespace Library
+{
+	// A blend shape stored as sparse deltas from the base mesh. Only vertices the shape actually moves are kept,
+	// so applying it costs time proportional to the size of the shape rather than the size of the mesh.
+	class MorphTarget
+	{
+		friend class Mesh;
+		friend class MemoryArena;
+
+	public:
+		typedef std::vector<UINT, ArenaAllocator<UINT>> IndexCollection;
+		typedef std::vector<XMFLOAT3, ArenaAllocator<XMFLOAT3>> DeltaCollection;
+
+		UINT Index() const;
+		UINT DeltaCount() const;
+		bool HasNormalDeltas() const;
+
+		const IndexCollection& VertexIndices() const;
+		const DeltaCollection& PositionDeltas() const;
+		const DeltaCollection& NormalDeltas() const;
+
+	private:
+		MorphTarget(UINT index, aiMesh& mesh, aiAnimMesh& animMesh, MemoryArena& arena);
+
+		MorphTarget();
+		MorphTarget(const MorphTarget& rhs);
+		MorphTarget& operator=(const MorphTarget& rhs);
+
+		static bool TryGetDeltas(const aiMesh& mesh, const aiAnimMesh& animMesh, UINT vertexIndex, XMVECTOR& positionDelta, XMVECTOR& normalDelta);
+
+		static const float DeltaEpsilon;
+
+		UINT mIndex;
+		IndexCollection mVertexIndices;
+		DeltaCollection mPositionDeltas;
+		DeltaCollection mNormalDeltas;		// Parallel to mVertexIndices; empty when the shape has no normals
+	};
+}
@@ -0,0 +1,156 @@
+#include "MorphTargetBlender.h"
+#include "MorphTarget.h"
+#include "Mesh.h"
+#include "Parallel.h"
+
+namespace Library
+{
+	const UINT MorphTargetBlender::MinimumDeltasPerWorker = 2048;
+
+	MorphTargetBlender::MorphTargetBlender(const Mesh& mesh)
+		: mMesh(&mesh), mWeights(mesh.MorphTargets().size(), 0.0f), mAppliedTargets(), mPositions(mesh.Vertices().begin(), mesh.Vertices().end()), mNormals(mesh.Normals().begin(), mesh.Normals().end()),
+		mIsDirty(false), mStatistics()
+	{
+		mStatistics.VertexCount = mPositions.size();
+	}
+
+	const Mesh& MorphTargetBlender::GetMesh() const
+	{
+		return *mMesh;
+	}
+
+	UINT MorphTargetBlender::TargetCount() const
+	{
+		return mWeights.size();
+	}
+
+	float MorphTargetBlender::Weight(UINT targetIndex) const
+	{
+		return mWeights.at(targetIndex);
+	}
+
+	void MorphTargetBlender::SetWeight(UINT targetIndex, float weight)
+	{
+		if (mWeights.at(targetIndex) != weight)
+		{
+			mWeights[targetIndex] = weight;
+			mIsDirty = true;
+		}
+	}
+
+	const std::vector<XMFLOAT3>& MorphTargetBlender::Positions() const
+	{
+		return mPositions;
+	}
+
+	const std::vector<XMFLOAT3>& MorphTargetBlender::Normals() const
+	{
+		return mNormals;
+	}
+
+	bool MorphTargetBlender::Apply()
+	{
+		if (mIsDirty == false)
+		{
+			return false;
+		}
+
+		const std::vector<MorphTarget*>& targets = mMesh->MorphTargets();
+
+		mStatistics.ActiveTargetCount = 0;
+		mStatistics.RestoredVertexCount = 0;
+		mStatistics.AppliedDeltaCount = 0;
+
+		for (UINT targetIndex : mAppliedTargets)
+		{
+			Restore(*targets[targetIndex]);
+		}
+
+		// Targets are accumulated one after another; vertex indices are unique within a target, so its deltas split across workers without contention
+		mAppliedTargets.clear();
+		for (UINT i = 0; i < targets.size(); i++)
+		{
+			if (mWeights[i] != 0.0f)
+			{
+				Accumulate(*targets[i], mWeights[i]);
+				mAppliedTargets.push_back(i);
+			}
+		}
+
+		mStatistics.ActiveTargetCount = mAppliedTargets.size();
+		mIsDirty = false;
+
+		return true;
+	}
+
+	const MorphTargetBlender::Statistics& MorphTargetBlender::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void MorphTargetBlender::Restore(const MorphTarget& target)
+	{
+		if (target.DeltaCount() == 0)
+		{
+			return;
+		}
+
+		const UINT* vertexIndices = &target.VertexIndices()[0];
+		const XMFLOAT3* baseVertices = &mMesh->Vertices()[0];
+		const XMFLOAT3* baseNormals = (target.HasNormalDeltas() ? &mMesh->Normals()[0] : nullptr);
+		XMFLOAT3* positions = &mPositions[0];
+		XMFLOAT3* normals = (target.HasNormalDeltas() ? &mNormals[0] : nullptr);
+
+		Parallel::For(0, target.DeltaCount(), MinimumDeltasPerWorker, [=](UINT begin, UINT end)
+		{
+			for (UINT i = begin; i < end; i++)
+			{
+				UINT vertexIndex = vertexIndices[i];
+				positions[vertexIndex] = baseVertices[vertexIndex];
+
+				if (normals != nullptr)
+				{
+					normals[vertexIndex] = baseNormals[vertexIndex];
+				}
+			}
+		});
+
+		mStatistics.RestoredVertexCount += target.DeltaCount();
+	}
+
+	void MorphTargetBlender::Accumulate(const MorphTarget& target, float weight)
+	{
+		if (target.DeltaCount() == 0)
+		{
+			return;
+		}
+
+		const UINT* vertexIndices = &target.VertexIndices()[0];
+		const XMFLOAT3* positionDeltas = &target.PositionDeltas()[0];
+		const XMFLOAT3* normalDeltas = (target.HasNormalDeltas() ? &target.NormalDeltas()[0] : nullptr);
+		XMFLOAT3* positions = &mPositions[0];
+		XMFLOAT3* normals = (target.HasNormalDeltas() ? &mNormals[0] : nullptr);
+
+		Parallel::For(0, target.DeltaCount(), MinimumDeltasPerWorker, [=](UINT begin, UINT end)
+		{
+			XMVECTOR weightVector = XMVectorReplicate(weight);
+
+			for (UINT i = begin; i < end; i++)
+			{
+				UINT vertexIndex = vertexIndices[i];
+
+				XMVECTOR position = XMVectorMultiplyAdd(XMLoadFloat3(&positionDeltas[i]), weightVector, XMLoadFloat3(&positions[vertexIndex]));
+				XMStoreFloat3(&positions[vertexIndex], position);
+
+				if (normals != nullptr)
+				{
+					// Blended normals are not renormalized here; shaders normalize interpolated normals already
+					XMVECTOR normal = XMVectorMultiplyAdd(XMLoadFloat3(&normalDeltas[i]), weightVector, XMLoadFloat3(&normals[vertexIndex]));
+					XMStoreFloat3(&normals[vertexIndex], normal);
+				}
+			}
+		});
+
+		mStatistics.AppliedDeltaCount += target.DeltaCount();
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	class Mesh;
+	class MorphTarget;
+
+	// Blends a mesh's morph targets into CPU-side position and normal streams. Each Apply first restores the vertices
+	// touched by the previous blend, then adds the weighted deltas of every active target, so the cost follows the
+	// number and size of active targets and never the vertex count of the mesh.
+	class MorphTargetBlender
+	{
+	public:
+		struct Statistics
+		{
+			UINT ActiveTargetCount;
+			UINT RestoredVertexCount;
+			UINT AppliedDeltaCount;
+			UINT VertexCount;
+
+			Statistics()
+				: ActiveTargetCount(0), RestoredVertexCount(0), AppliedDeltaCount(0), VertexCount(0) { }
+		};
+
+		MorphTargetBlender(const Mesh& mesh);
+
+		const Mesh& GetMesh() const;
+		UINT TargetCount() const;
+		float Weight(UINT targetIndex) const;
+		void SetWeight(UINT targetIndex, float weight);
+
+		const std::vector<XMFLOAT3>& Positions() const;
+		const std::vector<XMFLOAT3>& Normals() const;
+
+		bool Apply();
+		const Statistics& GetStatistics() const;
+
+	private:
+		MorphTargetBlender();
+		MorphTargetBlender(const MorphTargetBlender& rhs);
+		MorphTargetBlender& operator=(const MorphTargetBlender& rhs);
+
+		void Restore(const MorphTarget& target);
+		void Accumulate(const MorphTarget& target, float weight);
+
+		static const UINT MinimumDeltasPerWorker;
+
+		const Mesh* mMesh;
+		std::vector<float> mWeights;
+		std::vector<UINT> mAppliedTargets;
+		std::vector<XMFLOAT3> mPositions;
+		std::vector<XMFLOAT3> mNormals;
+		bool mIsDirty;
+		Statistics mStatistics;
+	};
+}
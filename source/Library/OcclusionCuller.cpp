@@ -0,0 +1,497 @@
+#include "OcclusionCuller.h"
+#include "ClockSource.h"
+#include "AxisAlignedBox.h"
+#include "Mesh.h"
+#include "MatrixHelper.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Library
+{
+	const UINT OcclusionCuller::DefaultWidth = 256;
+	const UINT OcclusionCuller::DefaultHeight = 128;
+	const UINT OcclusionCuller::MinimumWordsPerWorker = 4;
+
+	OcclusionCuller::OcclusionCuller(UINT width, UINT height)
+		: mWidth(0), mHeight(0), mTileColumns((std::max)((width + TileSize - 1) / TileSize, 1U)), mTileRows((std::max)((height + TileSize - 1) / TileSize, 1U)),
+		  mViewProjection(MatrixHelper::Identity), mClipVertices(), mTriangles(), mBins(), mLevels(), mStatistics()
+	{
+		mWidth = mTileColumns * TileSize;
+		mHeight = mTileRows * TileSize;
+		mBins.resize(mTileColumns * mTileRows);
+
+		// Every level down to a single texel; the first TileLevelCount halvings stay exact because the buffer is whole tiles
+		UINT levelWidth = mWidth;
+		UINT levelHeight = mHeight;
+		while (true)
+		{
+			Level level;
+			level.Width = levelWidth;
+			level.Height = levelHeight;
+			level.Depths.assign(levelWidth * levelHeight, 1.0f);
+			mLevels.push_back(level);
+
+			if (levelWidth == 1 && levelHeight == 1)
+			{
+				break;
+			}
+
+			levelWidth = (levelWidth + 1) / 2;
+			levelHeight = (levelHeight + 1) / 2;
+		}
+	}
+
+	UINT OcclusionCuller::Width() const
+	{
+		return mWidth;
+	}
+
+	UINT OcclusionCuller::Height() const
+	{
+		return mHeight;
+	}
+
+	void OcclusionCuller::BeginFrame(CXMMATRIX viewProjection)
+	{
+		XMStoreFloat4x4(&mViewProjection, viewProjection);
+		mTriangles.clear();
+	}
+
+	void OcclusionCuller::AddOccluder(const XMFLOAT3* vertices, UINT vertexCount, const UINT* indices, UINT indexCount, CXMMATRIX world)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		XMMATRIX worldViewProjection = XMMatrixMultiply(world, XMLoadFloat4x4(&mViewProjection));
+
+		mClipVertices.resize(vertexCount);
+		for (UINT i = 0; i < vertexCount; i++)
+		{
+			XMStoreFloat4(&mClipVertices[i], XMVector3Transform(XMLoadFloat3(&vertices[i]), worldViewProjection));
+		}
+
+		UINT triangleCount = indexCount / 3;
+		for (UINT i = 0; i < triangleCount; i++)
+		{
+			ScreenTriangle triangle;
+			if (SetupTriangle(mClipVertices[indices[i * 3]], mClipVertices[indices[i * 3 + 1]], mClipVertices[indices[i * 3 + 2]], triangle))
+			{
+				mTriangles.push_back(triangle);
+			}
+		}
+
+		mStatistics.OccluderTriangleCount += triangleCount;
+		mStatistics.RasterizeMilliseconds += RealClockSource::Milliseconds() - startTime;
+	}
+
+	void OcclusionCuller::AddOccluder(const Mesh& mesh, CXMMATRIX world)
+	{
+		if (mesh.Vertices().size() > 0 && mesh.Indices().size() > 0)
+		{
+			AddOccluder(&mesh.Vertices()[0], mesh.Vertices().size(), &mesh.Indices()[0], mesh.Indices().size(), world);
+		}
+	}
+
+	void OcclusionCuller::Rasterize()
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		for (std::vector<UINT>& bin : mBins)
+		{
+			bin.clear();
+		}
+
+		for (UINT i = 0; i < mTriangles.size(); i++)
+		{
+			const ScreenTriangle& triangle = mTriangles[i];
+			for (UINT row = triangle.MinY / TileSize; row <= triangle.MaxY / TileSize; row++)
+			{
+				for (UINT column = triangle.MinX / TileSize; column <= triangle.MaxX / TileSize; column++)
+				{
+					mBins[row * mTileColumns + column].push_back(i);
+				}
+			}
+		}
+
+		// Tiles own disjoint pixels and pyramid texels up to TileLevelCount, so they need no synchronization
+		Parallel::For(0, mBins.size(), 1, [&](UINT begin, UINT end)
+		{
+			for (UINT tile = begin; tile < end; tile++)
+			{
+				RasterizeTile(tile);
+			}
+		});
+
+		for (UINT level = TileLevelCount + 1; level < mLevels.size(); level++)
+		{
+			ReduceLevel(level, 0, 0, mLevels[level].Width, mLevels[level].Height);
+		}
+
+		mStatistics.RasterizedTriangleCount += mTriangles.size();
+		mStatistics.RasterizeMilliseconds += RealClockSource::Milliseconds() - startTime;
+	}
+
+	bool OcclusionCuller::IsOccluded(const AxisAlignedBox& box) const
+	{
+		return IsOccluded(XMLoadFloat4x4(&mViewProjection), box.Minimum, box.Maximum);
+	}
+
+	UINT OcclusionCuller::Cull(const FrustumCuller::BoxArray& boxes, std::vector<UINT>& visibilityMask)
+	{
+		double startTime = RealClockSource::Milliseconds();
+
+		UINT count = boxes.Count();
+		UINT wordCount = (count + 31) / 32;
+		if (visibilityMask.empty() && count > 0)
+		{
+			visibilityMask.assign(wordCount, UINT_MAX);
+			if ((count & 31) != 0)
+			{
+				visibilityMask.back() = (1U << (count & 31)) - 1;
+			}
+		}
+
+		// Each range owns whole mask words, so bits are cleared without contention and counted per word
+		std::vector<UINT> testedCounts(wordCount, 0);
+		std::vector<UINT> occludedCounts(wordCount, 0);
+		Parallel::For(0, wordCount, MinimumWordsPerWorker, [&](UINT begin, UINT end)
+		{
+			XMMATRIX viewProjection = XMLoadFloat4x4(&mViewProjection);
+
+			for (UINT word = begin; word < end; word++)
+			{
+				UINT visible = visibilityMask[word];
+				for (UINT bit = 0; visible != 0; bit++, visible >>= 1)
+				{
+					if ((visible & 1) == 0)
+					{
+						continue;
+					}
+
+					UINT index = word * 32 + bit;
+					XMFLOAT3 minimum(boxes.MinimumX[index], boxes.MinimumY[index], boxes.MinimumZ[index]);
+					XMFLOAT3 maximum(boxes.MaximumX[index], boxes.MaximumY[index], boxes.MaximumZ[index]);
+
+					testedCounts[word]++;
+					if (IsOccluded(viewProjection, minimum, maximum))
+					{
+						visibilityMask[word] &= ~(1U << bit);
+						occludedCounts[word]++;
+					}
+				}
+			}
+		});
+
+		UINT occludedCount = 0;
+		for (UINT word = 0; word < wordCount; word++)
+		{
+			mStatistics.TestedCount += testedCounts[word];
+			occludedCount += occludedCounts[word];
+		}
+
+		mStatistics.OccludedCount += occludedCount;
+		mStatistics.TestMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		return occludedCount;
+	}
+
+	const std::vector<float>& OcclusionCuller::DepthBuffer() const
+	{
+		return mLevels[0].Depths;
+	}
+
+	const OcclusionCuller::Statistics& OcclusionCuller::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void OcclusionCuller::ResetStatistics()
+	{
+		mStatistics = Statistics();
+	}
+
+	void OcclusionCuller::Validate() const
+	{
+#if defined( DEBUG ) || defined( _DEBUG )
+		static const float Tolerance = 1e-5f;
+
+		// Pixel centers and edge functions are evaluated as RasterizeTile does, over the same whole quads
+		std::vector<float> reference(mWidth * mHeight, 1.0f);
+		for (const ScreenTriangle& triangle : mTriangles)
+		{
+			int maximumX = (std::min)(triangle.MaxX | 3, static_cast<int>(mWidth) - 1);
+			for (int y = triangle.MinY; y <= triangle.MaxY; y++)
+			{
+				float centerY = y + 0.5f;
+				for (int x = triangle.MinX & ~3; x <= maximumX; x++)
+				{
+					float centerX = x + 0.5f;
+
+					bool isInside = true;
+					for (UINT i = 0; i < 3; i++)
+					{
+						isInside = (isInside && centerX * triangle.EdgeA[i] + (triangle.EdgeB[i] * centerY + triangle.EdgeC[i]) >= 0.0f);
+					}
+
+					if (isInside)
+					{
+						float& depth = reference[y * mWidth + x];
+						depth = (std::min)(depth, centerX * triangle.DepthA + (triangle.DepthB * centerY + triangle.DepthC));
+					}
+				}
+			}
+		}
+
+		const std::vector<float>& depths = mLevels[0].Depths;
+		for (UINT i = 0; i < reference.size(); i++)
+		{
+			assert(std::fabs(depths[i] - reference[i]) <= Tolerance);
+		}
+
+		for (UINT level = 1; level < mLevels.size(); level++)
+		{
+			const Level& source = mLevels[level - 1];
+			const Level& destination = mLevels[level];
+
+			for (UINT y = 0; y < destination.Height; y++)
+			{
+				UINT bottom = (std::min)(y * 2 + 1, source.Height - 1);
+				for (UINT x = 0; x < destination.Width; x++)
+				{
+					UINT right = (std::min)(x * 2 + 1, source.Width - 1);
+					float farthest = (std::max)((std::max)(source.Depths[y * 2 * source.Width + x * 2], source.Depths[y * 2 * source.Width + right]),
+						(std::max)(source.Depths[bottom * source.Width + x * 2], source.Depths[bottom * source.Width + right]));
+					assert(destination.Depths[y * destination.Width + x] == farthest);
+				}
+			}
+		}
+#endif
+	}
+
+	bool OcclusionCuller::SetupTriangle(const XMFLOAT4& clip0, const XMFLOAT4& clip1, const XMFLOAT4& clip2, ScreenTriangle& triangle) const
+	{
+		const XMFLOAT4* clips[] = { &clip0, &clip1, &clip2 };
+		float x[3];
+		float y[3];
+		float z[3];
+
+		for (UINT i = 0; i < 3; i++)
+		{
+			const XMFLOAT4& clip = *clips[i];
+			if (clip.z < 0.0f || clip.w <= 0.0f)
+			{
+				return false;
+			}
+
+			x[i] = (clip.x / clip.w * 0.5f + 0.5f) * mWidth;
+			y[i] = (0.5f - clip.y / clip.w * 0.5f) * mHeight;
+			z[i] = clip.z / clip.w;
+		}
+
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+		if (std::fabs(area) < 1e-6f)
+		{
+			return false;
+		}
+
+		// Winding is ignored; swapping two vertices makes the edge functions of either orientation positive inside
+		if (area < 0.0f)
+		{
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+			std::swap(z[1], z[2]);
+			area = -area;
+		}
+
+		float minimumX = (std::min)((std::min)(x[0], x[1]), x[2]);
+		float maximumX = (std::max)((std::max)(x[0], x[1]), x[2]);
+		float minimumY = (std::min)((std::min)(y[0], y[1]), y[2]);
+		float maximumY = (std::max)((std::max)(y[0], y[1]), y[2]);
+		if (maximumX < 0.0f || maximumY < 0.0f || minimumX >= mWidth || minimumY >= mHeight)
+		{
+			return false;
+		}
+
+		triangle.MinX = static_cast<int>((std::max)(minimumX, 0.0f));
+		triangle.MinY = static_cast<int>((std::max)(minimumY, 0.0f));
+		triangle.MaxX = static_cast<int>((std::min)(maximumX, mWidth - 1.0f));
+		triangle.MaxY = static_cast<int>((std::min)(maximumY, mHeight - 1.0f));
+
+		for (UINT i = 0; i < 3; i++)
+		{
+			UINT next = (i + 1) % 3;
+			triangle.EdgeA[i] = y[i] - y[next];
+			triangle.EdgeB[i] = x[next] - x[i];
+			triangle.EdgeC[i] = -(triangle.EdgeA[i] * x[i] + triangle.EdgeB[i] * y[i]);
+		}
+
+		triangle.DepthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+		triangle.DepthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+		triangle.DepthC = z[0] - triangle.DepthA * x[0] - triangle.DepthB * y[0];
+
+		return true;
+	}
+
+	void OcclusionCuller::RasterizeTile(UINT tile)
+	{
+		int tileX = (tile % mTileColumns) * TileSize;
+		int tileY = (tile / mTileColumns) * TileSize;
+		std::vector<float>& depths = mLevels[0].Depths;
+
+		for (int y = tileY; y < tileY + static_cast<int>(TileSize); y++)
+		{
+			std::fill_n(&depths[y * mWidth + tileX], TileSize, 1.0f);
+		}
+
+		XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+		XMVECTOR zero = XMVectorZero();
+
+		for (UINT index : mBins[tile])
+		{
+			const ScreenTriangle& triangle = mTriangles[index];
+
+			// Rows start on a four-pixel boundary so each group is one aligned quad of the tile
+			int minimumX = (std::max)(triangle.MinX, tileX) & ~3;
+			int maximumX = (std::min)(triangle.MaxX, tileX + static_cast<int>(TileSize) - 1);
+			int minimumY = (std::max)(triangle.MinY, tileY);
+			int maximumY = (std::min)(triangle.MaxY, tileY + static_cast<int>(TileSize) - 1);
+
+			XMVECTOR edgeA[3];
+			for (UINT i = 0; i < 3; i++)
+			{
+				edgeA[i] = XMVectorReplicate(triangle.EdgeA[i]);
+			}
+
+			XMVECTOR depthA = XMVectorReplicate(triangle.DepthA);
+
+			for (int y = minimumY; y <= maximumY; y++)
+			{
+				float centerY = y + 0.5f;
+				XMVECTOR rowEdge0 = XMVectorReplicate(triangle.EdgeB[0] * centerY + triangle.EdgeC[0]);
+				XMVECTOR rowEdge1 = XMVectorReplicate(triangle.EdgeB[1] * centerY + triangle.EdgeC[1]);
+				XMVECTOR rowEdge2 = XMVectorReplicate(triangle.EdgeB[2] * centerY + triangle.EdgeC[2]);
+				XMVECTOR rowDepth = XMVectorReplicate(triangle.DepthB * centerY + triangle.DepthC);
+				float* row = &depths[y * mWidth];
+
+				for (int x = minimumX; x <= maximumX; x += 4)
+				{
+					XMVECTOR centerX = XMVectorAdd(XMVectorReplicate(static_cast<float>(x)), laneOffsets);
+
+					XMVECTOR inside = XMVectorGreaterOrEqual(XMVectorMultiplyAdd(centerX, edgeA[0], rowEdge0), zero);
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(centerX, edgeA[1], rowEdge1), zero));
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(centerX, edgeA[2], rowEdge2), zero));
+					if (LaneMask(inside) == 0)
+					{
+						continue;
+					}
+
+					XMFLOAT4* pixels = reinterpret_cast<XMFLOAT4*>(row + x);
+					XMVECTOR current = XMLoadFloat4(pixels);
+					XMVECTOR depth = XMVectorMultiplyAdd(centerX, depthA, rowDepth);
+					XMStoreFloat4(pixels, XMVectorSelect(current, XMVectorMin(current, depth), inside));
+				}
+			}
+		}
+
+		for (UINT level = 1; level <= TileLevelCount && level < mLevels.size(); level++)
+		{
+			ReduceLevel(level, tileX >> level, tileY >> level, (tileX + TileSize) >> level, (tileY + TileSize) >> level);
+		}
+	}
+
+	void OcclusionCuller::ReduceLevel(UINT level, UINT beginX, UINT beginY, UINT endX, UINT endY)
+	{
+		const Level& source = mLevels[level - 1];
+		Level& destination = mLevels[level];
+
+		for (UINT y = beginY; y < endY; y++)
+		{
+			// Odd source dimensions repeat their last row or column
+			const float* top = &source.Depths[(y * 2) * source.Width];
+			const float* bottom = &source.Depths[(std::min)(y * 2 + 1, source.Height - 1) * source.Width];
+			float* texels = &destination.Depths[y * destination.Width];
+
+			for (UINT x = beginX; x < endX; x++)
+			{
+				UINT left = x * 2;
+				UINT right = (std::min)(left + 1, source.Width - 1);
+				texels[x] = (std::max)((std::max)(top[left], top[right]), (std::max)(bottom[left], bottom[right]));
+			}
+		}
+	}
+
+	bool OcclusionCuller::IsOccluded(FXMMATRIX viewProjection, const XMFLOAT3& minimum, const XMFLOAT3& maximum) const
+	{
+		XMVECTOR nearestCorner = XMVectorReplicate(FLT_MAX);
+		XMVECTOR farthestCorner = XMVectorReplicate(-FLT_MAX);
+
+		for (UINT i = 0; i < 8; i++)
+		{
+			XMVECTOR corner = XMVectorSet((i & 1) ? maximum.x : minimum.x, (i & 2) ? maximum.y : minimum.y, (i & 4) ? maximum.z : minimum.z, 1.0f);
+			XMVECTOR clip = XMVector4Transform(corner, viewProjection);
+			if (XMVectorGetZ(clip) < 0.0f || XMVectorGetW(clip) <= 0.0f)
+			{
+				return false;
+			}
+
+			XMVECTOR projected = XMVectorDivide(clip, XMVectorSplatW(clip));
+			nearestCorner = XMVectorMin(nearestCorner, projected);
+			farthestCorner = XMVectorMax(farthestCorner, projected);
+		}
+
+		XMFLOAT3 lower;
+		XMFLOAT3 upper;
+		XMStoreFloat3(&lower, nearestCorner);
+		XMStoreFloat3(&upper, farthestCorner);
+
+		// Screen y runs downward, so the top of the rectangle comes from the largest projected y
+		float left = (lower.x * 0.5f + 0.5f) * mWidth;
+		float right = (upper.x * 0.5f + 0.5f) * mWidth;
+		float top = (0.5f - upper.y * 0.5f) * mHeight;
+		float bottom = (0.5f - lower.y * 0.5f) * mHeight;
+		if (right < 0.0f || bottom < 0.0f || left >= mWidth || top >= mHeight)
+		{
+			// Off screen; that is the frustum's decision to make
+			return false;
+		}
+
+		UINT minimumX = static_cast<UINT>((std::max)(left, 0.0f));
+		UINT minimumY = static_cast<UINT>((std::max)(top, 0.0f));
+		UINT maximumX = static_cast<UINT>((std::min)(right, mWidth - 1.0f));
+		UINT maximumY = static_cast<UINT>((std::min)(bottom, mHeight - 1.0f));
+
+		UINT level = 0;
+		while ((maximumX >> level) - (minimumX >> level) >= MaxTestSpan || (maximumY >> level) - (minimumY >> level) >= MaxTestSpan)
+		{
+			level++;
+		}
+
+		const Level& texels = mLevels[level];
+		float nearestDepth = lower.z;
+		for (UINT y = minimumY >> level; y <= maximumY >> level; y++)
+		{
+			for (UINT x = minimumX >> level; x <= maximumX >> level; x++)
+			{
+				if (texels.Depths[y * texels.Width + x] >= nearestDepth)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	UINT OcclusionCuller::LaneMask(FXMVECTOR lanes)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		return static_cast<UINT>(_mm_movemask_ps(lanes));
+#else
+		XMUINT4 values;
+		XMStoreUInt4(&values, lanes);
+
+		return ((values.x & 1) | ((values.y & 1) << 1) | ((values.z & 1) << 2) | ((values.w & 1) << 3));
+#endif
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Common.h"
+#include "FrustumCuller.h"
+
+namespace Library
+{
+	struct AxisAlignedBox;
+	class Mesh;
+
+	// Software occlusion culling against a small depth buffer. Occluder triangles are transformed and set up as they are
+	// added, then binned into screen tiles that are rasterized on worker threads, four pixels at a time with the edge
+	// functions evaluated in one register. Each pixel keeps the nearest occluder depth, and a pyramid of farthest depths is
+	// built over the buffer so a bounding box is compared against a few coarse texels covering its screen rectangle.
+	// A box is occluded when its nearest point lies behind every one of those texels. Occluder triangles crossing the near
+	// plane are skipped rather than clipped and boxes crossing it are never occluded, so both shortcuts err towards drawing.
+	class OcclusionCuller
+	{
+	public:
+		struct Statistics
+		{
+			UINT OccluderTriangleCount;
+			UINT RasterizedTriangleCount;	// Left after near-plane, degenerate and off-screen rejection
+			UINT TestedCount;
+			UINT OccludedCount;
+			double RasterizeMilliseconds;	// Includes triangle setup in AddOccluder
+			double TestMilliseconds;
+
+			Statistics()
+				: OccluderTriangleCount(0), RasterizedTriangleCount(0), TestedCount(0), OccludedCount(0), RasterizeMilliseconds(0.0), TestMilliseconds(0.0) { }
+		};
+
+		static const UINT DefaultWidth;
+		static const UINT DefaultHeight;
+
+		// The buffer is rounded up to whole tiles
+		OcclusionCuller(UINT width = DefaultWidth, UINT height = DefaultHeight);
+
+		UINT Width() const;
+		UINT Height() const;
+
+		void BeginFrame(CXMMATRIX viewProjection);
+		void AddOccluder(const XMFLOAT3* vertices, UINT vertexCount, const UINT* indices, UINT indexCount, CXMMATRIX world);
+		void AddOccluder(const Mesh& mesh, CXMMATRIX world);
+		void Rasterize();
+
+		bool IsOccluded(const AxisAlignedBox& box) const;
+
+		// Tests the boxes whose bits are set, typically by FrustumCuller::Cull, and clears the bits of those found occluded.
+		// An empty mask is treated as every box visible. Returns the number of boxes occluded.
+		UINT Cull(const FrustumCuller::BoxArray& boxes, std::vector<UINT>& visibilityMask);
+
+		// Row-major nearest occluder depth per pixel; pixels no occluder covers hold 1
+		const std::vector<float>& DepthBuffer() const;
+
+		const Statistics& GetStatistics() const;
+		void ResetStatistics();
+
+		// Compares the depth buffer from the last Rasterize against a plain per-pixel rasterization of the same triangles, and
+		// every pyramid texel against the farthest of the texels below it. Checks only in debug builds, and is slow.
+		void Validate() const;
+
+	private:
+		OcclusionCuller(const OcclusionCuller& rhs);
+		OcclusionCuller& operator=(const OcclusionCuller& rhs);
+
+		static const UINT TileSize = 32;
+		static const UINT TileLevelCount = 5;		// Pyramid levels that stay within one tile, log2(TileSize)
+		static const UINT MaxTestSpan = 4;			// Texels per axis compared against one box
+		static const UINT MinimumWordsPerWorker;
+
+		struct ScreenTriangle
+		{
+			float EdgeA[3];		// Edge functions A * x + B * y + C, non-negative inside the triangle
+			float EdgeB[3];
+			float EdgeC[3];
+			float DepthA;		// Depth plane over pixel coordinates
+			float DepthB;
+			float DepthC;
+			int MinX;			// Pixel bounds, clipped to the buffer
+			int MinY;
+			int MaxX;
+			int MaxY;
+		};
+
+		struct Level
+		{
+			UINT Width;
+			UINT Height;
+			std::vector<float> Depths;
+		};
+
+		bool SetupTriangle(const XMFLOAT4& clip0, const XMFLOAT4& clip1, const XMFLOAT4& clip2, ScreenTriangle& triangle) const;
+		void RasterizeTile(UINT tile);
+		void ReduceLevel(UINT level, UINT beginX, UINT beginY, UINT endX, UINT endY);
+		bool IsOccluded(FXMMATRIX viewProjection, const XMFLOAT3& minimum, const XMFLOAT3& maximum) const;
+
+		static UINT LaneMask(FXMVECTOR lanes);
+
+		UINT mWidth;
+		UINT mHeight;
+		UINT mTileColumns;
+		UINT mTileRows;
+		XMFLOAT4X4 mViewProjection;
+		std::vector<XMFLOAT4> mClipVertices;
+		std::vector<ScreenTriangle> mTriangles;
+		std::vector<std::vector<UINT>> mBins;
+		std::vector<Level> mLevels;
+		Statistics mStatistics;
+	};
+}
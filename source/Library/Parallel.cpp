@@ -0,0 +1,233 @@
+#include "Parallel.h"
+#include "JobSystem.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <algorithm>
+
+namespace Library
+{
+	struct Parallel::Pool
+	{
+		std::mutex Mutex;
+		std::condition_variable RangeAvailable;
+		std::deque<std::function<void()>> Ranges;
+		std::once_flag Started;
+	};
+
+	struct Parallel::Batch
+	{
+		std::mutex Mutex;
+		std::condition_variable Finished;
+		UINT RemainingCount;
+
+		Batch(UINT remainingCount)
+			: Mutex(), Finished(), RemainingCount(remainingCount) { }
+	};
+
+	// Never deleted, so no worker is left waiting on a destroyed pool while static destructors run at exit
+	Parallel::Pool* Parallel::sPool = new Parallel::Pool();
+
+	UINT Parallel::sMaxWorkerCount = 0;
+	JobSystem* Parallel::sJobSystem = nullptr;
+
+	UINT Parallel::WorkerCount()
+	{
+		UINT workerCount;
+		if (sJobSystem != nullptr)
+		{
+			workerCount = (sJobSystem->IsSerial() ? 1 : sJobSystem->WorkerCount() + 1);
+		}
+		else
+		{
+			workerCount = (std::max)(1U, std::thread::hardware_concurrency());
+		}
+
+		return (sMaxWorkerCount > 0 ? (std::min)(workerCount, sMaxWorkerCount) : workerCount);
+	}
+
+	UINT Parallel::MaxWorkerCount()
+	{
+		return sMaxWorkerCount;
+	}
+
+	void Parallel::SetMaxWorkerCount(UINT maxWorkerCount)
+	{
+		sMaxWorkerCount = maxWorkerCount;
+	}
+
+	JobSystem* Parallel::CurrentJobSystem()
+	{
+		return sJobSystem;
+	}
+
+	void Parallel::SetJobSystem(JobSystem* jobSystem)
+	{
+		sJobSystem = jobSystem;
+	}
+
+	void Parallel::For(UINT begin, UINT end, UINT minimumRangeSize, const std::function<void(UINT, UINT)>& body)
+	{
+		if (end <= begin)
+		{
+			return;
+		}
+
+		UINT count = end - begin;
+		UINT rangeCount = (std::min)(WorkerCount(), (std::max)(1U, count / (std::max)(1U, minimumRangeSize)));
+		if (rangeCount == 1)
+		{
+			body(begin, end);
+			return;
+		}
+
+		UINT rangeSize = (count + rangeCount - 1) / rangeCount;
+		std::vector<std::exception_ptr> exceptions(rangeCount);
+		auto runRange = [&body, &exceptions](UINT index, UINT rangeBegin, UINT rangeEnd)
+		{
+			try
+			{
+				body(rangeBegin, rangeEnd);
+			}
+			catch (...)
+			{
+				exceptions[index] = std::current_exception();
+			}
+		};
+
+		if (sJobSystem != nullptr)
+		{
+			JobSystem::Counter counter(0);
+			for (UINT i = 1; i < rangeCount; i++)
+			{
+				UINT rangeBegin = begin + i * rangeSize;
+				UINT rangeEnd = (std::min)(end, rangeBegin + rangeSize);
+				if (rangeBegin >= rangeEnd)
+				{
+					break;
+				}
+
+				sJobSystem->Run(std::bind(runRange, i, rangeBegin, rangeEnd), counter);
+			}
+
+			runRange(0, begin, (std::min)(end, begin + rangeSize));
+
+			// A worker runs other jobs while it waits; any other thread sleeps until the workers have finished the ranges
+			sJobSystem->Wait(counter);
+		}
+		else
+		{
+			RunOnThreadPool(begin, end, rangeCount, rangeSize, runRange);
+		}
+
+		for (std::exception_ptr& exception : exceptions)
+		{
+			if (exception != nullptr)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+	}
+
+	void Parallel::RunOnThreadPool(UINT begin, UINT end, UINT rangeCount, UINT rangeSize, const std::function<void(UINT, UINT, UINT)>& runRange)
+	{
+		std::vector<std::function<void()>> ranges;
+		for (UINT i = 1; i < rangeCount; i++)
+		{
+			UINT rangeBegin = begin + i * rangeSize;
+			UINT rangeEnd = (std::min)(end, rangeBegin + rangeSize);
+			if (rangeBegin >= rangeEnd)
+			{
+				break;
+			}
+
+			ranges.push_back(std::bind(runRange, i, rangeBegin, rangeEnd));
+		}
+
+		Pool& pool = ThreadPool();
+		Batch batch(ranges.size());
+		{
+			std::lock_guard<std::mutex> lock(pool.Mutex);
+			for (std::function<void()>& range : ranges)
+			{
+				pool.Ranges.push_back([range, &batch]()
+				{
+					range();
+
+					std::lock_guard<std::mutex> batchLock(batch.Mutex);
+					if (--batch.RemainingCount == 0)
+					{
+						batch.Finished.notify_all();
+					}
+				});
+			}
+		}
+
+		pool.RangeAvailable.notify_all();
+
+		runRange(0, begin, (std::min)(end, begin + rangeSize));
+
+		// Ranges still queued may belong to this call, so they are run here rather than waited for
+		while (RunQueuedRange(pool))
+		{
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(batch.Mutex);
+			batch.Finished.wait(lock, [&batch]() { return batch.RemainingCount == 0; });
+		}
+	}
+
+	Parallel::Pool& Parallel::ThreadPool()
+	{
+		std::call_once(sPool->Started, &Parallel::StartThreadPool);
+
+		return *sPool;
+	}
+
+	void Parallel::StartThreadPool()
+	{
+		UINT threadCount = (std::max)(1U, std::thread::hardware_concurrency());
+		for (UINT i = 1; i < threadCount; i++)
+		{
+			std::thread(&Parallel::RunWorker, sPool).detach();
+		}
+	}
+
+	void Parallel::RunWorker(Pool* pool)
+	{
+		for (;;)
+		{
+			std::function<void()> range;
+			{
+				std::unique_lock<std::mutex> lock(pool->Mutex);
+				pool->RangeAvailable.wait(lock, [pool]() { return (pool->Ranges.empty() == false); });
+				range = pool->Ranges.front();
+				pool->Ranges.pop_front();
+			}
+
+			range();
+		}
+	}
+
+	bool Parallel::RunQueuedRange(Pool& pool)
+	{
+		std::function<void()> range;
+		{
+			std::lock_guard<std::mutex> lock(pool.Mutex);
+			if (pool.Ranges.empty())
+			{
+				return false;
+			}
+
+			range = pool.Ranges.front();
+			pool.Ranges.pop_front();
+		}
+
+		range();
+
+		return true;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Common.h"
+#include <functional>
+
+namespace Library
+{
+	class JobSystem;
+
+	class Parallel
+	{
+	public:
+		static UINT WorkerCount();
+		static UINT MaxWorkerCount();
+		static void SetMaxWorkerCount(UINT maxWorkerCount);
+
+		// Ranges run as jobs on this system when one is set, rather than on Parallel's own thread pool
+		static JobSystem* CurrentJobSystem();
+		static void SetJobSystem(JobSystem* jobSystem);
+
+		// Splits [begin, end) into contiguous ranges of at least minimumRangeSize and runs body(rangeBegin, rangeEnd) for each,
+		// one range on the calling thread. Returns once every range has finished; the first exception thrown by a range is rethrown.
+		// With a job system the other ranges are jobs, and a calling thread that is not one of its workers sleeps once its own
+		// range is done. Without one they run on a pool of one thread fewer than the hardware has, started by the first call
+		// and kept for the life of the process; while it waits, the calling thread runs ranges no worker has taken yet.
+		static void For(UINT begin, UINT end, UINT minimumRangeSize, const std::function<void(UINT, UINT)>& body);
+
+	private:
+		struct Pool;
+		struct Batch;
+
+		Parallel();
+		Parallel(const Parallel& rhs);
+		Parallel& operator=(const Parallel& rhs);
+
+		static void RunOnThreadPool(UINT begin, UINT end, UINT rangeCount, UINT rangeSize, const std::function<void(UINT, UINT, UINT)>& runRange);
+		static Pool& ThreadPool();
+		static void StartThreadPool();
+		static void RunWorker(Pool* pool);
+		static bool RunQueuedRange(Pool& pool);
+
+		static UINT sMaxWorkerCount;		// Caps WorkerCount, e.g. to measure scaling from one core up; zero means no cap
+		static JobSystem* sJobSystem;
+		static Pool* sPool;
+	};
+}
@@ -6,9 +6,11 @@
 #include "MatrixHelper.h"
 #include "VectorHelper.h"
 #include "Model.h"
+#include "ModelCache.h"
 #include "Mesh.h"
 #include "Utility.h"
 #include "RasterizerStates.h"
+#include "RenderPipeline.h"
 
 namespace Library
 {
@@ -18,10 +20,13 @@ namespace Library
 		: DrawableGameComponent(game, camera),
 		mModelFileName(modelFileName), mEffect(nullptr), mMaterial(nullptr),
 		mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0),
-		mWorldMatrix(MatrixHelper::Identity), mScaleMatrix(MatrixHelper::Identity), mDisplayWireframe(true),
+		mWorldMatrix(MatrixHelper::Identity), mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mIsWorldViewProjectionDirty(true), mCameraVersion(0), mWorldViewProjectionSlot(0), mScaleMatrix(MatrixHelper::Identity), mDisplayWireframe(true),
 		mPosition(Vector3Helper::Zero), mDirection(Vector3Helper::Forward), mUp(Vector3Helper::Up), mRight(Vector3Helper::Right)
 	{
 		XMStoreFloat4x4(&mScaleMatrix, XMMatrixScaling(scale, scale, scale));
+
+		DeclareModel(mModelFileName, true);
+		DeclareEffect(L"Content\\Effects\\BasicEffect.cso");
 	}
 
 	ProxyModel::~ProxyModel()
@@ -86,11 +91,13 @@ namespace Library
 	void ProxyModel::SetPosition(FXMVECTOR position)
 	{
 		XMStoreFloat3(&mPosition, position);
+		mIsWorldDirty = true;
 	}
 
 	void ProxyModel::SetPosition(const XMFLOAT3& position)
 	{
 		mPosition = position;
+		mIsWorldDirty = true;
 	}
 
 	void ProxyModel::ApplyRotation(CXMMATRIX transform)
@@ -110,6 +117,7 @@ namespace Library
 		XMStoreFloat3(&mDirection, direction);
 		XMStoreFloat3(&mUp, up);
 		XMStoreFloat3(&mRight, right);
+		mIsWorldDirty = true;
 	}
 
 	void ProxyModel::ApplyRotation(const XMFLOAT4X4& transform)
@@ -122,7 +130,7 @@ namespace Library
 	{
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-		std::unique_ptr<Model> model(new Model(*mGame, mModelFileName, true));
+		std::shared_ptr<Model> model = mGame->Models().Load(mModelFileName, true);
 
 		mEffect = new Effect(*mGame);
 		mEffect->LoadCompiledEffect(L"Content\\Effects\\BasicEffect.cso");
@@ -134,10 +142,20 @@ namespace Library
 		mMaterial->CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, &mVertexBuffer);
 		mesh->CreateIndexBuffer(&mIndexBuffer);
 		mIndexCount = mesh->Indices().size();
+
+		mWorldViewProjectionSlot = mGame->Pipeline().AllocateTransforms();
 	}
 
 	void ProxyModel::Update(const GameTime& gameTime)
 	{
+		if (mIsWorldDirty == false)
+		{
+			return;
+		}
+
+		mIsWorldDirty = false;
+		mIsWorldViewProjectionDirty = true;
+
 		XMMATRIX worldMatrix = XMMatrixIdentity();
 		MatrixHelper::SetForward(worldMatrix, mDirection);
 		MatrixHelper::SetUp(worldMatrix, mUp);
@@ -161,8 +179,7 @@ namespace Library
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
 		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-		XMMATRIX wvp = XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
-		mMaterial->WorldViewProjection() << wvp;
+		mMaterial->WorldViewProjection() << mGame->Pipeline().Current().TransformMatrix(mWorldViewProjectionSlot);
 
 		pass->Apply(0, direct3DDeviceContext);
 
@@ -177,4 +194,23 @@ namespace Library
 			direct3DDeviceContext->DrawIndexed(mIndexCount, 0, 0);
 		}
 	}
+
+	void ProxyModel::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		if (mIsWorldViewProjectionDirty || mCameraVersion != mCamera->ViewProjectionVersion())
+		{
+			XMMATRIX wvp = XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+			XMStoreFloat4x4(&mWorldViewProjectionMatrix, wvp);
+
+			mIsWorldViewProjectionDirty = false;
+			mCameraVersion = mCamera->ViewProjectionVersion();
+		}
+
+		snapshot.SetTransform(mWorldViewProjectionSlot, mWorldViewProjectionMatrix);
+	}
+
+	bool ProxyModel::DrawsFromSnapshot() const
+	{
+		return true;
+	}
 }
\ No newline at end of file
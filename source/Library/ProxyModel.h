@@ -39,6 +39,10 @@ namespace Library
 		virtual void Update(const GameTime& gameTime) override;
 		virtual void Draw(const GameTime& gameTime) override;
 
+		// Proxies are drawn by the component that owns them, which forwards its capture here
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
+		virtual bool DrawsFromSnapshot() const override;
+
 	private:
 		ProxyModel();
 		ProxyModel(const ProxyModel& rhs);
@@ -52,6 +56,11 @@ namespace Library
 		UINT mIndexCount;
 
 		XMFLOAT4X4 mWorldMatrix;
+		XMFLOAT4X4 mWorldViewProjectionMatrix;
+		bool mIsWorldDirty;
+		bool mIsWorldViewProjectionDirty;
+		UINT mCameraVersion;
+		UINT mWorldViewProjectionSlot;
 		XMFLOAT4X4 mScaleMatrix;
 
 		bool mDisplayWireframe;
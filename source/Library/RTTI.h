@@ -1,22 +1,32 @@
 #pragma once
 
 #include <string>
+#include <bitset>
+#include <cassert>
 
 namespace Library
 {
+	// Every RTTI type gets a small dense id and a mask holding the ids of itself and all of its ancestors, so Is and As
+	// are one virtual call and a bit test however deep the hierarchy. Ids are handed out on first use, which the mask
+	// definitions force during static initialization whatever order the translation units initialize in; they are
+	// stable for the life of the process but not between runs, so they must not be saved.
 	class RTTI
 	{
 	public:
+		static const unsigned int MaxTypeCount = 256;
+		typedef std::bitset<MaxTypeCount> TypeMask;
+
 		virtual const  unsigned int& TypeIdInstance() const = 0;
+		virtual const TypeMask& TypeMaskInstance() const = 0;
 
-		virtual RTTI* QueryInterface(const unsigned id) const
+		RTTI* QueryInterface(const unsigned id) const
 		{
-			return nullptr;
+			return (Is(id) ? (RTTI*)this : nullptr);
 		}
 
-		virtual bool Is(const unsigned int id) const
+		bool Is(const unsigned int id) const
 		{
-			return false;
+			return (id < MaxTypeCount && TypeMaskInstance()[id]);
 		}
 
 		virtual bool Is(const std::string& name) const
@@ -34,6 +44,22 @@ namespace Library
 
 			return nullptr;
 		}
+
+		static TypeMask BuildTypeMask()
+		{
+			return TypeMask();
+		}
+
+		static unsigned int NextTypeId()
+		{
+			// Zero marks an id not yet assigned
+			static unsigned int typeCount = 0;
+
+			typeCount++;
+			assert(typeCount < MaxTypeCount);
+
+			return typeCount;
+		}
 	};
 
 #define RTTI_DECLARATIONS(Type, ParentType)													\
@@ -41,21 +67,20 @@ public:																						\
 	typedef ParentType Parent;																\
 	static std::string TypeName() { return std::string(#Type); }							\
 	virtual const unsigned int& TypeIdInstance() const { return Type::TypeIdClass(); }		\
-	static const unsigned int& TypeIdClass() { return sRunTimeTypeId; }						\
-	virtual Library::RTTI* QueryInterface(const unsigned int id) const						\
+	static const unsigned int& TypeIdClass()												\
 				{																			\
-				if(id == sRunTimeTypeId)													\
-					{ return (RTTI*)this;}													\
-				else																		\
-					{ return Parent::QueryInterface(id); }									\
+				if(sRunTimeTypeId == 0)														\
+					{ sRunTimeTypeId = Library::RTTI::NextTypeId(); }						\
+				return sRunTimeTypeId;														\
 				}																			\
-	virtual bool Is(const unsigned int id) const											\
+	virtual const Library::RTTI::TypeMask& TypeMaskInstance() const { return sTypeMask; }	\
+	static Library::RTTI::TypeMask BuildTypeMask()											\
 				{																			\
-				if(id == sRunTimeTypeId)													\
-					{return true;}															\
-				else																		\
-					{return Parent::Is(id);}												\
+				Library::RTTI::TypeMask mask = Parent::BuildTypeMask();						\
+				mask.set(TypeIdClass());													\
+				return mask;																\
 				}																			\
+	using Parent::Is;																		\
 	virtual bool Is(const std::string& name) const											\
 				{																			\
 				if(name == TypeName())														\
@@ -64,7 +89,8 @@ public:																						\
 					{return Parent::Is(name);}												\
 				}																			\
 private:																					\
-	static unsigned int sRunTimeTypeId;
+	static unsigned int sRunTimeTypeId;														\
+	static Library::RTTI::TypeMask sTypeMask;
 
-#define RTTI_DEFINITIONS(Type) unsigned int Type::sRunTimeTypeId = (unsigned int)& Type::sRunTimeTypeId;
+#define RTTI_DEFINITIONS(Type) unsigned int Type::sRunTimeTypeId = 0; Library::RTTI::TypeMask Type::sTypeMask = Type::BuildTypeMask();
 }
\ No newline at end of file
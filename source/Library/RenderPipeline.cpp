@@ -0,0 +1,256 @@
+#include "RenderPipeline.h"
+#include "ClockSource.h"
+#include "GameException.h"
+
+namespace Library
+{
+	RenderPipeline::RenderPipeline(const RenderFunction& render)
+		: mRender(render), mPreviousStep(), mHasPreviousStep(false), mCaptureIndex(0), mFrameNumber(0), mIsCapturing(false), mTransformCount(0), mLightCount(0), mBoneTransformCount(0),
+		  mIsPipelined(false), mThread(), mMutex(), mCondition(), mHasFrame(false), mIsShuttingDown(false), mException(), mStatistics()
+	{
+		if (mRender == nullptr)
+		{
+			throw GameException("A render pipeline needs a render function.");
+		}
+	}
+
+	RenderPipeline::~RenderPipeline()
+	{
+		StopThread();
+	}
+
+	bool RenderPipeline::IsPipelined() const
+	{
+		return mIsPipelined;
+	}
+
+	void RenderPipeline::SetPipelined(bool isPipelined)
+	{
+		if (isPipelined == mIsPipelined)
+		{
+			return;
+		}
+
+		if (isPipelined)
+		{
+			StartThread();
+		}
+		else
+		{
+			Flush();
+			StopThread();
+		}
+
+		mIsPipelined = isPipelined;
+	}
+
+	UINT RenderPipeline::AllocateTransforms(UINT count)
+	{
+		UINT firstSlot = mTransformCount;
+		mTransformCount += count;
+
+		return firstSlot;
+	}
+
+	UINT RenderPipeline::AllocateLights(UINT count)
+	{
+		UINT firstSlot = mLightCount;
+		mLightCount += count;
+
+		return firstSlot;
+	}
+
+	UINT RenderPipeline::AllocateBonePalette(UINT boneCount)
+	{
+		UINT firstSlot = mBoneTransformCount;
+		mBoneTransformCount += boneCount;
+
+		return firstSlot;
+	}
+
+	RenderSnapshot& RenderPipeline::BeginCapture(const GameTime& gameTime)
+	{
+		if (mIsCapturing)
+		{
+			throw GameException("A render snapshot is already being captured.");
+		}
+
+		// The render stage only ever reads the other snapshot, so this one can be resized freely
+		RenderSnapshot& snapshot = mSnapshots[mCaptureIndex];
+		snapshot.Begin(mFrameNumber, gameTime, mTransformCount, mLightCount, mBoneTransformCount);
+		mIsCapturing = true;
+
+		return snapshot;
+	}
+
+	void RenderPipeline::KeepAsPreviousStep()
+	{
+		if (mIsCapturing == false)
+		{
+			throw GameException("KeepAsPreviousStep() without a matching BeginCapture().");
+		}
+
+		// The frame number is left alone, so the capture that follows has the same Index and overwrites any draw state
+		// components kept for this one
+		mPreviousStep.CopyState(mSnapshots[mCaptureIndex]);
+		mHasPreviousStep = true;
+		mIsCapturing = false;
+	}
+
+	void RenderPipeline::ClearPreviousStep()
+	{
+		mHasPreviousStep = false;
+	}
+
+	void RenderPipeline::Submit()
+	{
+		if (mIsCapturing == false)
+		{
+			throw GameException("Submit() without a matching BeginCapture().");
+		}
+
+		RenderSnapshot& snapshot = mSnapshots[mCaptureIndex];
+		if (mHasPreviousStep)
+		{
+			snapshot.Interpolate(mPreviousStep, static_cast<float>(snapshot.Time().InterpolationAlpha()));
+		}
+
+		snapshot.Publish();
+		mIsCapturing = false;
+		mFrameNumber++;
+
+		if (mIsPipelined == false)
+		{
+			mCaptureIndex ^= 1;
+			Render(snapshot);
+			return;
+		}
+
+		double startTime = RealClockSource::Milliseconds();
+		WaitForRender();
+		mStatistics.SubmitWaitMilliseconds += RealClockSource::Milliseconds() - startTime;
+
+		std::exception_ptr exception;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mCaptureIndex ^= 1;
+			mHasFrame = true;
+			exception = mException;
+			mException = nullptr;
+		}
+
+		mCondition.notify_all();
+
+		if (exception != nullptr)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+
+	void RenderPipeline::Flush()
+	{
+		if (mIsPipelined == false)
+		{
+			return;
+		}
+
+		WaitForRender();
+
+		std::exception_ptr exception;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			exception = mException;
+			mException = nullptr;
+		}
+
+		if (exception != nullptr)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+
+	const RenderSnapshot& RenderPipeline::Current() const
+	{
+		return mSnapshots[mCaptureIndex ^ 1];
+	}
+
+	const RenderPipeline::Statistics& RenderPipeline::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void RenderPipeline::RenderLoop()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		for (;;)
+		{
+			mCondition.wait(lock, [this]() { return (mHasFrame || mIsShuttingDown); });
+			if (mHasFrame == false)
+			{
+				return;
+			}
+
+			// Submit only switches snapshots while no frame is in flight, so this one stays put until mHasFrame is cleared
+			const RenderSnapshot& snapshot = mSnapshots[mCaptureIndex ^ 1];
+			lock.unlock();
+
+			std::exception_ptr exception;
+			try
+			{
+				Render(snapshot);
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+
+			lock.lock();
+			if (exception != nullptr && mException == nullptr)
+			{
+				mException = exception;
+			}
+
+			mHasFrame = false;
+			mCondition.notify_all();
+		}
+	}
+
+	void RenderPipeline::Render(const RenderSnapshot& snapshot)
+	{
+		double startTime = RealClockSource::Milliseconds();
+		mRender(snapshot);
+
+		mStatistics.FrameCount++;
+		mStatistics.RenderMilliseconds += RealClockSource::Milliseconds() - startTime;
+	}
+
+	void RenderPipeline::WaitForRender()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mCondition.wait(lock, [this]() { return (mHasFrame == false); });
+	}
+
+	void RenderPipeline::StartThread()
+	{
+		mIsShuttingDown = false;
+		mThread = std::thread(&RenderPipeline::RenderLoop, this);
+	}
+
+	void RenderPipeline::StopThread()
+	{
+		if (mThread.joinable() == false)
+		{
+			return;
+		}
+
+		WaitForRender();
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mIsShuttingDown = true;
+		}
+
+		mCondition.notify_all();
+		mThread.join();
+	}
+}
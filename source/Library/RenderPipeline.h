@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Common.h"
+#include "RenderSnapshot.h"
+#include <functional>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace Library
+{
+	// Hands frames from the simulation to a render stage through two alternating RenderSnapshots. The simulation thread
+	// captures into one with BeginCapture, then Submit waits for the render stage to finish the previous frame, publishes
+	// the snapshot and starts rendering it. Pipelined, the render stage runs on a thread of its own, so the next frame
+	// simulates while this one is drawn; otherwise Submit renders on the calling thread before it returns.
+	//
+	// Ownership while pipelined:
+	//  - the simulation thread owns all component state, the slot layout and the snapshot being captured;
+	//  - the render thread owns the Direct3D device context, effect variables and whatever Draw alone writes, and reads
+	//    the published snapshot, which nothing writes until the render stage has finished with it;
+	//  - neither thread reads state the other owns; Flush hands everything back to the caller.
+	// Debug builds throw if a published snapshot is written, the one way capture could race the render stage.
+	class RenderPipeline
+	{
+	public:
+		typedef std::function<void(const RenderSnapshot& snapshot)> RenderFunction;
+
+		struct Statistics
+		{
+			UINT FrameCount;
+			double SubmitWaitMilliseconds;		// Simulation thread blocked on the render stage
+			double RenderMilliseconds;
+
+			Statistics()
+				: FrameCount(0), SubmitWaitMilliseconds(0.0), RenderMilliseconds(0.0) { }
+		};
+
+		RenderPipeline(const RenderFunction& render);
+		~RenderPipeline();
+
+		// Switching waits for the frame in flight
+		bool IsPipelined() const;
+		void SetPipelined(bool isPipelined);
+
+		// Slots are reserved from the simulation thread and appear in every snapshot captured afterwards
+		UINT AllocateTransforms(UINT count = 1);
+		UINT AllocateLights(UINT count = 1);
+		UINT AllocateBonePalette(UINT boneCount);
+
+		RenderSnapshot& BeginCapture(const GameTime& gameTime);
+		void Submit();
+
+		// Ends the capture without submitting it and keeps it as the state before the last fixed step. Every later Submit
+		// blends its snapshot from that state by the snapshot's interpolation alpha, until ClearPreviousStep.
+		void KeepAsPreviousStep();
+		void ClearPreviousStep();
+
+		// Waits until the render stage is idle, rethrowing the first exception it raised since the last Submit or Flush
+		void Flush();
+
+		// The snapshot the render stage is drawing, or last drew; only read from the render stage
+		const RenderSnapshot& Current() const;
+
+		// Statistics are updated by both stages, so they are only read after Flush or when not pipelined
+		const Statistics& GetStatistics() const;
+
+	private:
+		RenderPipeline();
+		RenderPipeline(const RenderPipeline& rhs);
+		RenderPipeline& operator=(const RenderPipeline& rhs);
+
+		void RenderLoop();
+		void Render(const RenderSnapshot& snapshot);
+		void WaitForRender();
+		void StartThread();
+		void StopThread();
+
+		RenderFunction mRender;
+		RenderSnapshot mSnapshots[2];
+		RenderSnapshot mPreviousStep;	// Never published; only the simulation thread touches it
+		bool mHasPreviousStep;
+		UINT mCaptureIndex;
+		UINT mFrameNumber;
+		bool mIsCapturing;
+		UINT mTransformCount;
+		UINT mLightCount;
+		UINT mBoneTransformCount;
+
+		bool mIsPipelined;
+		std::thread mThread;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mHasFrame;					// Set by Submit, cleared by the render thread once the frame is drawn
+		bool mIsShuttingDown;
+		std::exception_ptr mException;
+		Statistics mStatistics;
+	};
+}
@@ -0,0 +1,239 @@
+#include "RenderSnapshot.h"
+#include "GameException.h"
+#include "MatrixHelper.h"
+#include "VectorHelper.h"
+#include "ColorHelper.h"
+#include <algorithm>
+
+namespace Library
+{
+	RenderSnapshot::ViewState::ViewState()
+		: ViewMatrix(MatrixHelper::Identity), ProjectionMatrix(MatrixHelper::Identity), ViewProjectionMatrix(MatrixHelper::Identity),
+		  Position(Vector3Helper::Zero), Direction(Vector3Helper::Forward)
+	{
+	}
+
+	RenderSnapshot::LightState::LightState()
+		: Color(reinterpret_cast<const float*>(&ColorHelper::White)), Position(Vector3Helper::Zero), Direction(Vector3Helper::Forward), Radius(0.0f), InnerAngle(0.0f), OuterAngle(0.0f)
+	{
+	}
+
+	RenderSnapshot::RenderSnapshot()
+		: mFrameNumber(0), mGameTime(), mView(), mTransforms(), mLights(), mBoneTransforms(), mVisibleComponents(), mIsPublished(false)
+	{
+	}
+
+	UINT RenderSnapshot::FrameNumber() const
+	{
+		return mFrameNumber;
+	}
+
+	UINT RenderSnapshot::Index() const
+	{
+		// Every Submit advances the frame number and swaps the snapshots together
+		return (mFrameNumber & 1);
+	}
+
+	const GameTime& RenderSnapshot::Time() const
+	{
+		return mGameTime;
+	}
+
+	const RenderSnapshot::ViewState& RenderSnapshot::View() const
+	{
+		return mView;
+	}
+
+	void RenderSnapshot::SetView(const ViewState& view)
+	{
+		ValidateWritable();
+		mView = view;
+	}
+
+	UINT RenderSnapshot::TransformCount() const
+	{
+		return mTransforms.size();
+	}
+
+	const XMFLOAT4X4& RenderSnapshot::Transform(UINT slot) const
+	{
+		assert(slot < mTransforms.size());
+		return mTransforms[slot];
+	}
+
+	XMMATRIX RenderSnapshot::TransformMatrix(UINT slot) const
+	{
+		return XMLoadFloat4x4(&Transform(slot));
+	}
+
+	void RenderSnapshot::SetTransform(UINT slot, const XMFLOAT4X4& transform)
+	{
+		ValidateWritable();
+		assert(slot < mTransforms.size());
+		mTransforms[slot] = transform;
+	}
+
+	void RenderSnapshot::SetTransform(UINT slot, CXMMATRIX transform)
+	{
+		ValidateWritable();
+		assert(slot < mTransforms.size());
+		XMStoreFloat4x4(&mTransforms[slot], transform);
+	}
+
+	UINT RenderSnapshot::LightCount() const
+	{
+		return mLights.size();
+	}
+
+	const RenderSnapshot::LightState& RenderSnapshot::Light(UINT slot) const
+	{
+		assert(slot < mLights.size());
+		return mLights[slot];
+	}
+
+	void RenderSnapshot::SetLight(UINT slot, const LightState& light)
+	{
+		ValidateWritable();
+		assert(slot < mLights.size());
+		mLights[slot] = light;
+	}
+
+	UINT RenderSnapshot::BoneTransformCount() const
+	{
+		return mBoneTransforms.size();
+	}
+
+	const XMFLOAT4X4* RenderSnapshot::BonePalette(UINT firstSlot) const
+	{
+		assert(firstSlot < mBoneTransforms.size());
+		return &mBoneTransforms[firstSlot];
+	}
+
+	void RenderSnapshot::SetBonePalette(UINT firstSlot, const std::vector<XMFLOAT4X4>& boneTransforms)
+	{
+		ValidateWritable();
+		assert(firstSlot + boneTransforms.size() <= mBoneTransforms.size());
+		std::copy(boneTransforms.begin(), boneTransforms.end(), mBoneTransforms.begin() + firstSlot);
+	}
+
+	const std::vector<DrawableGameComponent*>& RenderSnapshot::VisibleComponents() const
+	{
+		return mVisibleComponents;
+	}
+
+	void RenderSnapshot::AddVisibleComponent(DrawableGameComponent* component)
+	{
+		ValidateWritable();
+		mVisibleComponents.push_back(component);
+	}
+
+	void RenderSnapshot::Begin(UINT frameNumber, const GameTime& gameTime, UINT transformCount, UINT lightCount, UINT boneTransformCount)
+	{
+		mIsPublished = false;
+		mFrameNumber = frameNumber;
+		mGameTime = gameTime;
+
+		mTransforms.resize(transformCount, MatrixHelper::Identity);
+		mLights.resize(lightCount);
+		mBoneTransforms.resize(boneTransformCount, MatrixHelper::Identity);
+		mVisibleComponents.clear();
+	}
+
+	void RenderSnapshot::Publish()
+	{
+		mIsPublished = true;
+	}
+
+	void RenderSnapshot::CopyState(const RenderSnapshot& source)
+	{
+		// Assigning keeps each vector's capacity, so copying every frame allocates nothing once the slot counts settle
+		mFrameNumber = source.mFrameNumber;
+		mGameTime = source.mGameTime;
+		mView = source.mView;
+		mTransforms.assign(source.mTransforms.begin(), source.mTransforms.end());
+		mLights.assign(source.mLights.begin(), source.mLights.end());
+		mBoneTransforms.assign(source.mBoneTransforms.begin(), source.mBoneTransforms.end());
+		mVisibleComponents.assign(source.mVisibleComponents.begin(), source.mVisibleComponents.end());
+	}
+
+	void RenderSnapshot::Interpolate(const RenderSnapshot& previous, float alpha)
+	{
+		ValidateWritable();
+		if (alpha >= 1.0f)
+		{
+			return;
+		}
+
+		InterpolateTransform(previous.mView.ViewMatrix, mView.ViewMatrix, alpha);
+		XMStoreFloat4x4(&mView.ViewProjectionMatrix, XMLoadFloat4x4(&mView.ViewMatrix) * XMLoadFloat4x4(&mView.ProjectionMatrix));
+		XMStoreFloat3(&mView.Position, XMVectorLerp(XMLoadFloat3(&previous.mView.Position), XMLoadFloat3(&mView.Position), alpha));
+		XMStoreFloat3(&mView.Direction, XMVector3Normalize(XMVectorLerp(XMLoadFloat3(&previous.mView.Direction), XMLoadFloat3(&mView.Direction), alpha)));
+
+		// Slots reserved after the previous state was captured have nothing to blend from and keep their captured values
+		UINT transformCount = (std::min)(mTransforms.size(), previous.mTransforms.size());
+		for (UINT i = 0; i < transformCount; i++)
+		{
+			InterpolateTransform(previous.mTransforms[i], mTransforms[i], alpha);
+		}
+
+		UINT lightCount = (std::min)(mLights.size(), previous.mLights.size());
+		for (UINT i = 0; i < lightCount; i++)
+		{
+			const LightState& previousLight = previous.mLights[i];
+			LightState& light = mLights[i];
+
+			XMStoreFloat4(&light.Color, XMVectorLerp(XMLoadFloat4(&previousLight.Color), XMLoadFloat4(&light.Color), alpha));
+			XMStoreFloat3(&light.Position, XMVectorLerp(XMLoadFloat3(&previousLight.Position), XMLoadFloat3(&light.Position), alpha));
+			XMStoreFloat3(&light.Direction, XMVector3Normalize(XMVectorLerp(XMLoadFloat3(&previousLight.Direction), XMLoadFloat3(&light.Direction), alpha)));
+			light.Radius = previousLight.Radius + (light.Radius - previousLight.Radius) * alpha;
+			light.InnerAngle = previousLight.InnerAngle + (light.InnerAngle - previousLight.InnerAngle) * alpha;
+			light.OuterAngle = previousLight.OuterAngle + (light.OuterAngle - previousLight.OuterAngle) * alpha;
+		}
+
+		UINT boneTransformCount = (std::min)(mBoneTransforms.size(), previous.mBoneTransforms.size());
+		for (UINT i = 0; i < boneTransformCount; i++)
+		{
+			InterpolateTransform(previous.mBoneTransforms[i], mBoneTransforms[i], alpha);
+		}
+	}
+
+	void RenderSnapshot::InterpolateTransform(const XMFLOAT4X4& previous, XMFLOAT4X4& transform, float alpha)
+	{
+		// Slots may hold a world-view-projection, which Decompose would strip of its projection. The projection is the same
+		// on both sides, so blending the elements is the same as blending the affine part and projecting it afterwards.
+		bool isAffine = (previous._14 == 0.0f && previous._24 == 0.0f && previous._34 == 0.0f && previous._44 == 1.0f &&
+			transform._14 == 0.0f && transform._24 == 0.0f && transform._34 == 0.0f && transform._44 == 1.0f);
+
+		// Blending the parts rather than the elements keeps a turning affine transform rigid
+		XMVECTOR previousScale, previousRotation, previousTranslation;
+		XMVECTOR scale, rotation, translation;
+		if (isAffine == false ||
+			XMMatrixDecompose(&previousScale, &previousRotation, &previousTranslation, XMLoadFloat4x4(&previous)) == false ||
+			XMMatrixDecompose(&scale, &rotation, &translation, XMLoadFloat4x4(&transform)) == false)
+		{
+			XMMATRIX previousMatrix = XMLoadFloat4x4(&previous);
+			XMMATRIX matrix = XMLoadFloat4x4(&transform);
+			for (UINT i = 0; i < 4; i++)
+			{
+				matrix.r[i] = XMVectorLerp(previousMatrix.r[i], matrix.r[i], alpha);
+			}
+
+			XMStoreFloat4x4(&transform, matrix);
+			return;
+		}
+
+		XMMATRIX blended = XMMatrixAffineTransformation(XMVectorLerp(previousScale, scale, alpha), XMVectorZero(),
+			XMQuaternionSlerp(previousRotation, rotation, alpha), XMVectorLerp(previousTranslation, translation, alpha));
+		XMStoreFloat4x4(&transform, blended);
+	}
+
+	void RenderSnapshot::ValidateWritable() const
+	{
+#if defined( DEBUG ) || defined( _DEBUG )
+		if (mIsPublished)
+		{
+			throw GameException("A render snapshot was written after it was submitted, while the render stage may be reading it.");
+		}
+#endif
+	}
+}
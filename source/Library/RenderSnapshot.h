@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Common.h"
+#include "GameTime.h"
+
+namespace Library
+{
+	class DrawableGameComponent;
+
+	// Everything one frame's Draw is allowed to read from simulation state: the view, world transforms, light parameters
+	// and bone palettes, which drawable components are visible, plus the frame's game time. Components reserve slots through RenderPipeline while initializing and
+	// fill them from CaptureRenderState; every snapshot has the same slots, so a slot index stays valid in all of them.
+	// A snapshot is written only between RenderPipeline::BeginCapture and Submit, and is immutable once submitted. Snapshots
+	// alternate, so a slot not captured this frame still holds what was captured into it two frames ago. Under a fixed time
+	// step, the view, transforms, lights and bone palettes are blended before publishing from the state captured ahead of
+	// the frame's last step, by the interpolation alpha of the snapshot's game time.
+	class RenderSnapshot
+	{
+	public:
+		struct ViewState
+		{
+			XMFLOAT4X4 ViewMatrix;
+			XMFLOAT4X4 ProjectionMatrix;
+			XMFLOAT4X4 ViewProjectionMatrix;
+			XMFLOAT3 Position;
+			XMFLOAT3 Direction;
+
+			ViewState();
+		};
+
+		// Point lights leave Direction and the cone angles unused, directional lights Position and Radius
+		struct LightState
+		{
+			XMFLOAT4 Color;
+			XMFLOAT3 Position;
+			XMFLOAT3 Direction;
+			float Radius;
+			float InnerAngle;
+			float OuterAngle;
+
+			LightState();
+		};
+
+		RenderSnapshot();
+
+		UINT FrameNumber() const;
+
+		// Which of the two alternating snapshots this is. A component that keeps draw state the snapshot has no slots for
+		// keeps two copies, capturing into and drawing from the one this selects, so capture never writes the copy in use.
+		UINT Index() const;
+		const GameTime& Time() const;
+		const ViewState& View() const;
+		void SetView(const ViewState& view);
+
+		UINT TransformCount() const;
+		const XMFLOAT4X4& Transform(UINT slot) const;
+		XMMATRIX TransformMatrix(UINT slot) const;
+		void SetTransform(UINT slot, const XMFLOAT4X4& transform);
+		void SetTransform(UINT slot, CXMMATRIX transform);
+
+		UINT LightCount() const;
+		const LightState& Light(UINT slot) const;
+		void SetLight(UINT slot, const LightState& light);
+
+		// A palette occupies boneCount consecutive slots starting at the one AllocateBonePalette returned
+		UINT BoneTransformCount() const;
+		const XMFLOAT4X4* BonePalette(UINT firstSlot) const;
+		void SetBonePalette(UINT firstSlot, const std::vector<XMFLOAT4X4>& boneTransforms);
+
+		// The drawable components that were visible when the frame was captured, in the game's order
+		const std::vector<DrawableGameComponent*>& VisibleComponents() const;
+		void AddVisibleComponent(DrawableGameComponent* component);
+
+	private:
+		friend class RenderPipeline;
+
+		RenderSnapshot(const RenderSnapshot& rhs);
+		RenderSnapshot& operator=(const RenderSnapshot& rhs);
+
+		void Begin(UINT frameNumber, const GameTime& gameTime, UINT transformCount, UINT lightCount, UINT boneTransformCount);
+		void Publish();
+		void ValidateWritable() const;
+		void CopyState(const RenderSnapshot& source);
+		void Interpolate(const RenderSnapshot& previous, float alpha);
+
+		static void InterpolateTransform(const XMFLOAT4X4& previous, XMFLOAT4X4& transform, float alpha);
+
+		UINT mFrameNumber;
+		GameTime mGameTime;
+		ViewState mView;
+		std::vector<XMFLOAT4X4> mTransforms;
+		std::vector<LightState> mLights;
+		std::vector<XMFLOAT4X4> mBoneTransforms;
+		std::vector<DrawableGameComponent*> mVisibleComponents;
+		bool mIsPublished;
+	};
+}
@@ -8,6 +8,7 @@
 #include "VectorHelper.h"
 #include "Camera.h"
 #include "VertexDeclarations.h"
+#include "RenderPipeline.h"
 
 namespace Library
 {
@@ -43,7 +44,7 @@ namespace Library
 		: DrawableGameComponent(game, camera),
 		mVertexBuffer(nullptr), mIndexBuffer(nullptr), mMaterial(nullptr), mPass(nullptr), mInputLayout(nullptr),
 		mColor(DefaultColor), mPosition(Vector3Helper::Zero), mDirection(Vector3Helper::Forward), mUp(Vector3Helper::Up), mRight(Vector3Helper::Right),
-		mWorldMatrix(MatrixHelper::Identity)
+		mWorldMatrix(MatrixHelper::Identity), mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mIsWorldViewProjectionDirty(true), mCameraVersion(0), mWorldViewProjectionSlot(0)
 	{
 	}
 
@@ -51,7 +52,7 @@ namespace Library
 		: DrawableGameComponent(game, camera),
 		mVertexBuffer(nullptr), mIndexBuffer(nullptr), mMaterial(nullptr), mPass(nullptr), mInputLayout(nullptr),
 		mColor(color), mPosition(Vector3Helper::Zero), mDirection(Vector3Helper::Forward), mUp(Vector3Helper::Up), mRight(Vector3Helper::Right),
-		mWorldMatrix(MatrixHelper::Identity)
+		mWorldMatrix(MatrixHelper::Identity), mWorldViewProjectionMatrix(MatrixHelper::Identity), mIsWorldDirty(true), mIsWorldViewProjectionDirty(true), mCameraVersion(0), mWorldViewProjectionSlot(0)
 	{
 	}
 
@@ -117,11 +118,13 @@ namespace Library
 	void RenderableFrustum::SetPosition(FXMVECTOR position)
 	{
 		XMStoreFloat3(&mPosition, position);
+		mIsWorldDirty = true;
 	}
 
 	void RenderableFrustum::SetPosition(const XMFLOAT3& position)
 	{
 		mPosition = position;
+		mIsWorldDirty = true;
 	}
 
 	void RenderableFrustum::ApplyRotation(CXMMATRIX transform)
@@ -141,6 +144,7 @@ namespace Library
 		XMStoreFloat3(&mDirection, direction);
 		XMStoreFloat3(&mUp, up);
 		XMStoreFloat3(&mRight, right);
+		mIsWorldDirty = true;
 	}
 
 	void RenderableFrustum::ApplyRotation(const XMFLOAT4X4& transform)
@@ -166,10 +170,20 @@ namespace Library
 		mInputLayout = mMaterial->InputLayouts().at(mPass);
 
 		InitializeIndexBuffer();
+
+		mWorldViewProjectionSlot = mGame->Pipeline().AllocateTransforms();
 	}
 
 	void RenderableFrustum::Update(const GameTime& gameTime)
 	{
+		if (mIsWorldDirty == false)
+		{
+			return;
+		}
+
+		mIsWorldDirty = false;
+		mIsWorldViewProjectionDirty = true;
+
 		XMMATRIX worldMatrix = XMMatrixIdentity();
 		MatrixHelper::SetForward(worldMatrix, mDirection);
 		MatrixHelper::SetUp(worldMatrix, mUp);
@@ -193,15 +207,32 @@ namespace Library
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
 		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
 
-		XMMATRIX world = XMLoadFloat4x4(&mWorldMatrix);
-		XMMATRIX wvp = world * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
-		mMaterial->WorldViewProjection() << wvp;
+		mMaterial->WorldViewProjection() << mGame->Pipeline().Current().TransformMatrix(mWorldViewProjectionSlot);
 
 		mPass->Apply(0, direct3DDeviceContext);
 
 		direct3DDeviceContext->DrawIndexed(FrustumIndexCount, 0, 0);
 	}
 
+	void RenderableFrustum::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		if (mIsWorldViewProjectionDirty || mCameraVersion != mCamera->ViewProjectionVersion())
+		{
+			XMMATRIX wvp = XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+			XMStoreFloat4x4(&mWorldViewProjectionMatrix, wvp);
+
+			mIsWorldViewProjectionDirty = false;
+			mCameraVersion = mCamera->ViewProjectionVersion();
+		}
+
+		snapshot.SetTransform(mWorldViewProjectionSlot, mWorldViewProjectionMatrix);
+	}
+
+	bool RenderableFrustum::DrawsFromSnapshot() const
+	{
+		return true;
+	}
+
 	void RenderableFrustum::InitializeVertexBuffer(const Frustum& frustum)
 	{
 		ReleaseObject(mVertexBuffer);
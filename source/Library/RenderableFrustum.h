@@ -39,6 +39,8 @@ namespace Library
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
 		virtual void Draw(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
+		virtual bool DrawsFromSnapshot() const override;
 
 	private:
 		RenderableFrustum();
@@ -68,5 +70,10 @@ namespace Library
 		XMFLOAT3 mRight;
 
 		XMFLOAT4X4 mWorldMatrix;
+		XMFLOAT4X4 mWorldViewProjectionMatrix;
+		bool mIsWorldDirty;
+		bool mIsWorldViewProjectionDirty;
+		UINT mCameraVersion;
+		UINT mWorldViewProjectionSlot;
 	};
 }
\ No newline at end of file
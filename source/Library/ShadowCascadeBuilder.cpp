@@ -0,0 +1,289 @@
+#include "ShadowCascadeBuilder.h"
+#include "Camera.h"
+#include "VectorHelper.h"
+#include "GameException.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Library
+{
+	const UINT ShadowCascadeBuilder::MaxCascadeCount = 4;
+	const UINT ShadowCascadeBuilder::DefaultCascadeCount = 4;
+	const UINT ShadowCascadeBuilder::DefaultResolution = 1024;
+	const float ShadowCascadeBuilder::DefaultSplitBlend = 0.75f;
+
+	ShadowCascadeBuilder::ShadowCascadeBuilder(UINT cascadeCount, UINT resolution, float splitBlend, CascadeFit fit)
+		: mResolution(0), mSplitBlend(splitBlend), mFit(fit), mShadowDistance(0.0f), mCascades(), mSplitDistances(), mCasterMinimums(), mCasterMaximums()
+	{
+		SetCascadeCount(cascadeCount);
+		SetResolution(resolution);
+	}
+
+	UINT ShadowCascadeBuilder::CascadeCount() const
+	{
+		return mCascades.size();
+	}
+
+	void ShadowCascadeBuilder::SetCascadeCount(UINT cascadeCount)
+	{
+		if (cascadeCount == 0 || cascadeCount > MaxCascadeCount)
+		{
+			throw GameException("Cascade count must be between one and ShadowCascadeBuilder::MaxCascadeCount.");
+		}
+
+		mCascades.resize(cascadeCount);
+	}
+
+	UINT ShadowCascadeBuilder::Resolution() const
+	{
+		return mResolution;
+	}
+
+	void ShadowCascadeBuilder::SetResolution(UINT resolution)
+	{
+		if (resolution < 2)
+		{
+			throw GameException("Shadow map resolution must be at least two texels.");
+		}
+
+		mResolution = resolution;
+	}
+
+	float ShadowCascadeBuilder::SplitBlend() const
+	{
+		return mSplitBlend;
+	}
+
+	void ShadowCascadeBuilder::SetSplitBlend(float splitBlend)
+	{
+		mSplitBlend = splitBlend;
+	}
+
+	CascadeFit ShadowCascadeBuilder::Fit() const
+	{
+		return mFit;
+	}
+
+	void ShadowCascadeBuilder::SetFit(CascadeFit fit)
+	{
+		mFit = fit;
+	}
+
+	float ShadowCascadeBuilder::ShadowDistance() const
+	{
+		return mShadowDistance;
+	}
+
+	void ShadowCascadeBuilder::SetShadowDistance(float shadowDistance)
+	{
+		mShadowDistance = shadowDistance;
+	}
+
+	void ShadowCascadeBuilder::Build(const Camera& camera, const XMFLOAT3& lightDirection)
+	{
+		BuildCascades(camera, lightDirection, nullptr);
+	}
+
+	void ShadowCascadeBuilder::Build(const Camera& camera, const XMFLOAT3& lightDirection, const FrustumCuller::BoxArray& casters)
+	{
+		BuildCascades(camera, lightDirection, &casters);
+	}
+
+	const std::vector<ShadowCascadeBuilder::Cascade>& ShadowCascadeBuilder::Cascades() const
+	{
+		return mCascades;
+	}
+
+	void ShadowCascadeBuilder::Validate() const
+	{
+#if defined( DEBUG ) || defined( _DEBUG )
+		// Splits must tile the view range, and every split must lie wholly inside its cascade's light volume
+		static const float Tolerance = 1e-4f;
+
+		for (UINT i = 0; i < mCascades.size(); i++)
+		{
+			const Cascade& cascade = mCascades[i];
+			assert(cascade.NearDistance < cascade.FarDistance);
+			assert(i == 0 || mCascades[i - 1].FarDistance == cascade.NearDistance);
+
+			XMMATRIX viewProjection = XMLoadFloat4x4(&cascade.ViewProjectionMatrix);
+			for (UINT j = 0; j < ARRAYSIZE(cascade.Corners); j++)
+			{
+				XMFLOAT3 corner;
+				XMStoreFloat3(&corner, XMVector3TransformCoord(XMLoadFloat3(&cascade.Corners[j]), viewProjection));
+				assert(std::fabs(corner.x) <= 1.0f + Tolerance && std::fabs(corner.y) <= 1.0f + Tolerance);
+				assert(corner.z >= -Tolerance && corner.z <= 1.0f + Tolerance);
+			}
+		}
+#endif
+	}
+
+	void ShadowCascadeBuilder::ComputeSplitDistances(float nearDistance, float farDistance, UINT cascadeCount, float splitBlend, std::vector<float>& splitDistances)
+	{
+		splitDistances.resize(cascadeCount + 1);
+
+		for (UINT i = 0; i <= cascadeCount; i++)
+		{
+			float fraction = static_cast<float>(i) / cascadeCount;
+			float logarithmic = nearDistance * std::pow(farDistance / nearDistance, fraction);
+			float uniform = nearDistance + (farDistance - nearDistance) * fraction;
+
+			splitDistances[i] = splitBlend * logarithmic + (1.0f - splitBlend) * uniform;
+		}
+
+		// Pin the ends so rounding cannot open a gap at either plane
+		splitDistances[0] = nearDistance;
+		splitDistances[cascadeCount] = farDistance;
+	}
+
+	void ShadowCascadeBuilder::BuildCascades(const Camera& camera, const XMFLOAT3& lightDirection, const FrustumCuller::BoxArray* casters)
+	{
+		float nearDistance = camera.NearPlaneDistance();
+		float farDistance = camera.FarPlaneDistance();
+		if (mShadowDistance > nearDistance)
+		{
+			farDistance = (std::min)(farDistance, mShadowDistance);
+		}
+
+		ComputeSplitDistances(nearDistance, farDistance, mCascades.size(), mSplitBlend, mSplitDistances);
+
+		// Anchored at the origin so the texel grid stays put as the camera moves
+		XMVECTOR direction = XMVector3Normalize(XMLoadFloat3(&lightDirection));
+		XMVECTOR up = (std::fabs(XMVectorGetY(direction)) > 0.99f ? XMLoadFloat3(&Vector3Helper::Forward) : XMLoadFloat3(&Vector3Helper::Up));
+		XMMATRIX lightView = XMMatrixLookToRH(XMVectorZero(), direction, up);
+
+		if (casters != nullptr)
+		{
+			TransformCasters(lightView, *casters);
+		}
+		else
+		{
+			mCasterMinimums.clear();
+			mCasterMaximums.clear();
+		}
+
+		for (UINT i = 0; i < mCascades.size(); i++)
+		{
+			Cascade& cascade = mCascades[i];
+			cascade.NearDistance = mSplitDistances[i];
+			cascade.FarDistance = mSplitDistances[i + 1];
+			ComputeCorners(camera, cascade.NearDistance, &cascade.Corners[0]);
+			ComputeCorners(camera, cascade.FarDistance, &cascade.Corners[4]);
+
+			FitProjection(cascade, lightView);
+		}
+	}
+
+	void ShadowCascadeBuilder::TransformCasters(FXMMATRIX lightView, const FrustumCuller::BoxArray& casters)
+	{
+		UINT count = casters.Count();
+		mCasterMinimums.resize(count);
+		mCasterMaximums.resize(count);
+
+		// A box stays a box in light space; its extents there are the rotated extents summed by magnitude
+		XMVECTOR axisX = XMVectorAbs(lightView.r[0]);
+		XMVECTOR axisY = XMVectorAbs(lightView.r[1]);
+		XMVECTOR axisZ = XMVectorAbs(lightView.r[2]);
+
+		for (UINT i = 0; i < count; i++)
+		{
+			XMVECTOR minimum = XMVectorSet(casters.MinimumX[i], casters.MinimumY[i], casters.MinimumZ[i], 1.0f);
+			XMVECTOR maximum = XMVectorSet(casters.MaximumX[i], casters.MaximumY[i], casters.MaximumZ[i], 1.0f);
+			XMVECTOR center = XMVector3Transform(XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f), lightView);
+			XMVECTOR halfExtents = XMVectorScale(XMVectorSubtract(maximum, minimum), 0.5f);
+
+			XMVECTOR extents = XMVectorMultiply(XMVectorSplatX(halfExtents), axisX);
+			extents = XMVectorMultiplyAdd(XMVectorSplatY(halfExtents), axisY, extents);
+			extents = XMVectorMultiplyAdd(XMVectorSplatZ(halfExtents), axisZ, extents);
+
+			XMStoreFloat3(&mCasterMinimums[i], XMVectorSubtract(center, extents));
+			XMStoreFloat3(&mCasterMaximums[i], XMVectorAdd(center, extents));
+		}
+	}
+
+	void ShadowCascadeBuilder::FitProjection(Cascade& cascade, FXMMATRIX lightView)
+	{
+		XMVECTOR lower = XMVectorReplicate(FLT_MAX);
+		XMVECTOR upper = XMVectorReplicate(-FLT_MAX);
+		for (UINT i = 0; i < ARRAYSIZE(cascade.Corners); i++)
+		{
+			XMVECTOR corner = XMVector3Transform(XMLoadFloat3(&cascade.Corners[i]), lightView);
+			lower = XMVectorMin(lower, corner);
+			upper = XMVectorMax(upper, corner);
+		}
+
+		XMFLOAT3 minimum;
+		XMFLOAT3 maximum;
+		XMStoreFloat3(&minimum, lower);
+		XMStoreFloat3(&maximum, upper);
+
+		float extentX = maximum.x - minimum.x;
+		float extentY = maximum.y - minimum.y;
+
+		if (mFit == CascadeFitStable)
+		{
+			// No projection of the split is wider than its diameter, whichever way the camera faces
+			float diameter = 0.0f;
+			for (UINT i = 0; i < ARRAYSIZE(cascade.Corners); i++)
+			{
+				for (UINT j = i + 1; j < ARRAYSIZE(cascade.Corners); j++)
+				{
+					XMVECTOR span = XMVectorSubtract(XMLoadFloat3(&cascade.Corners[i]), XMLoadFloat3(&cascade.Corners[j]));
+					diameter = (std::max)(diameter, XMVectorGetX(XMVector3Length(span)));
+				}
+			}
+
+			minimum.x = (minimum.x + maximum.x - diameter) * 0.5f;
+			minimum.y = (minimum.y + maximum.y - diameter) * 0.5f;
+			extentX = diameter;
+			extentY = diameter;
+		}
+
+		// One texel of slack lets the lower bound snap down to the grid without the upper bound uncovering the split
+		float texelX = extentX / (mResolution - 1);
+		float texelY = extentY / (mResolution - 1);
+		minimum.x = std::floor(minimum.x / texelX) * texelX;
+		minimum.y = std::floor(minimum.y / texelY) * texelY;
+		maximum.x = minimum.x + texelX * mResolution;
+		maximum.y = minimum.y + texelY * mResolution;
+		cascade.TexelSize = (std::max)(texelX, texelY);
+
+		// Casters outside the split still shadow it if they lie between it and the light, which looks down negative z
+		cascade.Casters.clear();
+		for (UINT i = 0; i < mCasterMinimums.size(); i++)
+		{
+			const XMFLOAT3& casterMinimum = mCasterMinimums[i];
+			const XMFLOAT3& casterMaximum = mCasterMaximums[i];
+			if (casterMaximum.x < minimum.x || casterMinimum.x > maximum.x ||
+				casterMaximum.y < minimum.y || casterMinimum.y > maximum.y ||
+				casterMaximum.z < minimum.z)
+			{
+				continue;
+			}
+
+			cascade.Casters.push_back(i);
+			maximum.z = (std::max)(maximum.z, casterMaximum.z);
+		}
+
+		XMMATRIX projection = XMMatrixOrthographicOffCenterRH(minimum.x, maximum.x, minimum.y, maximum.y, -maximum.z, -minimum.z);
+		XMStoreFloat4x4(&cascade.ViewMatrix, lightView);
+		XMStoreFloat4x4(&cascade.ProjectionMatrix, projection);
+		XMStoreFloat4x4(&cascade.ViewProjectionMatrix, XMMatrixMultiply(lightView, projection));
+	}
+
+	void ShadowCascadeBuilder::ComputeCorners(const Camera& camera, float distance, XMFLOAT3* corners)
+	{
+		float halfHeight = distance * std::tan(camera.FieldOfView() * 0.5f);
+		float halfWidth = halfHeight * camera.AspectRatio();
+
+		XMVECTOR center = XMVectorAdd(camera.PositionVector(), XMVectorScale(camera.DirectionVector(), distance));
+		XMVECTOR up = XMVectorScale(camera.UpVector(), halfHeight);
+		XMVECTOR right = XMVectorScale(camera.RightVector(), halfWidth);
+
+		XMStoreFloat3(&corners[0], XMVectorSubtract(XMVectorAdd(center, up), right));
+		XMStoreFloat3(&corners[1], XMVectorAdd(XMVectorAdd(center, up), right));
+		XMStoreFloat3(&corners[2], XMVectorAdd(XMVectorSubtract(center, up), right));
+		XMStoreFloat3(&corners[3], XMVectorSubtract(XMVectorSubtract(center, up), right));
+	}
+}
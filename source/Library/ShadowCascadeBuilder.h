@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Common.h"
+#include "FrustumCuller.h"
+
+namespace Library
+{
+	class Camera;
+
+	enum CascadeFit
+	{
+		CascadeFitTight = 0,
+		CascadeFitStable
+	};
+
+	// Splits a camera's view range into cascades for a directional light and fits an orthographic light projection around
+	// each split. Split distances blend the logarithmic scheme, which matches texel density to perspective, with the uniform
+	// one, which keeps near cascades from becoming too thin. The light view is anchored at the world origin so its texel grid
+	// does not follow the camera, and every projection's bounds are snapped to whole texels, which stops shadow edges crawling
+	// as the camera moves. CascadeFitTight bounds each split exactly in light space and so wastes no resolution, but its texel
+	// size changes as the camera turns; CascadeFitStable sizes each cascade by its split's diameter instead, which does not
+	// depend on orientation and removes the remaining shimmer at some cost in resolution.
+	class ShadowCascadeBuilder
+	{
+	public:
+		struct Cascade
+		{
+			float NearDistance;				// Along the camera's view direction
+			float FarDistance;
+			float TexelSize;				// World units per shadow map texel, the larger of the two axes
+			XMFLOAT4X4 ViewMatrix;
+			XMFLOAT4X4 ProjectionMatrix;
+			XMFLOAT4X4 ViewProjectionMatrix;
+			XMFLOAT3 Corners[8];			// The split's slice of the view frustum; near face first, each face clockwise from top left
+			std::vector<UINT> Casters;		// Indices of the caster boxes that can shadow the split
+
+			Cascade()
+				: NearDistance(0.0f), FarDistance(0.0f), TexelSize(0.0f), Casters() { }
+		};
+
+		static const UINT MaxCascadeCount;
+		static const UINT DefaultCascadeCount;
+		static const UINT DefaultResolution;
+		static const float DefaultSplitBlend;
+
+		ShadowCascadeBuilder(UINT cascadeCount = DefaultCascadeCount, UINT resolution = DefaultResolution, float splitBlend = DefaultSplitBlend, CascadeFit fit = CascadeFitTight);
+
+		UINT CascadeCount() const;
+		void SetCascadeCount(UINT cascadeCount);
+
+		UINT Resolution() const;
+		void SetResolution(UINT resolution);
+
+		// Zero splits uniformly, one logarithmically
+		float SplitBlend() const;
+		void SetSplitBlend(float splitBlend);
+
+		CascadeFit Fit() const;
+		void SetFit(CascadeFit fit);
+
+		// Limits the shadowed range to less than the camera's far plane; zero uses the far plane
+		float ShadowDistance() const;
+		void SetShadowDistance(float shadowDistance);
+
+		void Build(const Camera& camera, const XMFLOAT3& lightDirection);
+		void Build(const Camera& camera, const XMFLOAT3& lightDirection, const FrustumCuller::BoxArray& casters);
+
+		const std::vector<Cascade>& Cascades() const;
+		void Validate() const;
+
+		static void ComputeSplitDistances(float nearDistance, float farDistance, UINT cascadeCount, float splitBlend, std::vector<float>& splitDistances);
+
+	private:
+		ShadowCascadeBuilder(const ShadowCascadeBuilder& rhs);
+		ShadowCascadeBuilder& operator=(const ShadowCascadeBuilder& rhs);
+
+		void BuildCascades(const Camera& camera, const XMFLOAT3& lightDirection, const FrustumCuller::BoxArray* casters);
+		void TransformCasters(FXMMATRIX lightView, const FrustumCuller::BoxArray& casters);
+		void FitProjection(Cascade& cascade, FXMMATRIX lightView);
+
+		static void ComputeCorners(const Camera& camera, float distance, XMFLOAT3* corners);
+
+		UINT mResolution;
+		float mSplitBlend;
+		CascadeFit mFit;
+		float mShadowDistance;
+		std::vector<Cascade> mCascades;
+		std::vector<float> mSplitDistances;
+		std::vector<XMFLOAT3> mCasterMinimums;		// Caster bounds in light view space
+		std::vector<XMFLOAT3> mCasterMaximums;
+	};
+}
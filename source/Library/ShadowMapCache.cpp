@@ -0,0 +1,152 @@
+#include "ShadowMapCache.h"
+#include "DepthMap.h"
+#include "Game.h"
+#include "GameException.h"
+
+namespace Library
+{
+	const UINT64 ShadowMapCache::HashOffsetBasis = 14695981039346656037ULL;
+	const UINT64 ShadowMapCache::HashPrime = 1099511628211ULL;
+
+	ShadowMapCache::ShadowMapCache(Game& game, UINT width, UINT height, bool hasDynamicLayer)
+		: mGame(&game), mStaticDepthMap(nullptr), mDynamicDepthMap(nullptr), mStaticDepthResource(nullptr), mDynamicDepthResource(nullptr),
+		  mStaticHash(HashOffsetBasis), mDynamicHash(HashOffsetBasis), mRenderedStaticHash(0), mRenderedDynamicHash(0),
+		  mIsStaticLayerValid(false), mIsDynamicLayerValid(false), mStatistics()
+	{
+		mStaticDepthMap = new DepthMap(game, width, height);
+
+		if (hasDynamicLayer)
+		{
+			mDynamicDepthMap = new DepthMap(game, width, height);
+			mStaticDepthResource = DepthResource(*mStaticDepthMap);
+			mDynamicDepthResource = DepthResource(*mDynamicDepthMap);
+		}
+	}
+
+	ShadowMapCache::~ShadowMapCache()
+	{
+		ReleaseObject(mDynamicDepthResource);
+		ReleaseObject(mStaticDepthResource);
+		DeleteObject(mDynamicDepthMap);
+		DeleteObject(mStaticDepthMap);
+	}
+
+	void ShadowMapCache::BeginFrame(CXMMATRIX lightViewProjection)
+	{
+		XMFLOAT4X4 matrix;
+		XMStoreFloat4x4(&matrix, lightViewProjection);
+
+		// The dynamic layer is built over the static one, so it inherits the light as well
+		mStaticHash = HashOffsetBasis;
+		Hash(mStaticHash, &matrix, sizeof(matrix));
+		mDynamicHash = mStaticHash;
+	}
+
+	void ShadowMapCache::AddCaster(CXMMATRIX worldMatrix, bool isVisible, ShadowCasterLayer layer)
+	{
+		UINT64& hash = (layer == ShadowCasterLayerDynamic && mDynamicDepthMap != nullptr ? mDynamicHash : mStaticHash);
+
+		byte visibility = (isVisible ? 1 : 0);
+		Hash(hash, &visibility, sizeof(visibility));
+
+		// A hidden caster's transform cannot affect the map
+		if (isVisible)
+		{
+			XMFLOAT4X4 matrix;
+			XMStoreFloat4x4(&matrix, worldMatrix);
+			Hash(hash, &matrix, sizeof(matrix));
+		}
+	}
+
+	void ShadowMapCache::Invalidate()
+	{
+		mIsStaticLayerValid = false;
+		mIsDynamicLayerValid = false;
+	}
+
+	bool ShadowMapCache::BeginStaticPass()
+	{
+		if (mIsStaticLayerValid && mStaticHash == mRenderedStaticHash)
+		{
+			mStatistics.StaticPassesSkipped++;
+			return false;
+		}
+
+		mStaticDepthMap->Begin();
+		mGame->Direct3DDeviceContext()->ClearDepthStencilView(mStaticDepthMap->DepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+
+		mRenderedStaticHash = mStaticHash;
+		mIsStaticLayerValid = true;
+		mIsDynamicLayerValid = false;
+		mStatistics.StaticPassCount++;
+
+		return true;
+	}
+
+	void ShadowMapCache::EndStaticPass()
+	{
+		mStaticDepthMap->End();
+	}
+
+	bool ShadowMapCache::BeginDynamicPass()
+	{
+		if (mDynamicDepthMap == nullptr)
+		{
+			return false;
+		}
+
+		if (mIsDynamicLayerValid && mDynamicHash == mRenderedDynamicHash)
+		{
+			mStatistics.DynamicPassesSkipped++;
+			return false;
+		}
+
+		mGame->Direct3DDeviceContext()->CopyResource(mDynamicDepthResource, mStaticDepthResource);
+		mDynamicDepthMap->Begin();
+
+		mRenderedDynamicHash = mDynamicHash;
+		mIsDynamicLayerValid = true;
+		mStatistics.DynamicPassCount++;
+
+		return true;
+	}
+
+	void ShadowMapCache::EndDynamicPass()
+	{
+		mDynamicDepthMap->End();
+	}
+
+	bool ShadowMapCache::HasDynamicLayer() const
+	{
+		return (mDynamicDepthMap != nullptr);
+	}
+
+	ID3D11ShaderResourceView* ShadowMapCache::OutputTexture() const
+	{
+		return (mDynamicDepthMap != nullptr ? mDynamicDepthMap->OutputTexture() : mStaticDepthMap->OutputTexture());
+	}
+
+	const ShadowMapCache::Statistics& ShadowMapCache::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void ShadowMapCache::Hash(UINT64& hash, const void* data, UINT size)
+	{
+		// FNV-1a
+		const byte* bytes = reinterpret_cast<const byte*>(data);
+		for (UINT i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= HashPrime;
+		}
+	}
+
+	ID3D11Resource* ShadowMapCache::DepthResource(const DepthMap& depthMap)
+	{
+		ID3D11Resource* resource = nullptr;
+		depthMap.DepthStencilView()->GetResource(&resource);
+
+		return resource;
+	}
+}
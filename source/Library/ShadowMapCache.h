@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	class Game;
+	class DepthMap;
+
+	enum ShadowCasterLayer
+	{
+		ShadowCasterLayerStatic = 0,
+		ShadowCasterLayerDynamic
+	};
+
+	// Keeps a shadow map's depth from one frame to the next and re-renders it only when something that affects it changes.
+	// Each frame the owner describes the shadow view: the light's view-projection, then every caster's world matrix and
+	// visibility, in a consistent order. These are hashed per layer and compared with the hashes the map was last rendered
+	// with, and BeginStaticPass / BeginDynamicPass return false when the layer's depth is still current, in which case the
+	// owner skips drawing it. With a dynamic layer, static casters are rendered once into their own map and each dynamic pass
+	// starts from a copy of it, so moving casters never force the static geometry to be drawn again. Anything else that
+	// changes the depth (rasterizer bias, technique) is the owner's to report through Invalidate.
+	class ShadowMapCache
+	{
+	public:
+		struct Statistics
+		{
+			UINT StaticPassCount;
+			UINT StaticPassesSkipped;
+			UINT DynamicPassCount;
+			UINT DynamicPassesSkipped;
+
+			Statistics()
+				: StaticPassCount(0), StaticPassesSkipped(0), DynamicPassCount(0), DynamicPassesSkipped(0) { }
+		};
+
+		ShadowMapCache(Game& game, UINT width, UINT height, bool hasDynamicLayer = false);
+		~ShadowMapCache();
+
+		void BeginFrame(CXMMATRIX lightViewProjection);
+
+		// Without a dynamic layer, dynamic casters are tracked with the static ones
+		void AddCaster(CXMMATRIX worldMatrix, bool isVisible = true, ShadowCasterLayer layer = ShadowCasterLayerStatic);
+		void Invalidate();
+
+		// When these return true the layer's depth map is bound (cleared, or holding the static depth for the dynamic layer)
+		// and its casters must be drawn before the matching End call
+		bool BeginStaticPass();
+		void EndStaticPass();
+		bool BeginDynamicPass();
+		void EndDynamicPass();
+
+		bool HasDynamicLayer() const;
+		ID3D11ShaderResourceView* OutputTexture() const;
+		const Statistics& GetStatistics() const;
+
+	private:
+		ShadowMapCache();
+		ShadowMapCache(const ShadowMapCache& rhs);
+		ShadowMapCache& operator=(const ShadowMapCache& rhs);
+
+		static void Hash(UINT64& hash, const void* data, UINT size);
+		static ID3D11Resource* DepthResource(const DepthMap& depthMap);
+
+		static const UINT64 HashOffsetBasis;
+		static const UINT64 HashPrime;
+
+		Game* mGame;
+		DepthMap* mStaticDepthMap;
+		DepthMap* mDynamicDepthMap;
+		ID3D11Resource* mStaticDepthResource;
+		ID3D11Resource* mDynamicDepthResource;
+
+		UINT64 mStaticHash;
+		UINT64 mDynamicHash;
+		UINT64 mRenderedStaticHash;
+		UINT64 mRenderedDynamicHash;
+		bool mIsStaticLayerValid;
+		bool mIsDynamicLayerValid;
+		Statistics mStatistics;
+	};
+}
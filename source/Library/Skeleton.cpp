@@ -0,0 +1,158 @@
+#include "Skeleton.h"
+#include "Bone.h"
+#include "SceneNode.h"
+#include "MemoryArena.h"
+#include "GameException.h"
+#include "scene.h"
+
+namespace Library
+{
+	Skeleton::Skeleton()
+		: mArena(new MemoryArena()), mBones(), mBoneIndexMapping(), mRootNode(nullptr), mHierarchy(), mRootTransform(), mBoneTransforms()
+	{
+	}
+
+	Skeleton::~Skeleton()
+	{
+		// Bones and scene nodes, including bones that never appear in the node tree, are destroyed with the arena
+	}
+
+	const std::vector<Bone*>& Skeleton::Bones() const
+	{
+		return mBones;
+	}
+
+	const std::map<std::string, UINT>& Skeleton::BoneIndexMapping() const
+	{
+		return mBoneIndexMapping;
+	}
+
+	SceneNode* Skeleton::RootNode() const
+	{
+		return mRootNode;
+	}
+
+	UINT Skeleton::BoneCount() const
+	{
+		return mBones.size();
+	}
+
+	bool Skeleton::HasHierarchy() const
+	{
+		return (mRootNode != nullptr);
+	}
+
+	const TransformHierarchy& Skeleton::Hierarchy() const
+	{
+		return mHierarchy;
+	}
+
+	TransformHierarchy::Handle Skeleton::RootTransform() const
+	{
+		return mRootTransform;
+	}
+
+	const std::vector<TransformHierarchy::Handle>& Skeleton::BoneTransforms() const
+	{
+		return mBoneTransforms;
+	}
+
+	bool Skeleton::TryGetBoneIndex(const std::string& boneName, UINT& boneIndex) const
+	{
+		auto boneMapping = mBoneIndexMapping.find(boneName);
+		if (boneMapping == mBoneIndexMapping.end())
+		{
+			return false;
+		}
+
+		boneIndex = boneMapping->second;
+		return true;
+	}
+
+	UINT Skeleton::AddBone(const std::string& boneName, const XMFLOAT4X4& offsetTransform)
+	{
+		assert(mBoneIndexMapping.find(boneName) == mBoneIndexMapping.end());
+
+		UINT boneIndex = mBones.size();
+		mBones.push_back(mArena->Create<Bone>(boneName, boneIndex, offsetTransform));
+		mBoneIndexMapping[boneName] = boneIndex;
+
+		return boneIndex;
+	}
+
+	void Skeleton::BuildHierarchy(aiNode& rootNode)
+	{
+		if (mRootNode != nullptr)
+		{
+			throw GameException("Skeleton hierarchy has already been built.");
+		}
+
+		mBoneTransforms.assign(mBones.size(), TransformHierarchy::InvalidHandle);
+		mRootNode = BuildHierarchy(rootNode, nullptr, TransformHierarchy::InvalidHandle);
+		mRootTransform = mHierarchy.HandleAt(0);
+		mHierarchy.Update();
+	}
+
+	SceneNode* Skeleton::BuildHierarchy(aiNode& node, SceneNode* parentSceneNode, TransformHierarchy::Handle parentTransform)
+	{
+		SceneNode* sceneNode = nullptr;
+
+		auto boneMapping = mBoneIndexMapping.find(node.mName.C_Str());
+		if (boneMapping == mBoneIndexMapping.end())
+		{
+			sceneNode = mArena->Create<SceneNode>(node.mName.C_Str());
+		}
+		else
+		{
+			sceneNode = mBones[boneMapping->second];
+		}
+
+		XMFLOAT4X4 nodeTransform(reinterpret_cast<const float*>(node.mTransformation[0]));
+		sceneNode->SetTransform(XMMatrixTranspose(XMLoadFloat4x4(&nodeTransform)));
+		sceneNode->SetParent(parentSceneNode);
+
+		// Depth-first creation leaves the hierarchy in topological order
+		TransformHierarchy::Handle transform = mHierarchy.Create(parentTransform, sceneNode->Transform());
+		if (boneMapping != mBoneIndexMapping.end())
+		{
+			mBoneTransforms[boneMapping->second] = transform;
+		}
+
+		sceneNode->Children().reserve(node.mNumChildren);
+		for (UINT i = 0; i < node.mNumChildren; i++)
+		{
+			SceneNode* childSceneNode = BuildHierarchy(*(node.mChildren[i]), sceneNode, transform);
+			sceneNode->Children().push_back(childSceneNode);
+		}
+
+		return sceneNode;
+	}
+
+	size_t Skeleton::EstimateArenaSize(const aiScene& scene)
+	{
+		// Nodes that turn out to be bones are counted twice; the slack is small next to a block
+		size_t size = 0;
+
+		std::vector<const aiNode*> nodes;
+		if (scene.mRootNode != nullptr)
+		{
+			nodes.push_back(scene.mRootNode);
+		}
+
+		while (nodes.size() > 0)
+		{
+			const aiNode* node = nodes.back();
+			nodes.pop_back();
+
+			size += sizeof(SceneNode);
+			nodes.insert(nodes.end(), node->mChildren, node->mChildren + node->mNumChildren);
+		}
+
+		for (UINT i = 0; i < scene.mNumMeshes; i++)
+		{
+			size += scene.mMeshes[i]->mNumBones * sizeof(Bone);
+		}
+
+		return size;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Common.h"
+#include "TransformHierarchy.h"
+
+struct aiNode;
+struct aiScene;
+
+namespace Library
+{
+	class SceneNode;
+	class Bone;
+	class MemoryArena;
+
+	// A bone hierarchy that can be shared between every Model built on the same rig.
+	// Animation clips are bound to a skeleton by bone index rather than by Bone pointer.
+	// Bones and scene nodes are allocated from the skeleton's own arena, so a skeleton shared between models stays
+	// independent of whichever model first loaded it.
+	class Skeleton
+	{
+		friend class Model;
+		friend class Mesh;
+
+	public:
+		Skeleton();
+		~Skeleton();
+
+		const std::vector<Bone*>& Bones() const;
+		const std::map<std::string, UINT>& BoneIndexMapping() const;
+		SceneNode* RootNode() const;
+		UINT BoneCount() const;
+		bool HasHierarchy() const;
+
+		const TransformHierarchy& Hierarchy() const;
+		TransformHierarchy::Handle RootTransform() const;
+		const std::vector<TransformHierarchy::Handle>& BoneTransforms() const;
+
+		bool TryGetBoneIndex(const std::string& boneName, UINT& boneIndex) const;
+
+	private:
+		Skeleton(const Skeleton& rhs);
+		Skeleton& operator=(const Skeleton& rhs);
+
+		UINT AddBone(const std::string& boneName, const XMFLOAT4X4& offsetTransform);
+		void BuildHierarchy(aiNode& rootNode);
+		SceneNode* BuildHierarchy(aiNode& node, SceneNode* parentSceneNode, TransformHierarchy::Handle parentTransform);
+
+		static size_t EstimateArenaSize(const aiScene& scene);
+
+		std::unique_ptr<MemoryArena> mArena;
+		std::vector<Bone*> mBones;
+		std::map<std::string, UINT> mBoneIndexMapping;
+		SceneNode* mRootNode;
+		TransformHierarchy mHierarchy;
+		TransformHierarchy::Handle mRootTransform;
+		std::vector<TransformHierarchy::Handle> mBoneTransforms;	// Indexed by bone index; invalid for bones absent from the node tree
+	};
+}
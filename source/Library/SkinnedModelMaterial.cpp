@@ -75,15 +75,15 @@ namespace Library
 			XMFLOAT3 position = sourceVertices.at(i);
 			XMFLOAT3 uv = textureCoordinates->at(i);
 			XMFLOAT3 normal = normals.at(i);
-			BoneVertexWeights vertexWeights = boneWeights.at(i);
+			const BoneVertexWeights& vertexWeights = boneWeights.at(i);
 
 			float weights[BoneVertexWeights::MaxBoneWeightsPerVertex];
 			UINT indices[BoneVertexWeights::MaxBoneWeightsPerVertex];
 			ZeroMemory(weights, sizeof(float) * ARRAYSIZE(weights));
 			ZeroMemory(indices, sizeof(UINT) * ARRAYSIZE(indices));
-			for (UINT i = 0; i < vertexWeights.Weights().size(); i++)
+			for (UINT i = 0; i < vertexWeights.WeightCount(); i++)
 			{
-				BoneVertexWeights::VertexWeight vertexWeight = vertexWeights.Weights().at(i);
+				const BoneVertexWeights::VertexWeight& vertexWeight = vertexWeights.WeightAt(i);
 				weights[i] = vertexWeight.Weight;
 				indices[i] = vertexWeight.BoneIndex;
 			}
@@ -5,9 +5,11 @@
 #include "Camera.h"
 #include "MatrixHelper.h"
 #include "Model.h"
+#include "ModelCache.h"
 #include "Mesh.h"
 #include "Utility.h"
-#include <DDSTextureLoader.h>
+#include "RenderPipeline.h"
+#include "AssetLoader.h"
 
 namespace Library
 {
@@ -17,9 +19,13 @@ namespace Library
 		: DrawableGameComponent(game, camera),
 		mCubeMapFileName(cubeMapFileName), mEffect(nullptr), mMaterial(nullptr),
 		mCubeMapShaderResourceView(nullptr), mVertexBuffer(nullptr), mIndexBuffer(nullptr), mIndexCount(0),
-		mWorldMatrix(MatrixHelper::Identity), mScaleMatrix(MatrixHelper::Identity)
+		mWorldMatrix(MatrixHelper::Identity), mScaleMatrix(MatrixHelper::Identity), mWorldMatrixSlot(0)
 	{
 		XMStoreFloat4x4(&mScaleMatrix, XMMatrixScaling(scale, scale, scale));
+
+		DeclareModel("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
+		DeclareEffect(L"Content\\Effects\\Skybox.cso");
+		DeclareTexture(mCubeMapFileName);
 	}
 
 	Skybox::~Skybox()
@@ -35,7 +41,7 @@ namespace Library
 	{
 		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
 
-		std::unique_ptr<Model> model(new Model(*mGame, "..\\source\\Library\\Content\\Models\\Sphere.obj", true));
+		std::shared_ptr<Model> model = mGame->Models().Load("..\\source\\Library\\Content\\Models\\Sphere.obj", true);
 
 		mEffect = new Effect(*mGame);
 		mEffect->LoadCompiledEffect(L"Content\\Effects\\Skybox.cso");
@@ -48,11 +54,9 @@ namespace Library
 		mesh->CreateIndexBuffer(&mIndexBuffer);
 		mIndexCount = mesh->Indices().size();
 
-		HRESULT hr = DirectX::CreateDDSTextureFromFile(mGame->Direct3DDevice(), mCubeMapFileName.c_str(), nullptr, &mCubeMapShaderResourceView);
-		if (FAILED(hr))
-		{
-			throw GameException("CreateDDSTextureFromFile() failed.", hr);
-		}
+		mCubeMapShaderResourceView = mGame->Assets().AcquireTexture(mCubeMapFileName);
+
+		mWorldMatrixSlot = mGame->Pipeline().AllocateTransforms();
 	}
 
 	void Skybox::Update(const GameTime& gameTime)
@@ -62,6 +66,11 @@ namespace Library
 		XMStoreFloat4x4(&mWorldMatrix, XMLoadFloat4x4(&mScaleMatrix) * XMMatrixTranslation(position.x, position.y, position.z));
 	}
 
+	void Skybox::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		snapshot.SetTransform(mWorldMatrixSlot, mWorldMatrix);
+	}
+
 	void Skybox::Draw(const GameTime& gametime)
 	{
 		ID3D11DeviceContext* direct3DDeviceContext = mGame->Direct3DDeviceContext();
@@ -76,7 +85,8 @@ namespace Library
 		direct3DDeviceContext->IASetVertexBuffers(0, 1, &mVertexBuffer, &stride, &offset);
 		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
-		XMMATRIX wvp = XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewMatrix() * mCamera->ProjectionMatrix();
+		const RenderSnapshot& snapshot = mGame->Pipeline().Current();
+		XMMATRIX wvp = snapshot.TransformMatrix(mWorldMatrixSlot) * XMLoadFloat4x4(&snapshot.View().ViewProjectionMatrix);
 		mMaterial->WorldViewProjection() << wvp;
 		mMaterial->SkyboxTexture() << mCubeMapShaderResourceView;
 
@@ -84,4 +94,9 @@ namespace Library
 
 		direct3DDeviceContext->DrawIndexed(mIndexCount, 0, 0);
 	}
+
+	bool Skybox::DrawsFromSnapshot() const
+	{
+		return true;
+	}
 }
\ No newline at end of file
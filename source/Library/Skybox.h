@@ -18,7 +18,9 @@ namespace Library
 
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
 		virtual void Draw(const GameTime& gameTime) override;
+		virtual bool DrawsFromSnapshot() const override;
 
 	private:
 		Skybox();
@@ -35,5 +37,6 @@ namespace Library
 
 		XMFLOAT4X4 mWorldMatrix;
 		XMFLOAT4X4 mScaleMatrix;
+		UINT mWorldMatrixSlot;
 	};
 }
\ No newline at end of file
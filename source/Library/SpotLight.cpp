@@ -48,7 +48,7 @@ namespace Library
 		return XMLoadFloat3(&mRight);
 	}
 
-	float SpotLight::InnerAngle()
+	float SpotLight::InnerAngle() const
 	{
 		return mInnerAngle;
 	}
@@ -58,7 +58,7 @@ namespace Library
 		mInnerAngle = value;
 	}
 
-	float SpotLight::OuterAngle()
+	float SpotLight::OuterAngle() const
 	{
 		return mOuterAngle;
 	}
@@ -21,10 +21,10 @@ namespace Library
 		XMVECTOR UpVector() const;
 		XMVECTOR RightVector() const;
 
-		float InnerAngle();
+		float InnerAngle() const;
 		void SetInnerAngle(float value);
 
-		float OuterAngle();
+		float OuterAngle() const;
 		void SetOuterAngle(float value);
 
 		void ApplyRotation(CXMMATRIX transform);
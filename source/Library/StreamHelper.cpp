@@ -0,0 +1,27 @@
+#include "StreamHelper.h"
+
+namespace Library
+{
+	void StreamHelper::WriteString(std::ostream& stream, const std::string& value)
+	{
+		UINT length = value.size();
+		Write(stream, length);
+		stream.write(value.c_str(), length);
+	}
+
+	void StreamHelper::ReadString(std::istream& stream, std::string& value)
+	{
+		UINT length;
+		Read(stream, length);
+
+		value.resize(length);
+		if (length > 0)
+		{
+			stream.read(&value[0], length);
+			if (stream.fail())
+			{
+				throw GameException("Unexpected end of stream.");
+			}
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Common.h"
+#include "GameException.h"
+#include <iostream>
+
+namespace Library
+{
+	class StreamHelper
+	{
+	public:
+		template <typename T>
+		static void Write(std::ostream& stream, const T& value)
+		{
+			stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		template <typename T>
+		static void Read(std::istream& stream, T& value)
+		{
+			stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+			if (stream.fail())
+			{
+				throw GameException("Unexpected end of stream.");
+			}
+		}
+
+		static void WriteString(std::ostream& stream, const std::string& value);
+		static void ReadString(std::istream& stream, std::string& value);
+
+	private:
+		StreamHelper();
+		StreamHelper(const StreamHelper& rhs);
+		StreamHelper& operator=(const StreamHelper& rhs);
+	};
+}
@@ -0,0 +1,343 @@
+#include "StreamingAnimationLibrary.h"
+#include "ClockSource.h"
+#include "AnimationClipArchive.h"
+#include "AnimationClip.h"
+#include "Skeleton.h"
+#include "GameException.h"
+#include "Utility.h"
+
+namespace Library
+{
+	StreamingAnimationLibrary::StreamingAnimationLibrary(std::shared_ptr<Skeleton> skeleton, const std::string& archiveFilename, size_t memoryBudget)
+		: mSkeleton(skeleton), mArchive(nullptr), mClipSlots(), mLeastRecentlyUsed(), mMemoryBudget(memoryBudget), mStatistics(),
+		mOwnerThreadId(std::this_thread::get_id())
+	{
+		if (mSkeleton == nullptr)
+		{
+			throw GameException("A streaming animation library requires a skeleton.");
+		}
+
+		mArchive = new AnimationClipArchive(archiveFilename);
+		if (mArchive->BoneCount() != mSkeleton->BoneCount())
+		{
+			DeleteObject(mArchive);
+			throw GameException("Animation clip archive was written for a different skeleton.");
+		}
+
+		mClipSlots.reserve(mArchive->Entries().size());
+		for (UINT i = 0; i < mArchive->Entries().size(); i++)
+		{
+			mClipSlots.push_back(new ClipSlot());
+		}
+	}
+
+	StreamingAnimationLibrary::~StreamingAnimationLibrary()
+	{
+		for (ClipSlot* slot : mClipSlots)
+		{
+			assert(slot->PinCount == 0);
+
+			if (slot->PendingClip.valid())
+			{
+				try
+				{
+					delete slot->PendingClip.get();
+				}
+				catch (...)
+				{
+				}
+			}
+
+			DeleteObject(slot->Clip);
+			delete slot;
+		}
+
+		DeleteObject(mArchive);
+	}
+
+	std::shared_ptr<Skeleton> StreamingAnimationLibrary::GetSkeleton() const
+	{
+		return mSkeleton;
+	}
+
+	const AnimationClipArchive& StreamingAnimationLibrary::Archive() const
+	{
+		return *mArchive;
+	}
+
+	bool StreamingAnimationLibrary::HasClip(const std::string& clipName) const
+	{
+		UINT entryIndex;
+		return mArchive->TryGetEntryIndex(clipName, entryIndex);
+	}
+
+	bool StreamingAnimationLibrary::IsResident(const std::string& clipName) const
+	{
+		UINT entryIndex;
+		return (mArchive->TryGetEntryIndex(clipName, entryIndex) && mClipSlots[entryIndex]->Clip != nullptr);
+	}
+
+	size_t StreamingAnimationLibrary::MemoryBudget() const
+	{
+		return mMemoryBudget;
+	}
+
+	void StreamingAnimationLibrary::SetMemoryBudget(size_t memoryBudget)
+	{
+		assert(std::this_thread::get_id() == mOwnerThreadId);
+
+		mMemoryBudget = memoryBudget;
+		EvictToBudget();
+	}
+
+	AnimationClip* StreamingAnimationLibrary::Acquire(const std::string& clipName)
+	{
+		assert(std::this_thread::get_id() == mOwnerThreadId);
+
+		UINT entryIndex = GetEntryIndex(clipName);
+		ClipSlot& slot = *(mClipSlots[entryIndex]);
+
+		if (slot.Clip == nullptr && slot.PendingClip.valid() && slot.PendingClip.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			// A finished prefetch is a hit; there is nothing to wait for
+			AnimationClip* clip = TakePrefetch(slot);
+			if (clip != nullptr)
+			{
+				MakeResident(entryIndex, clip);
+			}
+		}
+
+		if (slot.Clip != nullptr)
+		{
+			mStatistics.Hits++;
+		}
+		else
+		{
+			mStatistics.Misses++;
+
+			double startTime = RealClockSource::Milliseconds();
+			AnimationClip* clip = nullptr;
+			if (slot.PendingClip.valid())
+			{
+				clip = TakePrefetch(slot);
+			}
+
+			// A clip whose prefetch failed is read again here, where the caller can see the exception
+			if (clip == nullptr)
+			{
+				clip = mArchive->ReadClip(entryIndex, *mSkeleton);
+			}
+
+			double stallTime = RealClockSource::Milliseconds() - startTime;
+			mStatistics.Stalls++;
+			mStatistics.StallMilliseconds += stallTime;
+			if (stallTime > mStatistics.MaxStallMilliseconds)
+			{
+				mStatistics.MaxStallMilliseconds = stallTime;
+			}
+
+			MakeResident(entryIndex, clip);
+		}
+
+		if (slot.PinCount == 0)
+		{
+			mStatistics.PinnedClipCount++;
+		}
+
+		slot.PinCount++;
+		if (slot.IsInLeastRecentlyUsed)
+		{
+			mLeastRecentlyUsed.erase(slot.LeastRecentlyUsedPosition);
+			slot.IsInLeastRecentlyUsed = false;
+		}
+
+		EvictToBudget();
+
+		return slot.Clip;
+	}
+
+	void StreamingAnimationLibrary::Release(const AnimationClip& clip)
+	{
+		assert(std::this_thread::get_id() == mOwnerThreadId);
+
+		UINT entryIndex = GetEntryIndex(clip.Name());
+		ClipSlot& slot = *(mClipSlots[entryIndex]);
+
+		assert(slot.Clip == &clip);
+		assert(slot.PinCount > 0);
+
+		slot.PinCount--;
+		if (slot.PinCount == 0)
+		{
+			mStatistics.PinnedClipCount--;
+
+			slot.LeastRecentlyUsedPosition = mLeastRecentlyUsed.insert(mLeastRecentlyUsed.end(), entryIndex);
+			slot.IsInLeastRecentlyUsed = true;
+
+			EvictToBudget();
+		}
+	}
+
+	void StreamingAnimationLibrary::Prefetch(const std::string& clipName)
+	{
+		assert(std::this_thread::get_id() == mOwnerThreadId);
+
+		UINT entryIndex = GetEntryIndex(clipName);
+		ClipSlot& slot = *(mClipSlots[entryIndex]);
+
+		if (slot.Clip != nullptr)
+		{
+			if (slot.IsInLeastRecentlyUsed)
+			{
+				mLeastRecentlyUsed.splice(mLeastRecentlyUsed.end(), mLeastRecentlyUsed, slot.LeastRecentlyUsedPosition);
+			}
+
+			return;
+		}
+
+		if (slot.PendingClip.valid() == false)
+		{
+			const AnimationClipArchive* archive = mArchive;
+			std::shared_ptr<Skeleton> skeleton = mSkeleton;
+			slot.PendingClip = std::async(std::launch::async, [archive, skeleton, entryIndex]()
+			{
+				return archive->ReadClip(entryIndex, *skeleton);
+			});
+
+			mStatistics.Prefetches++;
+			mStatistics.PendingClipCount++;
+		}
+	}
+
+	void StreamingAnimationLibrary::Update()
+	{
+		assert(std::this_thread::get_id() == mOwnerThreadId);
+
+		CompletePrefetches();
+		EvictToBudget();
+	}
+
+	const StreamingAnimationLibrary::Statistics& StreamingAnimationLibrary::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void StreamingAnimationLibrary::ResetCounters()
+	{
+		assert(std::this_thread::get_id() == mOwnerThreadId);
+
+		mStatistics.PeakResidentBytes = mStatistics.ResidentBytes;
+		mStatistics.Hits = 0;
+		mStatistics.Misses = 0;
+		mStatistics.Prefetches = 0;
+		mStatistics.FailedPrefetches = 0;
+		mStatistics.Evictions = 0;
+		mStatistics.Stalls = 0;
+		mStatistics.StallMilliseconds = 0.0;
+		mStatistics.MaxStallMilliseconds = 0.0;
+	}
+
+	UINT StreamingAnimationLibrary::GetEntryIndex(const std::string& clipName) const
+	{
+		UINT entryIndex;
+		if (mArchive->TryGetEntryIndex(clipName, entryIndex) == false)
+		{
+			throw GameException("Animation clip not found in archive.");
+		}
+
+		return entryIndex;
+	}
+
+	AnimationClip* StreamingAnimationLibrary::TakePrefetch(ClipSlot& slot)
+	{
+		assert(slot.PendingClip.valid());
+
+		// The future is spent whether or not get throws, so the count is settled first
+		mStatistics.PendingClipCount--;
+
+		std::string error;
+		try
+		{
+			return slot.PendingClip.get();
+		}
+		catch (const std::exception& exception)
+		{
+			error = exception.what();
+		}
+		catch (...)
+		{
+			error = "Animation clip prefetch failed.";
+		}
+
+		mStatistics.FailedPrefetches++;
+
+#if defined( DEBUG ) || defined( _DEBUG )
+		OutputDebugString(Utility::ToWideString("Animation clip prefetch failed: " + error + "\n").c_str());
+#endif
+
+		return nullptr;
+	}
+
+	void StreamingAnimationLibrary::MakeResident(UINT entryIndex, AnimationClip* clip)
+	{
+		ClipSlot& slot = *(mClipSlots[entryIndex]);
+		assert(slot.Clip == nullptr);
+
+		slot.Clip = clip;
+		slot.SizeInBytes = clip->SizeInBytes();
+
+		mStatistics.ResidentClipCount++;
+		mStatistics.ResidentBytes += slot.SizeInBytes;
+		if (mStatistics.ResidentBytes > mStatistics.PeakResidentBytes)
+		{
+			mStatistics.PeakResidentBytes = mStatistics.ResidentBytes;
+		}
+	}
+
+	void StreamingAnimationLibrary::CompletePrefetches()
+	{
+		if (mStatistics.PendingClipCount == 0)
+		{
+			return;
+		}
+
+		for (UINT i = 0; i < mClipSlots.size(); i++)
+		{
+			ClipSlot& slot = *(mClipSlots[i]);
+			if (slot.PendingClip.valid() && slot.PendingClip.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			{
+				AnimationClip* clip = TakePrefetch(slot);
+				if (clip == nullptr)
+				{
+					continue;
+				}
+
+				MakeResident(i, clip);
+
+				// Prefetched clips are unpinned and most recently used
+				slot.LeastRecentlyUsedPosition = mLeastRecentlyUsed.insert(mLeastRecentlyUsed.end(), i);
+				slot.IsInLeastRecentlyUsed = true;
+			}
+		}
+	}
+
+	void StreamingAnimationLibrary::EvictToBudget()
+	{
+		while (mStatistics.ResidentBytes > mMemoryBudget && mLeastRecentlyUsed.empty() == false)
+		{
+			UINT entryIndex = mLeastRecentlyUsed.front();
+			mLeastRecentlyUsed.pop_front();
+
+			ClipSlot& slot = *(mClipSlots[entryIndex]);
+			assert(slot.PinCount == 0);
+
+			DeleteObject(slot.Clip);
+			slot.IsInLeastRecentlyUsed = false;
+
+			mStatistics.ResidentClipCount--;
+			mStatistics.ResidentBytes -= slot.SizeInBytes;
+			mStatistics.Evictions++;
+			slot.SizeInBytes = 0;
+		}
+	}
+}
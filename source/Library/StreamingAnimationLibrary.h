@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Common.h"
+#include <list>
+#include <future>
+#include <thread>
+
+namespace Library
+{
+	class Skeleton;
+	class AnimationClip;
+	class AnimationClipArchive;
+
+	// Animation clips decoded on demand from an AnimationClipArchive. Acquired clips are pinned until released;
+	// unpinned clips stay resident until the memory budget forces them out in least-recently-used order.
+	// All members must be called from the thread that created the library, which debug builds assert; only decoding for
+	// Prefetch runs on a worker. A prefetch that fails is counted and forgotten rather than thrown from Update, so the
+	// next Acquire or Prefetch of that clip reads it again.
+	class StreamingAnimationLibrary
+	{
+	public:
+		struct Statistics
+		{
+			UINT ResidentClipCount;
+			UINT PinnedClipCount;
+			UINT PendingClipCount;
+			size_t ResidentBytes;
+			size_t PeakResidentBytes;
+			UINT Hits;
+			UINT Misses;			// Acquires that had to decode or wait on a prefetch
+			UINT Prefetches;
+			UINT FailedPrefetches;
+			UINT Evictions;
+			UINT Stalls;
+			double StallMilliseconds;
+			double MaxStallMilliseconds;
+
+			Statistics()
+				: ResidentClipCount(0), PinnedClipCount(0), PendingClipCount(0), ResidentBytes(0), PeakResidentBytes(0),
+				Hits(0), Misses(0), Prefetches(0), FailedPrefetches(0), Evictions(0), Stalls(0), StallMilliseconds(0.0), MaxStallMilliseconds(0.0) { }
+		};
+
+		StreamingAnimationLibrary(std::shared_ptr<Skeleton> skeleton, const std::string& archiveFilename, size_t memoryBudget);
+		~StreamingAnimationLibrary();
+
+		std::shared_ptr<Skeleton> GetSkeleton() const;
+		const AnimationClipArchive& Archive() const;
+		bool HasClip(const std::string& clipName) const;
+		bool IsResident(const std::string& clipName) const;
+
+		size_t MemoryBudget() const;
+		void SetMemoryBudget(size_t memoryBudget);
+
+		AnimationClip* Acquire(const std::string& clipName);
+		void Release(const AnimationClip& clip);
+		void Prefetch(const std::string& clipName);
+		void Update();
+
+		const Statistics& GetStatistics() const;
+		void ResetCounters();
+
+	private:
+		struct ClipSlot
+		{
+			AnimationClip* Clip;
+			std::future<AnimationClip*> PendingClip;
+			size_t SizeInBytes;
+			UINT PinCount;
+			bool IsInLeastRecentlyUsed;
+			std::list<UINT>::iterator LeastRecentlyUsedPosition;
+
+			ClipSlot()
+				: Clip(nullptr), PendingClip(), SizeInBytes(0), PinCount(0), IsInLeastRecentlyUsed(false), LeastRecentlyUsedPosition() { }
+		};
+
+		StreamingAnimationLibrary();
+		StreamingAnimationLibrary(const StreamingAnimationLibrary& rhs);
+		StreamingAnimationLibrary& operator=(const StreamingAnimationLibrary& rhs);
+
+		UINT GetEntryIndex(const std::string& clipName) const;
+		AnimationClip* TakePrefetch(ClipSlot& slot);
+		void MakeResident(UINT entryIndex, AnimationClip* clip);
+		void CompletePrefetches();
+		void EvictToBudget();
+
+		std::shared_ptr<Skeleton> mSkeleton;
+		AnimationClipArchive* mArchive;
+		std::vector<ClipSlot*> mClipSlots;			// Indexed by archive entry
+		std::list<UINT> mLeastRecentlyUsed;			// Resident, unpinned entries; front is evicted first
+		size_t mMemoryBudget;
+		Statistics mStatistics;
+		std::thread::id mOwnerThreadId;
+	};
+}
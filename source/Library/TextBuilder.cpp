@@ -0,0 +1,92 @@
+#include "TextBuilder.h"
+#include <algorithm>
+
+namespace Library
+{
+	const UINT TextBuilder::DefaultCapacity = 256;
+	const UINT TextBuilder::DefaultPrecision = 6;
+
+	TextBuilder::TextBuilder(MemoryArena& arena, UINT capacity)
+		: mCharacters(ArenaAllocator<wchar_t>(arena)), mPrecision(DefaultPrecision)
+	{
+		mCharacters.reserve(capacity + 1);
+		mCharacters.push_back(L'\0');
+	}
+
+	const wchar_t* TextBuilder::Text() const
+	{
+		return &mCharacters[0];
+	}
+
+	UINT TextBuilder::Length() const
+	{
+		return mCharacters.size() - 1;
+	}
+
+	UINT TextBuilder::Precision() const
+	{
+		return mPrecision;
+	}
+
+	void TextBuilder::SetPrecision(UINT precision)
+	{
+		mPrecision = precision;
+	}
+
+	TextBuilder& TextBuilder::operator<<(const wchar_t* text)
+	{
+		Append(text, wcslen(text));
+
+		return *this;
+	}
+
+	TextBuilder& TextBuilder::operator<<(const char* text)
+	{
+		mCharacters.pop_back();
+		for (const char* character = text; *character != '\0'; ++character)
+		{
+			mCharacters.push_back(static_cast<wchar_t>(static_cast<unsigned char>(*character)));
+		}
+
+		mCharacters.push_back(L'\0');
+
+		return *this;
+	}
+
+	TextBuilder& TextBuilder::operator<<(int value)
+	{
+		wchar_t buffer[16];
+		int length = swprintf_s(buffer, L"%d", value);
+		Append(buffer, length);
+
+		return *this;
+	}
+
+	TextBuilder& TextBuilder::operator<<(UINT value)
+	{
+		wchar_t buffer[16];
+		int length = swprintf_s(buffer, L"%u", value);
+		Append(buffer, length);
+
+		return *this;
+	}
+
+	TextBuilder& TextBuilder::operator<<(float value)
+	{
+		return (*this << static_cast<double>(value));
+	}
+
+	TextBuilder& TextBuilder::operator<<(double value)
+	{
+		wchar_t buffer[64];
+		int length = swprintf_s(buffer, L"%.*g", static_cast<int>((std::min)(mPrecision, 17U)), value);
+		Append(buffer, length);
+
+		return *this;
+	}
+
+	void TextBuilder::Append(const wchar_t* text, UINT length)
+	{
+		mCharacters.insert(mCharacters.end() - 1, text, text + length);
+	}
+}
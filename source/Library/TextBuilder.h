@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Common.h"
+#include "MemoryArena.h"
+
+namespace Library
+{
+	// Builds wide text for display in arena memory, in place of a std::wostringstream, whose construction alone reaches
+	// the heap for its locale. Numbers are formatted as a stream would format them by default; SetPrecision stands in for
+	// std::setprecision. Text() stays valid until the builder is destroyed or its arena is reset.
+	class TextBuilder
+	{
+	public:
+		TextBuilder(MemoryArena& arena, UINT capacity = DefaultCapacity);
+
+		const wchar_t* Text() const;
+		UINT Length() const;
+
+		UINT Precision() const;
+		void SetPrecision(UINT precision);
+
+		TextBuilder& operator<<(const wchar_t* text);
+		TextBuilder& operator<<(const char* text);
+		TextBuilder& operator<<(int value);
+		TextBuilder& operator<<(UINT value);
+		TextBuilder& operator<<(float value);
+		TextBuilder& operator<<(double value);
+
+		static const UINT DefaultCapacity;
+		static const UINT DefaultPrecision;
+
+	private:
+		TextBuilder();
+		TextBuilder(const TextBuilder& rhs);
+		TextBuilder& operator=(const TextBuilder& rhs);
+
+		void Append(const wchar_t* text, UINT length);
+
+		// Always ends with the terminator, so Text() never has to copy
+		std::vector<wchar_t, ArenaAllocator<wchar_t>> mCharacters;
+		UINT mPrecision;
+	};
+}
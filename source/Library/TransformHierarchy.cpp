@@ -0,0 +1,572 @@
+#include "TransformHierarchy.h"
+#include "GameException.h"
+#include "MatrixHelper.h"
+#include "VectorHelper.h"
+#include "Parallel.h"
+#include <atomic>
+
+namespace Library
+{
+	const TransformHierarchy::Handle TransformHierarchy::InvalidHandle;
+	const UINT TransformHierarchy::InvalidIndex = UINT_MAX;
+	const UINT TransformHierarchy::DefaultMinimumNodesPerWorker = 1024;
+
+	TransformHierarchy::TransformHierarchy()
+		: mSlots(), mFreeSlots(), mSlotIndices(), mParentIndices(), mDepths(), mLocalTranslations(), mLocalRotations(), mLocalScales(),
+		mLocalTransforms(), mWorldTransforms(), mIsDecomposed(), mIsDirty(), mHasChanged(), mLevelOffsets(),
+		mIsOrderDirty(false), mIsDepthSorted(true), mAreLevelOffsetsDirty(true), mStatistics()
+	{
+	}
+
+	UINT TransformHierarchy::NodeCount() const
+	{
+		return mSlotIndices.size();
+	}
+
+	bool TransformHierarchy::IsValid(Handle node) const
+	{
+		return (node.Index < mSlots.size() && mSlots[node.Index].Generation == node.Generation && mSlots[node.Index].DenseIndex != InvalidIndex);
+	}
+
+	TransformHierarchy::Handle TransformHierarchy::Create(Handle parent)
+	{
+		return Create(parent, MatrixHelper::Identity);
+	}
+
+	TransformHierarchy::Handle TransformHierarchy::Create(Handle parent, const XMFLOAT4X4& localTransform)
+	{
+		UINT parentIndex = (parent == InvalidHandle ? InvalidIndex : GetDenseIndex(parent));
+
+		UINT slotIndex;
+		if (mFreeSlots.empty())
+		{
+			slotIndex = mSlots.size();
+			mSlots.push_back(Slot());
+		}
+		else
+		{
+			slotIndex = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		}
+
+		// Appending keeps the topological order intact because the parent already exists
+		UINT index = mSlotIndices.size();
+		mSlots[slotIndex].DenseIndex = index;
+
+		UINT depth = (parentIndex == InvalidIndex ? 0 : mDepths[parentIndex] + 1);
+		if (mDepths.empty() == false && depth < mDepths.back())
+		{
+			mIsDepthSorted = false;
+		}
+
+		mSlotIndices.push_back(slotIndex);
+		mParentIndices.push_back(parentIndex);
+		mDepths.push_back(depth);
+		mAreLevelOffsetsDirty = true;
+		mLocalTranslations.push_back(Vector3Helper::Zero);
+		mLocalRotations.push_back(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+		mLocalScales.push_back(Vector3Helper::One);
+		mLocalTransforms.push_back(MatrixHelper::Identity);
+		mWorldTransforms.push_back(MatrixHelper::Identity);
+		mIsDecomposed.push_back(true);
+		mIsDirty.push_back(true);
+		mHasChanged.push_back(false);
+
+		Handle node(slotIndex, mSlots[slotIndex].Generation);
+		SetLocalTransform(node, localTransform);
+
+		return node;
+	}
+
+	void TransformHierarchy::Destroy(Handle node)
+	{
+		UINT index = GetDenseIndex(node);
+		if (mIsOrderDirty)
+		{
+			SortByDepth();
+			index = GetDenseIndex(node);
+		}
+
+		// Descendants follow their ancestors, so one forward pass from the node finds the whole subtree
+		std::vector<bool> isDestroyed(mSlotIndices.size(), false);
+		isDestroyed[index] = true;
+		for (UINT i = index + 1; i < mSlotIndices.size(); i++)
+		{
+			UINT parentIndex = mParentIndices[i];
+			isDestroyed[i] = (parentIndex != InvalidIndex && isDestroyed[parentIndex]);
+		}
+
+		std::vector<UINT> remappedIndices(mSlotIndices.size(), InvalidIndex);
+		UINT count = 0;
+		for (UINT i = 0; i < mSlotIndices.size(); i++)
+		{
+			Slot& slot = mSlots[mSlotIndices[i]];
+			if (isDestroyed[i])
+			{
+				slot.DenseIndex = InvalidIndex;
+				slot.Generation++;
+				mFreeSlots.push_back(mSlotIndices[i]);
+				continue;
+			}
+
+			remappedIndices[i] = count;
+			slot.DenseIndex = count;
+
+			mSlotIndices[count] = mSlotIndices[i];
+			mParentIndices[count] = (mParentIndices[i] == InvalidIndex ? InvalidIndex : remappedIndices[mParentIndices[i]]);
+			mDepths[count] = mDepths[i];
+			mLocalTranslations[count] = mLocalTranslations[i];
+			mLocalRotations[count] = mLocalRotations[i];
+			mLocalScales[count] = mLocalScales[i];
+			mLocalTransforms[count] = mLocalTransforms[i];
+			mWorldTransforms[count] = mWorldTransforms[i];
+			mIsDecomposed[count] = mIsDecomposed[i];
+			mIsDirty[count] = mIsDirty[i];
+			mHasChanged[count] = mHasChanged[i];
+			count++;
+		}
+
+		mSlotIndices.resize(count);
+		mParentIndices.resize(count);
+		mDepths.resize(count);
+		mLocalTranslations.resize(count);
+		mLocalRotations.resize(count);
+		mLocalScales.resize(count);
+		mLocalTransforms.resize(count);
+		mWorldTransforms.resize(count);
+		mIsDecomposed.resize(count);
+		mIsDirty.resize(count);
+		mHasChanged.resize(count);
+		mAreLevelOffsetsDirty = true;
+	}
+
+	TransformHierarchy::Handle TransformHierarchy::GetParent(Handle node) const
+	{
+		UINT parentIndex = mParentIndices[GetDenseIndex(node)];
+
+		return (parentIndex == InvalidIndex ? InvalidHandle : HandleAt(parentIndex));
+	}
+
+	void TransformHierarchy::SetParent(Handle node, Handle parent)
+	{
+		UINT index = GetDenseIndex(node);
+		UINT parentIndex = InvalidIndex;
+
+		if (parent != InvalidHandle)
+		{
+			parentIndex = GetDenseIndex(parent);
+			for (UINT ancestorIndex = parentIndex; ancestorIndex != InvalidIndex; ancestorIndex = mParentIndices[ancestorIndex])
+			{
+				if (ancestorIndex == index)
+				{
+					throw GameException("A transform cannot be parented to itself or one of its descendants.");
+				}
+			}
+		}
+
+		mParentIndices[index] = parentIndex;
+		mIsDirty[index] = true;
+		mIsOrderDirty = true;
+	}
+
+	UINT TransformHierarchy::Depth(Handle node) const
+	{
+		UINT index = GetDenseIndex(node);
+		if (mIsOrderDirty == false)
+		{
+			return mDepths[index];
+		}
+
+		UINT depth = 0;
+		for (UINT ancestorIndex = mParentIndices[index]; ancestorIndex != InvalidIndex; ancestorIndex = mParentIndices[ancestorIndex])
+		{
+			depth++;
+		}
+
+		return depth;
+	}
+
+	const XMFLOAT3& TransformHierarchy::LocalTranslation(Handle node) const
+	{
+		return mLocalTranslations[GetDenseIndex(node)];
+	}
+
+	const XMFLOAT4& TransformHierarchy::LocalRotation(Handle node) const
+	{
+		UINT index = GetDenseIndex(node);
+		DecomposeLocalTransform(index);
+
+		return mLocalRotations[index];
+	}
+
+	const XMFLOAT3& TransformHierarchy::LocalScale(Handle node) const
+	{
+		UINT index = GetDenseIndex(node);
+		DecomposeLocalTransform(index);
+
+		return mLocalScales[index];
+	}
+
+	void TransformHierarchy::SetLocalTranslation(Handle node, const XMFLOAT3& translation)
+	{
+		// Only the last row changes, so the rest of the matrix is kept exactly, decomposed or not
+		UINT index = GetDenseIndex(node);
+		mLocalTranslations[index] = translation;
+
+		XMFLOAT4X4& localTransform = mLocalTransforms[index];
+		localTransform._41 = translation.x;
+		localTransform._42 = translation.y;
+		localTransform._43 = translation.z;
+		mIsDirty[index] = true;
+	}
+
+	void TransformHierarchy::SetLocalRotation(Handle node, const XMFLOAT4& rotationQuaternion)
+	{
+		UINT index = GetDenseIndex(node);
+		DecomposeLocalTransform(index);
+		mLocalRotations[index] = rotationQuaternion;
+		ComposeLocalTransform(index);
+	}
+
+	void TransformHierarchy::SetLocalScale(Handle node, const XMFLOAT3& scale)
+	{
+		UINT index = GetDenseIndex(node);
+		DecomposeLocalTransform(index);
+		mLocalScales[index] = scale;
+		ComposeLocalTransform(index);
+	}
+
+	const XMFLOAT4X4& TransformHierarchy::LocalTransform(Handle node) const
+	{
+		return mLocalTransforms[GetDenseIndex(node)];
+	}
+
+	XMMATRIX TransformHierarchy::LocalTransformMatrix(Handle node) const
+	{
+		return XMLoadFloat4x4(&mLocalTransforms[GetDenseIndex(node)]);
+	}
+
+	void TransformHierarchy::SetLocalTransform(Handle node, const XMFLOAT4X4& transform)
+	{
+		SetLocalTransform(node, XMLoadFloat4x4(&transform));
+	}
+
+	void TransformHierarchy::SetLocalTransform(Handle node, CXMMATRIX transform)
+	{
+		UINT index = GetDenseIndex(node);
+
+		// The matrix is kept exactly as given; rotation and scale are decomposed from it only if a caller asks for them
+		XMFLOAT4X4 localTransform;
+		XMStoreFloat4x4(&localTransform, transform);
+		if (memcmp(&localTransform, &mLocalTransforms[index], sizeof(XMFLOAT4X4)) == 0)
+		{
+			return;
+		}
+
+		mLocalTransforms[index] = localTransform;
+		mLocalTranslations[index] = XMFLOAT3(localTransform._41, localTransform._42, localTransform._43);
+		mIsDecomposed[index] = false;
+		mIsDirty[index] = true;
+	}
+
+	const XMFLOAT4X4& TransformHierarchy::WorldTransform(Handle node) const
+	{
+		return mWorldTransforms[GetDenseIndex(node)];
+	}
+
+	XMMATRIX TransformHierarchy::WorldTransformMatrix(Handle node) const
+	{
+		return XMLoadFloat4x4(&mWorldTransforms[GetDenseIndex(node)]);
+	}
+
+	bool TransformHierarchy::HasChanged(Handle node) const
+	{
+		return (mHasChanged[GetDenseIndex(node)] != 0);
+	}
+
+	void TransformHierarchy::MarkDirty(Handle node)
+	{
+		mIsDirty[GetDenseIndex(node)] = true;
+	}
+
+	void TransformHierarchy::Update()
+	{
+		if (mIsOrderDirty)
+		{
+			SortByDepth();
+		}
+
+		UINT count = mSlotIndices.size();
+
+		mStatistics.NodeCount = count;
+		mStatistics.RecomputedNodeCount = UpdateRange(0, count);
+		mStatistics.LevelCount = 0;
+		mStatistics.ParallelLevelCount = 0;
+	}
+
+	void TransformHierarchy::UpdateParallel(UINT minimumNodesPerWorker)
+	{
+		if (mIsOrderDirty || mIsDepthSorted == false)
+		{
+			SortByDepth();
+		}
+
+		if (mAreLevelOffsetsDirty)
+		{
+			UpdateLevelOffsets();
+		}
+
+		// Every node within a level depends only on earlier levels, so a level's nodes run concurrently and each level
+		// waits for the previous one. Nodes go through the same UpdateRange as the serial path, so results are bit-identical.
+		std::atomic<UINT> recomputedCount(0);
+		UINT levelCount = mLevelOffsets.size() - 1;
+		UINT parallelLevelCount = 0;
+		for (UINT level = 0; level < levelCount; level++)
+		{
+			UINT begin = mLevelOffsets[level];
+			UINT end = mLevelOffsets[level + 1];
+			if (end - begin >= minimumNodesPerWorker * 2)
+			{
+				parallelLevelCount++;
+			}
+
+			Parallel::For(begin, end, minimumNodesPerWorker, [this, &recomputedCount](UINT rangeBegin, UINT rangeEnd)
+			{
+				recomputedCount += UpdateRange(rangeBegin, rangeEnd);
+			});
+		}
+
+		mStatistics.NodeCount = mSlotIndices.size();
+		mStatistics.RecomputedNodeCount = recomputedCount;
+		mStatistics.LevelCount = levelCount;
+		mStatistics.ParallelLevelCount = parallelLevelCount;
+	}
+
+	const TransformHierarchy::Statistics& TransformHierarchy::GetStatistics() const
+	{
+		return mStatistics;
+	}
+
+	UINT TransformHierarchy::UpdateRange(UINT begin, UINT end)
+	{
+		// Depth order keeps siblings together, so a run of them multiplies against the parent's rows loaded once into registers
+		UINT recomputedCount = 0;
+		UINT loadedParentIndex = InvalidIndex;
+		XMMATRIX parentWorldTransform = XMMatrixIdentity();
+		for (UINT i = begin; i < end; i++)
+		{
+			UINT parentIndex = mParentIndices[i];
+			assert(parentIndex == InvalidIndex || parentIndex < i);
+
+			// A node is stale when its own local changed or its parent's world was recomputed earlier in this pass
+			bool isStale = (mIsDirty[i] != 0 || (parentIndex != InvalidIndex && mHasChanged[parentIndex] != 0));
+			mIsDirty[i] = false;
+			mHasChanged[i] = isStale;
+			if (isStale == false)
+			{
+				continue;
+			}
+
+			if (parentIndex == InvalidIndex)
+			{
+				mWorldTransforms[i] = mLocalTransforms[i];
+			}
+			else
+			{
+				if (parentIndex != loadedParentIndex)
+				{
+					parentWorldTransform = XMLoadFloat4x4(&mWorldTransforms[parentIndex]);
+					loadedParentIndex = parentIndex;
+				}
+
+				XMStoreFloat4x4(&mWorldTransforms[i], XMMatrixMultiply(XMLoadFloat4x4(&mLocalTransforms[i]), parentWorldTransform));
+			}
+
+			recomputedCount++;
+		}
+
+		return recomputedCount;
+	}
+
+	void TransformHierarchy::UpdateLevelOffsets()
+	{
+		assert(mIsDepthSorted);
+
+		mLevelOffsets.clear();
+		mLevelOffsets.push_back(0);
+
+		UINT count = mDepths.size();
+		for (UINT i = 1; i < count; i++)
+		{
+			if (mDepths[i] != mDepths[i - 1])
+			{
+				mLevelOffsets.push_back(i);
+			}
+		}
+
+		if (count > 0)
+		{
+			mLevelOffsets.push_back(count);
+		}
+
+		mAreLevelOffsetsDirty = false;
+	}
+
+	UINT TransformHierarchy::DenseIndex(Handle node) const
+	{
+		return GetDenseIndex(node);
+	}
+
+	TransformHierarchy::Handle TransformHierarchy::HandleAt(UINT denseIndex) const
+	{
+		UINT slotIndex = mSlotIndices.at(denseIndex);
+
+		return Handle(slotIndex, mSlots[slotIndex].Generation);
+	}
+
+	const std::vector<UINT>& TransformHierarchy::ParentIndices() const
+	{
+		return mParentIndices;
+	}
+
+	const std::vector<XMFLOAT4X4>& TransformHierarchy::LocalTransforms() const
+	{
+		return mLocalTransforms;
+	}
+
+	const std::vector<XMFLOAT4X4>& TransformHierarchy::WorldTransforms() const
+	{
+		return mWorldTransforms;
+	}
+
+	UINT TransformHierarchy::GetDenseIndex(Handle node) const
+	{
+		if (IsValid(node) == false)
+		{
+			throw GameException("Invalid transform handle.");
+		}
+
+		return mSlots[node.Index].DenseIndex;
+	}
+
+	void TransformHierarchy::ComposeLocalTransform(UINT index)
+	{
+		XMMATRIX transform = XMMatrixAffineTransformation(XMLoadFloat3(&mLocalScales[index]), XMVectorZero(), XMLoadFloat4(&mLocalRotations[index]), XMLoadFloat3(&mLocalTranslations[index]));
+		XMStoreFloat4x4(&mLocalTransforms[index], transform);
+		mIsDirty[index] = true;
+	}
+
+	void TransformHierarchy::DecomposeLocalTransform(UINT index) const
+	{
+		if (mIsDecomposed[index])
+		{
+			return;
+		}
+
+		// A singular matrix has no rotation to recover, and composing a guess would silently replace it
+		XMVECTOR scale;
+		XMVECTOR rotationQuaternion;
+		XMVECTOR translation;
+		if (XMMatrixDecompose(&scale, &rotationQuaternion, &translation, XMLoadFloat4x4(&mLocalTransforms[index])) == false)
+		{
+			throw GameException("The local transform cannot be decomposed into rotation and scale.");
+		}
+
+		XMStoreFloat3(&mLocalScales[index], scale);
+		XMStoreFloat4(&mLocalRotations[index], rotationQuaternion);
+		mIsDecomposed[index] = true;
+	}
+
+	void TransformHierarchy::SortByDepth()
+	{
+		UINT count = mSlotIndices.size();
+
+		// Reparenting may have put a child ahead of its parent, so depths are resolved by walking up rather than in order
+		const UINT unresolved = InvalidIndex;
+		std::vector<UINT> depths(count, unresolved);
+		UINT maxDepth = 0;
+		std::vector<UINT> path;
+		for (UINT i = 0; i < count; i++)
+		{
+			UINT index = i;
+			while (index != InvalidIndex && depths[index] == unresolved)
+			{
+				path.push_back(index);
+				index = mParentIndices[index];
+			}
+
+			UINT depth = (index == InvalidIndex ? 0 : depths[index] + 1);
+			while (path.empty() == false)
+			{
+				depths[path.back()] = depth++;
+				path.pop_back();
+			}
+
+			if (depths[i] > maxDepth)
+			{
+				maxDepth = depths[i];
+			}
+		}
+
+		// Stable counting sort by depth; parents always sort ahead of their children
+		std::vector<UINT> depthOffsets(maxDepth + 2, 0);
+		for (UINT depth : depths)
+		{
+			depthOffsets[depth + 1]++;
+		}
+
+		for (UINT depth = 1; depth < depthOffsets.size(); depth++)
+		{
+			depthOffsets[depth] += depthOffsets[depth - 1];
+		}
+
+		std::vector<UINT> order(count);
+		std::vector<UINT> remappedIndices(count);
+		for (UINT i = 0; i < count; i++)
+		{
+			UINT newIndex = depthOffsets[depths[i]]++;
+			order[newIndex] = i;
+			remappedIndices[i] = newIndex;
+		}
+
+		mDepths = depths;
+		Permute(mSlotIndices, order);
+		Permute(mParentIndices, order);
+		Permute(mDepths, order);
+		Permute(mLocalTranslations, order);
+		Permute(mLocalRotations, order);
+		Permute(mLocalScales, order);
+		Permute(mLocalTransforms, order);
+		Permute(mWorldTransforms, order);
+		Permute(mIsDecomposed, order);
+		Permute(mIsDirty, order);
+		Permute(mHasChanged, order);
+
+		for (UINT i = 0; i < count; i++)
+		{
+			if (mParentIndices[i] != InvalidIndex)
+			{
+				mParentIndices[i] = remappedIndices[mParentIndices[i]];
+			}
+
+			mSlots[mSlotIndices[i]].DenseIndex = i;
+		}
+
+		mIsOrderDirty = false;
+		mIsDepthSorted = true;
+		mAreLevelOffsetsDirty = true;
+	}
+
+	template <typename T>
+	void TransformHierarchy::Permute(std::vector<T>& values, const std::vector<UINT>& order)
+	{
+		std::vector<T> permutedValues;
+		permutedValues.reserve(values.size());
+		for (UINT index : order)
+		{
+			permutedValues.push_back(values[index]);
+		}
+
+		values.swap(permutedValues);
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Common.h"
+
+namespace Library
+{
+	// Transforms stored as contiguous arrays kept in topological order (every parent precedes its children),
+	// so world transforms are produced by a single forward pass that only recomputes nodes whose local transform
+	// or an ancestor's changed since the previous update. Nodes are referenced through generation-checked
+	// handles; dense indices are only stable until the next structural change.
+	// A hierarchy is plain data and copies by value, which lets a shared bind pose seed per-instance poses.
+	class TransformHierarchy
+	{
+	public:
+		struct Handle
+		{
+			UINT Index;
+			UINT Generation;
+
+			Handle()
+				: Index(UINT_MAX), Generation(0) { }
+
+			Handle(UINT index, UINT generation)
+				: Index(index), Generation(generation) { }
+
+			bool operator==(const Handle& rhs) const { return (Index == rhs.Index && Generation == rhs.Generation); }
+			bool operator!=(const Handle& rhs) const { return !(*this == rhs); }
+		};
+
+		struct Statistics
+		{
+			UINT NodeCount;
+			UINT RecomputedNodeCount;
+			UINT LevelCount;			// Depth levels visited by the last parallel update; zero after a serial update
+			UINT ParallelLevelCount;	// Levels large enough to be split across workers
+
+			Statistics()
+				: NodeCount(0), RecomputedNodeCount(0), LevelCount(0), ParallelLevelCount(0) { }
+		};
+
+		static const Handle InvalidHandle;
+		static const UINT InvalidIndex;
+		static const UINT DefaultMinimumNodesPerWorker;
+
+		TransformHierarchy();
+
+		UINT NodeCount() const;
+		bool IsValid(Handle node) const;
+
+		Handle Create(Handle parent = InvalidHandle);
+		Handle Create(Handle parent, const XMFLOAT4X4& localTransform);
+		void Destroy(Handle node);
+
+		Handle GetParent(Handle node) const;
+		void SetParent(Handle node, Handle parent);
+		UINT Depth(Handle node) const;
+
+		// Rotation and scale are decomposed from a matrix given to SetLocalTransform only once they are read or set, and
+		// throw for a matrix with no decomposition; translation is always the matrix's last row. Reading rotation or scale
+		// may fill that cache, so it is no safer alongside another thread's edits than a setter.
+		const XMFLOAT3& LocalTranslation(Handle node) const;
+		const XMFLOAT4& LocalRotation(Handle node) const;
+		const XMFLOAT3& LocalScale(Handle node) const;
+		void SetLocalTranslation(Handle node, const XMFLOAT3& translation);
+		void SetLocalRotation(Handle node, const XMFLOAT4& rotationQuaternion);
+		void SetLocalScale(Handle node, const XMFLOAT3& scale);
+
+		const XMFLOAT4X4& LocalTransform(Handle node) const;
+		XMMATRIX LocalTransformMatrix(Handle node) const;
+		void SetLocalTransform(Handle node, const XMFLOAT4X4& transform);
+		void SetLocalTransform(Handle node, CXMMATRIX transform);
+
+		const XMFLOAT4X4& WorldTransform(Handle node) const;
+		XMMATRIX WorldTransformMatrix(Handle node) const;
+
+		bool HasChanged(Handle node) const;
+		void MarkDirty(Handle node);
+
+		void Update();
+		void UpdateParallel(UINT minimumNodesPerWorker = DefaultMinimumNodesPerWorker);
+		const Statistics& GetStatistics() const;
+
+		UINT DenseIndex(Handle node) const;
+		Handle HandleAt(UINT denseIndex) const;
+		const std::vector<UINT>& ParentIndices() const;
+		const std::vector<XMFLOAT4X4>& LocalTransforms() const;
+		const std::vector<XMFLOAT4X4>& WorldTransforms() const;
+
+	private:
+		struct Slot
+		{
+			UINT DenseIndex;
+			UINT Generation;
+
+			Slot()
+				: DenseIndex(InvalidIndex), Generation(0) { }
+		};
+
+		UINT GetDenseIndex(Handle node) const;
+		void ComposeLocalTransform(UINT index);
+		void DecomposeLocalTransform(UINT index) const;
+		UINT UpdateRange(UINT begin, UINT end);
+		void UpdateLevelOffsets();
+		void SortByDepth();
+
+		template <typename T>
+		static void Permute(std::vector<T>& values, const std::vector<UINT>& order);
+
+		std::vector<Slot> mSlots;
+		std::vector<UINT> mFreeSlots;
+
+		// Dense arrays, all indexed alike and kept in topological order
+		std::vector<UINT> mSlotIndices;
+		std::vector<UINT> mParentIndices;
+		std::vector<UINT> mDepths;
+		std::vector<XMFLOAT3> mLocalTranslations;
+		mutable std::vector<XMFLOAT4> mLocalRotations;
+		mutable std::vector<XMFLOAT3> mLocalScales;
+		std::vector<XMFLOAT4X4> mLocalTransforms;
+		std::vector<XMFLOAT4X4> mWorldTransforms;
+		mutable std::vector<byte> mIsDecomposed;	// Local rotation and scale agree with the local transform
+		std::vector<byte> mIsDirty;			// Local transform edited since the last update
+		std::vector<byte> mHasChanged;		// World transform recomputed by the last update
+
+		std::vector<UINT> mLevelOffsets;	// Start of each depth level, valid while mIsDepthSorted and not mAreLevelOffsetsDirty
+
+		bool mIsOrderDirty;
+		bool mIsDepthSorted;
+		bool mAreLevelOffsetsDirty;
+		Statistics mStatistics;
+	};
+}
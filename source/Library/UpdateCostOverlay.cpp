@@ -0,0 +1,147 @@
+#include "UpdateCostOverlay.h"
+#include <SpriteBatch.h>
+#include <SpriteFont.h>
+#include "Game.h"
+#include "ComponentGraph.h"
+#include "Utility.h"
+#include "TextBuilder.h"
+#include "RenderPipeline.h"
+#include <typeinfo>
+
+namespace Library
+{
+	RTTI_DEFINITIONS(UpdateCostOverlay)
+
+	UpdateCostOverlay::UpdateCostOverlay(Game& game)
+		: DrawableGameComponent(game), mSpriteBatch(nullptr), mSpriteFont(nullptr), mTextPosition(0.0f, 60.0f), mDrawStates(), mNamedComponents(), mNames()
+	{
+	}
+
+	UpdateCostOverlay::~UpdateCostOverlay()
+	{
+		DeleteObject(mSpriteFont);
+		DeleteObject(mSpriteBatch);
+	}
+
+	XMFLOAT2& UpdateCostOverlay::TextPosition()
+	{
+		return mTextPosition;
+	}
+
+	void UpdateCostOverlay::Initialize()
+	{
+		SetCurrentDirectory(Utility::ExecutableDirectory().c_str());
+
+		mSpriteBatch = new SpriteBatch(mGame->Direct3DDeviceContext());
+		mSpriteFont = new SpriteFont(mGame->Direct3DDevice(), L"..\\source\\Library\\Content\\Arial_14_Regular.spritefont");
+	}
+
+	void UpdateCostOverlay::CaptureRenderState(RenderSnapshot& snapshot)
+	{
+		DrawState& drawState = mDrawStates[snapshot.Index()];
+		drawState.IsVisible = Visible();
+		if (drawState.IsVisible == false)
+		{
+			return;
+		}
+
+		const ComponentGraph& updateGraph = mGame->UpdateGraph();
+		const std::vector<GameComponent*>& components = updateGraph.Components();
+		const std::vector<ComponentGraph::ComponentCost>& costs = updateGraph.ComponentCosts();
+		if (components != mNamedComponents)
+		{
+			RefreshNames();
+		}
+
+		drawState.Statistics = updateGraph.GetStatistics();
+		drawState.Names = mNames;
+		drawState.Rows.resize(components.size());
+
+		for (UINT i = 0; i < components.size(); i++)
+		{
+			GameComponent* component = components[i];
+			Row& row = drawState.Rows[i];
+
+			row.AverageMilliseconds = costs[i].AverageMilliseconds;
+			row.Budget = component->UpdateBudget();
+			row.Interval = component->UpdateInterval();
+			row.IsHeld = (component->Enabled() && costs[i].WasUpdated == false);
+		}
+	}
+
+	void UpdateCostOverlay::Draw(const GameTime& gameTime)
+	{
+		const DrawState& drawState = mDrawStates[mGame->Pipeline().Current().Index()];
+		if (drawState.IsVisible == false)
+		{
+			return;
+		}
+
+		const ComponentGraph::Statistics& statistics = drawState.Statistics;
+		const std::vector<std::wstring>& names = *drawState.Names;
+
+		TextBuilder overlayText(mGame->FrameArena(), 1024);
+		overlayText.SetPrecision(3);
+		overlayText << L"Update: " << statistics.Milliseconds << L" ms, " << statistics.UpdatedCount << L" updated, "
+			<< statistics.HeldCount << L" held, " << statistics.DeferredCount << L" deferred";
+
+		for (UINT i = 0; i < drawState.Rows.size(); i++)
+		{
+			const Row& row = drawState.Rows[i];
+
+			overlayText << L"\n" << names[i].c_str() << L": " << row.AverageMilliseconds << L" ms";
+			if (row.Budget > 0.0)
+			{
+				overlayText << L" of " << row.Budget << L" ms";
+				if (row.AverageMilliseconds > row.Budget)
+				{
+					overlayText << L" OVER";
+				}
+			}
+
+			if (row.Interval > 0.0)
+			{
+				overlayText << L", every " << row.Interval << L" s";
+			}
+
+			if (row.IsHeld)
+			{
+				overlayText << L" (held)";
+			}
+		}
+
+		mSpriteBatch->Begin();
+		mSpriteFont->DrawString(mSpriteBatch, overlayText.Text(), mTextPosition);
+		mSpriteBatch->End();
+	}
+
+	void UpdateCostOverlay::RefreshNames()
+	{
+		const std::vector<GameComponent*>& components = mGame->UpdateGraph().Components();
+		mNamedComponents = components;
+
+		// A new list rather than a cleared one, since the snapshot being drawn may still hold the old names
+		std::shared_ptr<std::vector<std::wstring>> names(new std::vector<std::wstring>());
+		names->reserve(components.size());
+
+		for (GameComponent* component : components)
+		{
+			// Drops the "class " prefix and namespace the compiler's type name carries
+			std::string name = typeid(*component).name();
+			std::string::size_type separator = name.find_last_of(": ");
+			if (separator != std::string::npos)
+			{
+				name = name.substr(separator + 1);
+			}
+
+			names->push_back(Utility::ToWideString(name));
+		}
+
+		mNames = names;
+	}
+
+	bool UpdateCostOverlay::DrawsFromSnapshot() const
+	{
+		return true;
+	}
+}
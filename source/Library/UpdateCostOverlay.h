@@ -0,0 +1,70 @@
+#pragma once
+
+#include "DrawableGameComponent.h"
+#include "ComponentGraph.h"
+
+namespace DirectX
+{
+	class SpriteBatch;
+	class SpriteFont;
+}
+
+namespace Library
+{
+	// Lists each component in the game's update graph with its measured update cost against its budget and interval.
+	// Drawn by the game after its components, as the FpsComponent is, rather than added to the component list, so the game
+	// also forwards its CaptureRenderState here; the figures and visibility Draw shows are those captured for its snapshot.
+	class UpdateCostOverlay : public DrawableGameComponent
+	{
+		RTTI_DECLARATIONS(UpdateCostOverlay, DrawableGameComponent)
+
+	public:
+		UpdateCostOverlay(Game& game);
+		~UpdateCostOverlay();
+
+		XMFLOAT2& TextPosition();
+
+		virtual void Initialize() override;
+		virtual void CaptureRenderState(RenderSnapshot& snapshot) override;
+		virtual void Draw(const GameTime& gameTime) override;
+		virtual bool DrawsFromSnapshot() const override;
+
+	private:
+		UpdateCostOverlay();
+		UpdateCostOverlay(const UpdateCostOverlay& rhs);
+		UpdateCostOverlay& operator=(const UpdateCostOverlay& rhs);
+
+		struct Row
+		{
+			double AverageMilliseconds;
+			double Budget;
+			double Interval;
+			bool IsHeld;
+
+			Row()
+				: AverageMilliseconds(0.0), Budget(0.0), Interval(0.0), IsHeld(false) { }
+		};
+
+		struct DrawState
+		{
+			bool IsVisible;
+			ComponentGraph::Statistics Statistics;
+			std::vector<Row> Rows;
+			std::shared_ptr<const std::vector<std::wstring>> Names;
+
+			DrawState()
+				: IsVisible(false), Statistics(), Rows(), Names() { }
+		};
+
+		void RefreshNames();
+
+		SpriteBatch* mSpriteBatch;
+		SpriteFont* mSpriteFont;
+		XMFLOAT2 mTextPosition;
+		DrawState mDrawStates[2];		// Indexed by RenderSnapshot::Index
+
+		// Named once per component list, so steady frames draw without touching the heap; a list drawn from keeps its names
+		std::vector<GameComponent*> mNamedComponents;
+		std::shared_ptr<const std::vector<std::wstring>> mNames;
+	};
+}
@@ -77,6 +77,18 @@ namespace Library
 		}
 	}
 
+	void Utility::GetFullPath(const std::string& inputPath, std::string& fullPath)
+	{
+		char buffer[MAX_PATH];
+		DWORD length = GetFullPathNameA(inputPath.c_str(), MAX_PATH, buffer, nullptr);
+		if (length == 0 || length >= MAX_PATH)
+		{
+			throw std::exception("Could not resolve path.");
+		}
+
+		fullPath.assign(buffer, length);
+	}
+
 	void Utility::LoadBinaryFile(const std::wstring& filename, std::vector<char>& data)
 	{
 		std::ifstream file(filename.c_str(), std::ios::binary);
@@ -111,6 +123,26 @@ namespace Library
 		return dest;
 	}
 
+	std::string Utility::ToUtf8String(const std::wstring& source)
+	{
+		std::string dest;
+		if (source.empty())
+		{
+			return dest;
+		}
+
+		int size = WideCharToMultiByte(CP_UTF8, 0, source.c_str(), static_cast<int>(source.size()), nullptr, 0, nullptr, nullptr);
+		if (size == 0)
+		{
+			throw std::exception("Could not convert string.");
+		}
+
+		dest.resize(size);
+		WideCharToMultiByte(CP_UTF8, 0, source.c_str(), static_cast<int>(source.size()), &dest[0], size, nullptr, nullptr);
+
+		return dest;
+	}
+
 	void Utility::PathJoin(std::wstring& dest, const std::wstring& sourceDirectory, const std::wstring& sourceFile)
 	{
 		WCHAR buffer[MAX_PATH];
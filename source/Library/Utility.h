@@ -12,9 +12,11 @@ namespace Library
 		static void GetFileName(const std::string& inputPath, std::string& filename);
 		static void GetDirectory(const std::string& inputPath, std::string& directory);
 		static void GetFileNameAndDirectory(const std::string& inputPath, std::string& directory, std::string& filename);
+		static void GetFullPath(const std::string& inputPath, std::string& fullPath);
 		static void LoadBinaryFile(const std::wstring& filename, std::vector<char>& data);
 		static void ToWideString(const std::string& source, std::wstring& dest);
 		static std::wstring ToWideString(const std::string& source);
+		static std::string ToUtf8String(const std::wstring& source);
 		static void PathJoin(std::wstring& dest, const std::wstring& sourceDirectory, const std::wstring& sourceFile);
 		static void GetPathExtension(const std::wstring& source, std::wstring& dest);
 	private:
@@ -132,4 +132,17 @@ namespace Library
 
 		return *this;
 	}
+
+	Variable& Variable::SetMatrixArray(const XMFLOAT4X4* values, UINT count)
+	{
+		ID3DX11EffectMatrixVariable* variable = mVariable->AsMatrix();
+		if (variable->IsValid() == false)
+		{
+			throw GameException("Invalid effect variable cast.");
+		}
+
+		variable->SetMatrixArray(reinterpret_cast<const float*>(values), 0, count);
+
+		return *this;
+	}
 }
\ No newline at end of file
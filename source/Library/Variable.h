@@ -27,6 +27,9 @@ namespace Library
 		Variable& operator<<(const std::vector<XMFLOAT2>& values);
 		Variable& operator<<(const std::vector<XMFLOAT4X4>& values);
 
+		// For matrix arrays held outside a vector, such as a bone palette in a RenderSnapshot
+		Variable& SetMatrixArray(const XMFLOAT4X4* values, UINT count);
+
 	private:
 		Variable(const Variable& rhs);
 		Variable& operator=(const Variable& rhs);